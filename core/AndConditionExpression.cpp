@@ -21,6 +21,21 @@ bool core::AndConditionExpression::isStaticSatisfied()
   });
 }
 
+boost::optional<core::AndConditionExpression>
+core::AndConditionExpression::dynamicConditions() const {
+  QSet<ConditionExpression> condSet;
+  for (const auto& cond : m_condSet) {
+    if (!cond.isStatic()) {
+      condSet.insert(cond);
+    }
+  }
+
+  if (condSet.isEmpty()) {
+    return boost::none;
+  }
+  return AndConditionExpression(condSet);
+}
+
 QString core::AndConditionExpression::toString() {
   QStringList strs;
   for (const auto& cond : m_condSet) {
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <boost/optional.hpp>
 #include <QSet>
 
 #include "macros.h"
@@ -17,6 +18,9 @@ class AndConditionExpression {
 
   // check only static conditions
   bool isStaticSatisfied();
+
+  // Returns the conditions which are not static, or none if all of them are static.
+  boost::optional<AndConditionExpression> dynamicConditions() const;
   QString toString();
 
   int size();
@@ -0,0 +1,148 @@
+#include <algorithm>
+#include <QTextBlock>
+#include <QTextDocument>
+
+#include "BracketPairs.h"
+#include "ScopeTree.h"
+#include "Tracer.h"
+
+namespace core {
+
+namespace {
+// Returns the kind of a bracket, or -1 if ch isn't a bracket
+int kindOf(QChar ch) {
+  switch (ch.unicode()) {
+    case '(':
+      return 0;
+    case ')':
+      return 1;
+    case '[':
+      return 2;
+    case ']':
+      return 3;
+    case '{':
+      return 4;
+    case '}':
+      return 5;
+    default:
+      return -1;
+  }
+}
+
+// true if scope is string, comment or their descendant
+bool isIgnoredScope(const QString& scope) {
+  for (const QString& root : {QStringLiteral("string"), QStringLiteral("comment")}) {
+    if (scope.startsWith(root) &&
+        (scope.size() == root.size() || scope[root.size()] == QLatin1Char('.'))) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Returns the sorted regions of strings and comments intersecting region. Their children are
+// skipped because strings and comments don't nest other nodes of interest.
+QVector<Region> ignoredRegions(const ScopeTree* tree, const Region& region) {
+  QVector<Region> regions;
+  if (!tree) {
+    return regions;
+  }
+
+  tree->visit(region, [&](const ScopeNode& node, const Region& nodeRegion) {
+    if (!isIgnoredScope(node.name())) {
+      return true;
+    }
+    if (!nodeRegion.isEmpty()) {
+      regions.append(nodeRegion);
+    }
+    return false;
+  });
+  // Nodes of contentName overlap their siblings
+  std::sort(regions.begin(), regions.end(),
+            [](const Region& x, const Region& y) { return x.begin() < y.begin(); });
+  return regions;
+}
+
+bool isIgnored(const QVector<Region>& regions, int pos) {
+  auto it = std::upper_bound(
+      regions.begin(), regions.end(), pos,
+      [](int value, const Region& region) { return value < region.begin(); });
+  return it != regions.begin() && pos < (it - 1)->end();
+}
+}
+
+int BracketPairs::match(int pos) const {
+  const int index = m_brackets.lowerBound(pos);
+  if (index == m_brackets.size() || m_brackets.positionAt(index) != pos) {
+    return -1;
+  }
+  const int pair = m_brackets.pairOf(index);
+  return pair >= 0 ? m_brackets.positionAt(pair) : -1;
+}
+
+boost::optional<BracketPair> BracketPairs::enclosing(int pos) const {
+  const int index = m_brackets.lowerBound(pos);
+  const int open = m_brackets.enclosingOpen(index, index);
+  if (open < 0) {
+    return boost::none;
+  }
+  return BracketPair{m_brackets.positionAt(open), m_brackets.positionAt(m_brackets.pairOf(open))};
+}
+
+void BracketPairs::reset(const ScopeTree* tree, const QTextDocument* doc) {
+  TRACE_SCOPE("BracketPairs::reset");
+  QVector<int> positions;
+  QVector<quint8> kinds;
+  scan(tree, doc, 0, doc->characterCount(), positions, kinds);
+  m_brackets.reset(positions, kinds);
+}
+
+void BracketPairs::replace(const ScopeTree* tree, const Region& region, const QTextDocument* doc) {
+  TRACE_SCOPE("BracketPairs::replace");
+  const int end = std::min(region.end(), doc->characterCount());
+  QVector<int> positions;
+  QVector<quint8> kinds;
+  scan(tree, doc, region.begin(), end, positions, kinds);
+  m_brackets.splice(m_brackets.lowerBound(region.begin()), m_brackets.lowerBound(end), positions,
+                    kinds, 0);
+}
+
+void BracketPairs::update(const ScopeTree* tree,
+                          const QTextDocument* doc,
+                          int position,
+                          int charsRemoved,
+                          int charsAdded) {
+  if (charsRemoved == 0 && charsAdded == 0) {
+    return;
+  }
+
+  QVector<int> positions;
+  QVector<quint8> kinds;
+  scan(tree, doc, position, position + charsAdded, positions, kinds);
+  m_brackets.splice(m_brackets.lowerBound(position), m_brackets.lowerBound(position + charsRemoved),
+                    positions, kinds, charsAdded - charsRemoved);
+}
+
+void BracketPairs::scan(const ScopeTree* tree,
+                        const QTextDocument* doc,
+                        int begin,
+                        int end,
+                        QVector<int>& positions,
+                        QVector<quint8>& kinds) const {
+  const QVector<Region> regions = ignoredRegions(tree, Region(begin, end));
+  for (QTextBlock block = doc->findBlock(begin); block.isValid() && block.position() < end;
+       block = block.next()) {
+    const QString text = block.text();
+    const int blockPos = block.position();
+    const int to = std::min(end - blockPos, text.size());
+    for (int i = std::max(begin - blockPos, 0); i < to; i++) {
+      const int kind = kindOf(text[i]);
+      if (kind >= 0 && !isIgnored(regions, blockPos + i)) {
+        positions.append(blockPos + i);
+        kinds.append(static_cast<quint8>(kind));
+      }
+    }
+  }
+}
+
+}  // namespace core
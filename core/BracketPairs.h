@@ -0,0 +1,68 @@
+#pragma once
+
+#include <boost/optional.hpp>
+#include <QVector>
+
+#include "macros.h"
+#include "Region.h"
+#include "TokenPairs.h"
+
+class QTextDocument;
+
+namespace core {
+
+class ScopeTree;
+
+struct BracketPair {
+  // positions of the opening and the closing brackets
+  int open;
+  int close;
+};
+
+// Brackets of a document and their pairs, kept by SyntaxHighlighter.
+//
+// Brackets in string and comment nodes of the scope tree are ignored. The positions are updated on
+// contentsChange by dropping the removed brackets and scanning only the inserted text, so the
+// document is never scanned again after the first parse. The string and comment nodes are looked
+// up in the scope tree for the scanned text only. TokenPairs moves the following brackets lazily
+// and pairs again only the ones in the innermost pair enclosing an edit, or the ones around it at
+// the top level. The pair of a bracket is read from its offset and the enclosing pair is found by
+// binary search in the pairs of each depth.
+class BracketPairs {
+ public:
+  BracketPairs() = default;
+  ~BracketPairs() = default;
+  DEFAULT_COPY_AND_MOVE(BracketPairs)
+
+  // Returns the position of the bracket paired with the one at pos, or -1 if there is no bracket
+  // at pos or it's unpaired.
+  int match(int pos) const;
+  // Returns the innermost pair whose brackets enclose pos (open < pos <= close)
+  boost::optional<BracketPair> enclosing(int pos) const;
+
+  // Rebuilds the brackets from the whole text of doc. tree is the tree of a full parse or null.
+  void reset(const ScopeTree* tree, const QTextDocument* doc);
+  // Scans the brackets in region again after tree has replaced its nodes with a partial parse
+  void replace(const ScopeTree* tree, const Region& region, const QTextDocument* doc);
+  // Updates the brackets after charsRemoved characters at position are replaced with charsAdded
+  // characters in doc. tree has been adjusted for the change already.
+  void update(const ScopeTree* tree,
+              const QTextDocument* doc,
+              int position,
+              int charsRemoved,
+              int charsAdded);
+
+ private:
+  // The kinds are 0 to 5 for ( ) [ ] { }
+  TokenPairs m_brackets;
+
+  // Appends the brackets in [begin, end) of doc
+  void scan(const ScopeTree* tree,
+            const QTextDocument* doc,
+            int begin,
+            int end,
+            QVector<int>& positions,
+            QVector<quint8>& kinds) const;
+};
+
+}  // namespace core
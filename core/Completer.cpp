@@ -1,8 +1,17 @@
 #include "Completer.h"
+#include "CompletionIndex.h"
 
 namespace core {
 
-Completer::Completer(QObject* parent) : QCompleter(parent) {}
+Completer::Completer(QObject* parent)
+    : QCompleter(parent), m_modeBeforeCompletions(QCompleter::completionMode()) {}
+
+Completer::~Completer() {
+  // The proxy of QCompleter still refers to the model until the base class is destroyed
+  if (QCompleter::model() == &m_completionsModel) {
+    QCompleter::setModel(nullptr);
+  }
+}
 
 void Completer::setWidget(QWidget* widget) {
   QCompleter::setWidget(widget);
@@ -13,6 +22,9 @@ QWidget* Completer::widget() const {
 }
 
 void Completer::setModel(QAbstractItemModel* c) {
+  if (QCompleter::model() == &m_completionsModel && c != &m_completionsModel) {
+    QCompleter::setCompletionMode(m_modeBeforeCompletions);
+  }
   QCompleter::setModel(c);
 }
 
@@ -48,4 +60,16 @@ QAbstractItemModel* Completer::completionModel() const {
   return QCompleter::completionModel();
 }
 
+int Completer::setCompletions(Document* doc, int pos, int maxCount) {
+  const QStringList words = CompletionIndex::singleton().completeAt(doc, pos, maxCount);
+  if (QCompleter::model() != &m_completionsModel) {
+    m_modeBeforeCompletions = QCompleter::completionMode();
+    QCompleter::setModel(&m_completionsModel);
+  }
+  m_completionsModel.setStringList(words);
+  QCompleter::setCompletionMode(QCompleter::UnfilteredPopupCompletion);
+  setCompletionPrefix(QString());
+  return words.size();
+}
+
 }  // namespace core
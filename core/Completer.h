@@ -1,11 +1,14 @@
 #pragma once
 
 #include <QCompleter>
+#include <QStringListModel>
 
 #include "core/macros.h"
 
 namespace core {
 
+class Document;
+
 class Completer : public QCompleter {
   Q_OBJECT
   DISABLE_COPY(Completer)
@@ -18,7 +21,7 @@ class Completer : public QCompleter {
   Q_ENUM(ModelSorting)
 
   Q_INVOKABLE Completer(QObject* parent = nullptr);
-  ~Completer() = default;
+  ~Completer();
   DEFAULT_MOVE(Completer)
 
  public Q_SLOTS:
@@ -42,7 +45,16 @@ class Completer : public QCompleter {
 
   QAbstractItemModel* completionModel() const;
 
+  // Sets the words completing the word before pos in doc from CompletionIndex as the model and
+  // returns their count. They are already ranked, so they're shown unfiltered until another model
+  // is set, which restores the previous completion mode.
+  int setCompletions(core::Document* doc, int pos, int maxCount = 50);
+
  private:
+  // Reused by every setCompletions. It has no parent, so QCompleter doesn't delete it when another
+  // model replaces it.
+  QStringListModel m_completionsModel;
+  QCompleter::CompletionMode m_modeBeforeCompletions;
 };
 
 }  // namespace core
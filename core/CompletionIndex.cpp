@@ -0,0 +1,388 @@
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "CompletionIndex.h"
+#include "Document.h"
+#include "FuzzyMatcher.h"
+#include "LanguageParser.h"
+#include "Tracer.h"
+#include "Util.h"
+
+namespace core {
+
+namespace {
+// Longer runs are usually data like base64 rather than identifiers
+const int MAX_WORD_LENGTH = 64;
+// The vocabulary is compacted when it has at least this many unused words and they are the
+// majority
+const int MIN_COMPACT_COUNT = 1024;
+// Prefix matches come before other fuzzy matches, and ones in the same case come first
+const int PREFIX_BONUS = 1 << 20;
+const int CASE_BONUS = 1 << 19;
+
+struct Candidate {
+  int id;
+  int score;
+  // count in the document being edited
+  int localCount;
+  int count;
+  int length;
+};
+
+bool isBetter(const Candidate& x, const Candidate& y) {
+  if (x.score != y.score) {
+    return x.score > y.score;
+  }
+  if (x.localCount != y.localCount) {
+    return x.localCount > y.localCount;
+  }
+  if (x.count != y.count) {
+    return x.count > y.count;
+  }
+  if (x.length != y.length) {
+    return x.length < y.length;
+  }
+  return x.id < y.id;
+}
+
+bool isWordChar(QChar ch) {
+  return ch.isLetterOrNumber() || ch == QLatin1Char('_');
+}
+}
+
+QStringList CompletionIndex::words(const QString& text) {
+  QStringList words;
+  const QChar* chars = text.constData();
+  const int length = text.size();
+  int i = 0;
+  while (i < length) {
+    if (!isWordChar(chars[i])) {
+      i++;
+      continue;
+    }
+
+    const int begin = i;
+    while (i < length && isWordChar(chars[i])) {
+      i++;
+    }
+    const int wordLength = i - begin;
+    if (wordLength >= MIN_WORD_LENGTH && wordLength <= MAX_WORD_LENGTH && !chars[begin].isDigit()) {
+      words.append(text.mid(begin, wordLength));
+    }
+  }
+  return words;
+}
+
+QString CompletionIndex::prefixAt(Document* doc, int pos) {
+  const QTextBlock block = doc->findBlock(pos);
+  if (!block.isValid()) {
+    return QString();
+  }
+
+  const QString text = block.text();
+  const int end = std::min(pos - block.position(), text.size());
+  int begin = end;
+  while (begin > 0 && isWordChar(text[begin - 1])) {
+    begin--;
+  }
+  return text.mid(begin, end - begin);
+}
+
+CompletionIndex::CompletionIndex() : m_unusedCount(0) {
+  m_offsets.append(0);
+}
+
+void CompletionIndex::addDocument(Document* doc) {
+  if (!doc || m_tables.count(doc) > 0) {
+    return;
+  }
+
+  Table* table = new Table();
+  table->revision = doc->revision();
+  m_tables[doc].reset(table);
+  insertLines(table, doc->begin(), doc->blockCount());
+  connect(doc, &QTextDocument::contentsChange, this,
+          [=](int position, int charsRemoved, int charsAdded) {
+            update(doc, position, charsRemoved, charsAdded);
+          });
+  connect(doc, &Document::destroying, this, [=] { removeDocument(doc); });
+}
+
+void CompletionIndex::removeDocument(Document* doc) {
+  auto it = m_tables.find(doc);
+  if (it == m_tables.end()) {
+    return;
+  }
+
+  disconnect(doc, nullptr, this, nullptr);
+  Table* table = it->second.get();
+  removeLines(table, 0, table->lines.size());
+  m_tables.erase(it);
+  compact();
+}
+
+int CompletionIndex::count(const QString& word, Document* doc) const {
+  const int id = m_ids.value(word, -1);
+  if (id < 0) {
+    return 0;
+  }
+  if (!doc) {
+    return m_counts[id];
+  }
+
+  auto it = m_tables.find(doc);
+  return it != m_tables.end() ? it->second->counts.value(id) : 0;
+}
+
+QStringList CompletionIndex::complete(const QString& prefix,
+                                      int maxCount,
+                                      const QString& scope,
+                                      Document* doc) {
+  TRACE_SCOPE("CompletionIndex::complete");
+  const FuzzyMatcher matcher(prefix);
+  if (matcher.isEmpty() || maxCount <= 0) {
+    return QStringList();
+  }
+
+  // the documents in the language of the scope
+  QVector<const Table*> tables;
+  const QString rootScope = scope.section(QLatin1Char(' '), 0, 0, QString::SectionSkipEmpty);
+  if (!rootScope.isEmpty()) {
+    for (const auto& pair : m_tables) {
+      const Language* lang = pair.first->language();
+      if (lang && lang->scopeName == rootScope) {
+        tables.append(pair.second.get());
+      }
+    }
+    if (tables.isEmpty()) {
+      return QStringList();
+    }
+  }
+  auto localIt = doc ? m_tables.find(doc) : m_tables.end();
+  const Table* localTable = localIt != m_tables.end() ? localIt->second.get() : nullptr;
+
+  // Words which don't have all characters of the prefix are dropped by their masks first
+  QVector<int> ids;
+  matcher.filter(m_masks.constData(), 0, m_counts.size(), ids);
+
+  const QByteArray prefixBytes = prefix.toUtf8();
+  const QByteArray& lowerPrefix = matcher.query();
+  const char* words = m_words.constData();
+  const char* lowerWords = m_lowerWords.constData();
+  std::vector<Candidate> heap;
+  for (int id : ids) {
+    int count = 0;
+    if (rootScope.isEmpty()) {
+      count = m_counts[id];
+    } else {
+      for (const Table* table : tables) {
+        count += table->counts.value(id);
+      }
+    }
+    if (count == 0) {
+      continue;
+    }
+
+    const int offset = m_offsets[id];
+    const int length = m_offsets[id + 1] - offset;
+    // the word being typed
+    if (length == prefixBytes.size() &&
+        std::memcmp(words + offset, prefixBytes.constData(), length) == 0) {
+      continue;
+    }
+
+    int score = matcher.score(words + offset, lowerWords + offset, length, 0);
+    if (score < 0) {
+      continue;
+    }
+    if (length >= lowerPrefix.size() &&
+        std::memcmp(lowerWords + offset, lowerPrefix.constData(), lowerPrefix.size()) == 0) {
+      score += PREFIX_BONUS;
+      if (std::memcmp(words + offset, prefixBytes.constData(), prefixBytes.size()) == 0) {
+        score += CASE_BONUS;
+      }
+    }
+
+    const int localCount = localTable ? localTable->counts.value(id) : 0;
+    FuzzyMatcher::keepBest(heap, maxCount, Candidate{id, score, localCount, count, length},
+                           isBetter);
+  }
+
+  std::sort_heap(heap.begin(), heap.end(), isBetter);
+  QStringList result;
+  for (const Candidate& candidate : heap) {
+    result.append(word(candidate.id));
+  }
+  return result;
+}
+
+QStringList CompletionIndex::completeAt(Document* doc, int pos, int maxCount) {
+  if (!doc) {
+    return QStringList();
+  }
+  return complete(prefixAt(doc, pos), maxCount, doc->scopeName(pos), doc);
+}
+
+int CompletionIndex::addWord(const QString& word) {
+  auto it = m_ids.constFind(word);
+  if (it != m_ids.constEnd()) {
+    return it.value();
+  }
+
+  const int id = m_counts.size();
+  const QByteArray bytes = word.toUtf8();
+  m_ids.insert(word, id);
+  m_words.append(bytes);
+  m_lowerWords.append(Util::toAsciiLower(bytes));
+  m_offsets.append(m_words.size());
+  m_masks.append(FuzzyMatcher::charMask(bytes.constData(), bytes.size()));
+  m_counts.append(0);
+  m_unusedCount++;
+  return id;
+}
+
+QString CompletionIndex::word(int id) const {
+  return QString::fromUtf8(m_words.constData() + m_offsets[id], m_offsets[id + 1] - m_offsets[id]);
+}
+
+void CompletionIndex::insertLines(Table* table, QTextBlock block, int count) {
+  const int index = block.blockNumber();
+  QVector<QVector<int>> lines;
+  lines.reserve(count);
+  for (int i = 0; i < count && block.isValid(); i++, block = block.next()) {
+    QVector<int> ids;
+    for (const QString& word : words(block.text())) {
+      const int id = addWord(word);
+      ids.append(id);
+      table->counts[id]++;
+      if (m_counts[id]++ == 0) {
+        m_unusedCount--;
+      }
+    }
+    lines.append(ids);
+  }
+
+  if (index == table->lines.size()) {
+    table->lines += lines;
+  } else {
+    table->lines.insert(index, lines.size(), QVector<int>());
+    std::move(lines.begin(), lines.end(), table->lines.begin() + index);
+  }
+}
+
+void CompletionIndex::removeLines(Table* table, int first, int count) {
+  for (int i = first; i < first + count; i++) {
+    for (int id : table->lines[i]) {
+      auto it = table->counts.find(id);
+      if (--it.value() == 0) {
+        table->counts.erase(it);
+      }
+      if (--m_counts[id] == 0) {
+        m_unusedCount++;
+      }
+    }
+  }
+  table->lines.remove(first, count);
+}
+
+// contentsChange is emitted after the change. The blocks from the first changed one to the end of
+// the inserted text replace the old lines from the same first one, and the difference of the block
+// counts tells how many old lines were replaced.
+//
+// markContentsDirty also emits contentsChange for formatting changes such as highlighting. They
+// replace the same number of characters and don't change the revision.
+void CompletionIndex::update(Document* doc, int position, int charsRemoved, int charsAdded) {
+  TRACE_SCOPE("CompletionIndex::update");
+  auto it = m_tables.find(doc);
+  if (it == m_tables.end()) {
+    return;
+  }
+
+  Table* table = it->second.get();
+  if (charsRemoved == charsAdded && doc->revision() == table->revision) {
+    return;
+  }
+  table->revision = doc->revision();
+
+  const int end = std::max(doc->characterCount() - 1, 0);
+  const QTextBlock firstBlock = doc->findBlock(std::min(position, end));
+  const QTextBlock lastBlock = doc->findBlock(std::min(position + charsAdded, end));
+  const int first = firstBlock.blockNumber();
+  const int last = lastBlock.blockNumber();
+  const int oldLast = last - (doc->blockCount() - table->lines.size());
+  if (!firstBlock.isValid() || !lastBlock.isValid() || oldLast < first ||
+      oldLast >= table->lines.size()) {
+    // QTextDocument::setPlainText reports a removal with the new text
+    reindex(doc, table);
+    return;
+  }
+
+  removeLines(table, first, oldLast - first + 1);
+  insertLines(table, firstBlock, last - first + 1);
+  compact();
+}
+
+void CompletionIndex::reindex(Document* doc, Table* table) {
+  removeLines(table, 0, table->lines.size());
+  insertLines(table, doc->begin(), doc->blockCount());
+  compact();
+}
+
+void CompletionIndex::compact() {
+  if (m_unusedCount < MIN_COMPACT_COUNT || m_unusedCount * 2 < m_counts.size()) {
+    return;
+  }
+
+  TRACE_SCOPE("CompletionIndex::compact");
+  QVector<int> newIds(m_counts.size(), -1);
+  QByteArray words;
+  QByteArray lowerWords;
+  QVector<int> offsets{0};
+  QVector<quint64> masks;
+  QVector<int> counts;
+  for (int id = 0; id < m_counts.size(); id++) {
+    if (m_counts[id] == 0) {
+      continue;
+    }
+
+    newIds[id] = counts.size();
+    const int offset = m_offsets[id];
+    const int length = m_offsets[id + 1] - offset;
+    words.append(m_words.constData() + offset, length);
+    lowerWords.append(m_lowerWords.constData() + offset, length);
+    offsets.append(words.size());
+    masks.append(m_masks[id]);
+    counts.append(m_counts[id]);
+  }
+
+  QHash<QString, int> ids;
+  for (auto it = m_ids.constBegin(); it != m_ids.constEnd(); ++it) {
+    if (newIds[it.value()] >= 0) {
+      ids.insert(it.key(), newIds[it.value()]);
+    }
+  }
+  for (auto& pair : m_tables) {
+    Table* table = pair.second.get();
+    for (QVector<int>& line : table->lines) {
+      for (int& id : line) {
+        id = newIds[id];
+      }
+    }
+    QHash<int, int> tableCounts;
+    for (auto it = table->counts.constBegin(); it != table->counts.constEnd(); ++it) {
+      tableCounts.insert(newIds[it.key()], it.value());
+    }
+    table->counts.swap(tableCounts);
+  }
+
+  m_ids.swap(ids);
+  m_words.swap(words);
+  m_lowerWords.swap(lowerWords);
+  m_offsets.swap(offsets);
+  m_masks.swap(masks);
+  m_counts.swap(counts);
+  m_unusedCount = 0;
+}
+
+}  // namespace core
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <QByteArray>
+#include <QHash>
+#include <QObject>
+#include <QStringList>
+#include <QTextBlock>
+#include <QVector>
+
+#include "macros.h"
+#include "Singleton.h"
+
+namespace core {
+
+class Document;
+
+// Words of the open documents for completion.
+//
+// Each document is tokenized incrementally on contentsChange: only the changed lines are split
+// into words again and the word counts of the document are updated. All documents share one
+// vocabulary kept in flat arrays with a character mask each, so a query scans the masks and scores
+// the remaining words with FuzzyMatcher without walking the documents.
+class CompletionIndex : public QObject, public Singleton<CompletionIndex> {
+  Q_OBJECT
+
+ public:
+  // Words shorter than this aren't worth completing
+  static const int MIN_WORD_LENGTH = 3;
+
+  // Returns the words of a line. A word is a run of letters, digits and '_' not starting with a
+  // digit.
+  static QStringList words(const QString& text);
+
+  // Returns the part of a word before pos
+  static QString prefixAt(Document* doc, int pos);
+
+  ~CompletionIndex() = default;
+
+  // Starts indexing a document. It's dropped from the index when it's destroyed.
+  void addDocument(Document* doc);
+  void removeDocument(Document* doc);
+  // Returns how many times a word appears in a document, or in all documents if doc is null
+  int count(const QString& word, Document* doc = nullptr) const;
+
+ public slots:
+  // Returns up to maxCount words which start with or fuzzily match prefix, best first. Prefix
+  // matches come first, and words appearing more often in doc and then in all documents rank
+  // higher among equal matches.
+  // If scope isn't empty, only words of the documents whose language is its root scope are
+  // returned (e.g. "source.js string.quoted.js" takes words from JavaScript documents).
+  QStringList complete(const QString& prefix,
+                       int maxCount = 50,
+                       const QString& scope = QString(),
+                       core::Document* doc = nullptr);
+  // Completes the word before pos in doc, filtered by the scope at pos
+  QStringList completeAt(core::Document* doc, int pos, int maxCount = 50);
+
+ private:
+  friend class Singleton<CompletionIndex>;
+
+  // words of a document
+  struct Table {
+    // word ids of each line
+    QVector<QVector<int>> lines;
+    // word id -> count
+    QHash<int, int> counts;
+    // revision of the document when the lines were tokenized
+    int revision;
+  };
+
+  std::unordered_map<Document*, std::unique_ptr<Table>> m_tables;
+
+  // vocabulary. UTF-8 words joined without separators. m_offsets has the start of each word and
+  // the end.
+  QHash<QString, int> m_ids;
+  QByteArray m_words;
+  QByteArray m_lowerWords;
+  QVector<int> m_offsets;
+  QVector<quint64> m_masks;
+  // count of each word in all documents
+  QVector<int> m_counts;
+  // # of words whose count is 0
+  int m_unusedCount;
+
+  CompletionIndex();
+
+  int addWord(const QString& word);
+  QString word(int id) const;
+  // Tokenizes count lines from block and inserts them at its line number
+  void insertLines(Table* table, QTextBlock block, int count);
+  void removeLines(Table* table, int first, int count);
+  void update(Document* doc, int position, int charsRemoved, int charsAdded);
+  void reindex(Document* doc, Table* table);
+  // Drops unused words from the vocabulary when they are the majority
+  void compact();
+};
+
+}  // namespace core
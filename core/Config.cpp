@@ -1,5 +1,7 @@
 #include <string>
 #include <QDebug>
+#include <QRunnable>
+#include <QSaveFile>
 #include <QVariant>
 
 #include "Config.h"
@@ -40,6 +42,9 @@ const QString& SHOW_TOOLBAR_KEY = QStringLiteral("show_toolbar");
 
 const QString& DEFAULT_THEME_NAME = QStringLiteral("Tomorrow");
 
+// delay to save changes at once when they come in succession (e.g. moving a font size slider)
+const int SAVE_DELAY_MS = 500;
+
 QHash<QString, QVariant::Type> keyTypeHashForBuiltinConfigs;
 
 void initKeyTypeHash() {
@@ -56,6 +61,45 @@ void initKeyTypeHash() {
   keyTypeHashForBuiltinConfigs[WORD_WRAP_KEY] = QVariant::Bool;
   keyTypeHashForBuiltinConfigs[SHOW_TOOLBAR_KEY] = QVariant::Bool;
 }
+
+// Applies changes to config.yml. The file is replaced atomically, so it's never left half written.
+class SaveTask : public QRunnable {
+ public:
+  SaveTask(const QString& path, std::map<std::string, YAML::Node> changes)
+      : m_path(path), m_changes(std::move(changes)) {}
+
+  void run() override {
+    try {
+      YAML::Node rootNode;
+      if (QFile(m_path).exists()) {
+        rootNode = YAML::LoadFile(m_path.toUtf8().constData());
+      } else {
+        rootNode = YAML::Load("");
+      }
+
+      for (const auto& change : m_changes) {
+        rootNode[change.first] = change.second;
+      }
+
+      YAML::Emitter emitter;
+      emitter << rootNode;
+
+      QSaveFile file(m_path);
+      if (!file.open(QIODevice::WriteOnly) || file.write(emitter.c_str(), emitter.size()) < 0 ||
+          !file.commit()) {
+        qWarning() << "can't save yaml file:" << m_path << ", reason:" << file.errorString();
+      }
+    } catch (const std::exception& e) {
+      qWarning() << "can't edit yaml file:" << m_path << ", reason: " << e.what();
+    } catch (...) {
+      qWarning() << "can't edit yaml file because of an unexpected exception: " << m_path;
+    }
+  }
+
+ private:
+  QString m_path;
+  std::map<std::string, YAML::Node> m_changes;
+};
 }
 
 namespace core {
@@ -123,21 +167,19 @@ void Config::setFont(const QFont& font) {
 }
 
 int Config::tabWidth(const QString& scopeName) {
-  const QString& key = scopeName.isEmpty() ? TAB_WIDTH_KEY : scopeName + "." + TAB_WIDTH_KEY;
-  if (contains(key)) {
-    return get(key, 2);
+  if (!scopeName.isEmpty()) {
+    auto it = m_snapshot.scopeTabWidths.find(scopeName);
+    if (it != m_snapshot.scopeTabWidths.end()) {
+      return it->second;
+    }
   }
-  return get(TAB_WIDTH_KEY, 2);
+  return m_snapshot.tabWidth;
 }
 
 void Config::setTabWidth(int tabWidth) {
   setValue(TAB_WIDTH_KEY, tabWidth);
 }
 
-bool Config::indentUsingSpaces() {
-  return get(INDENT_USING_SPACES_KEY, true);
-}
-
 void Config::setIndentUsingSpaces(bool value) {
   if (setValue(INDENT_USING_SPACES_KEY, value)) {
     emit indentUsingSpacesChanged(value);
@@ -154,6 +196,7 @@ void Config::init() {
   s_defaultValueMap.insert(SHOW_TOOLBAR_KEY, true);
 
   load();
+  updateSnapshot();
 
   auto theme = ThemeManager::theme(themeName());
   if (!theme) {
@@ -164,6 +207,44 @@ void Config::init() {
   setFont(font);
 }
 
+void Config::flush() {
+  m_saveTimer.stop();
+  savePendingChanges();
+  m_savePool.waitForDone();
+}
+
+void Config::savePendingChanges() {
+  if (m_pendingChanges.empty()) {
+    return;
+  }
+
+  m_savePool.start(
+      new SaveTask(Constants::singleton().userConfigPath(), std::move(m_pendingChanges)));
+  m_pendingChanges.clear();
+}
+
+void Config::updateSnapshot() {
+  const QString tabWidthSuffix = "." + TAB_WIDTH_KEY;
+  m_snapshot.scopeTabWidths.clear();
+  for (const auto& pair : m_scalarConfigs) {
+    if (pair.first.endsWith(tabWidthSuffix) && pair.second.canConvert<int>()) {
+      m_snapshot.scopeTabWidths[pair.first.left(pair.first.size() - tabWidthSuffix.size())] =
+          pair.second.value<int>();
+    }
+  }
+
+  m_snapshot.tabWidth = get(TAB_WIDTH_KEY, 2);
+  m_snapshot.indentUsingSpaces = get(INDENT_USING_SPACES_KEY, true);
+  m_snapshot.endOfLineStr = get(END_OF_LINE_STR_KEY, u8"\u00AC");  // U+00AC is '¬'
+  m_snapshot.endOfFileStr = get(END_OF_FILE_STR_KEY, "");
+  m_snapshot.enableMnemonic = get("enable_mnemonic", false);
+  m_snapshot.showInvisibles = get(SHOW_INVISIBLES_KEY, false);
+  m_snapshot.showTabsAndSpaces =
+      get(SHOW_TABS_AND_SPACES_KEY, defaultValue(SHOW_TABS_AND_SPACES_KEY).toBool());
+  m_snapshot.wordWrap = get(WORD_WRAP_KEY, defaultValue(WORD_WRAP_KEY).toBool());
+  m_snapshot.showToolbar = get(SHOW_TOOLBAR_KEY, defaultValue(SHOW_TOOLBAR_KEY).toBool());
+}
+
 std::unordered_map<std::string, std::string> Config::mapValue(const QString& key) {
   if (m_mapConfigs.count(key) != 0) {
     return m_mapConfigs[key];
@@ -306,24 +387,12 @@ void Config::setFont(const v8::FunctionCallbackInfo<v8::Value>& args) {
   }
 }
 
-QString Config::endOfLineStr() {
-  return get(END_OF_LINE_STR_KEY, u8"\u00AC");  // U+00AC is '測'
-}
-
 void Config::setEndOfLineStr(const QString& newValue) {
   if (setValue(END_OF_LINE_STR_KEY, newValue)) {
     emit endOfLineStrChanged(newValue);
   }
 }
 
-QString Config::endOfFileStr() {
-  return get(END_OF_FILE_STR_KEY, "");
-}
-
-bool Config::enableMnemonic() {
-  return get("enable_mnemonic", false);
-}
-
 QString Config::locale() {
   const QString& systemLocale = QLocale::system().name();
   const QString& locale = get(LOCALE_KEY, systemLocale);
@@ -337,30 +406,20 @@ void Config::setLocale(const QString& newValue) {
   setValue(LOCALE_KEY, newValue);
 }
 
-bool Config::showInvisibles() {
-  return get(SHOW_INVISIBLES_KEY, false);
-}
-
 void Config::setShowInvisibles(bool newValue) {
   if (setValue(SHOW_INVISIBLES_KEY, newValue)) {
     emit showInvisiblesChanged(newValue);
   }
 }
 
-bool Config::showTabsAndSpaces() {
-  return get(SHOW_TABS_AND_SPACES_KEY, defaultValue(SHOW_TABS_AND_SPACES_KEY).toBool());
+Config::Config() : m_theme(nullptr) {
+  m_saveTimer.setSingleShot(true);
+  m_saveTimer.setInterval(SAVE_DELAY_MS);
+  connect(&m_saveTimer, &QTimer::timeout, this, &Config::savePendingChanges);
+  m_savePool.setMaxThreadCount(1);
+  updateSnapshot();
 }
 
-bool Config::wordWrap() {
-  return get(WORD_WRAP_KEY, defaultValue(WORD_WRAP_KEY).toBool());
-}
-
-bool Config::showToolbar() {
-  return get(SHOW_TOOLBAR_KEY, defaultValue(SHOW_TOOLBAR_KEY).toBool());
-}
-
-Config::Config() : m_theme(nullptr) {}
-
 void Config::load() {
   QStringList existingConfigPaths;
   foreach (const QString& path, Constants::singleton().configPaths()) {
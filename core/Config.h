@@ -2,8 +2,8 @@
 
 #include <v8.h>
 #include <yaml-cpp/yaml.h>
+#include <map>
 #include <unordered_map>
-#include <fstream>
 #include <QColor>
 #include <QFontMetrics>
 #include <QFile>
@@ -11,6 +11,8 @@
 #include <QObject>
 #include <QFont>
 #include <QDebug>
+#include <QThreadPool>
+#include <QTimer>
 
 #include "macros.h"
 #include "Singleton.h"
@@ -25,6 +27,9 @@ class Theme;
 /**
  * @brief Model class for config.yml
  * We don't use QSettings to support if condition
+ *
+ * Changes are written to config.yml in a background thread after a short delay, so consecutive
+ * changes are saved at once.
  */
 class Config : public QObject, public Singleton<Config> {
   Q_OBJECT
@@ -46,28 +51,30 @@ class Config : public QObject, public Singleton<Config> {
   int tabWidth(const QString &scopeName = "");
   void setTabWidth(int tabWidth);
 
-  bool indentUsingSpaces();
+  bool indentUsingSpaces() { return m_snapshot.indentUsingSpaces; }
   void setIndentUsingSpaces(bool get);
 
-  QString endOfLineStr();
+  QString endOfLineStr() { return m_snapshot.endOfLineStr; }
   void setEndOfLineStr(const QString& newValue);
 
-  QString endOfFileStr();
+  QString endOfFileStr() { return m_snapshot.endOfFileStr; }
 
-  bool enableMnemonic();
+  bool enableMnemonic() { return m_snapshot.enableMnemonic; }
 
   QString locale();
   void setLocale(const QString& newValue);
 
-  bool showInvisibles();
+  bool showInvisibles() { return m_snapshot.showInvisibles; }
   void setShowInvisibles(bool newValue);
 
-  bool showTabsAndSpaces();
-  bool wordWrap();
+  bool showTabsAndSpaces() { return m_snapshot.showTabsAndSpaces; }
+  bool wordWrap() { return m_snapshot.wordWrap; }
 
-  bool showToolbar();
+  bool showToolbar() { return m_snapshot.showToolbar; }
 
   void init();
+  // Writes pending changes to config.yml and waits until it finishes
+  void flush();
   bool contains(const QString& key);
   void addPackageConfigDefinition(const core::ConfigDefinition& def);
   QString tabWidthKey(const QString &scopeName = "");
@@ -98,6 +105,7 @@ class Config : public QObject, public Singleton<Config> {
       }
 
       m_scalarConfigs[key] = newValue;
+      updateSnapshot();
       save(key, value);
       emitConfigChange(key, oldValue, newValue);
       return true;
@@ -119,6 +127,22 @@ class Config : public QObject, public Singleton<Config> {
   void showToolBarChanged(bool visible);
 
  private:
+  // Typed values of built-in configs. Accessors read them instead of looking up and converting
+  // QVariant because some of them are called in painting.
+  struct Snapshot {
+    int tabWidth;
+    // tab widths defined for scopes (e.g. source.python.tab_width)
+    std::unordered_map<QString, int> scopeTabWidths;
+    bool indentUsingSpaces;
+    QString endOfLineStr;
+    QString endOfFileStr;
+    bool enableMnemonic;
+    bool showInvisibles;
+    bool showTabsAndSpaces;
+    bool wordWrap;
+    bool showToolbar;
+  };
+
   // public API accessible from JS
   static void get(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void set(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -130,10 +154,20 @@ class Config : public QObject, public Singleton<Config> {
   std::unordered_map<QString, QVariant> m_scalarConfigs;
   std::unordered_map<QString, std::unordered_map<std::string, std::string>> m_mapConfigs;
   QMap<QString, core::ConfigDefinition> m_packageConfigDefinitions;
+  Snapshot m_snapshot;
+
+  // Changes which are not written to config.yml yet. Keys are UTF-8 encoded.
+  std::map<std::string, YAML::Node> m_pendingChanges;
+  QTimer m_saveTimer;
+  // runs one save at a time to keep the order of changes
+  QThreadPool m_savePool;
 
   friend class Singleton<Config>;
   Config();
 
+  void updateSnapshot();
+  void savePendingChanges();
+
   std::unordered_map<std::string, std::string> mapValue(const QString& key);
   void load();
   void load(const QString& filename);
@@ -157,37 +191,18 @@ class Config : public QObject, public Singleton<Config> {
   }
 
   void save(const QString& key, const QString& newValue) {
-    save(key, newValue.toUtf8().constData());
+    save(key, std::string(newValue.toUtf8().constData()));
   }
 
   /**
-   * @brief save 'key: newValue' in config.yml
+   * @brief save 'key: newValue' in config.yml later
    * @param key
    * @param newValue
    */
   template <typename T>
   void save(const QString& key, const T& newValue) {
-    QString configFilePath = Constants::singleton().userConfigPath();
-
-    try {
-      YAML::Node rootNode;
-      if (QFile(configFilePath).exists()) {
-        std::string name = configFilePath.toUtf8().constData();
-        rootNode = YAML::LoadFile(name);
-      } else {
-        rootNode = YAML::Load("");
-      }
-
-      rootNode[key.toUtf8().constData()] = newValue;
-
-      std::string configFileName = configFilePath.toUtf8().constData();
-      std::ofstream fout(configFileName);
-      fout << rootNode;  // dump it back into the file
-    } catch (const std::exception& e) {
-      qWarning() << "can't edit yaml file:" << configFilePath << ", reason: " << e.what();
-    } catch (...) {
-      qWarning() << "can't edit yaml file because of an unexpected exception: " << configFilePath;
-    }
+    m_pendingChanges[key.toUtf8().constData()] = YAML::Node(newValue);
+    m_saveTimer.start();
   }
 };
 
@@ -117,6 +117,10 @@ QString Constants::sessionPath() {
   return QStandardPaths::standardLocations(QStandardPaths::AppDataLocation)[0] + "/session.ini";
 }
 
+QString Constants::indexDirPath() {
+  return QStandardPaths::standardLocations(QStandardPaths::CacheLocation)[0] + "/index";
+}
+
 QStringList Constants::themePaths() {
   QStringList themePaths;
   foreach (const QString& path, dataDirectoryPaths()) { themePaths.append(path + "/themes"); }
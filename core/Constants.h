@@ -35,6 +35,8 @@ class Constants : public QObject, public core::Singleton<Constants> {
   QString silkHomePath() const;
   QString recentOpenHistoryPath();
   QString sessionPath();
+  // directory of project search indexes
+  QString indexDirPath();
   QStringList themePaths();
   QStringList packagesPaths();
   QString userRootPackageJsonPath() const;
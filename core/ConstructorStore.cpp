@@ -47,9 +47,7 @@ v8::Local<v8::Function> ConstructorStore::createConstructorInternal(const QMetaO
   ObjectTemplateStore::initInstanceTemplate(objTempl, metaObj, isolate);
 
   // register invokable methods and slots to prototype object
-  Util::processWithPublicMethods(metaObj, [&](const QMetaMethod& method) {
-    NODE_SET_PROTOTYPE_METHOD(tpl, method.name().constData(), V8Util::invokeQObjectMethod);
-  });
+  ObjectTemplateStore::setPrototypeMethods(tpl, metaObj, isolate);
 
   v8::MaybeLocal<v8::Function> maybeFunc = tpl->GetFunction(isolate->GetCurrentContext());
   if (maybeFunc.IsEmpty()) {
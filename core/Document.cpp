@@ -1,12 +1,13 @@
 #include <boost/optional.hpp>
 #include <tuple>
-#include <QPlainTextDocumentLayout>
 #include <QTextCodec>
 #include <QDir>
 #include <QSettings>
 #include <QUuid>
+#include <QTextBlock>
 
 #include "Document.h"
+#include "DocumentLayout.h"
 #include "LineSeparator.h"
 #include "Config.h"
 #include "LanguageParser.h"
@@ -175,6 +176,7 @@ void Document::init() {
               setTabWidth(newValue.value<int>());
             }
           });
+  connect(this, &QTextDocument::contentsChange, this, [=] { m_textSnapshot = QString(); });
 }
 
 Document::Document()
@@ -187,7 +189,7 @@ Document::Document()
 }
 
 void Document::setupLayout() {
-  QPlainTextDocumentLayout* layout = new QPlainTextDocumentLayout(this);
+  DocumentLayout* layout = new DocumentLayout(this);
   setDocumentLayout(layout);
 }
 
@@ -371,7 +373,7 @@ void Document::setBOM(const BOM& bom) {
 }
 
 std::unique_ptr<Regexp> Document::createRegexp(const QString& subString,
-                                               Document::FindFlags options) const {
+                                               Document::FindFlags options) {
   bool isCaseSensitive = options & FindFlag::FindCaseSensitively;
   bool isRegex = options & FindFlag::FindRegex;
   bool isWholeWord = options & FindFlag::FindWholeWords;
@@ -467,6 +469,24 @@ boost::optional<Region> Document::find(const Regexp* expr,
   return boost::none;
 }
 
+const SymbolTable* Document::symbolTable() const {
+  return m_syntaxHighlighter ? &m_syntaxHighlighter->symbolTable() : nullptr;
+}
+
+FoldingRanges* Document::foldingRanges() {
+  return m_syntaxHighlighter ? &m_syntaxHighlighter->foldingRanges() : nullptr;
+}
+
+const BracketPairs* Document::bracketPairs() const {
+  return m_syntaxHighlighter ? &m_syntaxHighlighter->bracketPairs() : nullptr;
+}
+
+void Document::setVisibleBlocks(const QObject* view, int firstBlock, int lastBlock) {
+  if (m_syntaxHighlighter) {
+    m_syntaxHighlighter->setVisibleBlocks(view, firstBlock, lastBlock);
+  }
+}
+
 QString Document::scopeName(int pos) const {
   return m_syntaxHighlighter ? m_syntaxHighlighter->scopeName(pos) : "";
 }
@@ -507,4 +527,59 @@ void Document::setDefaultTextOption(const QTextOption& option) {
   QTextDocument::setDefaultTextOption(option);
 }
 
+QString Document::text(int begin, int end) const {
+  // characterCount includes the last paragraph separator
+  const int length = characterCount() - 1;
+  begin = qBound(0, begin, length);
+  end = end < 0 ? length : qBound(begin, end, length);
+
+  if (!m_textSnapshot.isNull()) {
+    return begin == 0 && end == length ? m_textSnapshot : m_textSnapshot.mid(begin, end - begin);
+  }
+
+  // Don't build the whole text for a part of it
+  if (begin != 0 || end != length) {
+    return textInBlocks(begin, end);
+  }
+
+  m_textSnapshot = textInBlocks(0, length);
+  return m_textSnapshot;
+}
+
+// Unlike toPlainText, this doesn't replace nbsp with a space.
+QString Document::textInBlocks(int begin, int end) const {
+  QString text;
+  text.reserve(end - begin);
+  for (QTextBlock block = findBlock(begin); block.isValid() && block.position() < end;
+       block = block.next()) {
+    const QString& blockText = block.text();
+    const int from = qMax(0, begin - block.position());
+    const int to = qMin(blockText.size(), end - block.position());
+    text.append(blockText.constData() + from, to - from);
+    if (block.position() + blockText.size() < end) {
+      text.append(QLatin1Char('\n'));
+    }
+  }
+  // not null even if it's empty
+  if (text.isNull()) {
+    text = QLatin1String("");
+  }
+  return text;
+}
+
+QStringList Document::lines(int first, int count) const {
+  QStringList lines;
+  if (first < 0 || first >= blockCount()) {
+    return lines;
+  }
+
+  const int last = count < 0 ? blockCount() : qMin(blockCount(), first + count);
+  lines.reserve(last - first);
+  QTextBlock block = findBlockByNumber(first);
+  for (int i = first; i < last && block.isValid(); i++, block = block.next()) {
+    lines.append(block.text());
+  }
+  return lines;
+}
+
 }  // namespace core
@@ -15,6 +15,9 @@ namespace core {
 struct Language;
 class Regexp;
 class SyntaxHighlighter;
+class SymbolTable;
+class FoldingRanges;
+class BracketPairs;
 
 class Document : public QTextDocument {
   Q_OBJECT
@@ -33,6 +36,8 @@ class Document : public QTextDocument {
   static const QString SETTINGS_PREFIX;
 
   static Document* createBlank();
+  // Returns nullptr if subString is empty or an invalid regex
+  static std::unique_ptr<Regexp> createRegexp(const QString& subString, FindFlags options);
 
   // Don't call these except DocumentManager
   static Document* create(const QString& path = "");
@@ -78,6 +83,15 @@ class Document : public QTextDocument {
 
   QString scopeName(int pos) const;
   QString scopeTree() const;
+  // Returns the symbols found by the last parse. null if the document has no language.
+  const SymbolTable* symbolTable() const;
+  // null if the document has no language
+  FoldingRanges* foldingRanges();
+  // null if the document has no language
+  const BracketPairs* bracketPairs() const;
+  // Tells the syntax highlighter which blocks view shows. firstBlock < 0 means view doesn't show
+  // this document any more.
+  void setVisibleBlocks(const QObject* view, int firstBlock, int lastBlock);
 
   /**
    * @brief reload from a local file and guess its encoding
@@ -108,6 +122,14 @@ class Document : public QTextDocument {
   QTextOption defaultTextOption() const;
   void setDefaultTextOption(const QTextOption& option);
 
+  // Returns the text in [begin, end). Lines are separated by '\n'. end < 0 means the end.
+  // The whole text is cached until the document is changed, so reading it repeatedly doesn't copy
+  // the text, and the JS string refers to the cached buffer (see V8Util::toV8String).
+  QString text(int begin = 0, int end = -1) const;
+
+  // Returns count lines from the line at first. count < 0 means until the last line.
+  QStringList lines(int first = 0, int count = -1) const;
+
  private:
   friend class DocumentTest;
 
@@ -118,6 +140,8 @@ class Document : public QTextDocument {
   BOM m_bom;
   SyntaxHighlighter* m_syntaxHighlighter;
   QString m_tabWidthKey;
+  // null if the document is changed after the last call of text()
+  mutable QString m_textSnapshot;
 
   Document(const QString& path,
            const QString& text,
@@ -130,10 +154,10 @@ class Document : public QTextDocument {
   void setupLayout();
   void setupSyntaxHighlighter(std::unique_ptr<Language> lang, const QString& text = "");
   void init();
-  std::unique_ptr<Regexp> createRegexp(const QString& subString, Document::FindFlags options) const;
   void setShowTabsAndSpaces(bool showTabsAndSpaces);
   void setTabWidth(int tabWidth);
   void setTabWidth();
+  QString textInBlocks(int begin, int end) const;
 };
 
 }  // namespace core
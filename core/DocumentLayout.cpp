@@ -0,0 +1,12 @@
+#include "DocumentLayout.h"
+
+namespace core {
+
+DocumentLayout::DocumentLayout(QTextDocument* doc) : QPlainTextDocumentLayout(doc) {}
+
+void DocumentLayout::updateBlockVisibility() {
+  requestUpdate();
+  emit documentSizeChanged(documentSize());
+}
+
+}  // namespace core
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <QPlainTextDocumentLayout>
+
+#include "macros.h"
+
+namespace core {
+
+// QPlainTextDocumentLayout of Document.
+//
+// FoldingRanges hides blocks with QTextBlock::setVisible, which doesn't notify the layout. The
+// layout lays out a hidden block as no line already, so it only has to repaint the views and
+// report the new document size to resize their scroll bars.
+class DocumentLayout : public QPlainTextDocumentLayout {
+  Q_OBJECT
+  DISABLE_COPY(DocumentLayout)
+
+ public:
+  explicit DocumentLayout(QTextDocument* doc);
+  ~DocumentLayout() = default;
+  DEFAULT_MOVE(DocumentLayout)
+
+  // Repaints and resizes the document after blocks are hidden or shown
+  void updateBlockVisibility();
+};
+
+}  // namespace core
@@ -0,0 +1,130 @@
+#include <algorithm>
+#include <vector>
+
+#include "FileIndex.h"
+#include "FuzzyMatcher.h"
+#include "Tracer.h"
+#include "Util.h"
+
+namespace core {
+
+namespace {
+struct Candidate {
+  int id;
+  int score;
+  int length;
+};
+
+bool isBetter(const Candidate& x, const Candidate& y) {
+  if (x.score != y.score) {
+    return x.score > y.score;
+  }
+  if (x.length != y.length) {
+    return x.length < y.length;
+  }
+  return x.id < y.id;
+}
+}
+
+FileIndex::FileIndex(ProjectFileSystem* fileSystem, QObject* parent)
+    : QObject(parent), m_fileSystem(fileSystem), m_lastSize(0) {
+  m_offsets.append(0);
+  appendAll();
+  connect(fileSystem, &ProjectFileSystem::changed, this, &FileIndex::onFilesChanged);
+}
+
+QString FileIndex::path(int id) const {
+  return QString::fromUtf8(m_paths.constData() + m_offsets[id], m_offsets[id + 1] - m_offsets[id]);
+}
+
+QStringList FileIndex::find(const QString& query, int maxCount) {
+  TRACE_SCOPE("FileIndex::find");
+  const FuzzyMatcher matcher(query);
+  if (matcher.isEmpty() || maxCount <= 0) {
+    return QStringList();
+  }
+
+  // Paths which don't have all characters of the query are dropped by their masks first
+  QVector<int> ids;
+  int begin = 0;
+  if (!m_lastQuery.isEmpty() && matcher.query().startsWith(m_lastQuery)) {
+    ids = m_lastMatches;
+    begin = m_lastSize;
+  }
+  const int end = size();
+  matcher.filter(m_masks.constData(), begin, end, ids);
+
+  QVector<int> matches;
+  std::vector<Candidate> heap;
+  const char* paths = m_paths.constData();
+  const char* lowerPaths = m_lowerPaths.constData();
+  for (int id : ids) {
+    const int offset = m_offsets[id];
+    const int length = m_offsets[id + 1] - offset;
+    const int score = matcher.score(paths + offset, lowerPaths + offset, length,
+                                    m_nameStarts[id] - offset);
+    if (score < 0) {
+      continue;
+    }
+
+    matches.append(id);
+    FuzzyMatcher::keepBest(heap, maxCount, Candidate{id, score, length}, isBetter);
+  }
+
+  m_lastQuery = matcher.query();
+  m_lastMatches = matches;
+  m_lastSize = end;
+
+  std::sort_heap(heap.begin(), heap.end(), isBetter);
+  QStringList result;
+  for (const Candidate& candidate : heap) {
+    result.append(path(candidate.id));
+  }
+  return result;
+}
+
+void FileIndex::clear() {
+  m_paths.clear();
+  m_lowerPaths.clear();
+  m_offsets = QVector<int>{0};
+  m_nameStarts.clear();
+  m_masks.clear();
+  m_lastQuery.clear();
+  m_lastMatches.clear();
+  m_lastSize = 0;
+}
+
+void FileIndex::appendAll() {
+  for (const ProjectFileSystem::Entry& entry : m_fileSystem->files()) {
+    append(entry.name);
+  }
+}
+
+void FileIndex::append(const QString& path) {
+  const QByteArray bytes = path.toUtf8();
+  const int offset = m_paths.size();
+  m_paths.append(bytes);
+  m_lowerPaths.append(Util::toAsciiLower(bytes));
+  m_offsets.append(m_paths.size());
+  m_nameStarts.append(offset + bytes.lastIndexOf('/') + 1);
+  m_masks.append(FuzzyMatcher::charMask(bytes.constData(), bytes.size()));
+}
+
+void FileIndex::onFilesChanged(const ProjectFileSystem::Changes& changes) {
+  if (changes.addedFiles.isEmpty() && changes.removedFiles.isEmpty()) {
+    return;
+  }
+
+  // Ids are positions in the flat arrays, so removals rebuild them
+  if (changes.removedFiles.isEmpty()) {
+    for (const QString& path : changes.addedFiles) {
+      append(path);
+    }
+  } else {
+    clear();
+    appendAll();
+  }
+  emit updated();
+}
+
+}  // namespace core
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <QByteArray>
+#include <QObject>
+#include <QStringList>
+#include <QVector>
+
+#include "macros.h"
+#include "ProjectFileSystem.h"
+
+namespace core {
+
+// Relative paths of the files in a project directory for quick open.
+//
+// Paths are taken from ProjectFileSystem as its crawler finds them, so find() works while the crawl
+// is still going on. They are kept in flat arrays with a character mask each, and find() scans the
+// masks before scoring the remaining paths with FuzzyMatcher.
+class FileIndex : public QObject {
+  Q_OBJECT
+  DISABLE_COPY(FileIndex)
+
+ public:
+  // fileSystem must outlive the index
+  explicit FileIndex(ProjectFileSystem* fileSystem, QObject* parent = nullptr);
+  DEFAULT_MOVE(FileIndex)
+
+  QString rootPath() const { return m_fileSystem->rootPath(); }
+  int size() const { return m_nameStarts.size(); }
+  // relative to the root
+  QString path(int id) const;
+
+  // Returns the relative paths of up to maxCount files matching the query, best first.
+  // A query extending the previous one only rescores the previous matches.
+  QStringList find(const QString& query, int maxCount);
+
+ signals:
+  // Files have been added or removed
+  void updated();
+
+ private:
+  ProjectFileSystem* m_fileSystem;
+
+  // UTF-8 paths joined without separators. m_offsets has the start of each path and the end.
+  QByteArray m_paths;
+  QByteArray m_lowerPaths;
+  QVector<int> m_offsets;
+  QVector<int> m_nameStarts;
+  QVector<quint64> m_masks;
+
+  // the last query, its matches and the number of paths then
+  QByteArray m_lastQuery;
+  QVector<int> m_lastMatches;
+  int m_lastSize;
+
+  void clear();
+  void appendAll();
+  void append(const QString& path);
+
+ private slots:
+  void onFilesChanged(const core::ProjectFileSystem::Changes& changes);
+};
+
+}  // namespace core
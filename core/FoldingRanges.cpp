@@ -0,0 +1,508 @@
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <QTextBlock>
+#include <QTextDocument>
+
+#include "DocumentLayout.h"
+#include "FoldingRanges.h"
+#include "Metadata.h"
+#include "Regexp.h"
+#include "ScopeTree.h"
+#include "Tracer.h"
+
+namespace core {
+
+namespace {
+bool isBefore(const FoldRange& range, int line) {
+  return range.first < line;
+}
+
+void extend(int& dirtyFirst, int& dirtyLast, int first, int last) {
+  dirtyFirst = std::min(dirtyFirst, first);
+  dirtyLast = std::max(dirtyLast, last);
+}
+}
+
+FoldingRanges::FoldingRanges() : m_doc(nullptr), m_metadata(nullptr), m_lineCount(0) {
+  m_root.first = -1;
+  m_root.last = -1;
+}
+
+QVector<FoldRange> FoldingRanges::ranges() const {
+  QVector<FoldRange> ranges;
+  appendRanges(m_root, m_root.first, ranges);
+  return ranges;
+}
+
+boost::optional<FoldRange> FoldingRanges::find(int line) const {
+  const Node* node = &m_root;
+  int nodeFirst = m_root.first;
+  while (true) {
+    // The last child starting at or before line
+    const int i = lowerBound(*node, line - nodeFirst + 1) - 1;
+    if (i < 0) {
+      return boost::none;
+    }
+    const FoldRange range = childRange(*node, i);
+    if (nodeFirst + range.first == line) {
+      return FoldRange{line, nodeFirst + range.last};
+    }
+    if (nodeFirst + range.last < line) {
+      return boost::none;
+    }
+    node = &node->children.raw(i);
+    nodeFirst += range.first;
+  }
+}
+
+bool FoldingRanges::isFolded(int line) const {
+  auto it = std::lower_bound(m_folded.begin(), m_folded.end(), line, isBefore);
+  return it != m_folded.end() && it->first == line;
+}
+
+bool FoldingRanges::fold(int line) {
+  const boost::optional<FoldRange> range = find(line);
+  if (!range || isFolded(line)) {
+    return false;
+  }
+
+  m_folded.insert(std::lower_bound(m_folded.begin(), m_folded.end(), line, isBefore), *range);
+  updateVisibility(range->first + 1, range->last);
+  return true;
+}
+
+bool FoldingRanges::unfold(int line) {
+  auto it = std::lower_bound(m_folded.begin(), m_folded.end(), line, isBefore);
+  if (it == m_folded.end() || it->first != line) {
+    return false;
+  }
+
+  // Folded ranges inside stay hidden
+  const FoldRange range = *it;
+  m_folded.erase(it);
+  updateVisibility(range.first + 1, range.last);
+  return true;
+}
+
+void FoldingRanges::foldAll() {
+  TRACE_SCOPE("FoldingRanges::foldAll");
+  QVector<FoldRange> topLevelRanges;
+  for (int i = 0; i < m_root.children.size(); i++) {
+    const FoldRange range = childRange(m_root, i);
+    topLevelRanges.append(FoldRange{m_root.first + range.first, m_root.first + range.last});
+  }
+
+  QVector<FoldRange> folded;
+  std::set_union(m_folded.begin(), m_folded.end(), topLevelRanges.begin(), topLevelRanges.end(),
+                 std::back_inserter(folded),
+                 [](const FoldRange& x, const FoldRange& y) { return x.first < y.first; });
+  m_folded.swap(folded);
+  if (m_doc) {
+    updateVisibility(0, m_doc->blockCount() - 1);
+  }
+}
+
+void FoldingRanges::unfoldAll() {
+  m_folded.clear();
+  if (m_doc) {
+    updateVisibility(0, m_doc->blockCount() - 1);
+  }
+}
+
+void FoldingRanges::reveal(int line) {
+  int dirtyFirst = std::numeric_limits<int>::max();
+  int dirtyLast = -1;
+  auto end = std::remove_if(m_folded.begin(), m_folded.end(), [&](const FoldRange& range) {
+    if (range.first < line && line <= range.last) {
+      extend(dirtyFirst, dirtyLast, range.first + 1, range.last);
+      return true;
+    }
+    return false;
+  });
+  m_folded.erase(end, m_folded.end());
+  updateVisibility(dirtyFirst, dirtyLast);
+}
+
+void FoldingRanges::reset(const ScopeTree* tree, QTextDocument* doc) {
+  TRACE_SCOPE("FoldingRanges::reset");
+  m_doc = doc;
+  m_metadata = tree ? Metadata::get(tree->root().name()) : nullptr;
+  resetRanges(tree);
+
+  int dirtyFirst = std::numeric_limits<int>::max();
+  int dirtyLast = -1;
+  updateFolded(dirtyFirst, dirtyLast);
+  updateVisibility(dirtyFirst, dirtyLast);
+}
+
+void FoldingRanges::replace(const ScopeTree* tree, const Region& region) {
+  if (!m_doc) {
+    return;
+  }
+
+  TRACE_SCOPE("FoldingRanges::replace");
+  const int end = std::max(m_doc->characterCount() - 1, 0);
+  const int first = m_doc->findBlock(std::min(region.begin(), end)).blockNumber();
+  const int last = m_doc->findBlock(std::min(std::max(region.end() - 1, 0), end)).blockNumber();
+  rebuild(tree, first, std::max(first, last));
+
+  int dirtyFirst = std::numeric_limits<int>::max();
+  int dirtyLast = -1;
+  updateFolded(dirtyFirst, dirtyLast);
+  updateVisibility(dirtyFirst, dirtyLast);
+}
+
+// The blocks from the first changed one to the end of the inserted text replace the old lines from
+// the same first one, same as CompletionIndex.
+void FoldingRanges::update(const ScopeTree* tree,
+                           int position,
+                           int charsRemoved,
+                           int charsAdded) {
+  if (!m_doc) {
+    return;
+  }
+
+  TRACE_SCOPE("FoldingRanges::update");
+  const int end = std::max(m_doc->characterCount() - 1, 0);
+  QTextBlock block = m_doc->findBlock(std::min(position, end));
+  const QTextBlock lastBlock = m_doc->findBlock(std::min(position + charsAdded, end));
+  const int first = block.blockNumber();
+  const int last = lastBlock.blockNumber();
+  const int lineDelta = m_doc->blockCount() - m_lineCount;
+  const int oldLast = last - lineDelta;
+  if (!block.isValid() || !lastBlock.isValid() || oldLast < first || oldLast >= m_lineCount) {
+    // QTextDocument::setPlainText reports a removal with the new text
+    m_folded.clear();
+    resetRanges(tree);
+    updateVisibility(0, m_doc->blockCount() - 1);
+    return;
+  }
+
+  QVector<int> lines;
+  QVector<quint8> kinds;
+  for (; block.isValid() && block.blockNumber() <= last; block = block.next()) {
+    appendMarks(block.text(), block.blockNumber(), lines, kinds);
+  }
+  m_lineCount = m_doc->blockCount();
+  const QPair<int, int> changedMarks = m_marks.splice(
+      m_marks.lowerBound(first), m_marks.lowerBound(oldLast + 1), lines, kinds, lineDelta);
+
+  // Folded ranges touched by the edit are unfolded, except when only their first line is edited.
+  // The others are moved by the lines inserted or removed.
+  int dirtyFirst = first;
+  int dirtyLast = last;
+  const bool isLineEdit = first == oldLast && first == last;
+  QVector<FoldRange> folded;
+  for (const FoldRange& range : m_folded) {
+    if (range.last < first || (isLineEdit && range.first == first)) {
+      folded.append(range);
+    } else if (range.first > oldLast) {
+      folded.append(FoldRange{range.first + lineDelta, range.last + lineDelta});
+    } else {
+      extend(dirtyFirst, dirtyLast, std::min(range.first + 1, first),
+             range.last > oldLast ? range.last + lineDelta : last);
+    }
+  }
+  m_folded.swap(folded);
+
+  // Only the ranges on the path to the changed lines are visited
+  m_root.last += lineDelta;
+  adjustChildren(m_root, first - m_root.first, oldLast - m_root.first, lineDelta);
+
+  // A pair which is only moved keeps its range. Lines opening another pair, like the ones before an
+  // unbalanced "}" inserted, are rebuilt as if they were changed.
+  int changedFirst = first;
+  int changedLast = last;
+  if (changedMarks.first < changedMarks.second) {
+    extend(changedFirst, changedLast, m_marks.positionAt(changedMarks.first),
+           m_marks.positionAt(changedMarks.second - 1));
+  }
+
+  rebuild(tree, changedFirst, changedLast);
+  updateFolded(dirtyFirst, dirtyLast);
+  updateVisibility(dirtyFirst, dirtyLast);
+}
+
+FoldRange FoldingRanges::childRange(const Node& node, int i) {
+  const Node& child = node.children.raw(i);
+  const int delta = node.children.pendingDelta(i);
+  return FoldRange{child.first + delta, child.last + delta};
+}
+
+int FoldingRanges::lowerBound(const Node& node, int line) {
+  int lo = 0;
+  int hi = node.children.size();
+  while (lo < hi) {
+    const int mid = lo + (hi - lo) / 2;
+    if (childRange(node, mid).first < line) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+void FoldingRanges::appendRanges(const Node& node, int nodeFirst, QVector<FoldRange>& ranges) {
+  for (int i = 0; i < node.children.size(); i++) {
+    const FoldRange range = childRange(node, i);
+    ranges.append(FoldRange{nodeFirst + range.first, nodeFirst + range.last});
+    appendRanges(node.children.raw(i), nodeFirst + range.first, ranges);
+  }
+}
+
+// Children don't overlap, so only the one before the first starting in the changed lines may end
+// in them. The lines of the children in the changed lines are clamped to the new ones, and the
+// children which start before and end after them are adjusted the same way. They are rebuilt
+// unless they enclose the changed lines. The following children are moved by the pending delta.
+void FoldingRanges::adjustChildren(Node& node, int first, int oldLast, int delta) {
+  const int last = oldLast + delta;
+  int i = lowerBound(node, first);
+  if (i > 0 && childRange(node, i - 1).last >= first) {
+    i--;
+  }
+  for (; i < node.children.size(); i++) {
+    const FoldRange range = childRange(node, i);
+    if (range.first > oldLast) {
+      break;
+    }
+
+    Node& child = node.children.raw(i);
+    if (range.first < first && range.last > oldLast) {
+      adjustChildren(child, first - range.first, oldLast - range.first, delta);
+    }
+    const int newFirst = std::min(range.first, last);
+    const int newLast = range.last > oldLast ? range.last + delta : std::min(range.last, last);
+    // The children are relative to the first line
+    child.children.shift(0, range.first - newFirst);
+    const int pending = node.children.pendingDelta(i);
+    child.first = newFirst - pending;
+    child.last = newLast - pending;
+  }
+  node.children.shift(i, delta);
+}
+
+QList<FoldingRanges::Node> FoldingRanges::nest(const QVector<FoldRange>& ranges,
+                                               int& i,
+                                               int parentFirst,
+                                               int parentLast) {
+  QList<Node> nodes;
+  while (i < ranges.size() && ranges[i].first <= parentLast) {
+    const FoldRange range = ranges[i++];
+    Node node;
+    node.first = range.first - parentFirst;
+    node.last = range.last - parentFirst;
+    node.children.replace(0, 0, nest(ranges, i, range.first, range.last));
+    nodes.append(node);
+  }
+  return nodes;
+}
+
+// A line can close a range and open another like "} else {"
+void FoldingRanges::appendMarks(const QString& text,
+                                int line,
+                                QVector<int>& lines,
+                                QVector<quint8>& kinds) const {
+  if (!m_metadata) {
+    return;
+  }
+
+  if (m_metadata->decreaseIndentPattern() && m_metadata->decreaseIndentPattern()->matches(text)) {
+    lines.append(line);
+    kinds.append(Decrease);
+  }
+  if (m_metadata->increaseIndentPattern() && m_metadata->increaseIndentPattern()->matches(text)) {
+    lines.append(line);
+    kinds.append(Increase);
+  }
+}
+
+void FoldingRanges::resetRanges(const ScopeTree* tree) {
+  QVector<int> lines;
+  QVector<quint8> kinds;
+  for (QTextBlock block = m_doc->begin(); block.isValid(); block = block.next()) {
+    appendMarks(block.text(), block.blockNumber(), lines, kinds);
+  }
+  m_lineCount = m_doc->blockCount();
+  m_marks.reset(lines, kinds);
+  m_root.last = m_lineCount - 1;
+  m_root.children.clear();
+  rebuildLines(tree, m_root, m_root.first, m_root.last, 0, 0, 0, m_root.last);
+}
+
+// Ranges nest, so the child of a range before the changed lines encloses them, ends in them or
+// ends before them. The path of the enclosing children leads to the innermost enclosing range, the
+// parent. The children of the parent ending before the changed lines or the one ending in them,
+// and the ones starting after both, are kept. The children in the gap between them are rebuilt, or
+// all the children of the parent if a new one ends past the gap.
+void FoldingRanges::rebuild(const ScopeTree* tree, int first, int last) {
+  Node* parent = &m_root;
+  int parentFirst = m_root.first;
+  int parentLast = m_root.last;
+  int index = lowerBound(*parent, first - parentFirst);
+  while (index > 0) {
+    const FoldRange range = childRange(*parent, index - 1);
+    if (parentFirst + range.last <= last) {
+      break;
+    }
+    parent = &parent->children.raw(index - 1);
+    parentLast = parentFirst + range.last;
+    parentFirst += range.first;
+    index = lowerBound(*parent, first - parentFirst);
+  }
+
+  int begin = index;
+  int from = parentFirst + 1;
+  if (index > 0) {
+    const int previousLast = parentFirst + childRange(*parent, index - 1).last;
+    if (previousLast >= first) {
+      begin--;
+      if (begin > 0) {
+        from = parentFirst + childRange(*parent, begin - 1).last + 1;
+      }
+    } else {
+      from = previousLast + 1;
+    }
+  }
+  int end = index;
+  int endLine = last;
+  int to = parentLast;
+  for (; end < parent->children.size(); end++) {
+    const FoldRange range = childRange(*parent, end);
+    if (parentFirst + range.first > endLine) {
+      to = parentFirst + range.first - 1;
+      break;
+    }
+    endLine = std::max(endLine, parentFirst + range.last);
+  }
+
+  if (!rebuildLines(tree, *parent, parentFirst, parentLast, begin, end, from, to)) {
+    rebuildLines(tree, *parent, parentFirst, parentLast, 0, parent->children.size(),
+                 parentFirst + 1, parentLast);
+  }
+}
+
+bool FoldingRanges::rebuildLines(const ScopeTree* tree,
+                                 Node& parent,
+                                 int parentFirst,
+                                 int parentLast,
+                                 int begin,
+                                 int end,
+                                 int from,
+                                 int to) {
+  QVector<FoldRange> ranges;
+  const int lastMark = m_marks.lowerBound(to + 1);
+  for (int i = m_marks.lowerBound(from); i < lastMark; i++) {
+    const int pair = m_marks.pairOf(i);
+    if (m_marks.kindAt(i) == Increase && pair >= 0 &&
+        m_marks.positionAt(pair) - 1 > m_marks.positionAt(i)) {
+      ranges.append(FoldRange{m_marks.positionAt(i), m_marks.positionAt(pair) - 1});
+    }
+  }
+  if (tree && from <= to) {
+    const QTextBlock toBlock = m_doc->findBlockByNumber(to);
+    const Region region(m_doc->findBlockByNumber(from).position(),
+                        toBlock.position() + toBlock.length());
+    tree->visit(region, [&](const ScopeNode&, const Region& nodeRegion) {
+      // The children of a node in a line are in the line too
+      const QTextBlock block = m_doc->findBlock(nodeRegion.begin());
+      if (!block.isValid() || nodeRegion.end() <= block.position() + block.length()) {
+        return false;
+      }
+      // A node starting before from is visited only for its children
+      const int first = block.blockNumber();
+      const int last = m_doc->findBlock(nodeRegion.end() - 1).blockNumber();
+      if (first >= from && last > first) {
+        ranges.append(FoldRange{first, last});
+      }
+      return true;
+    });
+  }
+
+  // Outer ones first among the ranges starting at the same line
+  std::sort(ranges.begin(), ranges.end(), [](const FoldRange& x, const FoldRange& y) {
+    return x.first != y.first ? x.first < y.first : x.last > y.last;
+  });
+  QVector<FoldRange> kept;
+  QVector<int> lastLines{parentLast};
+  for (const FoldRange& range : ranges) {
+    if (!kept.isEmpty() && kept.last().first == range.first) {
+      continue;
+    }
+    while (lastLines.last() < range.first) {
+      lastLines.removeLast();
+    }
+    if (range.last > lastLines.last()) {
+      continue;
+    }
+    if (range.last > to) {
+      return false;
+    }
+    kept.append(range);
+    lastLines.append(range.last);
+  }
+
+  int i = 0;
+  parent.children.replace(begin, end, nest(kept, i, parentFirst, parentLast));
+  return true;
+}
+
+void FoldingRanges::updateFolded(int& dirtyFirst, int& dirtyLast) {
+  QVector<FoldRange> folded;
+  for (const FoldRange& range : m_folded) {
+    const boost::optional<FoldRange> current = find(range.first);
+    if (!current) {
+      extend(dirtyFirst, dirtyLast, range.first + 1, range.last);
+      continue;
+    }
+    if (current->last != range.last) {
+      extend(dirtyFirst, dirtyLast, range.first + 1, std::max(range.last, current->last));
+    }
+    folded.append(*current);
+  }
+  m_folded.swap(folded);
+}
+
+void FoldingRanges::updateVisibility(int first, int last) {
+  if (!m_doc) {
+    return;
+  }
+  first = std::max(first, 0);
+  last = std::min(last, m_doc->blockCount() - 1);
+  if (first > last) {
+    return;
+  }
+
+  QVector<bool> hidden(last - first + 1, false);
+  for (const FoldRange& range : m_folded) {
+    for (int line = std::max(range.first + 1, first); line <= std::min(range.last, last); line++) {
+      hidden[line - first] = true;
+    }
+  }
+
+  bool changed = false;
+  QTextBlock block = m_doc->findBlockByNumber(first);
+  for (int i = 0; block.isValid() && i < hidden.size(); i++, block = block.next()) {
+    if (block.isVisible() == hidden[i]) {
+      // A hidden block takes no line, same as QPlainTextDocumentLayout lays it out
+      block.setVisible(!hidden[i]);
+      block.setLineCount(hidden[i] ? 0 : std::max(block.layout()->lineCount(), 1));
+      changed = true;
+    }
+  }
+
+  if (!changed) {
+    return;
+  }
+  // Another QPlainTextDocumentLayout is only repainted
+  QAbstractTextDocumentLayout* layout = m_doc->documentLayout();
+  if (DocumentLayout* documentLayout = qobject_cast<DocumentLayout*>(layout)) {
+    documentLayout->updateBlockVisibility();
+  } else if (QPlainTextDocumentLayout* plainLayout =
+                 qobject_cast<QPlainTextDocumentLayout*>(layout)) {
+    plainLayout->requestUpdate();
+  }
+}
+
+}  // namespace core
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <boost/optional.hpp>
+#include <QList>
+#include <QVector>
+
+#include "macros.h"
+#include "PartitionedVector.h"
+#include "Region.h"
+#include "TokenPairs.h"
+
+class QTextDocument;
+
+namespace core {
+
+class Metadata;
+class ScopeTree;
+
+struct FoldRange {
+  // the line kept visible when folded
+  int first;
+  // the last line hidden when folded
+  int last;
+};
+
+// Foldable ranges of a document and the folded ones, kept by SyntaxHighlighter.
+//
+// A line matching increaseIndentPattern of Metadata opens a range which the next line matching
+// decreaseIndentPattern closes, and a node of the scope tree spanning lines (made by begin/end
+// patterns) is also a range. The pattern matches are kept as TokenPairs at their lines, so only the
+// changed lines are matched again after an edit and only the matches in the innermost pair
+// enclosing them are paired again. Multi-line nodes are looked up in the scope tree, which shifts
+// them on edits.
+//
+// Ranges nest: one crossing another is dropped and only the outermost one is kept among the ranges
+// starting at the same line. They are kept in a tree like ScopeNode. The lines of a range are
+// relative to the first line of its parent and the children are a PartitionedVector, so an edit
+// moves only the ranges on the path to it, and the range of a line is found by binary search at
+// each level.
+//
+// An edit or a partial parse rebuilds only the children of the innermost range enclosing the
+// changed lines, between the unchanged ones around them.
+//
+// Folding hides blocks with QTextBlock::setVisible and asks DocumentLayout to repaint and resize
+// once, so folding all the ranges relayouts the document in one pass. Unlike markContentsDirty,
+// this doesn't emit contentsChange, which the other listeners such as packages would take for an
+// edit.
+class FoldingRanges {
+ public:
+  FoldingRanges();
+  ~FoldingRanges() = default;
+  DEFAULT_COPY_AND_MOVE(FoldingRanges)
+
+  // Returns the ranges sorted by the first line
+  QVector<FoldRange> ranges() const;
+  // Returns the range starting at line
+  boost::optional<FoldRange> find(int line) const;
+  bool isFolded(int line) const;
+
+  // Fold or unfold the range starting at line. Return false if there is nothing to do.
+  bool fold(int line);
+  bool unfold(int line);
+  // Folds all the top level ranges
+  void foldAll();
+  void unfoldAll();
+  // Unfolds the ranges hiding line
+  void reveal(int line);
+
+  // Rebuilds the ranges from the tree of a full parse
+  void reset(const ScopeTree* tree, QTextDocument* doc);
+  // Updates the ranges after tree has replaced its nodes in region with a partial parse. region
+  // covers the removed nodes too.
+  void replace(const ScopeTree* tree, const Region& region);
+  // Updates the ranges after contentsChange. tree has been adjusted for the change already.
+  void update(const ScopeTree* tree, int position, int charsRemoved, int charsAdded);
+
+ private:
+  // Kinds of the matches in TokenPairs
+  enum Mark { Increase = 0, Decrease = 1 };
+
+  // A range whose lines are relative to the first line of its parent
+  struct Node {
+    struct Move {
+      void operator()(Node& node, int delta) const {
+        node.first += delta;
+        node.last += delta;
+      }
+    };
+
+    int first;
+    int last;
+    PartitionedVector<Node, Move, QList<Node>> children;
+  };
+
+  QTextDocument* m_doc;
+  Metadata* m_metadata;
+  int m_lineCount;
+  // Lines matching the patterns
+  TokenPairs m_marks;
+  // Spans [-1, the last line], so the lines after its first one are all the lines like the ones
+  // hidden by a range
+  Node m_root;
+  // folded ranges sorted by the first line
+  QVector<FoldRange> m_folded;
+
+  // Returns the range of the i-th child of node relative to node
+  static FoldRange childRange(const Node& node, int i);
+  // Returns the index of the first child of node starting at or after line relative to node
+  static int lowerBound(const Node& node, int line);
+  static void appendRanges(const Node& node, int nodeFirst, QVector<FoldRange>& ranges);
+  // Moves the children of node after the lines [first, oldLast] relative to node are replaced with
+  // delta more lines
+  static void adjustChildren(Node& node, int first, int oldLast, int delta);
+  // Makes the nodes of the sorted nested ranges from i which start by parentLast
+  static QList<Node> nest(const QVector<FoldRange>& ranges,
+                          int& i,
+                          int parentFirst,
+                          int parentLast);
+
+  void appendMarks(const QString& text,
+                   int line,
+                   QVector<int>& lines,
+                   QVector<quint8>& kinds) const;
+  // Rebuilds the marks and the ranges of all the lines
+  void resetRanges(const ScopeTree* tree);
+  // Rebuilds the ranges around the changed lines [first, last]
+  void rebuild(const ScopeTree* tree, int first, int last);
+  // Replaces the children [begin, end) of parent, which spans [parentFirst, parentLast], with the
+  // ranges starting in [from, to] built from the marks and tree. Returns false without replacing
+  // them if a new range ends after to, which would change the ranges after it.
+  bool rebuildLines(const ScopeTree* tree,
+                    Node& parent,
+                    int parentFirst,
+                    int parentLast,
+                    int begin,
+                    int end,
+                    int from,
+                    int to);
+  // Updates or drops the folded ranges after a rebuild. The span of lines whose visibility may
+  // change is added to [dirtyFirst, dirtyLast].
+  void updateFolded(int& dirtyFirst, int& dirtyLast);
+  void updateVisibility(int first, int last);
+};
+
+}  // namespace core
@@ -0,0 +1,148 @@
+#include <algorithm>
+#include <cstring>
+
+#include "FuzzyMatcher.h"
+#include "Util.h"
+
+namespace core {
+
+namespace {
+const int MATCH_SCORE = 16;
+const int NAME_BONUS = 32;
+const int CONSECUTIVE_BONUS = 6;
+// after '/', or at the beginning of the name
+const int SEPARATOR_BONUS = 10;
+// after '_', '-', '.' and ' '
+const int DELIMITER_BONUS = 8;
+const int CAMEL_CASE_BONUS = 7;
+const int GAP_START_PENALTY = 3;
+const int GAP_EXTENSION_PENALTY = 1;
+
+bool isAsciiLower(char ch) {
+  return ch >= 'a' && ch <= 'z';
+}
+
+bool isAsciiUpper(char ch) {
+  return ch >= 'A' && ch <= 'Z';
+}
+
+int boundaryBonus(const char* path, int i, int begin) {
+  if (i == begin) {
+    return SEPARATOR_BONUS;
+  }
+
+  const char prev = path[i - 1];
+  switch (prev) {
+    case '/':
+    case '\\':
+      return SEPARATOR_BONUS;
+    case '_':
+    case '-':
+    case '.':
+    case ' ':
+      return DELIMITER_BONUS;
+    default:
+      return isAsciiLower(prev) && isAsciiUpper(path[i]) ? CAMEL_CASE_BONUS : 0;
+  }
+}
+
+// Bits are shared by several characters. Non-ASCII bytes share the last bit.
+int charBit(uchar ch) {
+  return ch < 0x80 ? Util::toAsciiLower(ch) % 63 : 63;
+}
+}
+
+quint64 FuzzyMatcher::charMask(const char* str, int length) {
+  quint64 mask = 0;
+  for (int i = 0; i < length; i++) {
+    mask |= quint64(1) << charBit(str[i]);
+  }
+  return mask;
+}
+
+FuzzyMatcher::FuzzyMatcher(const QString& query) : m_query(Util::toAsciiLower(query.toUtf8())) {
+  m_mask = charMask(m_query.constData(), m_query.size());
+}
+
+// The mask test writes one flag per id with no dependency between iterations, which the compiler
+// can vectorize, and the flagged ids are then compacted with a branchless store.
+void FuzzyMatcher::filter(const quint64* masks, int begin, int end, QVector<int>& ids) const {
+  std::vector<quint8> hits(end - begin);
+  for (int i = 0; i < end - begin; i++) {
+    hits[i] = (masks[begin + i] & m_mask) == m_mask;
+  }
+
+  const int idCount = ids.size();
+  ids.resize(idCount + end - begin);
+  int* idData = ids.data() + idCount;
+  int n = 0;
+  for (int i = 0; i < end - begin; i++) {
+    idData[n] = begin + i;
+    n += hits[i];
+  }
+  ids.resize(idCount + n);
+}
+
+int FuzzyMatcher::score(const char* path, const char* lowerPath, int length, int nameStart) const {
+  if (m_query.isEmpty()) {
+    return 0;
+  }
+
+  // Prefer a match in the file name
+  const int nameScore = scoreFrom(path, lowerPath, length, nameStart);
+  if (nameScore >= 0) {
+    return nameScore + NAME_BONUS;
+  }
+  return nameStart > 0 ? scoreFrom(path, lowerPath, length, 0) : -1;
+}
+
+int FuzzyMatcher::scoreFrom(const char* path,
+                            const char* lowerPath,
+                            int length,
+                            int begin) const {
+  const char* query = m_query.constData();
+  const int queryLength = m_query.size();
+  if (length - begin < queryLength) {
+    return -1;
+  }
+
+  // Find the first end of the query as a subsequence. memchr is vectorized by the C library.
+  int end = begin;
+  for (int i = 0; i < queryLength; i++) {
+    const void* found = std::memchr(lowerPath + end, query[i], length - end);
+    if (!found) {
+      return -1;
+    }
+    end = static_cast<const char*>(found) - lowerPath + 1;
+  }
+
+  // Then find the last start from there to get a short match
+  int start = end - 1;
+  for (int i = queryLength - 1; i >= 0; start--) {
+    if (lowerPath[start] == query[i] && --i < 0) {
+      break;
+    }
+  }
+
+  int score = 0;
+  int prev = -1;
+  for (int i = start, q = 0; q < queryLength; i++) {
+    if (lowerPath[i] != query[q]) {
+      continue;
+    }
+
+    score += MATCH_SCORE + boundaryBonus(path, i, begin);
+    if (prev >= 0) {
+      if (i == prev + 1) {
+        score += CONSECUTIVE_BONUS;
+      } else {
+        score -= GAP_START_PENALTY + GAP_EXTENSION_PENALTY * (i - prev - 2);
+      }
+    }
+    prev = i;
+    q++;
+  }
+  return std::max(score, 0);
+}
+
+}  // namespace core
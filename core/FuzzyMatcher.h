@@ -0,0 +1,58 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+namespace core {
+
+// Matches a query against paths as a subsequence, ignoring ASCII case, and scores the match.
+//
+// Matches in the file name, at word boundaries (after '/', '_', '.', camelCase humps, etc.) and in
+// runs of consecutive characters score higher. Gaps between matched characters cost.
+class FuzzyMatcher {
+ public:
+  // Returns a bit set of the characters in str. A string can contain the query only if its mask
+  // has all bits of the query's mask.
+  static quint64 charMask(const char* str, int length);
+
+  // Adds candidate to heap, which keeps the best maxCount candidates with the worst of them on
+  // top. std::sort_heap with the same isBetter sorts them best first.
+  template <typename T, typename IsBetter>
+  static void keepBest(std::vector<T>& heap, int maxCount, const T& candidate, IsBetter isBetter) {
+    if (heap.size() < static_cast<size_t>(maxCount)) {
+      heap.push_back(candidate);
+      std::push_heap(heap.begin(), heap.end(), isBetter);
+    } else if (isBetter(candidate, heap.front())) {
+      std::pop_heap(heap.begin(), heap.end(), isBetter);
+      heap.back() = candidate;
+      std::push_heap(heap.begin(), heap.end(), isBetter);
+    }
+  }
+
+  explicit FuzzyMatcher(const QString& query);
+
+  bool isEmpty() const { return m_query.isEmpty(); }
+  // UTF-8 query with ASCII letters in lower case
+  const QByteArray& query() const { return m_query; }
+  quint64 mask() const { return m_mask; }
+
+  // Appends the ids in [begin, end) whose masks have all bits of mask() to ids. masks is indexed
+  // by id.
+  void filter(const quint64* masks, int begin, int end, QVector<int>& ids) const;
+
+  // Returns the score of the best match in path, or -1 if path doesn't contain the query.
+  // lowerPath is path with ASCII letters in lower case. Both are UTF-8 and nameStart is the
+  // offset of the file name in them.
+  int score(const char* path, const char* lowerPath, int length, int nameStart) const;
+
+ private:
+  QByteArray m_query;
+  quint64 m_mask;
+
+  int scoreFrom(const char* path, const char* lowerPath, int length, int begin) const;
+};
+
+}  // namespace core
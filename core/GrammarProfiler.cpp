@@ -0,0 +1,149 @@
+#include <algorithm>
+#include <QDebug>
+#include <QVariantMap>
+#include <QVector>
+
+#include "GrammarProfiler.h"
+
+namespace core {
+
+std::atomic<bool> GrammarProfiler::s_enabled(false);
+QMutex GrammarProfiler::s_mutex;
+std::unordered_map<QString, std::unique_ptr<GrammarProfiler::Entry>> GrammarProfiler::s_entries;
+
+namespace {
+
+qint64 totalNsecs(const GrammarProfiler::Entry* entry) {
+  return entry->searchNsecs.load(std::memory_order_relaxed) +
+         entry->compileNsecs.load(std::memory_order_relaxed);
+}
+
+double toMsecs(qint64 nsecs) {
+  return nsecs / 1000000.0;
+}
+}
+
+GrammarProfiler::Entry::Entry()
+    : searches(0), matches(0), recompiles(0), searchNsecs(0), compileNsecs(0) {}
+
+void GrammarProfiler::Entry::addSearch(qint64 nsecs, bool matched) {
+  searches.fetch_add(1, std::memory_order_relaxed);
+  if (matched) {
+    matches.fetch_add(1, std::memory_order_relaxed);
+  }
+  searchNsecs.fetch_add(nsecs, std::memory_order_relaxed);
+}
+
+void GrammarProfiler::Entry::addRecompile(qint64 nsecs) {
+  recompiles.fetch_add(1, std::memory_order_relaxed);
+  compileNsecs.fetch_add(nsecs, std::memory_order_relaxed);
+}
+
+void GrammarProfiler::Entry::clear() {
+  searches.store(0, std::memory_order_relaxed);
+  matches.store(0, std::memory_order_relaxed);
+  recompiles.store(0, std::memory_order_relaxed);
+  searchNsecs.store(0, std::memory_order_relaxed);
+  compileNsecs.store(0, std::memory_order_relaxed);
+}
+
+GrammarProfiler::Entry* GrammarProfiler::entry(const QString& file,
+                                               const QString& grammar,
+                                               const QString& repositoryKey,
+                                               const QString& regex) {
+  const QString key = file + QLatin1Char('\0') + grammar + QLatin1Char('\0') + repositoryKey +
+                      QLatin1Char('\0') + regex;
+
+  QMutexLocker locker(&s_mutex);
+  auto it = s_entries.find(key);
+  if (it != s_entries.end()) {
+    return it->second.get();
+  }
+
+  Entry* entry = new Entry();
+  entry->file = file;
+  entry->grammar = grammar;
+  entry->repositoryKey = repositoryKey;
+  entry->regex = regex;
+  s_entries[key] = std::unique_ptr<Entry>(entry);
+  return entry;
+}
+
+void GrammarProfiler::start() {
+  s_enabled.store(true, std::memory_order_relaxed);
+}
+
+void GrammarProfiler::stop() {
+  s_enabled.store(false, std::memory_order_relaxed);
+}
+
+bool GrammarProfiler::isRunning() {
+  return isEnabled();
+}
+
+// Entries are kept because regexes hold pointers to them
+void GrammarProfiler::reset() {
+  QMutexLocker locker(&s_mutex);
+  for (auto& pair : s_entries) {
+    pair.second->clear();
+  }
+}
+
+QVariantList GrammarProfiler::report(int limit) {
+  QVector<const Entry*> entries;
+  {
+    QMutexLocker locker(&s_mutex);
+    for (const auto& pair : s_entries) {
+      if (pair.second->searches.load(std::memory_order_relaxed) > 0 ||
+          pair.second->recompiles.load(std::memory_order_relaxed) > 0) {
+        entries.append(pair.second.get());
+      }
+    }
+  }
+
+  std::sort(entries.begin(), entries.end(), [](const Entry* x, const Entry* y) {
+    return totalNsecs(x) > totalNsecs(y);
+  });
+  if (limit > 0 && entries.size() > limit) {
+    entries.resize(limit);
+  }
+
+  QVariantList list;
+  for (const Entry* entry : entries) {
+    const int searches = entry->searches.load(std::memory_order_relaxed);
+    const int matches = entry->matches.load(std::memory_order_relaxed);
+    QVariantMap map;
+    map.insert(QStringLiteral("file"), entry->file);
+    map.insert(QStringLiteral("grammar"), entry->grammar);
+    map.insert(QStringLiteral("repositoryKey"), entry->repositoryKey);
+    map.insert(QStringLiteral("regex"), entry->regex);
+    map.insert(QStringLiteral("searches"), searches);
+    map.insert(QStringLiteral("matches"), matches);
+    map.insert(QStringLiteral("misses"), searches - matches);
+    map.insert(QStringLiteral("recompiles"), entry->recompiles.load(std::memory_order_relaxed));
+    map.insert(QStringLiteral("time"), toMsecs(totalNsecs(entry)));
+    list.append(map);
+  }
+  return list;
+}
+
+void GrammarProfiler::dump(int limit) {
+  const QVariantList entries = report(limit);
+  qDebug("grammar profile (%d entries)", entries.size());
+  qDebug("%10s %8s %8s %8s %6s  %s", "time(ms)", "searches", "matches", "misses", "recomp",
+         "pattern");
+  for (const QVariant& var : entries) {
+    const QVariantMap map = var.toMap();
+    const QString repositoryKey = map.value(QStringLiteral("repositoryKey")).toString();
+    const QString pattern = map.value(QStringLiteral("grammar")).toString() +
+                            (repositoryKey.isEmpty() ? QString() : QString('#' + repositoryKey)) +
+                            QLatin1Char(' ') + map.value(QStringLiteral("regex")).toString();
+    qDebug("%10.2f %8d %8d %8d %6d  %s", map.value(QStringLiteral("time")).toDouble(),
+           map.value(QStringLiteral("searches")).toInt(),
+           map.value(QStringLiteral("matches")).toInt(),
+           map.value(QStringLiteral("misses")).toInt(),
+           map.value(QStringLiteral("recompiles")).toInt(), qPrintable(pattern));
+  }
+}
+
+}  // namespace core
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#include <QObject>
+#include <QMutex>
+#include <QVariantList>
+
+#include "macros.h"
+#include "Singleton.h"
+#include "stlSpecialization.h"
+
+namespace core {
+
+// Opt-in profiler which attributes tokenization time to the regexes of grammars.
+//
+// Regexes are searched in the parser threads, so the counters are updated without lock. The
+// overhead when the profiler is stopped is a relaxed atomic load per search.
+class GrammarProfiler : public QObject, public Singleton<GrammarProfiler> {
+  Q_OBJECT
+
+ public:
+  // Counters of a regex of a pattern
+  struct Entry {
+    QString file;
+    QString grammar;
+    QString repositoryKey;
+    QString regex;
+    std::atomic<int> searches;
+    std::atomic<int> matches;
+    // # of compiles of a regex with back references
+    std::atomic<int> recompiles;
+    std::atomic<qint64> searchNsecs;
+    std::atomic<qint64> compileNsecs;
+
+    Entry();
+    DISABLE_COPY_AND_MOVE(Entry)
+
+    void addSearch(qint64 nsecs, bool matched);
+    void addRecompile(qint64 nsecs);
+    void clear();
+  };
+
+  static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+  // Returns the counters of the regex. The returned entry lives until the app quits.
+  static Entry* entry(const QString& file,
+                      const QString& grammar,
+                      const QString& repositoryKey,
+                      const QString& regex);
+
+  ~GrammarProfiler() = default;
+
+ public slots:
+  void start();
+  void stop();
+  bool isRunning();
+  void reset();
+
+  // Returns the entries sorted by total time in descending order. Each entry is an object which
+  // has file, grammar, repositoryKey, regex, searches, matches, misses, recompiles and time (ms).
+  // limit <= 0 means no limit.
+  QVariantList report(int limit = 0);
+
+  // Prints the report to the log
+  void dump(int limit = 50);
+
+ private:
+  friend class Singleton<GrammarProfiler>;
+
+  static std::atomic<bool> s_enabled;
+  static QMutex s_mutex;
+  static std::unordered_map<QString, std::unique_ptr<Entry>> s_entries;
+
+  GrammarProfiler() = default;
+};
+
+}  // namespace core
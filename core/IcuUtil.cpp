@@ -1,8 +1,4 @@
 #include "IcuUtil.h"
-#include "scoped_guard.h"
-
-#include <QDebug>
-#include <QVector>
 
 namespace core {
 QString IcuUtil::toQString(const UnicodeString& string) {
@@ -12,38 +8,13 @@ QString IcuUtil::toQString(const UnicodeString& string) {
   return ret;
 }
 
+// Both are UTF-16, so the text is copied without conversion
 UnicodeString IcuUtil::toIcuString(const QString& string) {
-  return icu::UnicodeString::fromUTF8(string.toUtf8().constData());
+  return icu::UnicodeString(reinterpret_cast<const UChar*>(string.utf16()), string.size());
 }
 
 Locale IcuUtil::icuLocale(const QString& localeStr) {
   return Locale::createCanonical(localeStr.toUtf8().constData());
 }
 
-QVector<int> IcuUtil::wordBoundaries(const QString& text, Locale locale) {
-  UErrorCode status = U_ZERO_ERROR;
-  auto boundary = BreakIterator::createWordInstance(locale, status);
-  if (!boundary) {
-    qWarning() << "Failed to createWordInstance using locale:" << locale.getName()
-               << "use en_US locale instead";
-    boundary = BreakIterator::createWordInstance(Locale::getUS(), status);
-    if (!boundary) {
-      throw std::runtime_error("Failed to createWordInstance using en_US locale");
-    }
-  }
-  Q_ASSERT(boundary);
-
-  scoped_guard guard([=] { delete boundary; });
-  boundary->setText(IcuUtil::toIcuString(text));
-  int32_t pos = boundary->first();
-
-  QVector<int> positions;
-  while (pos != BreakIterator::DONE) {
-    positions.append(pos);
-    pos = boundary->next();
-  }
-
-  return positions;
-}
-
 }  // namespace core
@@ -28,6 +28,9 @@ namespace core {
 
 v8::Persistent<v8::Object> JSHandler::s_jsHandler;
 bool JSHandler::s_isInitialized = false;
+v8::Persistent<v8::String> JSHandler::s_emitKey;
+v8::Persistent<v8::String> JSHandler::s_emitBatchKey;
+std::unordered_map<QString, v8::UniquePersistent<v8::String>> JSHandler::s_signalNames;
 
 namespace {
 constexpr int MAX_ARGS_COUNT_FOR_SIGNAL = MAX_ARGS_COUNT + 1;
@@ -118,6 +121,19 @@ void JSHandler::inheritsQtEventEmitter(Isolate* isolate, Local<v8::Value> proto)
   }
 }
 
+Local<String> JSHandler::signalName(Isolate* isolate, const QString& signal) {
+  auto it = s_signalNames.find(signal);
+  if (it != s_signalNames.end()) {
+    return it->second.Get(isolate);
+  }
+
+  Local<String> name =
+      String::NewFromTwoByte(isolate, signal.utf16(), v8::NewStringType::kInternalized, signal.size())
+          .ToLocalChecked();
+  s_signalNames.insert(std::make_pair(signal, v8::UniquePersistent<String>(isolate, name)));
+  return name;
+}
+
 void JSHandler::emitSignal(Isolate* isolate, QObject* obj, const QString& signal, QVariantList args) {
   qDebug() << "emitSignal. " << signal << "args:" << args;
 
@@ -131,48 +147,69 @@ void JSHandler::emitSignal(Isolate* isolate, QObject* obj, const QString& signal
   }
 
   if (const auto& jsObj = ObjectStore::singleton().find(obj, isolate)) {
-    MaybeLocal<Value> maybeEmitValue = (*jsObj)->Get(
-        isolate->GetCurrentContext(),
-        String::NewFromUtf8(isolate, "_emit", v8::NewStringType::kNormal).ToLocalChecked());
-    if (maybeEmitValue.IsEmpty()) {
-      qWarning() << "emit method not found";
-      return;
-    }
-
-    Local<Value> emitValue = maybeEmitValue.ToLocalChecked();
-    if (!emitValue->IsFunction()) {
-      qWarning() << "emit is not function";
-      return;
-    }
-
-    Local<Function> emitFn = Local<Function>::Cast(emitValue);
-
     Local<Value> argv[MAX_ARGS_COUNT_FOR_SIGNAL];
-    argv[0] = String::NewFromUtf8(isolate, signal.toUtf8().constData(), v8::NewStringType::kNormal)
-                  .ToLocalChecked();
+    argv[0] = signalName(isolate, signal);
     for (int i = 0; i < qMin(args.size(), MAX_ARGS_COUNT_FOR_SIGNAL - 1); i++) {
       argv[i + 1] = V8Util::toV8Value(isolate, args[i]);
     }
+    callEmitter(isolate, *jsObj, s_emitKey, "_emit",
+                qMin(args.size() + 1, MAX_ARGS_COUNT_FOR_SIGNAL), argv);
+  } else {
+    qWarning() << "associated JS object not found";
+  }
+}
 
-    TryCatch trycatch(isolate);
-    // When an exception occurs, Function::Call returns empty value.
-    MaybeLocal<Value> maybeResult =
-        emitFn->Call(isolate->GetCurrentContext(), *jsObj,
-                     qMin(args.size() + 1, MAX_ARGS_COUNT_FOR_SIGNAL), argv);
-    if (trycatch.HasCaught()) {
-      QLoggingCategory category("silkedit");
-      const auto& msg = V8Util::getErrorMessage(isolate, trycatch);
-      qCCritical(category).noquote() << msg;
-
-      return;
-    } else if (maybeResult.IsEmpty()) {
-      QLoggingCategory category("silkedit");
-      qCCritical(category) << "maybeResult is empty (but exception is not thrown...)";
-      return;
-    }
+void JSHandler::emitSignalBatch(Isolate* isolate,
+                                QObject* obj,
+                                const QString& signal,
+                                const QVariantList& argsList) {
+  if (!s_isInitialized) {
+    qWarning() << "JSHandler is not yet initialized";
+    return;
+  }
+
+  if (const auto& jsObj = ObjectStore::singleton().find(obj, isolate)) {
+    Local<Value> argv[] = {signalName(isolate, signal), V8Util::toV8Value(isolate, argsList)};
+    callEmitter(isolate, *jsObj, s_emitBatchKey, "_emitBatch", 2, argv);
   } else {
     qWarning() << "associated JS object not found";
   }
 }
 
+void JSHandler::callEmitter(Isolate* isolate,
+                            Local<Object> jsObj,
+                            Persistent<String>& key,
+                            const char* name,
+                            int argc,
+                            Local<Value> argv[]) {
+  if (key.IsEmpty()) {
+    key.Reset(isolate, String::NewFromUtf8(isolate, name, v8::NewStringType::kInternalized)
+                           .ToLocalChecked());
+  }
+  MaybeLocal<Value> maybeEmitValue = jsObj->Get(isolate->GetCurrentContext(), key.Get(isolate));
+  if (maybeEmitValue.IsEmpty()) {
+    qWarning() << name << "method not found";
+    return;
+  }
+
+  Local<Value> emitValue = maybeEmitValue.ToLocalChecked();
+  if (!emitValue->IsFunction()) {
+    qWarning() << name << "is not function";
+    return;
+  }
+
+  Local<Function> emitFn = Local<Function>::Cast(emitValue);
+  TryCatch trycatch(isolate);
+  // When an exception occurs, Function::Call returns empty value.
+  MaybeLocal<Value> maybeResult = emitFn->Call(isolate->GetCurrentContext(), jsObj, argc, argv);
+  if (trycatch.HasCaught()) {
+    QLoggingCategory category("silkedit");
+    const auto& msg = V8Util::getErrorMessage(isolate, trycatch);
+    qCCritical(category).noquote() << msg;
+  } else if (maybeResult.IsEmpty()) {
+    QLoggingCategory category("silkedit");
+    qCCritical(category) << "maybeResult is empty (but exception is not thrown...)";
+  }
+}
+
 }  // namespace core
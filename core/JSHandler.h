@@ -1,9 +1,12 @@
 #pragma once
 
 #include <v8.h>
+#include <unordered_map>
 #include <QObject>
 #include <QVariant>
 
+#include "stlSpecialization.h"
+
 namespace core {
 
 class JSHandler {
@@ -12,6 +15,11 @@ class JSHandler {
   static QVariant callFunc(v8::Isolate *isolate, const QString& funcName, QVariantList args);
   static void inheritsQtEventEmitter(v8::Isolate *isolate, v8::Local<v8::Value> proto);
   static void emitSignal(v8::Isolate* isolate, QObject *obj, const QString& signal, QVariantList args);
+  // Calls the batched listeners of signal with argsList, the list of the arguments of each emission
+  static void emitSignalBatch(v8::Isolate* isolate,
+                              QObject* obj,
+                              const QString& signal,
+                              const QVariantList& argsList);
 
   template <typename T>
   static T callFunc(v8::Isolate* isolate, const QString &funcName, QVariantList args, T defaultValue) {
@@ -22,6 +30,19 @@ class JSHandler {
 private:
   static v8::Persistent<v8::Object> s_jsHandler;
   static bool s_isInitialized;
+  static v8::Persistent<v8::String> s_emitKey;
+  static v8::Persistent<v8::String> s_emitBatchKey;
+  // internalized signal names
+  static std::unordered_map<QString, v8::UniquePersistent<v8::String>> s_signalNames;
+
+  static v8::Local<v8::String> signalName(v8::Isolate* isolate, const QString& signal);
+  // Calls the method stored in key of jsObj. key is initialized with name on first use.
+  static void callEmitter(v8::Isolate* isolate,
+                          v8::Local<v8::Object> jsObj,
+                          v8::Persistent<v8::String>& key,
+                          const char* name,
+                          int argc,
+                          v8::Local<v8::Value> argv[]);
 
   JSHandler() = delete;
   ~JSHandler() = delete;
@@ -8,10 +8,12 @@
 #include <QRegularExpression>
 #include <QFile>
 #include <QDir>
+#include <QElapsedTimer>
 
 #include "LanguageParser.h"
 #include "PListParser.h"
 #include "Regexp.h"
+#include "Tracer.h"
 
 namespace core {
 
@@ -51,7 +53,10 @@ Captures toCaptures(QVariantMap map) {
   return captures;
 }
 
-Pattern* toChildPattern(QVariantMap map, Pattern* parent, Language* lang);
+Pattern* toChildPattern(QVariantMap map,
+                        Pattern* parent,
+                        Language* lang,
+                        const QString& repositoryKey = QString());
 
 QVector<Pattern*>* toPatterns(QVariant patternsVar, Pattern* parent, Language* lang) {
   if (patternsVar.canConvert<QVariantList>()) {
@@ -77,7 +82,7 @@ void toPattern(QVariantMap map, Pattern* pat, Language* lang) {
   // match
   static const QString match = QStringLiteral("match");
   if (map.contains(match)) {
-    pat->match.reset(new FixedRegex(map.value(match).toString()));
+    pat->match.reset(new FixedRegex(map.value(match).toString(), pat));
   }
 
   // name
@@ -89,7 +94,7 @@ void toPattern(QVariantMap map, Pattern* pat, Language* lang) {
   // begin
   static const QString begin = QStringLiteral("begin");
   if (map.contains(begin)) {
-    pat->begin.reset(new FixedRegex(map.value(begin).toString()));
+    pat->begin.reset(new FixedRegex(map.value(begin).toString(), pat));
   }
 
   // beginCaptures
@@ -110,7 +115,7 @@ void toPattern(QVariantMap map, Pattern* pat, Language* lang) {
   // end
   static const QString end = QStringLiteral("end");
   if (map.contains(end)) {
-    pat->end.reset(Regex::create(map.value(end).toString()));
+    pat->end.reset(Regex::create(map.value(end).toString(), pat));
   }
 
   // endCaptures
@@ -148,7 +153,7 @@ void toPattern(QVariantMap map, Pattern* pat, Language* lang) {
       QString key = iter.key();
       if (iter.value().canConvert<QVariantMap>()) {
         QVariantMap subMap = iter.value().toMap();
-        if (Pattern* pattern = toChildPattern(subMap, pat, lang)) {
+        if (Pattern* pattern = toChildPattern(subMap, pat, lang, key)) {
           pat->repository[key] = std::unique_ptr<Pattern>(pattern);
         }
       }
@@ -163,8 +168,12 @@ RootPattern* toRootPattern(QVariantMap map, Language* lang) {
 }
 
 // todo: check ownership
-Pattern* toChildPattern(QVariantMap map, Pattern* parent, Language* lang) {
+Pattern* toChildPattern(QVariantMap map,
+                        Pattern* parent,
+                        Language* lang,
+                        const QString& repositoryKey) {
   Pattern* pat = new Pattern(lang, parent);
+  pat->repositoryKey = repositoryKey.isEmpty() && parent ? parent->repositoryKey : repositoryKey;
   toPattern(map, pat, lang);
   return pat;
 }
@@ -226,10 +235,11 @@ bool inSameLine(const QString& text, int begin, int end) {
 }
 
 // Returns the expanded region that covers nodes that intersect region
-boost::optional<std::tuple<int, int>> coveringIndices(QList<Node> nodes, Region region) {
+boost::optional<std::tuple<int, int>> coveringIndices(const QVector<Region>& nodeRegions,
+                                                      Region region) {
   int begin = INT_MAX, end = -1;
-  for (int i = 0; i < nodes.size(); i++) {
-    if (nodes[i].region.intersects(region)) {
+  for (int i = 0; i < nodeRegions.size(); i++) {
+    if (nodeRegions[i].intersects(region)) {
       begin = qMin(begin, i);
       end = qMax(end, i);
     }
@@ -257,7 +267,7 @@ boost::optional<RootNode> LanguageParser::parse() {
 
   const auto& txt = text();
   RootNode rootNode(m_lang->scopeName);
-  auto result = parse(txt, QList<Node>(), Region(0, txt.length()));
+  auto result = parse(txt, QVector<Region>(), Region(0, txt.length()));
   auto children = std::get<0>(result);
 
   if (isCancelRequested()) {
@@ -275,11 +285,12 @@ boost::optional<RootNode> LanguageParser::parse() {
 }
 
 // parse in [begin, end) (doensn't include end)
-boost::optional<std::tuple<QList<Node>, Region>> LanguageParser::parse(QList<Node> children,
-                                                                       Region region) {
+boost::optional<std::tuple<QList<Node>, Region>> LanguageParser::parse(
+    QVector<Region> childRegions,
+    Region region) {
   Q_ASSERT(isIdle());
   setState(State::PartialParsing);
-  auto result = parse(text(), children, region);
+  auto result = parse(text(), childRegions, region);
   auto nodes = std::get<0>(result);
   auto parsedRegion = std::get<1>(result);
 
@@ -295,22 +306,20 @@ boost::optional<std::tuple<QList<Node>, Region>> LanguageParser::parse(QList<Nod
 // The main thread MUST NOT run this method because this method calls
 // QCoreApplication::processEvents to cancel
 std::tuple<QList<Node>, Region> LanguageParser::parse(const QString& text,
-                                                      QList<Node> children,
+                                                      QVector<Region> childRegions,
                                                       Region region) {
-  qDebug() << "parse. region:" << region.toString() << "lang:" << m_lang->scopeName;
+  TRACE_SCOPE("LanguageParser::parse");
   int endChildIndex = -1;
-  if (const auto& indices = coveringIndices(children, region)) {
+  if (const auto& indices = coveringIndices(childRegions, region)) {
     int beginChildIndex = std::get<0>(*indices);
     endChildIndex = std::get<1>(*indices);
 
     // expand region to cover affected children
-    region = Region(qMin(region.begin(), children[beginChildIndex].region.begin()),
-                    qMax(region.end(), children[endChildIndex].region.end()));
+    region = Region(qMin(region.begin(), childRegions[beginChildIndex].begin()),
+                    qMax(region.end(), childRegions[endChildIndex].end()));
   }
 
-  QTime t;
-  t.start();
-
+  TRACE_COUNTER("LanguageParser::parseLength", region.length());
   clearCache();
 
   QList<Node> nodes;
@@ -354,10 +363,10 @@ std::tuple<QList<Node>, Region> LanguageParser::parse(const QString& text,
       pos = newNodeRegion.end();
 
       // Expand region to parse more children
-      if (0 <= endChildIndex && pos > children[endChildIndex].region.end() &&
-          endChildIndex + 1 < children.size()) {
+      if (0 <= endChildIndex && pos > childRegions[endChildIndex].end() &&
+          endChildIndex + 1 < childRegions.size()) {
         endChildIndex++;
-        region.setEnd(children[endChildIndex].region.end());
+        region.setEnd(childRegions[endChildIndex].end());
       }
 
       if (region.intersects(newNodeRegion)) {
@@ -371,9 +380,8 @@ std::tuple<QList<Node>, Region> LanguageParser::parse(const QString& text,
     }
   }
 
-  qDebug("parse finished. elapsed: %d ms", t.elapsed());
   Region parsedRegion(region.begin(),
-                      endChildIndex >= 0 ? children[endChildIndex].region.end() : region.end());
+                      endChildIndex >= 0 ? childRegions[endChildIndex].end() : region.end());
   return std::make_tuple(nodes, parsedRegion);
 }
 
@@ -523,34 +531,6 @@ bool Node::isLeaf() const {
   return children.size() == 0;
 }
 
-void Node::adjust(int pos, int delta) {
-  region.adjust(pos, delta);
-  for (auto& child : children) {
-    child.adjust(pos, delta);
-  }
-}
-
-// Remove children that intersect region
-void Node::removeChildren(Region region) {
-  for (auto it = children.begin(); it != children.end();) {
-    if ((*it).region.intersects(region)) {
-      it = children.erase(it);
-    } else {
-      it++;
-    }
-  }
-}
-
-void Node::addChildren(QList<Node> newNodes) {
-  std::for_each(newNodes.begin(), newNodes.end(),
-                [&](const Node& node) { children.push_back(node); });
-}
-
-void Node::sortChildren() {
-  std::sort(children.begin(), children.end(),
-            [](const Node& x, const Node& y) { return x.region.begin() < y.region.begin(); });
-}
-
 QString Node::format(QString indent, const QString& text) const {
   if (isLeaf()) {
     return indent +
@@ -600,7 +580,16 @@ boost::optional<QVector<Region>> Regex::find(Regexp* regex,
     return boost::none;
   }
 
+  QElapsedTimer timer;
+  const bool profiling = GrammarProfiler::isEnabled();
+  if (profiling) {
+    timer.start();
+  }
+
   QVector<int> indices = regex->findStringSubmatchIndex(str, beginPos, endPos, false);
+  if (profiling) {
+    profileEntry()->addSearch(timer.nsecsElapsed(), !indices.isEmpty());
+  }
   if (!indices.isEmpty()) {
     Q_ASSERT(!indices.isEmpty());
     Q_ASSERT(indices.size() % 2 == 0);
@@ -614,11 +603,25 @@ boost::optional<QVector<Region>> Regex::find(Regexp* regex,
   return boost::none;
 }
 
-Regex* Regex::create(const QString& pattern) {
+// Grammars are shared by the parsers of all threads. GrammarProfiler::entry returns the same entry
+// for the same regex, so threads racing to set m_profileEntry store the same pointer.
+GrammarProfiler::Entry* Regex::profileEntry() {
+  GrammarProfiler::Entry* entry = m_profileEntry.load(std::memory_order_acquire);
+  if (!entry) {
+    Language* lang = m_owner ? m_owner->lang : nullptr;
+    entry = GrammarProfiler::entry(lang ? lang->path : QString(),
+                                   lang ? lang->scopeName : QString(),
+                                   m_owner ? m_owner->repositoryKey : QString(), pattern());
+    m_profileEntry.store(entry, std::memory_order_release);
+  }
+  return entry;
+}
+
+Regex* Regex::create(const QString& pattern, Pattern* owner) {
   if (hasBackReference(pattern)) {
-    return new RegexWithBackReference(pattern);
+    return new RegexWithBackReference(pattern, owner);
   } else {
-    return new FixedRegex(pattern);
+    return new FixedRegex(pattern, owner);
   }
 }
 
@@ -1077,6 +1080,7 @@ Language* LanguageProvider::loadLanguage(const QString& path) {
 
   QVariantMap rootMap = root.toMap();
   Language* lang = new Language(rootMap);
+  lang->path = path;
 
   QWriteLocker locker(&s_lock);
 
@@ -1095,7 +1099,8 @@ QVector<QPair<QString, QString>> LanguageProvider::scopeAndLangNamePairs() {
   return s_scopeAndLangNamePairs;
 }
 
-FixedRegex::FixedRegex(const QString& pattern) : Regex(), regex(Regexp::compile(pattern)) {}
+FixedRegex::FixedRegex(const QString& pattern, Pattern* owner)
+    : Regex(owner), regex(Regexp::compile(pattern)) {}
 
 QString FixedRegex::pattern() {
   return regex ? regex->pattern() : "";
@@ -1160,18 +1165,20 @@ RootNode::RootNode() : Node() {}
 
 RootNode::RootNode(const QString& name) : Node(name) {}
 
-void RootNode::adjust(int pos, int delta) {
-  region.setEnd(region.end() + delta);
-  for (auto& child : children) {
-    child.adjust(pos, delta);
-  }
-}
-
 boost::optional<QVector<Region>> RegexWithBackReference::find(const QString& str,
                                                               int beginPos,
                                                               int endPos,
                                                               QList<QStringRef> capturedStrs) {
+  QElapsedTimer timer;
+  const bool profiling = GrammarProfiler::isEnabled();
+  if (profiling) {
+    timer.start();
+  }
+
   auto regex = Regexp::compile(expandBackReferences(patternStr, capturedStrs));
+  if (profiling) {
+    profileEntry()->addRecompile(timer.nsecsElapsed());
+  }
   if (!regex) {
     qWarning() << "failed to compile" << expandBackReferences(patternStr, capturedStrs);
     return boost::none;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <vector>
 #include <unordered_map>
@@ -13,6 +14,7 @@
 #include "Regexp.h"
 #include "stlSpecialization.h"
 #include "Region.h"
+#include "GrammarProfiler.h"
 
 namespace core {
 
@@ -20,6 +22,7 @@ struct Language;
 class LanguageParser;
 struct Node;
 struct RootNode;
+struct Pattern;
 
 struct Capture {
   int key;
@@ -29,7 +32,8 @@ struct Capture {
 typedef QVector<Capture> Captures;
 
 struct Regex {
-  static Regex* create(const QString& pattern);
+  // owner is used to attribute the search time to the pattern in GrammarProfiler
+  static Regex* create(const QString& pattern, Pattern* owner = nullptr);
 
   virtual ~Regex() = default;
 
@@ -42,16 +46,21 @@ struct Regex {
   virtual QString pattern() = 0;
 
  protected:
-  Regex() {}
+  explicit Regex(Pattern* owner) : m_owner(owner), m_profileEntry(nullptr) {}
 
   boost::optional<QVector<Region>> find(Regexp* regex,
                                         const QString& str,
                                         int beginPos,
                                         int endPos);
+  GrammarProfiler::Entry* profileEntry();
 
  private:
   friend class LanguageParserTest;
 
+  Pattern* m_owner;
+  // Set lazily by parsers on any thread
+  std::atomic<GrammarProfiler::Entry*> m_profileEntry;
+
   static bool hasBackReference(const QString& str);
 };
 
@@ -59,7 +68,7 @@ struct Regex {
 struct FixedRegex : public Regex {
   std::unique_ptr<Regexp> regex;
 
-  explicit FixedRegex(const QString& pattern);
+  explicit FixedRegex(const QString& pattern, Pattern* owner = nullptr);
 
   QString pattern() override;
 
@@ -75,7 +84,8 @@ struct FixedRegex : public Regex {
 struct RegexWithBackReference : public Regex {
   QString patternStr;
 
-  explicit RegexWithBackReference(const QString& pattern) : Regex(), patternStr(pattern) {}
+  explicit RegexWithBackReference(const QString& pattern, Pattern* owner = nullptr)
+      : Regex(owner), patternStr(pattern) {}
 
   QString pattern() override { return patternStr; }
 
@@ -93,6 +103,8 @@ struct Pattern {
   QString name;
   QString contentName;
   QString include;
+  // key of the innermost repository item which has this pattern
+  QString repositoryKey;
   std::unique_ptr<Regex> match;
   Captures captures;
   std::unique_ptr<Regex> begin;
@@ -159,6 +171,8 @@ class LanguageProvider {
 // Language cannot be shared (means mutable) across multiple documents because RootPattern has some
 // cache and is unique for a certain document.
 struct Language {
+  // path of the grammar file
+  QString path;
   QVector<QString> fileTypes;
   QString firstLineMatch;
   std::unique_ptr<RootPattern> rootPattern;  // patterns
@@ -186,7 +200,11 @@ class LanguageParser {
   DEFAULT_COPY_AND_MOVE(LanguageParser)
 
   boost::optional<RootNode> parse();
-  boost::optional<std::tuple<QList<Node>, Region> > parse(QList<Node> children, Region region);
+  // childRegions are the regions of the current top level nodes around region (see
+  // ScopeTree::childRegions). The region to parse is expanded to cover the nodes which intersect
+  // it.
+  boost::optional<std::tuple<QList<Node>, Region> > parse(QVector<Region> childRegions,
+                                                          Region region);
   QString getData(int start, int end);
 
   QString text();
@@ -210,7 +228,9 @@ class LanguageParser {
 
   LanguageParser(std::unique_ptr<Language> lang, const QString& str);
 
-  std::tuple<QList<Node>, Region> parse(const QString& text, QList<Node> children, Region region);
+  std::tuple<QList<Node>, Region> parse(const QString& text,
+                                        QVector<Region> childRegions,
+                                        Region region);
   void clearCache();
 };
 
@@ -235,11 +255,6 @@ struct Node {
   Region updateRegion();
   QString toString(const QString &text) const;
   bool isLeaf() const;
-  virtual void adjust(int pos, int delta);
-
-  void removeChildren(Region region);
-  void addChildren(QList<Node> newNodes);
-  void sortChildren();
 
   inline bool operator==(const Node& other) const {
     return region == other.region && name == other.name && children.size() == other.children.size();
@@ -255,8 +270,6 @@ struct Node {
 struct RootNode : public Node {
   RootNode();
   RootNode(const QString& name);
-
-  void adjust(int pos, int delta) override;
 };
 
 }  // namespace core
@@ -1,5 +1,11 @@
+#include <atomic>
+#include <cstring>
 #include <string>
 #include <QMetaMethod>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
 
 #include "MessageHandler.h"
 
@@ -7,6 +13,77 @@ Q_LOGGING_CATEGORY(silkedit, SILKEDIT_CATEGORY)
 
 namespace core {
 
+namespace {
+
+// must be a power of 2
+constexpr size_t BUFFER_CAPACITY = 4096;
+// Formatted messages are emitted at most once per this interval (a frame at 60 fps)
+constexpr int FORMAT_INTERVAL_MS = 16;
+constexpr int MAX_MESSAGES_PER_SECOND = 500;
+
+// rate limit of the messages sent to the console
+struct RateLimit {
+  std::atomic<qint64> windowBegin;
+  std::atomic<int> count;
+  std::atomic<int> suppressed;
+};
+
+// zero initialized
+RateLimit s_rateLimit;
+
+QElapsedTimer& clock() {
+  static QElapsedTimer s_clock;
+  return s_clock;
+}
+}
+
+class MessageHandler::Formatter : public QThread {
+ public:
+  explicit Formatter(MessageHandler* handler)
+      : m_handler(handler), m_hasMessages(false), m_stopped(false) {}
+
+  // Called by producers. Only the first message after the formatter becomes idle takes the lock.
+  void notify() {
+    if (!m_hasMessages.exchange(true)) {
+      QMutexLocker locker(&m_mutex);
+      m_wakeup.wakeOne();
+    }
+  }
+
+  void stop() {
+    QMutexLocker locker(&m_mutex);
+    m_stopped = true;
+    m_wakeup.wakeOne();
+  }
+
+ protected:
+  void run() override {
+    for (;;) {
+      {
+        QMutexLocker locker(&m_mutex);
+        while (!m_stopped && !m_hasMessages.load()) {
+          m_wakeup.wait(&m_mutex);
+        }
+        if (m_stopped) {
+          return;
+        }
+      }
+
+      // collect messages in a frame
+      QThread::msleep(FORMAT_INTERVAL_MS);
+      m_hasMessages = false;
+      m_handler->flush();
+    }
+  }
+
+ private:
+  MessageHandler* m_handler;
+  std::atomic<bool> m_hasMessages;
+  QMutex m_mutex;
+  QWaitCondition m_wakeup;
+  bool m_stopped;
+};
+
 QtMessageHandler MessageHandler::s_defaultMsgHandler = nullptr;
 
 void MessageHandler::handler(QtMsgType type,
@@ -20,7 +97,10 @@ void MessageHandler::handler(QtMsgType type,
       case QtInfoMsg:
       case QtWarningMsg:
       case QtCriticalMsg:
-        MessageHandler::singleton().handleMessage(type, msg);
+        // Only the messages sent to the console are rate limited
+        if (checkRateLimit()) {
+          MessageHandler::singleton().handleMessage(type, msg);
+        }
         s_defaultMsgHandler(type, context, msg);
         break;
       case QtFatalMsg:
@@ -38,26 +118,87 @@ void MessageHandler::init() {
       "[%{time h:mm:ss.zzz} "
       "%{if-debug}D%{endif}%{if-info}I%{endif}%{if-warning}W%{endif}%{if-critical}C%{endif}%{if-"
       "fatal}F%{endif}] %{file}:%{line} - %{message}");
+  clock().start();
   s_defaultMsgHandler = qInstallMessageHandler(MessageHandler::handler);
   Q_ASSERT(s_defaultMsgHandler);
 }
 
+QString MessageHandler::toHtml(const MessageInfo& info) {
+  QString color;
+  switch (info.type) {
+    case QtDebugMsg:
+    case QtInfoMsg:
+      color = QStringLiteral("black");
+      break;
+    case QtWarningMsg:
+      color = QStringLiteral("#9F6000");
+      break;
+    case QtCriticalMsg:
+    case QtFatalMsg:
+      color = QStringLiteral("red");
+      break;
+  }
+
+  const QString& htmlMsg =
+      info.msg.toHtmlEscaped().replace(QStringLiteral("\n"), QStringLiteral("<br>"));
+  return QStringLiteral("<div style='color:%1;'>%2</div>").arg(color).arg(htmlMsg);
+}
+
+// Fixed window rate limit. The count is approximate when many threads log at the same time.
+bool MessageHandler::checkRateLimit() {
+  const qint64 now = clock().elapsed();
+  qint64 windowBegin = s_rateLimit.windowBegin.load(std::memory_order_relaxed);
+  if (now - windowBegin >= 1000 &&
+      s_rateLimit.windowBegin.compare_exchange_strong(windowBegin, now)) {
+    s_rateLimit.count = 0;
+    if (int suppressed = s_rateLimit.suppressed.exchange(0)) {
+      MessageHandler::singleton().handleMessage(
+          QtWarningMsg, QStringLiteral("%1 messages were suppressed").arg(suppressed));
+    }
+  }
+
+  if (s_rateLimit.count.fetch_add(1, std::memory_order_relaxed) < MAX_MESSAGES_PER_SECOND) {
+    return true;
+  }
+  s_rateLimit.suppressed.fetch_add(1, std::memory_order_relaxed);
+  return false;
+}
+
+MessageHandler::MessageHandler()
+    : m_messages(BUFFER_CAPACITY), m_formatter(new Formatter(this)) {}
+
+MessageHandler::~MessageHandler() {
+  m_formatter->stop();
+  m_formatter->wait();
+}
+
 void MessageHandler::handleMessage(QtMsgType type, const QString& msg) {
-  static const QMetaMethod messageSignal = QMetaMethod::fromSignal(&MessageHandler::message);
-  if (isSignalConnected(messageSignal)) {
-    emit message(type, msg);
-  } else {
-    // buffer messages when no connection
-    m_storedMessages.append(MessageInfo{type, msg});
+  // Messages are buffered until the signal is connected because the formatter isn't started
+  m_messages.push(MessageInfo{type, msg});
+  m_formatter->notify();
+}
+
+void MessageHandler::flush() {
+  QString html;
+  if (int dropped = m_messages.takeDroppedCount()) {
+    html +=
+        toHtml(MessageInfo{QtWarningMsg, QStringLiteral("%1 messages were dropped").arg(dropped)});
+  }
+
+  MessageInfo info;
+  while (m_messages.tryPop(info)) {
+    html += toHtml(info);
+  }
+
+  if (!html.isEmpty()) {
+    emit messagesFormatted(html);
   }
 }
 
 void MessageHandler::connectNotify(const QMetaMethod& signal) {
-  if (signal == QMetaMethod::fromSignal(&MessageHandler::message)) {
-    for (const auto& msgInfo : m_storedMessages) {
-      emit message(msgInfo.type, msgInfo.msg);
-    }
-    m_storedMessages.clear();
+  if (signal == QMetaMethod::fromSignal(&MessageHandler::messagesFormatted) &&
+      !m_formatter->isRunning()) {
+    m_formatter->start(QThread::LowPriority);
   }
 }
 
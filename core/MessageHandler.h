@@ -1,11 +1,13 @@
 #pragma once
 
+#include <memory>
 #include <QObject>
 #include <QDebug>
 #include <QLoggingCategory>
 
 #include "macros.h"
 #include "Singleton.h"
+#include "RingBuffer.h"
 
 #define SILKEDIT_CATEGORY "silkedit"
 
@@ -18,6 +20,9 @@ struct MessageInfo {
   QString msg;
 };
 
+// Log messages are pushed to a bounded lock-free buffer on the logging thread. A background thread
+// formats them as HTML and emits them in batch at most once per frame. When the buffer is full, the
+// oldest messages are dropped.
 class MessageHandler : public QObject, public Singleton<MessageHandler> {
   Q_OBJECT
   DISABLE_COPY(MessageHandler)
@@ -25,25 +30,36 @@ class MessageHandler : public QObject, public Singleton<MessageHandler> {
  public:
   static void handler(QtMsgType type, const QMessageLogContext& context, const QString& msg);
   static void init();
+  static QString toHtml(const MessageInfo& info);
 
-  ~MessageHandler() = default;
+  ~MessageHandler();
   DEFAULT_MOVE(MessageHandler)
 
+  // thread safe
   void handleMessage(QtMsgType type, const QString& msg);
 
  signals:
-  void message(QtMsgType type, const QString& msg);
+  // HTML of messages in a batch. Emitted in the formatter thread.
+  void messagesFormatted(const QString& html);
 
  protected:
   void connectNotify(const QMetaMethod& signal);
 
  private:
+  class Formatter;
+
   static QtMessageHandler s_defaultMsgHandler;
 
   friend class Singleton<MessageHandler>;
-  MessageHandler() = default;
+  MessageHandler();
+
+  RingBuffer<MessageInfo> m_messages;
+  std::unique_ptr<Formatter> m_formatter;
+
+  // Returns false if the message shouldn't be sent to the console
+  static bool checkRateLimit();
 
-  QList<MessageInfo> m_storedMessages;
+  void flush();
 };
 
 }  // namespace core
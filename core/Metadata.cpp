@@ -14,6 +14,7 @@ const QString decreaseIndentPatternStr = "decreaseIndentPattern";
 const QString bracketIndentNextLinePatternStr = "bracketIndentNextLinePattern";
 const QString disableIndentNextLinePatternStr = "disableIndentNextLinePattern";
 const QString unIndentedLinePatternStr = "unIndentedLinePattern";
+const QString showInSymbolListStr = "showInSymbolList";
 }
 
 namespace core {
@@ -43,6 +44,17 @@ void Metadata::setUnIndentedLinePattern(const QString& pattern) {
   m_unIndentedLinePattern = Regexp::compile(pattern);
 }
 
+QStringList Metadata::symbolListSelectors(bool show) {
+  QStringList selectors;
+  for (const auto& pair : s_scopeMetadataMap) {
+    const boost::optional<bool> showInSymbolList = pair.second->showInSymbolList();
+    if (showInSymbolList && *showInSymbolList == show) {
+      selectors.append(pair.first);
+    }
+  }
+  return selectors;
+}
+
 Metadata* Metadata::get(const QString& scope) {
   if (s_scopeMetadataMap.count(scope) != 0) {
     return s_scopeMetadataMap[scope].get();
@@ -102,6 +114,10 @@ void Metadata::load(const QString& filename) {
         if (settingMap.contains(unIndentedLinePatternStr)) {
           metadata->setUnIndentedLinePattern(settingMap.value(unIndentedLinePatternStr).toString());
         }
+        if (settingMap.contains(showInSymbolListStr)) {
+          // <integer>1</integer> in most bundles and <true/> in some
+          metadata->setShowInSymbolList(settingMap.value(showInSymbolListStr).toBool());
+        }
       }
     }
   }
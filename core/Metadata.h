@@ -1,6 +1,8 @@
+#include <boost/optional.hpp>
 #include <memory>
 #include <unordered_map>
 #include <QString>
+#include <QStringList>
 
 #include "macros.h"
 #include "stlSpecialization.h"
@@ -15,6 +17,8 @@ class Metadata {
  public:
   static Metadata* get(const QString& scope);
   static void load(const QString& filename);
+  // Returns the scope selectors whose showInSymbolList setting is show
+  static QStringList symbolListSelectors(bool show);
 
   ~Metadata() = default;
 
@@ -37,6 +41,10 @@ class Metadata {
   Regexp* unIndentedLinePattern() { return m_unIndentedLinePattern.get(); }
   void setUnIndentedLinePattern(const QString& pattern);
 
+  // Symbol List
+  boost::optional<bool> showInSymbolList() { return m_showInSymbolList; }
+  void setShowInSymbolList(bool show) { m_showInSymbolList = show; }
+
  private:
   static std::unordered_map<QString, std::unique_ptr<Metadata>> s_scopeMetadataMap;
 
@@ -52,6 +60,9 @@ class Metadata {
   std::unique_ptr<Regexp> m_disableIndentNextLinePattern;
   std::unique_ptr<Regexp> m_unIndentedLinePattern;
 
+  // Whether the text in the scope is listed as a symbol. Unset if the file doesn't say.
+  boost::optional<bool> m_showInSymbolList;
+
   explicit Metadata(const QString& scope);
   DEFAULT_MOVE(Metadata)
 };
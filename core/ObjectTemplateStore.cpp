@@ -1,4 +1,5 @@
 #include <QMetaProperty>
+#include <QMetaMethod>
 #include <QDebug>
 #include <sstream>
 
@@ -52,6 +53,51 @@ void ObjectTemplateStore::initInstanceTemplate(Local<ObjectTemplate> objTempl,
   }
 }
 
+Local<v8::FunctionTemplate> ObjectTemplateStore::createMethodTemplate(
+    const QMetaObject* metaObj,
+    const QByteArray& name,
+    Isolate* isolate,
+    Local<v8::Signature> signature) {
+  const BoundMethod* method = V8Util::bindMethod(metaObj, name);
+  Local<v8::FunctionTemplate> tpl = v8::FunctionTemplate::New(
+      isolate, V8Util::invokeBoundQObjectMethod,
+      v8::External::New(isolate, const_cast<BoundMethod*>(method)), signature);
+  tpl->SetClassName(String::NewFromUtf8(isolate, name.constData()));
+  return tpl;
+}
+
+// overloaded methods have the same name
+QList<QByteArray> ObjectTemplateStore::publicMethodNames(const QMetaObject* metaObj) {
+  QList<QByteArray> names;
+  Util::processWithPublicMethods(metaObj, [&](const QMetaMethod& method) {
+    if (!names.contains(method.name())) {
+      names.append(method.name());
+    }
+  });
+  return names;
+}
+
+void ObjectTemplateStore::setPrototypeMethods(Local<v8::FunctionTemplate> tpl,
+                                              const QMetaObject* metaObj,
+                                              Isolate* isolate) {
+  Local<v8::Signature> signature = v8::Signature::New(isolate, tpl);
+  for (const QByteArray& name : publicMethodNames(metaObj)) {
+    tpl->PrototypeTemplate()->Set(String::NewFromUtf8(isolate, name.constData()),
+                                  createMethodTemplate(metaObj, name, isolate, signature));
+  }
+}
+
+void ObjectTemplateStore::setMethods(Local<v8::Object> obj,
+                                     const QMetaObject* metaObj,
+                                     Isolate* isolate) {
+  for (const QByteArray& name : publicMethodNames(metaObj)) {
+    Local<v8::Function> fn = createMethodTemplate(metaObj, name, isolate)->GetFunction();
+    Local<String> fnName = String::NewFromUtf8(isolate, name.constData());
+    fn->SetName(fnName);
+    obj->Set(fnName, fn);
+  }
+}
+
 void ObjectTemplateStore::addObjectTemplate(Local<ObjectTemplate> objTempl,
                                             const QMetaObject* metaObj,
                                             v8::Isolate* isolate) {
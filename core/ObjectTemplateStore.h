@@ -20,6 +20,15 @@ class ObjectTemplateStore : public Singleton<ObjectTemplateStore> {
   static void initInstanceTemplate(v8::Local<v8::ObjectTemplate> objTempl,
                                    const QMetaObject* metaObj,
                                    v8::Isolate* isolate);
+  // Sets a function for each public method of metaObj to the prototype of tpl.
+  // Each function has the overloads of the method resolved in advance (see V8Util::bindMethod).
+  static void setPrototypeMethods(v8::Local<v8::FunctionTemplate> tpl,
+                                  const QMetaObject* metaObj,
+                                  v8::Isolate* isolate);
+  // Sets a function for each public method of metaObj to obj
+  static void setMethods(v8::Local<v8::Object> obj,
+                         const QMetaObject* metaObj,
+                         v8::Isolate* isolate);
 
   ~ObjectTemplateStore() = default;
   DEFAULT_MOVE(ObjectTemplateStore)
@@ -29,6 +38,12 @@ class ObjectTemplateStore : public Singleton<ObjectTemplateStore> {
 private:
   static QHash<const QMetaObject*, QHash<QString, int>> s_classPropertiesHash;
   static void cacheProperties(const QMetaObject* metaObj);
+  static v8::Local<v8::FunctionTemplate> createMethodTemplate(
+      const QMetaObject* metaObj,
+      const QByteArray& name,
+      v8::Isolate* isolate,
+      v8::Local<v8::Signature> signature = v8::Local<v8::Signature>());
+  static QList<QByteArray> publicMethodNames(const QMetaObject* metaObj);
   static void getterCallback(v8::Local<v8::String> property,
                              const v8::PropertyCallbackInfo<v8::Value>& info);
   static void setterCallback(v8::Local<v8::String> property,
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <algorithm>
+#include <utility>
+#include <QList>
+#include <QVector>
+
+#include "macros.h"
+
+namespace core {
+
+// Sorted elements with positions, such as the children of ScopeNode, the symbols of SymbolTable
+// and the brackets of BracketPairs.
+//
+// Elements at the step index or after have a pending delta on their positions (same as the step of
+// Scintilla's Partitioning). Shifting the elements after an edit adds to the pending delta, and
+// only the elements between the previous and the new step index are moved when the step moves, so
+// the elements following an edit are not visited one by one.
+//
+// Shift is a function object called as shift(element, delta) to move an element. Container is
+// QVector<T> or QList<T>.
+template <typename T, typename Shift, typename Container = QVector<T>>
+class PartitionedVector {
+ public:
+  PartitionedVector() : m_stepIndex(0), m_stepDelta(0) {}
+  explicit PartitionedVector(Container items)
+      : m_items(std::move(items)), m_stepIndex(0), m_stepDelta(0) {}
+  ~PartitionedVector() = default;
+  DEFAULT_COPY_AND_MOVE(PartitionedVector)
+
+  int size() const { return m_items.size(); }
+  bool isEmpty() const { return m_items.isEmpty(); }
+
+  // Returns the i-th element without its pending delta
+  const T& raw(int i) const { return m_items[i]; }
+  T& raw(int i) { return m_items[i]; }
+  // Returns the delta pending on the i-th element
+  int pendingDelta(int i) const { return i >= m_stepIndex ? m_stepDelta : 0; }
+
+  // Applies the pending delta to all elements
+  const Container& items() {
+    moveStep(size());
+    return m_items;
+  }
+
+  // Moves the elements at from or after by delta
+  void shift(int from, int delta) {
+    if (delta == 0 || from >= size()) {
+      return;
+    }
+    moveStep(from);
+    m_stepDelta += delta;
+  }
+
+  // Replaces the elements in [first, last) with items, which have actual positions. The following
+  // elements keep their pending delta, so the step is moved after the new ones.
+  void replace(int first, int last, const Container& items) {
+    moveStep(first);
+    m_items.erase(m_items.begin() + first, m_items.begin() + last);
+    insert(m_items, first, items);
+    m_stepIndex = first + items.size();
+  }
+
+  void clear() {
+    m_items.clear();
+    m_stepIndex = 0;
+    m_stepDelta = 0;
+  }
+
+  // Moves the step to index. The pending delta is applied to or removed from the elements in
+  // between.
+  void moveStep(int index) {
+    if (m_stepDelta != 0) {
+      Shift shift;
+      for (int i = m_stepIndex; i < index; i++) {
+        shift(m_items[i], m_stepDelta);
+      }
+      for (int i = index; i < m_stepIndex; i++) {
+        shift(m_items[i], -m_stepDelta);
+      }
+    }
+    m_stepIndex = index;
+    if (m_stepIndex == size()) {
+      m_stepDelta = 0;
+    }
+  }
+
+ private:
+  Container m_items;
+  int m_stepIndex;
+  int m_stepDelta;
+
+  static void insert(QVector<T>& items, int i, const QVector<T>& newItems) {
+    items.insert(i, newItems.size(), T());
+    std::copy(newItems.begin(), newItems.end(), items.begin() + i);
+  }
+
+  static void insert(QList<T>& items, int i, const QList<T>& newItems) {
+    for (int j = 0; j < newItems.size(); j++) {
+      items.insert(i + j, newItems[j]);
+    }
+  }
+};
+
+}  // namespace core
@@ -0,0 +1,563 @@
+#include <algorithm>
+#include <functional>
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QRegExp>
+#include <QRunnable>
+
+#ifdef Q_OS_LINUX
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <QFile>
+#include <QSocketNotifier>
+#else
+#include <QFileSystemWatcher>
+#endif
+
+#include "ProjectFileSystem.h"
+#include "ProjectSearch.h"
+#include "Tracer.h"
+
+namespace core {
+
+namespace {
+// Change notifications are coalesced for this period
+const int RESCAN_DELAY_MS = 100;
+
+#ifdef Q_OS_LINUX
+// Changes of the entries and writes to the files in a directory
+const uint32_t WATCH_MASK = IN_ATTRIB | IN_CREATE | IN_DELETE | IN_DELETE_SELF | IN_MOVE |
+                            IN_MOVE_SELF | IN_MODIFY | IN_CLOSE_WRITE | IN_ONLYDIR;
+#endif
+
+QString joinPath(const QString& dirPath, const QString& name) {
+  return dirPath.isEmpty() ? name : dirPath + QLatin1Char('/') + name;
+}
+
+// Version control metadata isn't shown in the tree. Other ignored names are listed but not indexed.
+bool isHidden(const QString& name) {
+  static const QSet<QString> names{".git", ".hg", ".svn", ".DS_Store"};
+  return names.contains(name);
+}
+
+bool hasWildcard(const QString& pattern) {
+  return pattern.contains(QLatin1Char('*')) || pattern.contains(QLatin1Char('?')) ||
+         pattern.contains(QLatin1Char('['));
+}
+
+// Directories first, then by name
+bool isLess(const ProjectFileSystem::Entry& x, const ProjectFileSystem::Entry& y) {
+  if (x.isDir != y.isDir) {
+    return x.isDir;
+  }
+  const int result = QString::compare(x.name, y.name, Qt::CaseInsensitive);
+  return result != 0 ? result < 0 : x.name < y.name;
+}
+}
+
+bool ProjectFileSystem::Changes::isEmpty() const {
+  return addedFiles.isEmpty() && removedFiles.isEmpty() && modifiedFiles.isEmpty() &&
+         changedDirs.isEmpty();
+}
+
+// Wildcard patterns split into exact names and suffixes, so they can be matched from any thread
+// without QRegExp, which isn't thread safe.
+class ProjectFileSystem::IgnorePatterns {
+ public:
+  explicit IgnorePatterns(const QStringList& patterns) {
+    for (const QString& pattern : patterns) {
+      if (!hasWildcard(pattern)) {
+        m_names.insert(pattern);
+      } else if (pattern.startsWith(QLatin1Char('*')) && !hasWildcard(pattern.mid(1))) {
+        m_suffixes.append(pattern.mid(1));
+      } else {
+        m_patterns.append(pattern);
+      }
+    }
+  }
+
+  bool matches(const QString& name) const {
+    if (m_names.contains(name)) {
+      return true;
+    }
+    for (const QString& suffix : m_suffixes) {
+      if (name.endsWith(suffix)) {
+        return true;
+      }
+    }
+    for (const QString& pattern : m_patterns) {
+      if (QRegExp(pattern, Qt::CaseSensitive, QRegExp::Wildcard).exactMatch(name)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+ private:
+  QSet<QString> m_names;
+  QStringList m_suffixes;
+  QStringList m_patterns;
+};
+
+class ProjectFileSystem::ListTask : public QRunnable {
+ public:
+  static Listing list(const ProjectFileSystem* fileSystem, const QString& dirPath, bool recursive) {
+    Listing listing{dirPath, false, recursive, QVector<Entry>()};
+    const QString absolutePath = fileSystem->absolutePath(dirPath);
+    if (!QFileInfo(absolutePath).isDir()) {
+      return listing;
+    }
+
+    listing.exists = true;
+    // Everything under an ignored directory is ignored too
+    bool isDirIgnored = false;
+    if (!dirPath.isEmpty()) {
+      for (const QString& name : dirPath.split(QLatin1Char('/'))) {
+        isDirIgnored = isDirIgnored || fileSystem->isIgnored(name);
+      }
+    }
+    QDirIterator it(absolutePath, QDir::Dirs | QDir::Files | QDir::NoDotAndDotDot | QDir::Hidden);
+    while (it.hasNext()) {
+      it.next();
+      const QFileInfo info = it.fileInfo();
+      const QString name = info.fileName();
+      // don't follow symlinks to avoid cycles
+      if (isHidden(name) || (info.isDir() && info.isSymLink())) {
+        continue;
+      }
+
+      // The mtime of a directory changes with its entries, which are compared separately
+      const bool isDir = info.isDir();
+      listing.entries.append(Entry{name, isDir, isDirIgnored || fileSystem->isIgnored(name),
+                                   isDir ? 0 : info.lastModified().toMSecsSinceEpoch(),
+                                   isDir ? 0 : info.size()});
+    }
+    std::sort(listing.entries.begin(), listing.entries.end(), isLess);
+    return listing;
+  }
+
+  ListTask(ProjectFileSystem* fileSystem, const QString& dirPath, bool recursive)
+      : m_fileSystem(fileSystem), m_dirPath(dirPath), m_recursive(recursive) {}
+
+  void run() override {
+    TRACE_SCOPE("ProjectFileSystem::ListTask");
+    ProjectFileSystem* fs = m_fileSystem;
+    {
+      QMutexLocker locker(&fs->m_mutex);
+      if (fs->m_canceled) {
+        fs->m_pendingTasks--;
+        return;
+      }
+    }
+    Listing listing = list(fs, m_dirPath, m_recursive);
+
+    QMutexLocker locker(&fs->m_mutex);
+    fs->m_pendingTasks--;
+    if (fs->m_canceled) {
+      return;
+    }
+
+    // Ignored directories such as node_modules are listed when they're fetched
+    if (m_recursive) {
+      for (const Entry& entry : listing.entries) {
+        if (entry.isDir && !entry.isIgnored) {
+          fs->m_pendingTasks++;
+          fs->m_pool.start(new ListTask(fs, joinPath(m_dirPath, entry.name), true));
+        }
+      }
+    }
+
+    // A parent is always posted before its subdirectories because they're posted after this
+    const bool wasEmpty = fs->m_listings.isEmpty();
+    fs->m_listings.append(std::move(listing));
+    if (wasEmpty) {
+      QMetaObject::invokeMethod(fs, "flushListings", Qt::QueuedConnection);
+    }
+  }
+
+ private:
+  ProjectFileSystem* m_fileSystem;
+  const QString m_dirPath;
+  const bool m_recursive;
+};
+
+// Reports changes of watched directories. QFileSystemWatcher doesn't watch writes to the files in a
+// directory on Linux, so inotify is used directly there and a file written in place reports its
+// directory, whose listing then has the new mtime and size.
+class ProjectFileSystem::DirWatcher {
+  DISABLE_COPY_AND_MOVE(DirWatcher)
+
+ public:
+  // onChanged is called with the absolute path of a changed directory
+  explicit DirWatcher(std::function<void(const QString&)> onChanged);
+  ~DirWatcher();
+
+  // Returns the paths which couldn't be watched
+  QStringList addPaths(const QStringList& paths);
+  void removePath(const QString& path);
+
+ private:
+  std::function<void(const QString&)> m_onChanged;
+#ifdef Q_OS_LINUX
+  int m_fd;
+  std::unique_ptr<QSocketNotifier> m_notifier;
+  // watch descriptor -> path, and the reverse
+  QHash<int, QString> m_paths;
+  QHash<QString, int> m_descriptors;
+
+  void readEvents();
+#else
+  QFileSystemWatcher m_watcher;
+#endif
+};
+
+#ifdef Q_OS_LINUX
+ProjectFileSystem::DirWatcher::DirWatcher(std::function<void(const QString&)> onChanged)
+    : m_onChanged(std::move(onChanged)), m_fd(inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) {
+  if (m_fd < 0) {
+    qWarning("inotify_init1 failed");
+    return;
+  }
+  m_notifier.reset(new QSocketNotifier(m_fd, QSocketNotifier::Read));
+  QObject::connect(m_notifier.get(), &QSocketNotifier::activated, [=] { readEvents(); });
+}
+
+ProjectFileSystem::DirWatcher::~DirWatcher() {
+  m_notifier.reset();
+  if (m_fd >= 0) {
+    close(m_fd);
+  }
+}
+
+QStringList ProjectFileSystem::DirWatcher::addPaths(const QStringList& paths) {
+  QStringList failedPaths;
+  for (const QString& path : paths) {
+    if (m_descriptors.contains(path)) {
+      continue;
+    }
+    const int wd =
+        m_fd < 0 ? -1 : inotify_add_watch(m_fd, QFile::encodeName(path).constData(), WATCH_MASK);
+    if (wd < 0) {
+      failedPaths.append(path);
+      continue;
+    }
+    m_paths.insert(wd, path);
+    m_descriptors.insert(path, wd);
+  }
+  return failedPaths;
+}
+
+void ProjectFileSystem::DirWatcher::removePath(const QString& path) {
+  auto it = m_descriptors.find(path);
+  if (it == m_descriptors.end()) {
+    return;
+  }
+  inotify_rm_watch(m_fd, it.value());
+  m_paths.remove(it.value());
+  m_descriptors.erase(it);
+}
+
+// Events of the same directory are reported once per read
+void ProjectFileSystem::DirWatcher::readEvents() {
+  alignas(inotify_event) char buffer[4096];
+  QSet<QString> changedPaths;
+  ssize_t length;
+  while ((length = read(m_fd, buffer, sizeof(buffer))) > 0) {
+    for (const char* p = buffer; p < buffer + length;) {
+      const inotify_event* event = reinterpret_cast<const inotify_event*>(p);
+      p += sizeof(inotify_event) + event->len;
+      if (event->mask & IN_Q_OVERFLOW) {
+        // Events have been dropped, so any directory may have changed
+        for (const QString& path : m_paths) {
+          changedPaths.insert(path);
+        }
+        continue;
+      }
+
+      auto it = m_paths.find(event->wd);
+      if (it == m_paths.end()) {
+        continue;
+      }
+      changedPaths.insert(it.value());
+      // The directory has been removed or unmounted
+      if (event->mask & IN_IGNORED) {
+        m_descriptors.remove(it.value());
+        m_paths.erase(it);
+      }
+    }
+  }
+
+  for (const QString& path : changedPaths) {
+    m_onChanged(path);
+  }
+}
+#else
+ProjectFileSystem::DirWatcher::DirWatcher(std::function<void(const QString&)> onChanged)
+    : m_onChanged(std::move(onChanged)) {
+  QObject::connect(&m_watcher, &QFileSystemWatcher::directoryChanged,
+                   [=](const QString& path) { m_onChanged(path); });
+}
+
+ProjectFileSystem::DirWatcher::~DirWatcher() = default;
+
+QStringList ProjectFileSystem::DirWatcher::addPaths(const QStringList& paths) {
+  return m_watcher.addPaths(paths);
+}
+
+void ProjectFileSystem::DirWatcher::removePath(const QString& path) {
+  m_watcher.removePath(path);
+}
+#endif
+
+ProjectFileSystem::ProjectFileSystem(const QString& rootPath, QObject* parent)
+    : QObject(parent),
+      m_rootPath(QDir::cleanPath(rootPath)),
+      m_ignorePatterns(
+          std::make_shared<const IgnorePatterns>(ProjectSearch::defaultIgnorePatterns())),
+      m_started(false),
+      m_ready(false),
+      m_watcher(new DirWatcher([=](const QString& path) {
+        QString dirPath;
+        if (toRelativePath(path, dirPath)) {
+          m_changedDirs.insert(dirPath);
+          // Not restarted by later notifications so that continuous changes are still shown
+          if (!m_rescanTimer.isActive()) {
+            m_rescanTimer.start();
+          }
+        }
+      })),
+      m_watchFailed(false),
+      m_canceled(false),
+      m_pendingTasks(0) {
+  m_rescanTimer.setSingleShot(true);
+  m_rescanTimer.setInterval(RESCAN_DELAY_MS);
+  connect(&m_rescanTimer, &QTimer::timeout, this, &ProjectFileSystem::rescanChangedDirs);
+}
+
+ProjectFileSystem::~ProjectFileSystem() {
+  {
+    QMutexLocker locker(&m_mutex);
+    m_canceled = true;
+  }
+  m_pool.waitForDone();
+}
+
+QString ProjectFileSystem::absolutePath(const QString& relativePath) const {
+  if (relativePath.isEmpty()) {
+    return m_rootPath;
+  }
+  // "/" and "C:/"
+  return m_rootPath.endsWith(QLatin1Char('/')) ? m_rootPath + relativePath
+                                               : m_rootPath + QLatin1Char('/') + relativePath;
+}
+
+bool ProjectFileSystem::toRelativePath(const QString& path, QString& relativePath) const {
+  const QString cleanPath = QDir::cleanPath(path);
+  if (cleanPath == m_rootPath) {
+    relativePath.clear();
+    return true;
+  }
+
+  const QString prefix =
+      m_rootPath.endsWith(QLatin1Char('/')) ? m_rootPath : m_rootPath + QLatin1Char('/');
+  if (!cleanPath.startsWith(prefix)) {
+    return false;
+  }
+  relativePath = cleanPath.mid(prefix.size());
+  return true;
+}
+
+bool ProjectFileSystem::isIgnored(const QString& name) const {
+  return m_ignorePatterns->matches(name);
+}
+
+QVector<ProjectFileSystem::Entry> ProjectFileSystem::entries(const QString& dirPath) const {
+  return m_dirs.value(dirPath);
+}
+
+QVector<ProjectFileSystem::Entry> ProjectFileSystem::files() const {
+  QVector<Entry> files;
+  for (auto it = m_dirs.constBegin(); it != m_dirs.constEnd(); ++it) {
+    for (const Entry& entry : it.value()) {
+      if (!entry.isDir && !entry.isIgnored) {
+        files.append(Entry{joinPath(it.key(), entry.name), false, false, entry.mtime, entry.size});
+      }
+    }
+  }
+  return files;
+}
+
+void ProjectFileSystem::start() {
+  if (m_started) {
+    return;
+  }
+
+  m_started = true;
+  list(QString(), true);
+}
+
+void ProjectFileSystem::refresh(const QString& dirPath) {
+  QString relativePath;
+  if (!toRelativePath(dirPath, relativePath) || !m_dirs.contains(relativePath)) {
+    return;
+  }
+
+  Changes changes;
+  QStringList newDirPaths;
+  apply(ListTask::list(this, relativePath, false), changes, newDirPaths);
+  watch(newDirPaths);
+  if (!changes.isEmpty()) {
+    emit changed(changes);
+  }
+}
+
+void ProjectFileSystem::fetch(const QString& dirPath) {
+  if (!m_dirs.contains(dirPath)) {
+    list(dirPath, false);
+  }
+}
+
+void ProjectFileSystem::list(const QString& dirPath, bool recursive) {
+  {
+    QMutexLocker locker(&m_mutex);
+    m_pendingTasks++;
+  }
+  m_pool.start(new ListTask(this, dirPath, recursive));
+}
+
+// Compares a listing with the previous one. Both are sorted, so they're merged in one pass.
+void ProjectFileSystem::apply(const Listing& listing, Changes& changes, QStringList& newDirPaths) {
+  const QString& dirPath = listing.dirPath;
+  if (!listing.exists) {
+    removeDir(dirPath, changes);
+    return;
+  }
+
+  const bool isNew = !m_dirs.contains(dirPath);
+  if (isNew && !dirPath.isEmpty()) {
+    // Drop a listing of a directory which has been removed from its parent since
+    const int slash = dirPath.lastIndexOf(QLatin1Char('/'));
+    const QString name = dirPath.mid(slash + 1);
+    const QVector<Entry> siblings = m_dirs.value(slash < 0 ? QString() : dirPath.left(slash));
+    if (std::none_of(siblings.begin(), siblings.end(),
+                     [&](const Entry& entry) { return entry.isDir && entry.name == name; })) {
+      return;
+    }
+  }
+
+  const QVector<Entry> oldEntries = m_dirs.value(dirPath);
+  const QVector<Entry>& newEntries = listing.entries;
+  bool isChanged = isNew;
+  int i = 0;
+  int j = 0;
+  while (i < oldEntries.size() || j < newEntries.size()) {
+    if (j == newEntries.size() || (i < oldEntries.size() && isLess(oldEntries[i], newEntries[j]))) {
+      const Entry& entry = oldEntries[i++];
+      const QString path = joinPath(dirPath, entry.name);
+      if (entry.isDir) {
+        removeDir(path, changes);
+      } else if (!entry.isIgnored) {
+        changes.removedFiles.append(path);
+      }
+      isChanged = true;
+    } else if (i == oldEntries.size() || isLess(newEntries[j], oldEntries[i])) {
+      const Entry& entry = newEntries[j++];
+      const QString path = joinPath(dirPath, entry.name);
+      if (!entry.isDir) {
+        if (!entry.isIgnored) {
+          changes.addedFiles.append(path);
+        }
+      } else if (!listing.recursive && !entry.isIgnored) {
+        // a new directory found by a rescan
+        list(path, true);
+      }
+      isChanged = true;
+    } else {
+      const Entry& oldEntry = oldEntries[i++];
+      const Entry& newEntry = newEntries[j++];
+      if (!newEntry.isIgnored &&
+          (oldEntry.mtime != newEntry.mtime || oldEntry.size != newEntry.size)) {
+        changes.modifiedFiles.append(joinPath(dirPath, newEntry.name));
+      }
+    }
+  }
+
+  m_dirs.insert(dirPath, newEntries);
+  if (isChanged) {
+    changes.changedDirs.append(dirPath);
+  }
+  if (isNew) {
+    newDirPaths.append(absolutePath(dirPath));
+  }
+}
+
+void ProjectFileSystem::removeDir(const QString& dirPath, Changes& changes) {
+  auto it = m_dirs.find(dirPath);
+  if (it == m_dirs.end()) {
+    return;
+  }
+
+  const QVector<Entry> entries = it.value();
+  m_dirs.erase(it);
+  for (const Entry& entry : entries) {
+    const QString path = joinPath(dirPath, entry.name);
+    if (entry.isDir) {
+      removeDir(path, changes);
+    } else if (!entry.isIgnored) {
+      changes.removedFiles.append(path);
+    }
+  }
+  changes.changedDirs.append(dirPath);
+  m_watcher->removePath(absolutePath(dirPath));
+}
+
+void ProjectFileSystem::watch(const QStringList& absoluteDirPaths) {
+  if (absoluteDirPaths.isEmpty()) {
+    return;
+  }
+
+  // This fails when the OS limit of watches is reached
+  const QStringList failedPaths = m_watcher->addPaths(absoluteDirPaths);
+  if (!failedPaths.isEmpty() && !m_watchFailed) {
+    m_watchFailed = true;
+    qWarning("failed to watch some directories under %s", qPrintable(m_rootPath));
+  }
+}
+
+void ProjectFileSystem::flushListings() {
+  TRACE_SCOPE("ProjectFileSystem::flushListings");
+  QVector<Listing> listings;
+  bool crawled;
+  {
+    QMutexLocker locker(&m_mutex);
+    listings.swap(m_listings);
+    crawled = m_pendingTasks == 0;
+  }
+
+  Changes changes;
+  QStringList newDirPaths;
+  for (const Listing& listing : listings) {
+    apply(listing, changes, newDirPaths);
+  }
+  watch(newDirPaths);
+
+  if (!changes.isEmpty()) {
+    emit changed(changes);
+  }
+  if (crawled && !m_ready) {
+    m_ready = true;
+    emit ready();
+  }
+}
+
+void ProjectFileSystem::rescanChangedDirs() {
+  for (const QString& dirPath : m_changedDirs) {
+    if (m_dirs.contains(dirPath)) {
+      list(dirPath, false);
+    }
+  }
+  m_changedDirs.clear();
+}
+
+}  // namespace core
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <memory>
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+#include <QThreadPool>
+#include <QTimer>
+#include <QVector>
+
+#include "macros.h"
+
+namespace core {
+
+// Files under a project directory, shared by the project tree, quick open, project search and
+// DocumentManager.
+//
+// A crawler lists directories in parallel on a thread pool and keeps the listings in memory.
+// Entries matching the ignore patterns are listed for the tree but left out of files() and Changes,
+// and ignored directories are only listed when they're fetched. Every listed directory is watched
+// (inotify on Linux, which reports files written in place too). Notifications are coalesced and the
+// changed directories are listed again in the background, so the GUI thread never walks the tree.
+// Differences from the previous listings are emitted in batches.
+//
+// Paths are relative to the root unless noted. The root is "". Symlinks to directories aren't
+// followed.
+class ProjectFileSystem : public QObject {
+  Q_OBJECT
+  DISABLE_COPY(ProjectFileSystem)
+
+ public:
+  struct Entry {
+    // a relative path in files()
+    QString name;
+    bool isDir;
+    // The name or a parent directory matches the ignore patterns
+    bool isIgnored;
+    // msecs since epoch
+    qint64 mtime;
+    qint64 size;
+  };
+
+  struct Changes {
+    QStringList addedFiles;
+    QStringList removedFiles;
+    QStringList modifiedFiles;
+    // directories whose entries have changed, including added and removed ones
+    QStringList changedDirs;
+
+    bool isEmpty() const;
+  };
+
+  explicit ProjectFileSystem(const QString& rootPath, QObject* parent = nullptr);
+  // Stops the crawler and waits for it
+  ~ProjectFileSystem();
+  DEFAULT_MOVE(ProjectFileSystem)
+
+  QString rootPath() const { return m_rootPath; }
+  QString absolutePath(const QString& relativePath) const;
+  // Returns false if path isn't under the root
+  bool toRelativePath(const QString& path, QString& relativePath) const;
+  // Returns true if a file or directory name matches the ignore patterns
+  bool isIgnored(const QString& name) const;
+  // true after the first crawl
+  bool isReady() const { return m_ready; }
+
+  // Returns the entries of a directory, directories first and then sorted by name.
+  // Empty if the directory hasn't been listed.
+  QVector<Entry> entries(const QString& dirPath) const;
+  // Returns all files listed so far except ignored ones
+  QVector<Entry> files() const;
+
+ public slots:
+  // Starts the first crawl
+  void start();
+  // Lists an absolute directory again now. Call this after changing the directory to see the
+  // change immediately.
+  void refresh(const QString& dirPath);
+  // Lists a directory which the crawler has skipped, such as an ignored one, in the background.
+  // changed() reports it.
+  void fetch(const QString& dirPath);
+
+ signals:
+  void changed(const core::ProjectFileSystem::Changes& changes);
+  void ready();
+
+ private:
+  class IgnorePatterns;
+  class ListTask;
+  class DirWatcher;
+
+  struct Listing {
+    QString dirPath;
+    bool exists;
+    // The subdirectories are listed by the crawler too
+    bool recursive;
+    QVector<Entry> entries;
+  };
+
+  const QString m_rootPath;
+  const std::shared_ptr<const IgnorePatterns> m_ignorePatterns;
+  QThreadPool m_pool;
+  bool m_started;
+  bool m_ready;
+  // directory -> entries
+  QHash<QString, QVector<Entry>> m_dirs;
+  std::unique_ptr<DirWatcher> m_watcher;
+  QSet<QString> m_changedDirs;
+  QTimer m_rescanTimer;
+  bool m_watchFailed;
+
+  QMutex m_mutex;
+  // guarded by m_mutex
+  bool m_canceled;
+  int m_pendingTasks;
+  QVector<Listing> m_listings;
+
+  void list(const QString& dirPath, bool recursive);
+  void apply(const Listing& listing, Changes& changes, QStringList& newDirPaths);
+  void removeDir(const QString& dirPath, Changes& changes);
+  void watch(const QStringList& absoluteDirPaths);
+
+ private slots:
+  void flushListings();
+  void rescanChangedDirs();
+};
+
+}  // namespace core
+
+Q_DECLARE_METATYPE(core::ProjectFileSystem::Changes)
@@ -0,0 +1,514 @@
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <QByteArrayMatcher>
+#include <QDebug>
+#include <QDirIterator>
+#include <QFile>
+#include <QMutex>
+#include <QRegExp>
+#include <QRunnable>
+#include <QStack>
+#include <QTextCodec>
+#include <QThread>
+
+#include "ProjectSearch.h"
+#include "Encoding.h"
+#include "ProjectFileSystem.h"
+#include "Regexp.h"
+#include "Tracer.h"
+#include "TrigramIndex.h"
+#include "Util.h"
+
+namespace core {
+
+namespace {
+const int DEFAULT_MAX_MATCH_COUNT = 20000;
+// Larger files are not searched
+const qint64 MAX_FILE_SIZE = 32 * 1024 * 1024;
+// A file with a null byte in this range is regarded as a binary file
+const int BINARY_CHECK_LENGTH = 8000;
+const int MAX_LINE_TEXT_LENGTH = 1000;
+// The crawler starts with small chunks so that the first results arrive early
+const int MIN_CHUNK_SIZE = 4;
+const int MAX_CHUNK_SIZE = 64;
+
+QTextCodec* utf8Codec() {
+  static QTextCodec* s_codec = QTextCodec::codecForName("UTF-8");
+  return s_codec;
+}
+
+bool isAscii(const QString& str) {
+  return std::all_of(str.begin(), str.end(), [](const QChar& ch) { return ch.unicode() < 0x80; });
+}
+
+// lowerNeedle must be in lower case
+bool containsIgnoringAsciiCase(const QByteArray& haystack, const QByteArray& lowerNeedle) {
+  const int length = lowerNeedle.size();
+  const char first = lowerNeedle.at(0);
+  const char* data = haystack.constData();
+  for (int i = 0; i + length <= haystack.size(); i++) {
+    if (Util::toAsciiLower(data[i]) == first &&
+        qstrnicmp(data + i, lowerNeedle.constData(), length) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+}
+
+struct ProjectSearch::State {
+  State(ProjectSearch* search,
+        int generation,
+        std::unique_ptr<Regexp> regexp,
+        const QByteArray& literal,
+        bool isLiteralCaseSensitive,
+        int maxMatchCount)
+      : search(search),
+        generation(generation),
+        regexp(std::move(regexp)),
+        literal(literal),
+        isLiteralCaseSensitive(isLiteralCaseSensitive),
+        literalMatcher(literal),
+        maxMatchCount(maxMatchCount),
+        canceled(false),
+        limitReached(false),
+        pendingTasks(1),
+        fileCount(0),
+        matchCount(0),
+        reportedMatchCount(0) {}
+
+  ProjectSearch* const search;
+  // Calls queued by the workers of a stopped search are ignored by this
+  const int generation;
+  const std::unique_ptr<Regexp> regexp;
+  // ASCII bytes of a literal query. A file is decoded and searched only if its bytes contain them.
+  // Empty for regex and non-ASCII queries.
+  const QByteArray literal;
+  const bool isLiteralCaseSensitive;
+  const QByteArrayMatcher literalMatcher;
+  const int maxMatchCount;
+
+  std::atomic<bool> canceled;
+  std::atomic<bool> limitReached;
+  // the crawler and the search tasks
+  std::atomic<int> pendingTasks;
+  std::atomic<int> fileCount;
+  std::atomic<int> matchCount;
+  // accessed only by the thread of search
+  int reportedMatchCount;
+
+  QMutex mutex;
+  QVector<FileResult> results;
+
+  bool isCanceled() const { return canceled.load(std::memory_order_relaxed); }
+
+  // Returns false if bytes don't contain the literal
+  bool mayMatch(const QByteArray& bytes) const {
+    if (literal.isEmpty()) {
+      return true;
+    }
+    return isLiteralCaseSensitive ? literalMatcher.indexIn(bytes) >= 0
+                                  : containsIgnoringAsciiCase(bytes, literal);
+  }
+
+  void addResult(FileResult&& result) {
+    const int count = result.matches.size();
+    const int prevCount = matchCount.fetch_add(count, std::memory_order_relaxed);
+    if (prevCount >= maxMatchCount) {
+      return;
+    }
+    if (prevCount + count >= maxMatchCount) {
+      result.matches.resize(maxMatchCount - prevCount);
+      limitReached.store(true, std::memory_order_relaxed);
+      canceled.store(true, std::memory_order_relaxed);
+    }
+
+    QMutexLocker locker(&mutex);
+    results.append(std::move(result));
+    if (results.size() == 1) {
+      QMetaObject::invokeMethod(search, "flushResults", Qt::QueuedConnection,
+                                Q_ARG(int, generation));
+    }
+  }
+
+  void taskFinished() {
+    if (pendingTasks.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      QMetaObject::invokeMethod(search, "finish", Qt::QueuedConnection, Q_ARG(int, generation));
+    }
+  }
+};
+
+class ProjectSearch::SearchTask : public QRunnable {
+ public:
+  SearchTask(std::shared_ptr<State> state, const QStringList& paths)
+      : m_state(std::move(state)), m_paths(paths) {}
+
+  void run() override {
+    TRACE_SCOPE("ProjectSearch::SearchTask");
+    for (const QString& path : m_paths) {
+      if (m_state->isCanceled()) {
+        break;
+      }
+      searchFile(path);
+    }
+    m_state->taskFinished();
+  }
+
+ private:
+  std::shared_ptr<State> m_state;
+  QStringList m_paths;
+
+  void searchFile(const QString& path) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+      return;
+    }
+    const qint64 size = file.size();
+    if (size == 0 || size > MAX_FILE_SIZE) {
+      return;
+    }
+
+    // Map the file instead of reading it. Files that can't be mapped are read.
+    QByteArray bytes;
+    if (uchar* data = file.map(0, size)) {
+      bytes = QByteArray::fromRawData(reinterpret_cast<const char*>(data), size);
+    } else {
+      bytes = file.readAll();
+    }
+
+    m_state->fileCount.fetch_add(1, std::memory_order_relaxed);
+    // The literal check is skipped for UTF-16 and UTF-32 files
+    const bool hasBOM = QTextCodec::codecForUtfText(bytes, nullptr) != nullptr;
+    if (!hasBOM && !m_state->mayMatch(bytes)) {
+      return;
+    }
+
+    QString text;
+    if (!decode(bytes, text)) {
+      return;
+    }
+
+    const int remaining =
+        m_state->maxMatchCount - m_state->matchCount.load(std::memory_order_relaxed);
+    if (remaining <= 0) {
+      return;
+    }
+    FileResult result{path, search(m_state->regexp.get(), text, remaining)};
+    if (!result.matches.isEmpty()) {
+      m_state->addResult(std::move(result));
+    }
+  }
+};
+
+class ProjectSearch::CrawlTask : public QRunnable {
+ public:
+  CrawlTask(std::shared_ptr<State> state,
+            QThreadPool* pool,
+            const QString& dirPath,
+            const QStringList& ignorePatterns,
+            boost::optional<QStringList> candidates,
+            std::shared_ptr<const TrigramIndex::Snapshot> snapshot,
+            const QString& text,
+            Document::FindFlags flags)
+      : m_state(std::move(state)),
+        m_pool(pool),
+        m_dirPath(dirPath),
+        m_candidates(std::move(candidates)),
+        m_snapshot(std::move(snapshot)),
+        m_text(text),
+        m_flags(flags) {
+    for (const QString& pattern : ignorePatterns) {
+      m_ignorePatterns.append(QRegExp(pattern, Qt::CaseSensitive, QRegExp::Wildcard));
+    }
+  }
+
+  void run() override {
+    TRACE_SCOPE("ProjectSearch::CrawlTask");
+    int chunkSize = MIN_CHUNK_SIZE;
+    QStringList chunk;
+    // Looking the query up in the index decodes and intersects posting lists, so it's done here
+    // instead of the GUI thread
+    if (m_snapshot) {
+      m_candidates = m_snapshot->candidates(m_text, m_flags, m_dirPath);
+    }
+    // The index or the file system has already listed the files
+    if (m_candidates) {
+      for (const QString& path : *m_candidates) {
+        if (m_state->isCanceled()) {
+          break;
+        }
+        chunk.append(path);
+        if (chunk.size() >= chunkSize) {
+          submit(chunk);
+          chunkSize = std::min(chunkSize * 2, MAX_CHUNK_SIZE);
+        }
+      }
+      finish(chunk);
+      return;
+    }
+
+    QStack<QString> dirs;
+    dirs.push(m_dirPath);
+    while (!dirs.isEmpty() && !m_state->isCanceled()) {
+      QDirIterator it(dirs.pop(), QDir::Dirs | QDir::Files | QDir::NoDotAndDotDot | QDir::Hidden);
+      while (it.hasNext() && !m_state->isCanceled()) {
+        it.next();
+        const QFileInfo info = it.fileInfo();
+        if (isIgnored(info.fileName())) {
+          continue;
+        }
+
+        if (info.isDir()) {
+          // don't follow symlinks to avoid cycles
+          if (!info.isSymLink()) {
+            dirs.push(info.filePath());
+          }
+        } else {
+          chunk.append(info.filePath());
+          if (chunk.size() >= chunkSize) {
+            submit(chunk);
+            chunkSize = std::min(chunkSize * 2, MAX_CHUNK_SIZE);
+          }
+        }
+      }
+    }
+    finish(chunk);
+  }
+
+ private:
+  std::shared_ptr<State> m_state;
+  QThreadPool* m_pool;
+  QString m_dirPath;
+  QVector<QRegExp> m_ignorePatterns;
+  boost::optional<QStringList> m_candidates;
+  std::shared_ptr<const TrigramIndex::Snapshot> m_snapshot;
+  const QString m_text;
+  const Document::FindFlags m_flags;
+
+  bool isIgnored(const QString& name) {
+    return std::any_of(m_ignorePatterns.begin(), m_ignorePatterns.end(),
+                       [&](const QRegExp& pattern) { return pattern.exactMatch(name); });
+  }
+
+  void submit(QStringList& paths) {
+    m_state->pendingTasks.fetch_add(1, std::memory_order_relaxed);
+    m_pool->start(new SearchTask(m_state, paths));
+    paths.clear();
+  }
+
+  void finish(QStringList& chunk) {
+    if (!chunk.isEmpty()) {
+      submit(chunk);
+    }
+    m_state->taskFinished();
+  }
+};
+
+QStringList ProjectSearch::defaultIgnorePatterns() {
+  return QStringList{
+      ".git",   ".hg",   ".svn",   ".DS_Store", "node_modules", "*.o",   "*.obj", "*.a",
+      "*.lib",  "*.so",  "*.dll",  "*.dylib",   "*.exe",        "*.pyc", "*.class", "*.jar",
+      "*.zip",  "*.gz",  "*.png",  "*.jpg",     "*.gif",        "*.ico", "*.pdf",
+  };
+}
+
+QVector<ProjectSearch::Match> ProjectSearch::search(const Regexp* regexp,
+                                                    const QString& text,
+                                                    int maxCount) {
+  QVector<Match> matches;
+  if (!regexp || text.isEmpty()) {
+    return matches;
+  }
+
+  int line = 0;
+  int lineStart = 0;
+  int lineEnd = text.indexOf(QLatin1Char('\n'));
+  if (lineEnd < 0) {
+    lineEnd = text.size();
+  }
+
+  // Search one match at a time to stop at maxCount
+  for (int pos = 0; pos <= text.size() && matches.size() < maxCount;) {
+    const QVector<int> indices = regexp->findStringSubmatchIndex(text, pos, text.size());
+    if (indices.size() < 2) {
+      break;
+    }
+    const int begin = indices[0];
+    const int end = indices[1];
+    if (begin == end) {
+      pos = end + 1;
+      continue;
+    }
+    pos = end;
+
+    // Matches are in order, so lines are scanned only once
+    while (lineEnd < begin) {
+      line++;
+      lineStart = lineEnd + 1;
+      lineEnd = text.indexOf(QLatin1Char('\n'), lineStart);
+      if (lineEnd < 0) {
+        lineEnd = text.size();
+      }
+    }
+
+    QString lineText = text.mid(lineStart, std::min(lineEnd - lineStart, MAX_LINE_TEXT_LENGTH));
+    if (lineText.endsWith(QLatin1Char('\r'))) {
+      lineText.chop(1);
+    }
+    matches.append(Match{line, begin - lineStart, end - begin, lineText});
+  }
+
+  return matches;
+}
+
+bool ProjectSearch::decode(const QByteArray& bytes, QString& text) {
+  // UTF-8, UTF-16 and UTF-32 with BOM
+  if (QTextCodec* codec = QTextCodec::codecForUtfText(bytes, nullptr)) {
+    text = codec->toUnicode(bytes);
+    return true;
+  }
+
+  if (std::memchr(bytes.constData(), 0, std::min(bytes.size(), BINARY_CHECK_LENGTH))) {
+    return false;
+  }
+
+  // Most source files are UTF-8. Guessing an encoding is much slower than decoding.
+  QTextCodec::ConverterState state;
+  text = utf8Codec()->toUnicode(bytes.constData(), bytes.size(), &state);
+  if (state.invalidChars == 0) {
+    return true;
+  }
+
+  QTextCodec* codec = Encoding::guessEncoding(bytes).codec();
+  text = (codec ? codec : utf8Codec())->toUnicode(bytes);
+  return true;
+}
+
+ProjectSearch::ProjectSearch(QObject* parent)
+    : QObject(parent), m_ignorePatterns(defaultIgnorePatterns()),
+      m_maxMatchCount(DEFAULT_MAX_MATCH_COUNT), m_generation(0) {
+  // +1 for the crawler, which mostly waits for the file system
+  m_pool.setMaxThreadCount(QThread::idealThreadCount() + 1);
+}
+
+ProjectSearch::~ProjectSearch() {
+  stop();
+}
+
+bool ProjectSearch::start(const QString& dirPath, const QString& text, Document::FindFlags flags) {
+  cancel();
+
+  if (!QFileInfo(dirPath).isDir()) {
+    qWarning("%s is not a directory", qPrintable(dirPath));
+    return false;
+  }
+
+  std::unique_ptr<Regexp> regexp = Document::createRegexp(text, flags);
+  if (!regexp) {
+    return false;
+  }
+
+  QByteArray literal;
+  const bool isCaseSensitive = flags & Document::FindFlag::FindCaseSensitively;
+  if (!(flags & Document::FindFlag::FindRegex) && isAscii(text)) {
+    literal = isCaseSensitive ? text.toLatin1() : text.toLatin1().toLower();
+  }
+
+  boost::optional<QStringList> candidates;
+  std::shared_ptr<const TrigramIndex::Snapshot> snapshot;
+  if (m_ignorePatterns == defaultIgnorePatterns()) {
+    if (m_index) {
+      snapshot = m_index->snapshot();
+      if (snapshot && !snapshot->canNarrow(text, flags, dirPath)) {
+        snapshot.reset();
+      }
+    }
+    // The files crawled already are searched without walking the tree again
+    if (!snapshot && m_fileSystem && m_fileSystem->isReady()) {
+      candidates = filesUnder(dirPath);
+    }
+  }
+
+  m_state = std::make_shared<State>(this, ++m_generation, std::move(regexp), literal,
+                                    isCaseSensitive, m_maxMatchCount);
+  m_pool.start(new CrawlTask(m_state, &m_pool, dirPath, m_ignorePatterns, std::move(candidates),
+                             std::move(snapshot), text, flags));
+  return true;
+}
+
+boost::optional<QStringList> ProjectSearch::filesUnder(const QString& dirPath) const {
+  QString relativeDirPath;
+  if (!m_fileSystem->toRelativePath(dirPath, relativeDirPath)) {
+    return boost::none;
+  }
+
+  const QString prefix = relativeDirPath.isEmpty() ? QString() : relativeDirPath + QLatin1Char('/');
+  QStringList paths;
+  for (const ProjectFileSystem::Entry& entry : m_fileSystem->files()) {
+    if (entry.name.startsWith(prefix)) {
+      paths.append(m_fileSystem->absolutePath(entry.name));
+    }
+  }
+  return paths;
+}
+
+void ProjectSearch::cancel() {
+  if (!m_state) {
+    return;
+  }
+
+  const int fileCount = m_state->fileCount.load(std::memory_order_relaxed);
+  const int matchCount = m_state->reportedMatchCount;
+  stop();
+  emit finished(fileCount, matchCount, true, false);
+}
+
+void ProjectSearch::stop() {
+  if (!m_state) {
+    return;
+  }
+
+  m_state->canceled.store(true, std::memory_order_relaxed);
+  m_pool.waitForDone();
+  // flushResults and finish queued by the workers are ignored by their generation
+  m_state.reset();
+}
+
+void ProjectSearch::flushResults(int generation) {
+  if (!m_state || m_state->generation != generation) {
+    return;
+  }
+
+  QVector<FileResult> results;
+  {
+    QMutexLocker locker(&m_state->mutex);
+    results.swap(m_state->results);
+  }
+
+  if (!results.isEmpty()) {
+    for (const FileResult& result : results) {
+      m_state->reportedMatchCount += result.matches.size();
+    }
+    emit found(results);
+  }
+}
+
+void ProjectSearch::finish(int generation) {
+  if (!m_state || m_state->generation != generation) {
+    return;
+  }
+
+  std::shared_ptr<State> state = m_state;
+  flushResults(generation);
+  // a slot connected to found may have started another search
+  if (m_state != state) {
+    return;
+  }
+
+  m_state.reset();
+  emit finished(state->fileCount.load(std::memory_order_relaxed), state->reportedMatchCount, false,
+                state->limitReached.load(std::memory_order_relaxed));
+}
+
+}  // namespace core
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <limits>
+#include <memory>
+#include <boost/optional.hpp>
+#include <QObject>
+#include <QPointer>
+#include <QStringList>
+#include <QThreadPool>
+#include <QVector>
+
+#include "macros.h"
+#include "Document.h"
+
+namespace core {
+
+class ProjectFileSystem;
+class Regexp;
+class TrigramIndex;
+
+// Searches files under a directory (find in files).
+//
+// A crawler walks the tree, skipping ignored names, and hands files in chunks to a thread pool.
+// Each worker maps a file, decodes it and runs Regexp on the whole text. Results are collected
+// from the workers and emitted on the thread of this object, so found() arrives while the crawl
+// is still going on.
+//
+// If a ready TrigramIndex of the directory is set, only the files which may contain matches are
+// searched instead of crawling the tree. Otherwise the files of a ready ProjectFileSystem are used.
+class ProjectSearch : public QObject {
+  Q_OBJECT
+  DISABLE_COPY(ProjectSearch)
+
+ public:
+  struct Match {
+    // 0-based
+    int line;
+    // 0-based, in UTF-16 code units
+    int column;
+    int length;
+    // the line without its line separator. Truncated if it's very long.
+    QString lineText;
+  };
+
+  struct FileResult {
+    QString path;
+    QVector<Match> matches;
+  };
+
+  // .git, node_modules, etc.
+  static QStringList defaultIgnorePatterns();
+
+  // Searches text. Returns matches in the order of their positions. Stops after maxCount matches.
+  static QVector<Match> search(const Regexp* regexp,
+                               const QString& text,
+                               int maxCount = std::numeric_limits<int>::max());
+
+  // Decodes a file. Returns false if it's a binary file.
+  static bool decode(const QByteArray& bytes, QString& text);
+
+  explicit ProjectSearch(QObject* parent = nullptr);
+  // Cancels the search and waits for the workers
+  ~ProjectSearch();
+  DEFAULT_MOVE(ProjectSearch)
+
+  // Wildcard patterns matched against file and directory names
+  void setIgnorePatterns(const QStringList& patterns) { m_ignorePatterns = patterns; }
+  QStringList ignorePatterns() const { return m_ignorePatterns; }
+
+  // The search stops after finding this many matches
+  void setMaxMatchCount(int count) { m_maxMatchCount = count; }
+
+  // The index is used only with the default ignore patterns
+  void setIndex(TrigramIndex* index) { m_index = index; }
+  // The file system is used only with the default ignore patterns
+  void setFileSystem(ProjectFileSystem* fileSystem) { m_fileSystem = fileSystem; }
+
+  // Starts a search. A running search is canceled.
+  // Returns false if text is an invalid regex or dirPath doesn't exist.
+  bool start(const QString& dirPath, const QString& text, Document::FindFlags flags = 0);
+  void cancel();
+  bool isRunning() const { return m_state != nullptr; }
+
+ signals:
+  void found(const QVector<core::ProjectSearch::FileResult>& results);
+  // limitReached is true if the search stopped at the max match count
+  void finished(int fileCount, int matchCount, bool canceled, bool limitReached);
+
+ private:
+  struct State;
+  class CrawlTask;
+  class SearchTask;
+
+  QThreadPool m_pool;
+  QStringList m_ignorePatterns;
+  int m_maxMatchCount;
+  // incremented for each search
+  int m_generation;
+  QPointer<TrigramIndex> m_index;
+  QPointer<ProjectFileSystem> m_fileSystem;
+  std::shared_ptr<State> m_state;
+
+  // Cancels the search without emitting finished
+  void stop();
+  // Absolute paths of the files under dirPath in the file system. none if it's outside.
+  boost::optional<QStringList> filesUnder(const QString& dirPath) const;
+
+ private slots:
+  void flushResults(int generation);
+  void finish(int generation);
+};
+
+}  // namespace core
+
+Q_DECLARE_METATYPE(core::ProjectSearch::FileResult)
@@ -131,14 +131,34 @@ QVariant core::QObjectUtil::invokeQObjectMethodInternal(QObject* object,
     throw std::runtime_error("object is null");
   }
 
-  int methodIndex = -1;
-  const QMetaObject* metaObj = object->metaObject();
+  return invokeQObjectMethodInternal(object, methods(object->metaObject(), methodName), args);
+}
+
+QList<MethodInfo> QObjectUtil::methods(const QMetaObject* metaObj, const QString& methodName) {
   if (!s_classMethodCache.contains(metaObj)) {
     cacheMethods(metaObj);
   }
+  return s_classMethodCache[metaObj]->values(methodName);
+}
+
+QVariant QObjectUtil::invokeQObjectMethodInternal(QObject* object,
+                                                  const QList<MethodInfo>& methods,
+                                                  QVariantList args) {
+  if (args.size() > Q_METAMETHOD_INVOKE_MAX_ARGS) {
+    std::stringstream ss;
+    ss << "Can't invoke a method with more than" << Q_METAMETHOD_INVOKE_MAX_ARGS
+       << "arguments. args:" << args.size();
+    throw std::runtime_error(ss.str());
+  }
+
+  if (!object) {
+    throw std::runtime_error("object is null");
+  }
+
+  int methodIndex = -1;
 
   // Find an appropriate method with the provided arguments
-  for (MethodInfo methodInfo : s_classMethodCache[metaObj]->values(methodName)) {
+  for (const MethodInfo& methodInfo : methods) {
     ParameterTypes parameterTypes = methodInfo.second;
     if (Util::matchTypes(parameterTypes, args)) {
       // overwrite QVariant type with parameter type to match the method signature.
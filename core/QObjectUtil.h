@@ -21,6 +21,12 @@ class QObjectUtil {
   static QVariant invokeQObjectMethodInternal(QObject* object,
                                               const QString& methodName,
                                               QVariantList args);
+  // Invokes the first method in methods which matches args
+  static QVariant invokeQObjectMethodInternal(QObject* object,
+                                              const QList<MethodInfo>& methods,
+                                              QVariantList args);
+  // Returns the methods named methodName in the order in which they are tried
+  static QList<MethodInfo> methods(const QMetaObject* metaObj, const QString& methodName);
   static QObject* newInstanceFromJS(const QMetaObject& metaObj, QVariantList args);
   static void* newInstanceOfGadgetFromJS(const QMetaObject& metaObj, QVariantList args);
 
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <QtGlobal>
+
+#include "macros.h"
+
+namespace core {
+
+// Bounded lock-free multi-producer multi-consumer queue.
+// When the buffer is full, push drops the oldest element and counts it.
+// Based on Dmitry Vyukov's bounded MPMC queue.
+template <typename T>
+class RingBuffer {
+  DISABLE_COPY_AND_MOVE(RingBuffer)
+
+ public:
+  // capacity must be a power of 2
+  explicit RingBuffer(size_t capacity)
+      : m_cells(new Cell[capacity]),
+        m_mask(capacity - 1),
+        m_enqueuePos(0),
+        m_dequeuePos(0),
+        m_dropped(0) {
+    Q_ASSERT(capacity >= 2 && (capacity & (capacity - 1)) == 0);
+    for (size_t i = 0; i < capacity; i++) {
+      m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  ~RingBuffer() = default;
+
+  // Returns false if the buffer is full. data is moved only when this succeeds.
+  bool tryPush(T& data) {
+    Cell* cell;
+    size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+    for (;;) {
+      cell = &m_cells[pos & m_mask];
+      const size_t seq = cell->sequence.load(std::memory_order_acquire);
+      const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+      if (diff == 0) {
+        if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = m_enqueuePos.load(std::memory_order_relaxed);
+      }
+    }
+
+    cell->data = std::move(data);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Pushes data and drops the oldest elements if the buffer is full
+  void push(T data) {
+    while (!tryPush(data)) {
+      T oldest;
+      if (tryPop(oldest)) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Returns false if the buffer is empty
+  bool tryPop(T& data) {
+    Cell* cell;
+    size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+    for (;;) {
+      cell = &m_cells[pos & m_mask];
+      const size_t seq = cell->sequence.load(std::memory_order_acquire);
+      const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+      if (diff == 0) {
+        if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = m_dequeuePos.load(std::memory_order_relaxed);
+      }
+    }
+
+    data = std::move(cell->data);
+    // Move assignment of Qt types swaps values, so clear the cell not to keep the old value alive
+    cell->data = T();
+    cell->sequence.store(pos + m_mask + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Returns # of dropped elements since the last call
+  int takeDroppedCount() { return m_dropped.exchange(0, std::memory_order_relaxed); }
+
+  size_t capacity() const { return m_mask + 1; }
+
+ private:
+  struct Cell {
+    std::atomic<size_t> sequence;
+    T data;
+  };
+
+  std::unique_ptr<Cell[]> m_cells;
+  const size_t m_mask;
+  // separate cache lines to avoid false sharing between producers and consumers
+  alignas(64) std::atomic<size_t> m_enqueuePos;
+  alignas(64) std::atomic<size_t> m_dequeuePos;
+  std::atomic<int> m_dropped;
+};
+
+}  // namespace core
@@ -0,0 +1,104 @@
+#include "ScopeCursor.h"
+#include "ScopeTree.h"
+
+namespace core {
+
+ScopeStackTable::ScopeStackTable() {
+  m_names.append(QString());
+}
+
+int ScopeStackTable::push(int parentId, const QString& name) {
+  Q_ASSERT(0 <= parentId && parentId < m_names.size());
+  if (name.isEmpty()) {
+    return parentId;
+  }
+
+  const auto key = qMakePair(parentId, name);
+  auto it = m_ids.constFind(key);
+  if (it != m_ids.constEnd()) {
+    return it.value();
+  }
+
+  int id = m_names.size();
+  const QString& parentName = m_names.at(parentId);
+  m_names.append(parentName.isEmpty() ? name : QString(parentName + QLatin1Char(' ') + name));
+  m_ids.insert(key, id);
+  return id;
+}
+
+ScopeCursor::ScopeCursor(ScopeStackTable* table) : m_table(table), m_tree(nullptr), m_pos(-1) {
+  Q_ASSERT(m_table);
+}
+
+void ScopeCursor::reset(const ScopeTree* tree) {
+  m_tree = tree;
+  m_stack.clear();
+  m_pos = -1;
+}
+
+int ScopeCursor::seek(int pos) {
+  if (!m_tree) {
+    return -1;
+  }
+
+  // Moving backward. Restart from the root.
+  if (pos < m_pos) {
+    m_stack.clear();
+  }
+  m_pos = pos;
+
+  // Pop nodes which don't cover pos anymore
+  while (!m_stack.isEmpty() && m_stack.last().end < pos + 1) {
+    m_stack.removeLast();
+  }
+
+  if (m_stack.isEmpty()) {
+    const Region& region = m_tree->region();
+    if (region.begin() > pos || region.end() < pos + 1) {
+      return -1;
+    }
+    push(&m_tree->root(), region);
+  }
+
+  // Descend into the children which cover pos
+  while (true) {
+    top.childIndex = top.node->findChild(top.childIndex, pos - top.begin);
+    if (top.childIndex >= top.node->childCount()) {
+      break;
+    }
+
+    const Region& childRegion = top.node->childRegion(top.childIndex);
+    if (top.begin + childRegion.begin() > pos) {
+      break;
+    }
+    push(&top.node->child(top.childIndex),
+         Region(top.begin + childRegion.begin(), top.begin + childRegion.end()));
+  }
+
+  return m_stack.last().scopeId;
+}
+
+Region ScopeCursor::region() const {
+  return m_stack.isEmpty() ? Region() : Region(m_stack.last().begin, m_stack.last().end);
+}
+
+int ScopeCursor::runEnd() const {
+  if (m_stack.isEmpty()) {
+    return m_pos + 1;
+  }
+
+  const Frame& top = m_stack.last();
+  int end = top.end;
+  if (top.childIndex < top.node->childCount()) {
+    end = qMin(end, top.begin + top.node->childRegion(top.childIndex).begin());
+  }
+  return qMax(end, m_pos + 1);
+}
+
+void ScopeCursor::push(const ScopeNode* node, const Region& region) {
+  int parentId = m_stack.isEmpty() ? ScopeStackTable::EMPTY_ID : m_stack.last().scopeId;
+  m_stack.append(
+      Frame{node, region.begin(), region.end(), 0, m_table->push(parentId, node->name())});
+}
+
+}  // namespace core
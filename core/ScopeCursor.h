@@ -0,0 +1,90 @@
+#pragma once
+
+#include <QHash>
+#include <QPair>
+#include <QString>
+#include <QVector>
+
+#include "macros.h"
+#include "Region.h"
+
+namespace core {
+
+class ScopeNode;
+class ScopeTree;
+
+// Interns scope stacks (a list of nested scope names) into int ids.
+// The id 0 is the empty scope stack.
+class ScopeStackTable {
+  DISABLE_COPY(ScopeStackTable)
+
+ public:
+  static const int EMPTY_ID = 0;
+
+  ScopeStackTable();
+  ~ScopeStackTable() = default;
+  DEFAULT_MOVE(ScopeStackTable)
+
+  // Returns the id of the scope stack made by pushing name onto the stack of parentId.
+  // An empty name doesn't make a new scope stack.
+  int push(int parentId, const QString& name);
+
+  // Returns the full concatenated nested scope name of the scope stack. e.g. "source.c++ string"
+  const QString& name(int id) const { return m_names[id]; }
+  int size() const { return m_names.size(); }
+
+ private:
+  QHash<QPair<int, QString>, int> m_ids;
+  QVector<QString> m_names;
+};
+
+// Walks a ScopeTree forward to find the innermost node covering a position.
+//
+// Seeking to a position at or after the previous one costs amortized O(1) because the cursor keeps
+// the path from the root to the innermost node and only moves forward among children. Seeking
+// backward restarts from the root with a binary search at each level. ScopeNode keeps children
+// sorted without overlaps, so every level is searched this way.
+// The cursor keeps pointers into the tree, so it must be reset whenever the tree is modified.
+class ScopeCursor {
+  DISABLE_COPY(ScopeCursor)
+
+ public:
+  explicit ScopeCursor(ScopeStackTable* table);
+  ~ScopeCursor() = default;
+  DEFAULT_MOVE(ScopeCursor)
+
+  void reset(const ScopeTree* tree);
+
+  // Moves the cursor to the innermost node which fully covers [pos, pos + 1) and returns its scope
+  // stack id. Returns -1 if no node covers pos.
+  int seek(int pos);
+
+  // The innermost node found by the last seek and its absolute region
+  const ScopeNode* node() const { return m_stack.isEmpty() ? nullptr : m_stack.last().node; }
+  Region region() const;
+  int scopeId() const { return m_stack.isEmpty() ? -1 : m_stack.last().scopeId; }
+
+  // Returns the end of the run starting at the last seek position where the innermost node stays
+  // same. i.e. the end of the innermost node or the beginning of its next child.
+  int runEnd() const;
+
+ private:
+  struct Frame {
+    const ScopeNode* node;
+    // absolute region of node
+    int begin;
+    int end;
+    // index of the first child which may cover the current or a later position
+    int childIndex;
+    int scopeId;
+  };
+
+  ScopeStackTable* m_table;
+  const ScopeTree* m_tree;
+  QVector<Frame> m_stack;
+  int m_pos;
+
+  void push(const ScopeNode* node, const Region& region);
+};
+
+}  // namespace core
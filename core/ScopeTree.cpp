@@ -0,0 +1,234 @@
+#include <algorithm>
+
+#include "ScopeTree.h"
+#include "LanguageParser.h"
+
+namespace core {
+
+namespace {
+Region shift(const Region& region, int delta) {
+  return Region(region.begin() + delta, region.end() + delta);
+}
+
+// Returns true if nodes are sorted, don't overlap and are within region
+bool isNested(const QList<Node>& nodes, const Region& region) {
+  int end = region.begin();
+  for (const auto& node : nodes) {
+    if (node.region.begin() < end) {
+      return false;
+    }
+    end = node.region.end();
+  }
+  return end <= region.end();
+}
+
+// Returns nodes sorted and nested so that they don't overlap. A node beginning inside a previous
+// one becomes its child, clipped to its end. e.g. The parser appends a node of contentName after
+// the nodes of the patterns between begin and end, and they become children of the contentName
+// node. All nodes are clipped to region.
+QList<Node> nest(QList<Node> nodes, const Region& region) {
+  // Outer nodes first when they begin at the same position
+  std::stable_sort(nodes.begin(), nodes.end(), [](const Node& x, const Node& y) {
+    return x.region.begin() < y.region.begin() ||
+           (x.region.begin() == y.region.begin() && x.region.end() > y.region.end());
+  });
+
+  QList<Node> nested;
+  for (Node& node : nodes) {
+    const int begin = qMax(node.region.begin(), region.begin());
+    const int end = qMin(node.region.end(), region.end());
+    if (begin > end) {
+      continue;
+    }
+
+    if (!nested.isEmpty() && nested.last().region.end() > begin) {
+      // The children of previous are nested again when its ScopeNode is created
+      Node& previous = nested.last();
+      node.region = Region(begin, qMin(end, previous.region.end()));
+      auto it = std::upper_bound(
+          previous.children.begin(), previous.children.end(), node,
+          [](const Node& x, const Node& y) { return x.region.begin() < y.region.begin(); });
+      previous.children.insert(it, node);
+    } else {
+      node.region = Region(begin, end);
+      nested.append(node);
+    }
+  }
+  return nested;
+}
+}
+
+ScopeNode::ScopeNode() : m_begin(0), m_end(0) {}
+
+ScopeNode::ScopeNode(const Node& node, int parentBegin)
+    : m_name(node.name),
+      m_begin(node.region.begin() - parentBegin),
+      m_end(node.region.end() - parentBegin) {
+  const QList<Node>& children = isNested(node.children, node.region)
+                                    ? node.children
+                                    : nest(node.children, node.region);
+  QList<ScopeNode> scopeNodes;
+  scopeNodes.reserve(children.size());
+  for (const auto& child : children) {
+    scopeNodes.append(ScopeNode(child, node.region.begin()));
+  }
+  m_children.replace(0, 0, scopeNodes);
+}
+
+Region ScopeNode::childRegion(int i) const {
+  Q_ASSERT(0 <= i && i < m_children.size());
+  const ScopeNode& child = m_children.raw(i);
+  const int delta = m_children.pendingDelta(i);
+  return Region(child.m_begin + delta, child.m_end + delta);
+}
+
+int ScopeNode::findChild(int from, int pos) const {
+  // In most cases the result is from or the next one because callers move forward.
+  for (int i = from; i < from + 2; i++) {
+    if (i >= m_children.size() || childRegion(i).end() > pos) {
+      return i;
+    }
+  }
+
+  int lo = from + 2, hi = m_children.size();
+  while (lo < hi) {
+    int mid = lo + (hi - lo) / 2;
+    if (childRegion(mid).end() > pos) {
+      hi = mid;
+    } else {
+      lo = mid + 1;
+    }
+  }
+  return lo;
+}
+
+void ScopeNode::move(int delta) {
+  m_begin += delta;
+  m_end += delta;
+}
+
+// pos is relative to the begin of this node
+void ScopeNode::adjustChildren(int pos, int delta) {
+  if (delta == 0 || m_children.isEmpty()) {
+    return;
+  }
+
+  // Children which end before the edit are not affected
+  int i = findChild(0, delta > 0 ? pos - 1 : pos + delta);
+  for (; i < m_children.size() && childRegion(i).begin() < pos; i++) {
+    adjustChild(i, pos, delta);
+  }
+
+  // The rest begin at or after pos, so they just move
+  m_children.shift(i, delta);
+}
+
+void ScopeNode::adjustChild(int i, int pos, int delta) {
+  Region region = childRegion(i);
+  int oldBegin = region.begin();
+  if (region.end() < pos && region.end() <= pos + delta) {
+    return;
+  }
+
+  region.adjust(pos, delta);
+  ScopeNode& child = m_children.raw(i);
+  if (oldBegin < pos) {
+    child.adjustChildren(pos - oldBegin, delta);
+    // The begin is moved when the removed text covers it. Children are relative to the begin.
+    child.m_children.shift(0, oldBegin - region.begin());
+  }
+
+  const int pending = m_children.pendingDelta(i);
+  child.m_begin = region.begin() - pending;
+  child.m_end = region.end() - pending;
+}
+
+// region is relative to the begin of this node and begin is the absolute begin of this node. The
+// returned region is relative too.
+Region ScopeNode::replaceChildren(const Region& region, const QList<Node>& nodes, int begin) {
+  Region removed;
+  // The new nodes may extend past region. Remove the children they overlap too so that the children
+  // stay sorted.
+  Region replaced = region;
+  for (const auto& node : nodes) {
+    replaced = replaced.sum(shift(node.region, -begin));
+  }
+  const QList<Node> nested = isNested(nodes, shift(replaced, begin))
+                                 ? nodes
+                                 : nest(nodes, shift(replaced, begin));
+
+  // Nothing intersects an empty region
+  int first = findChild(0, replaced.begin());
+  int last = first;
+  while (!replaced.isEmpty() && last < m_children.size() &&
+         childRegion(last).begin() < replaced.end()) {
+    last++;
+  }
+
+  if (last > first) {
+    removed = Region(childRegion(first).begin(), childRegion(last - 1).end());
+  }
+  // Remove [first, last) and insert the new nodes there. They have actual positions.
+  QList<ScopeNode> children;
+  children.reserve(nested.size());
+  for (const auto& node : nested) {
+    children.append(ScopeNode(node, begin));
+  }
+  m_children.replace(first, last, children);
+  return removed;
+}
+
+// region is the absolute region of this node
+Node ScopeNode::toNode(const Region& region) const {
+  Node node(m_name, region);
+  for (int i = 0; i < m_children.size(); i++) {
+    node.children.append(m_children.raw(i).toNode(shift(childRegion(i), region.begin())));
+  }
+  return node;
+}
+
+ScopeTree::ScopeTree(const RootNode& root) : m_root(root, 0), m_region(root.region) {}
+
+void ScopeTree::adjust(int pos, int delta) {
+  m_region.setEnd(m_region.end() + delta);
+  m_root.adjustChildren(pos - m_region.begin(), delta);
+}
+
+Region ScopeTree::replaceChildren(const Region& region, const QList<Node>& nodes) {
+  const Region removed =
+      m_root.replaceChildren(shift(region, -m_region.begin()), nodes, m_region.begin());
+  return removed.isEmpty() ? removed : shift(removed, m_region.begin());
+}
+
+QVector<Region> ScopeTree::childRegions(const Region& region) const {
+  const int count = m_root.childCount();
+  const Region relativeRegion = shift(region, -m_region.begin());
+  int first = m_root.findChild(0, relativeRegion.begin());
+  int last = first;
+  while (last < count && m_root.childRegion(last).begin() < relativeRegion.end()) {
+    last++;
+  }
+  first = qMax(first - 1, 0);
+  last = qMin(last + 1, count);
+
+  QVector<Region> regions;
+  regions.reserve(last - first + 1);
+  for (int i = first; i < last; i++) {
+    regions.append(shift(m_root.childRegion(i), m_region.begin()));
+  }
+  if (last < count) {
+    regions.append(shift(
+        Region(m_root.childRegion(last - 1).end(), m_root.childRegion(count - 1).end()),
+        m_region.begin()));
+  }
+  return regions;
+}
+
+RootNode ScopeTree::toRootNode() const {
+  RootNode root(m_root.name());
+  root.region = m_region;
+  root.children = m_root.toNode(m_region).children;
+  return root;
+}
+
+}  // namespace core
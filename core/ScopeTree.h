@@ -0,0 +1,129 @@
+#pragma once
+
+#include <QList>
+#include <QString>
+#include <QVector>
+
+#include "macros.h"
+#include "PartitionedVector.h"
+#include "Region.h"
+
+namespace core {
+
+struct Node;
+struct RootNode;
+
+// A node of ScopeTree.
+//
+// Positions of children are relative to the begin of their parent, so moving a node moves its whole
+// subtree without visiting it. The children are a PartitionedVector, so after an edit only the
+// children between the previous and the current edit position are touched to move the pending
+// delta, and the nodes following the edit are not visited one by one. Moving the step costs
+// O(distance between the edits), which is bounded by the O(children) splice that the partial parse
+// after each edit does.
+//
+// Children are sorted and don't overlap. A node covered by a previous sibling in the parser output,
+// such as the nodes of the patterns inside a contentName node, becomes a child of that sibling.
+class ScopeNode {
+ public:
+  ScopeNode();
+  ScopeNode(const Node& node, int parentBegin);
+  ~ScopeNode() = default;
+  DEFAULT_COPY_AND_MOVE(ScopeNode)
+
+  const QString& name() const { return m_name; }
+  bool isLeaf() const { return m_children.isEmpty(); }
+  int childCount() const { return m_children.size(); }
+
+  // Note: positions stored in the child itself may have a pending delta. Use childRegion instead.
+  const ScopeNode& child(int i) const { return m_children.raw(i); }
+
+  // Returns the region of the i-th child relative to the begin of this node
+  Region childRegion(int i) const;
+
+  // Returns the smallest index i in [from, childCount()) such that the i-th child ends after pos.
+  // pos is relative to the begin of this node.
+  int findChild(int from, int pos) const;
+
+ private:
+  friend class ScopeTree;
+
+  struct MoveNode {
+    void operator()(ScopeNode& node, int delta) const { node.move(delta); }
+  };
+
+  QString m_name;
+  int m_begin;
+  int m_end;
+  PartitionedVector<ScopeNode, MoveNode, QList<ScopeNode>> m_children;
+
+  void move(int delta);
+  void adjustChildren(int pos, int delta);
+  void adjustChild(int i, int pos, int delta);
+  Region replaceChildren(const Region& region, const QList<Node>& nodes, int begin);
+  Node toNode(const Region& region) const;
+};
+
+// Scope tree kept by SyntaxHighlighter.
+// Adjusting positions after an edit visits only the nodes on the path to the edit position and
+// replacing nodes after a partial parse is a splice of the top level nodes.
+class ScopeTree {
+ public:
+  ScopeTree() = default;
+  explicit ScopeTree(const RootNode& root);
+  ~ScopeTree() = default;
+  DEFAULT_COPY_AND_MOVE(ScopeTree)
+
+  const ScopeNode& root() const { return m_root; }
+  Region region() const { return m_region; }
+
+  // Adjusts regions for the given position and delta. Same as Region::adjust for every node.
+  void adjust(int pos, int delta);
+
+  // Replaces the top level nodes which intersect region with nodes. Returns the region covering the
+  // removed nodes, which may extend past region, or an empty region if none is removed.
+  Region replaceChildren(const Region& region, const QList<Node>& nodes);
+
+  // Returns the regions of the top level nodes a partial parse of region needs: the ones which
+  // intersect region and one on each side. If more nodes follow, one more region covers all of them
+  // so that the parse can expand up to the end of the last node.
+  QVector<Region> childRegions(const Region& region) const;
+
+  // Returns the tree with absolute regions
+  RootNode toRootNode() const;
+
+  // Calls visit(node, nodeRegion) for each node intersecting region, parents before their children.
+  // nodeRegion is the absolute region of node. The children of a node are visited only if visit
+  // returns true. Children before region are skipped by binary search.
+  template <typename Visit>
+  void visit(const Region& region, Visit visit) const {
+    visitChildren(m_root, m_region.begin(), region, visit);
+  }
+
+ private:
+  ScopeNode m_root;
+  Region m_region;
+
+  template <typename Visit>
+  static void visitChildren(const ScopeNode& node, int begin, const Region& region, Visit& visit);
+};
+
+template <typename Visit>
+void ScopeTree::visitChildren(const ScopeNode& node,
+                              int begin,
+                              const Region& region,
+                              Visit& visit) {
+  const int count = node.childCount();
+  for (int i = node.findChild(0, region.begin() - begin); i < count; i++) {
+    const Region childRegion = node.childRegion(i);
+    const Region absoluteRegion(childRegion.begin() + begin, childRegion.end() + begin);
+    if (absoluteRegion.begin() >= region.end()) {
+      break;
+    }
+    if (absoluteRegion.end() > region.begin() && visit(node.child(i), absoluteRegion)) {
+      visitChildren(node.child(i), absoluteRegion.begin(), region, visit);
+    }
+  }
+}
+
+}  // namespace core
@@ -0,0 +1,123 @@
+#include <algorithm>
+#include <vector>
+
+#include "SymbolIndex.h"
+#include "Document.h"
+#include "FuzzyMatcher.h"
+#include "SymbolTable.h"
+#include "Tracer.h"
+
+namespace core {
+
+namespace {
+struct Candidate {
+  Document* doc;
+  const Symbol* symbol;
+  int score;
+  // in the order of appearance across the documents
+  int order;
+};
+
+bool isBetter(const Candidate& x, const Candidate& y) {
+  if (x.score != y.score) {
+    return x.score > y.score;
+  }
+  if (x.symbol->utf8Name.size() != y.symbol->utf8Name.size()) {
+    return x.symbol->utf8Name.size() < y.symbol->utf8Name.size();
+  }
+  return x.order < y.order;
+}
+
+QVariantMap toMap(const Symbol& symbol) {
+  QVariantMap map;
+  map.insert("name", symbol.name);
+  map.insert("scope", symbol.scope);
+  map.insert("begin", symbol.region.begin());
+  map.insert("end", symbol.region.end());
+  return map;
+}
+}
+
+void SymbolIndex::addDocument(Document* doc) {
+  if (!doc || m_docs.contains(doc)) {
+    return;
+  }
+
+  m_docs.append(doc);
+  connect(doc, &Document::destroying, this, [=] { removeDocument(doc); });
+}
+
+void SymbolIndex::removeDocument(Document* doc) {
+  if (m_docs.removeOne(doc)) {
+    disconnect(doc, nullptr, this, nullptr);
+  }
+}
+
+QVariantList SymbolIndex::symbols(Document* doc) {
+  QVariantList list;
+  const SymbolTable* table = doc ? doc->symbolTable() : nullptr;
+  if (!table) {
+    return list;
+  }
+
+  for (const Symbol& symbol : table->symbols()) {
+    list.append(toMap(symbol));
+  }
+  return list;
+}
+
+QVariantMap SymbolIndex::symbolAt(Document* doc, int pos) {
+  const SymbolTable* table = doc ? doc->symbolTable() : nullptr;
+  if (!table) {
+    return QVariantMap();
+  }
+
+  const int index = table->indexAt(pos);
+  return index >= 0 ? toMap(table->symbol(index)) : QVariantMap();
+}
+
+QVariantList SymbolIndex::find(const QString& query, int maxCount, Document* doc) {
+  TRACE_SCOPE("SymbolIndex::find");
+  if (maxCount <= 0) {
+    return QVariantList();
+  }
+
+  // Like FileIndex::find, names which don't have all characters of the query are dropped by their
+  // masks first and the best maxCount of the rest are kept in a heap
+  const QVector<Document*> docs = doc ? QVector<Document*>{doc} : m_docs;
+  const FuzzyMatcher matcher(query);
+  std::vector<Candidate> heap;
+  QVector<int> ids;
+  int order = 0;
+  for (Document* current : docs) {
+    const SymbolTable* table = current->symbolTable();
+    if (!table) {
+      continue;
+    }
+
+    const QVector<Symbol>& symbols = table->symbols();
+    ids.clear();
+    matcher.filter(table->masks().constData(), 0, symbols.size(), ids);
+    for (int id : ids) {
+      const Symbol& symbol = symbols[id];
+      const int score = matcher.score(symbol.utf8Name.constData(), symbol.lowerName.constData(),
+                                      symbol.utf8Name.size(), 0);
+      if (score >= 0) {
+        FuzzyMatcher::keepBest(heap, maxCount, Candidate{current, &symbol, score, order + id},
+                               isBetter);
+      }
+    }
+    order += symbols.size();
+  }
+
+  std::sort_heap(heap.begin(), heap.end(), isBetter);
+  QVariantList list;
+  for (const Candidate& candidate : heap) {
+    QVariantMap map = toMap(*candidate.symbol);
+    map.insert("path", candidate.doc->path());
+    list.append(map);
+  }
+  return list;
+}
+
+}  // namespace core
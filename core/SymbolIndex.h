@@ -0,0 +1,49 @@
+#pragma once
+
+#include <QObject>
+#include <QVariantList>
+#include <QVariantMap>
+#include <QVector>
+
+#include "macros.h"
+#include "Singleton.h"
+
+namespace core {
+
+class Document;
+struct Symbol;
+
+// Go to symbol in a document or across the open documents.
+//
+// Symbols are kept by the SymbolTable of each document, which is updated from the results of the
+// syntax highlighter's parses, so nothing is parsed here. A query scans the character masks of the
+// symbol names and scores the remaining ones with FuzzyMatcher.
+class SymbolIndex : public QObject, public Singleton<SymbolIndex> {
+  Q_OBJECT
+
+ public:
+  ~SymbolIndex() = default;
+
+  // The document is dropped when it's destroyed
+  void addDocument(Document* doc);
+  void removeDocument(Document* doc);
+
+ public slots:
+  // Returns the symbols of doc in the order of appearance. Each one is an object with name, scope,
+  // begin and end.
+  QVariantList symbols(core::Document* doc);
+  // Returns the symbol at pos (the last one beginning at or before it), or an empty object
+  QVariantMap symbolAt(core::Document* doc, int pos);
+  // Returns up to maxCount symbols matching query, best first. They are searched in doc, or in all
+  // the open documents if doc is null. Each one has path in addition to the ones of symbols().
+  QVariantList find(const QString& query, int maxCount = 50, core::Document* doc = nullptr);
+
+ private:
+  friend class Singleton<SymbolIndex>;
+
+  QVector<Document*> m_docs;
+
+  SymbolIndex() = default;
+};
+
+}  // namespace core
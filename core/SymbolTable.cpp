@@ -0,0 +1,227 @@
+#include <algorithm>
+#include <QRegExp>
+#include <QTextBlock>
+#include <QTextDocument>
+
+#include "SymbolTable.h"
+#include "FuzzyMatcher.h"
+#include "LanguageParser.h"
+#include "Metadata.h"
+#include "Tracer.h"
+#include "Util.h"
+
+namespace core {
+
+namespace {
+// true if scope is selector or its descendant like entity.name.function.js for entity.name.function
+bool matches(const QString& selector, const QString& scope) {
+  return scope.startsWith(selector) &&
+         (scope.size() == selector.size() || scope[selector.size()] == QLatin1Char('.'));
+}
+
+// A symbol spanning lines is cut at the end of its first line
+QString textOf(const QTextDocument* doc, const Region& region) {
+  const QTextBlock block = doc->findBlock(region.begin());
+  if (!block.isValid()) {
+    return QString();
+  }
+  const int begin = region.begin() - block.position();
+  const int end = std::min(region.end() - block.position(), block.length() - 1);
+  return block.text().mid(begin, end - begin).trimmed();
+}
+
+// true if the parts of a selector before the last one match the ancestors in path in order
+bool matchesAncestors(const QStringList& scopes, const QVector<const QString*>& path) {
+  int i = path.size() - 2;
+  for (int j = scopes.size() - 2; j >= 0; j--, i--) {
+    while (i >= 0 && !matches(scopes[j], *path[i])) {
+      i--;
+    }
+    if (i < 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+QVector<quint64> masksOf(const QVector<Symbol>& symbols) {
+  QVector<quint64> masks;
+  masks.reserve(symbols.size());
+  for (const Symbol& symbol : symbols) {
+    masks.append(FuzzyMatcher::charMask(symbol.lowerName.constData(), symbol.lowerName.size()));
+  }
+  return masks;
+}
+
+Region shift(const Region& region, int delta) {
+  return Region(region.begin() + delta, region.end() + delta);
+}
+}
+
+const QStringList SymbolTable::DEFAULT_SELECTORS{"entity.name.function", "entity.name.type",
+                                                 "entity.name.class"};
+
+SymbolTable::SymbolTable() : m_maxLength(0) {}
+
+const QVector<Symbol>& SymbolTable::symbols() const {
+  return m_symbols.items();
+}
+
+Symbol SymbolTable::symbol(int i) const {
+  Symbol symbol = m_symbols.raw(i);
+  symbol.region = regionAt(i);
+  return symbol;
+}
+
+int SymbolTable::indexAt(int pos) const {
+  return lowerBound(pos + 1) - 1;
+}
+
+void SymbolTable::reset(const RootNode& root, const QTextDocument* doc) {
+  TRACE_SCOPE("SymbolTable::reset");
+  m_rootScope = root.name;
+  loadSelectors();
+  m_maxLength = 0;
+  QVector<Symbol> symbols;
+  collect(root.children, doc, symbols);
+  m_masks = masksOf(symbols);
+  updateMaxLength(symbols);
+  m_symbols.clear();
+  m_symbols.replace(0, 0, symbols);
+}
+
+// Same as ScopeNode::replaceChildren
+void SymbolTable::replace(const Region& region,
+                          const QList<Node>& nodes,
+                          const QTextDocument* doc) {
+  TRACE_SCOPE("SymbolTable::replace");
+  const int first = lowerBound(region.begin());
+  const int last = lowerBound(region.end());
+  m_masks.erase(m_masks.begin() + first, m_masks.begin() + last);
+
+  QVector<Symbol> symbols;
+  collect(nodes, doc, symbols);
+  updateMaxLength(symbols);
+  const QVector<quint64> masks = masksOf(symbols);
+  m_masks.insert(first, masks.size(), 0);
+  std::copy(masks.begin(), masks.end(), m_masks.begin() + first);
+  m_symbols.replace(first, last, symbols);
+}
+
+// Symbols beginning at or after pos just move, so the delta is added to the pending one. A symbol
+// beginning before pos is changed only if it ends at or after the start of the edit, so only the
+// ones beginning within the longest length from there are checked.
+void SymbolTable::adjust(int pos, int delta) {
+  if (delta == 0) {
+    return;
+  }
+
+  const int index = lowerBound(pos);
+  const int threshold = std::min(pos, pos + delta);
+  for (int i = index - 1; i >= 0 && regionAt(i).begin() >= threshold - m_maxLength; i--) {
+    Region region = regionAt(i);
+    if (region.end() >= threshold) {
+      region.adjust(pos, delta);
+      setRegion(i, region);
+      m_maxLength = std::max(m_maxLength, region.length());
+    }
+  }
+
+  m_symbols.shift(index, delta);
+}
+
+Region SymbolTable::regionAt(int i) const {
+  return shift(m_symbols.raw(i).region, m_symbols.pendingDelta(i));
+}
+
+void SymbolTable::setRegion(int i, const Region& region) {
+  m_symbols.raw(i).region = shift(region, -m_symbols.pendingDelta(i));
+}
+
+int SymbolTable::lowerBound(int pos) const {
+  int lo = 0;
+  int hi = m_symbols.size();
+  while (lo < hi) {
+    const int mid = lo + (hi - lo) / 2;
+    if (regionAt(mid).begin() < pos) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+void SymbolTable::updateMaxLength(const QVector<Symbol>& symbols) {
+  for (const Symbol& symbol : symbols) {
+    m_maxLength = std::max(m_maxLength, symbol.region.length());
+  }
+}
+
+void SymbolTable::loadSelectors() {
+  m_selectors.clear();
+  for (const QString& selector : DEFAULT_SELECTORS) {
+    m_selectors.append(Selector{QStringList{selector}, true});
+  }
+  for (bool show : {true, false}) {
+    // A scope selector can be a list like "source.js meta.function, source.js meta.class"
+    for (const QString& selectors : Metadata::symbolListSelectors(show)) {
+      for (const QString& selector : selectors.split(QLatin1Char(','), QString::SkipEmptyParts)) {
+        const QStringList scopes = selector.split(QRegExp("\\s+"), QString::SkipEmptyParts);
+        if (!scopes.isEmpty()) {
+          m_selectors.append(Selector{scopes, show});
+        }
+      }
+    }
+  }
+}
+
+// A selector matches if its last part matches the node and the other parts match its ancestors in
+// order, like a descendant selector. Excluding selectors win.
+bool SymbolTable::isSymbol(const QVector<const QString*>& path) const {
+  bool show = false;
+  for (const Selector& selector : m_selectors) {
+    if ((show && selector.show) || !matches(selector.scopes.last(), *path.last()) ||
+        !matchesAncestors(selector.scopes, path)) {
+      continue;
+    }
+    if (!selector.show) {
+      return false;
+    }
+    show = true;
+  }
+  return show;
+}
+
+void SymbolTable::collect(const Node& node,
+                          QVector<const QString*>& path,
+                          const QTextDocument* doc,
+                          QVector<Symbol>& symbols) const {
+  path.append(&node.name);
+  if (!node.region.isEmpty() && isSymbol(path)) {
+    const QString name = textOf(doc, node.region);
+    if (!name.isEmpty()) {
+      const QByteArray utf8Name = name.toUtf8();
+      symbols.append(Symbol{name, node.name, node.region, utf8Name, Util::toAsciiLower(utf8Name)});
+    }
+  }
+  for (const Node& child : node.children) {
+    collect(child, path, doc, symbols);
+  }
+  path.removeLast();
+}
+
+void SymbolTable::collect(const QList<Node>& nodes,
+                          const QTextDocument* doc,
+                          QVector<Symbol>& symbols) const {
+  QVector<const QString*> path{&m_rootScope};
+  for (const Node& node : nodes) {
+    collect(node, path, doc, symbols);
+  }
+  // Nodes of contentName overlap their siblings
+  std::stable_sort(symbols.begin(), symbols.end(), [](const Symbol& x, const Symbol& y) {
+    return x.region.begin() < y.region.begin();
+  });
+}
+
+}  // namespace core
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "macros.h"
+#include "PartitionedVector.h"
+#include "Region.h"
+
+class QTextDocument;
+
+namespace core {
+
+struct Node;
+struct RootNode;
+
+struct Symbol {
+  QString name;
+  // scope name of the node
+  QString scope;
+  Region region;
+  // UTF-8 name and the one with ASCII letters in lower case for FuzzyMatcher
+  QByteArray utf8Name;
+  QByteArray lowerName;
+};
+
+// Symbols of a document found in the scope tree, sorted by position.
+//
+// A node is a symbol if its scope path matches one of the symbol list selectors, which are read
+// from showInSymbolList of .tmPreferences (see Metadata::symbolListSelectors) in addition to the
+// default ones like entity.name.function. The table is rebuilt after a full parse, and only the
+// symbols in the reparsed region are replaced after a partial parse.
+//
+// Edits in between shift the positions with the pending delta of PartitionedVector, so only the
+// symbols between two consecutive edits and the ones within the longest symbol before the edit are
+// touched.
+class SymbolTable {
+ public:
+  // used when no .tmPreferences says otherwise
+  static const QStringList DEFAULT_SELECTORS;
+
+  SymbolTable();
+  ~SymbolTable() = default;
+  DEFAULT_COPY_AND_MOVE(SymbolTable)
+
+  // Applies the pending delta to all symbols
+  const QVector<Symbol>& symbols() const;
+  int size() const { return m_symbols.size(); }
+  // FuzzyMatcher::charMask of the names, indexed like symbols() so FuzzyMatcher::filter scans them
+  const QVector<quint64>& masks() const { return m_masks; }
+  Symbol symbol(int i) const;
+  // Returns the index of the last symbol beginning at or before pos, or -1 if there is none.
+  // This is the innermost symbol containing pos if any, because symbols are sorted by begin.
+  int indexAt(int pos) const;
+
+  // Rebuilds the table from the tree of a full parse. Names are read from doc.
+  void reset(const RootNode& root, const QTextDocument* doc);
+  // Replaces the symbols in region with the ones in nodes, which are top level nodes of a partial
+  // parse. region covers the removed nodes too, which may extend past the new ones.
+  void replace(const Region& region, const QList<Node>& nodes, const QTextDocument* doc);
+  // Same as Region::adjust for every symbol
+  void adjust(int pos, int delta);
+
+ private:
+  struct ShiftSymbol {
+    void operator()(Symbol& symbol, int delta) const {
+      symbol.region = Region(symbol.region.begin() + delta, symbol.region.end() + delta);
+    }
+  };
+
+  struct Selector {
+    // whitespace separated parts of the selector
+    QStringList scopes;
+    bool show;
+  };
+
+  QString m_rootScope;
+  QVector<Selector> m_selectors;
+  mutable PartitionedVector<Symbol, ShiftSymbol> m_symbols;
+  QVector<quint64> m_masks;
+  // length of the longest region so far
+  int m_maxLength;
+
+  Region regionAt(int i) const;
+  void setRegion(int i, const Region& region);
+  // Returns the index of the first symbol beginning at or after pos
+  int lowerBound(int pos) const;
+  void updateMaxLength(const QVector<Symbol>& symbols);
+  void loadSelectors();
+  bool isSymbol(const QVector<const QString*>& path) const;
+  void collect(const Node& node,
+               QVector<const QString*>& path,
+               const QTextDocument* doc,
+               QVector<Symbol>& symbols) const;
+  void collect(const QList<Node>& nodes, const QTextDocument* doc, QVector<Symbol>& symbols) const;
+};
+
+}  // namespace core
@@ -1,5 +1,7 @@
 #include <QTextDocument>
 #include <QTextDocumentFragment>
+#include <QTextLayout>
+#include <QTimer>
 #include <QDebug>
 
 #include "SyntaxHighlighter.h"
@@ -7,14 +9,25 @@
 #include "Util.h"
 #include "Config.h"
 #include "Theme.h"
+#include "Tracer.h"
 
 namespace core {
 
+namespace {
+// number of blocks reformatted in one event loop iteration after a theme or font change
+const int REFORMAT_BATCH_SIZE = 1000;
+}
+
 SyntaxHighlighter::SyntaxHighlighter(QTextDocument* doc,
                                      std::unique_ptr<LanguageParser> parser,
                                      Theme* theme,
                                      QFont font)
-    : QSyntaxHighlighter(doc), m_parser(*parser), m_theme(theme) {
+    : QSyntaxHighlighter(doc),
+      m_parser(*parser),
+      m_theme(theme),
+      m_scopeCursor(&m_scopeStacks),
+      m_reformatting(false),
+      m_reformatGeneration(0) {
   Q_ASSERT(parser);
 
   /*
@@ -62,53 +75,61 @@ void SyntaxHighlighter::setParser(LanguageParser parser) {
 }
 
 Region SyntaxHighlighter::scopeExtent(int point) {
-  updateScope(point);
-  if (m_lastScopeNode) {
-    return m_lastScopeNode->region;
-  }
-  return Region();
+  m_scopeCursor.seek(point);
+  return m_scopeCursor.region();
 }
 
 QString SyntaxHighlighter::scopeName(int point) {
-  updateScope(point);
-  return m_lastScopeName;
+  int id = m_scopeCursor.seek(point);
+  return id >= 0 ? m_scopeStacks.name(id) : QString();
 }
 
 QString SyntaxHighlighter::scopeTree() {
-  return m_rootNode ? m_rootNode->toString(document()->toPlainText()) : "";
+  return m_scopeTree ? m_scopeTree->toRootNode().toString(document()->toPlainText()) : "";
 }
 
 void SyntaxHighlighter::highlight(const Region& region) {
+  QVector<Region> childRegions =
+      m_scopeTree ? m_scopeTree->childRegions(region) : QVector<Region>();
   QMetaObject::invokeMethod(&SyntaxHighlighterThread::singleton(), "parse", Qt::QueuedConnection,
                             Q_ARG(SyntaxHighlighter*, this), Q_ARG(LanguageParser, *m_parser),
-                            Q_ARG(QList<Node>, m_rootNode->children), Q_ARG(Region, region));
+                            Q_ARG(QVector<Region>, childRegions), Q_ARG(Region, region));
 }
 
 void SyntaxHighlighter::updateNode(int position, int charsRemoved, int charsAdded) {
-  qDebug("contentsChange(pos: %d, charsRemoved: %d, charsAdded: %d)", position, charsRemoved,
-         charsAdded);
+  TRACE_SCOPE("SyntaxHighlighter::updateNode");
 
   if (!document()) {
     qWarning() << "document is null";
     return;
   }
 
+  // Reformatting blocks marks them dirty and emits contentsChange, but the text is not changed.
+  if (m_reformatting) {
+    return;
+  }
+
   // position is the position after removal happeened, so we need +charsRemoved
   //
   // NOTE: When pasting a text in an empty document, charsRemoved becomes 1 and charsAdded is the
   // actual charsAdded + 1 because of this bug.
   // We need to decrement them by 1.
   // https://bugreports.qt.io/browse/QTBUG-3495
-  if (m_rootNode && m_rootNode->region.isEmpty() && charsRemoved == 1) {
+  if (m_scopeTree && m_scopeTree->region().isEmpty() && charsRemoved == 1) {
     charsRemoved--;
     charsAdded--;
   }
 
   int delta = charsAdded - charsRemoved;
 
-  if (m_rootNode) {
-    m_rootNode->adjust(position + charsRemoved, delta);
+  if (m_scopeTree) {
+    m_scopeTree->adjust(position + charsRemoved, delta);
+    resetScopeCursor();
   }
+  m_symbols.adjust(position + charsRemoved, delta);
+  const ScopeTree* tree = m_scopeTree ? &*m_scopeTree : nullptr;
+  m_foldingRanges.update(tree, position, charsRemoved, charsAdded);
+  m_brackets.update(tree, document(), position, charsRemoved, charsAdded);
 
   //   We need to extend affectedRegion to the region from the beginning of the line at beginPos
   //   to the end of the line at endPos to support look ahead and behind regex.
@@ -162,26 +183,38 @@ void SyntaxHighlighter::updateNode(int position, int charsRemoved, int charsAdde
 }
 
 void SyntaxHighlighter::fullParseFinished(RootNode node) {
-  m_rootNode = node;
-  m_lastScopeNode = boost::none;
+  m_scopeTree = ScopeTree(node);
+  m_symbols.reset(node, document());
+  m_foldingRanges.reset(&*m_scopeTree, document());
+  m_brackets.reset(&*m_scopeTree, document());
+  resetScopeCursor();
   rehighlight();
   emit parseFinished();
 }
 
 void SyntaxHighlighter::partialParseFinished(QList<Node> newNodes, Region region) {
+  TRACE_SCOPE("SyntaxHighlighter::partialParseFinished");
   Region affectedRegion(region);
   if (newNodes.size() > 0) {
     // Extend affectedRegion by considering newNodes
-    qDebug() << "affectedRegion:" << affectedRegion;
     affectedRegion.setBegin(qMin(affectedRegion.begin(), newNodes[0].region.begin()));
     affectedRegion.setEnd(qMax(affectedRegion.end(), newNodes[newNodes.size() - 1].region.end()));
   }
 
-  m_rootNode->removeChildren(affectedRegion);
-  m_rootNode->addChildren(newNodes);
-  m_rootNode->sortChildren();
+  if (!m_scopeTree) {
+    qWarning() << "scope tree is null";
+    return;
+  }
+
+  // The symbols, folding ranges and brackets of the removed nodes past affectedRegion change too
+  const Region removedRegion = m_scopeTree->replaceChildren(affectedRegion, newNodes);
+  const Region changedRegion =
+      removedRegion.isEmpty() ? affectedRegion : affectedRegion.sum(removedRegion);
+  m_symbols.replace(changedRegion, newNodes, document());
+  m_foldingRanges.replace(&*m_scopeTree, changedRegion);
+  m_brackets.replace(&*m_scopeTree, changedRegion, document());
+  resetScopeCursor();
 
-  qDebug("new children.size: %d", (int)m_rootNode->children.size());
   //  qDebug().noquote() << *this;
 
   //  qDebug().noquote() << "affectedRegion:" << affectedRegion;
@@ -192,9 +225,6 @@ void SyntaxHighlighter::partialParseFinished(QList<Node> newNodes, Region region
     affectedBlock = affectedBlock.next();
   }
 
-  m_lastScopeNode = boost::none;
-  m_lastScopeBuf.clear();
-  m_lastScopeName = "";
   emit parseFinished();
 }
 
@@ -204,105 +234,129 @@ void SyntaxHighlighter::highlightBlock(const QString& text) {
     return;
   }
 
+  TokenRunsData* data = static_cast<TokenRunsData*>(currentBlockUserData());
+  if (m_reformatting && data) {
+    data->generation = m_reformatGeneration;
+    applyTokenRuns(data->runs);
+    return;
+  }
+
+  if (!data) {
+    data = new TokenRunsData();
+    setCurrentBlockUserData(data);
+  }
+  data->runs.clear();
+  data->generation = m_reformatGeneration;
+
   int posInDoc = currentBlock().position();
   //  qDebug("highlightBlock. text: %s. current block pos: %d", qPrintable(text), posInDoc);
 
   for (int posInText = 0; posInText < text.length();) {
-    updateScope(posInDoc + posInText);
-    if (!m_lastScopeNode) {
-      //      qDebug("lastScopeNode is null. after updateScope(%d)", posInDoc + posInText);
-      return;
+    int id = m_scopeCursor.seek(posInDoc + posInText);
+    if (id < 0) {
+      //      qDebug("no scope covers %d", posInDoc + posInText);
+      break;
     }
 
-    QTextCharFormat* format = m_theme->getFormat(m_lastScopeName);
-    if (format) {
-      if (m_lastScopeNode->isLeaf()) {
-        Region region = m_lastScopeNode->region;
-        int length = region.end() - (posInDoc + posInText);
-        //      qDebug("%d - %d  %s", region.begin(), region.end(), qPrintable(m_lastScopeName));
-        //        qDebug("setFormat(%d, %d, %s",
-        //               i,
-        //               qMin(text.length(), region.length()),
-        //               qPrintable(format->foreground().color().name()));
-        setFormat(posInText, qMin(text.length(), length), *format);
-        posInText += length;
-      } else {
-        //        qDebug("setFormat(%d, %d, %s",
-        //               i,
-        //               1,
-        //               qPrintable(format->foreground().color().name()));
-        setFormat(posInText, 1, *format);
-        posInText++;
-      }
+    int length = qMin(text.length(), m_scopeCursor.runEnd() - posInDoc) - posInText;
+    if (!data->runs.isEmpty() && data->runs.last().scopeId == id &&
+        data->runs.last().offset + data->runs.last().length == posInText) {
+      data->runs.last().length += length;
     } else {
-      qDebug("format not found for %s", qPrintable(m_lastScopeName));
-      posInText++;
+      data->runs.append(TokenRun{posInText, length, id});
     }
+    posInText += length;
   }
+
+  applyTokenRuns(data->runs);
 }
 
-boost::optional<Node> SyntaxHighlighter::findScope(const Region& search, const Node& node) {
-  int idx = Util::binarySearch(node.children.size(), [search, node](int i) {
-    return node.children[i].region.begin() >= search.begin() ||
-           node.children[i].region.fullyCovers(search);
-  });
+void SyntaxHighlighter::resetScopeCursor() {
+  m_scopeCursor.reset(m_scopeTree ? &*m_scopeTree : nullptr);
+}
 
-  while (static_cast<int>(idx) < node.children.size()) {
-    auto child = node.children[idx];
-    if (child.region.begin() > search.end()) {
-      break;
+QTextCharFormat* SyntaxHighlighter::format(int scopeId) {
+  Q_ASSERT(0 <= scopeId && scopeId < m_scopeStacks.size());
+  if (m_formats.size() <= scopeId) {
+    // new elements are initialized with nullptr
+    m_formats.resize(m_scopeStacks.size());
+  }
+
+  if (!m_formats[scopeId] && m_theme) {
+    m_formats[scopeId] = m_theme->getFormat(m_scopeStacks.name(scopeId));
+    if (!m_formats[scopeId]) {
+      qDebug("format not found for %s", qPrintable(m_scopeStacks.name(scopeId)));
     }
-    if (child.region.fullyCovers(search)) {
-      if (!node.name.isEmpty() && node != m_lastScopeNode) {
-        if (m_lastScopeBuf.length() > 0) {
-          m_lastScopeBuf.append(' ');
-        }
-        m_lastScopeBuf.append(node.name);
-      }
-      return findScope(search, node.children[idx]);
+  }
+  return m_formats[scopeId];
+}
+
+void SyntaxHighlighter::applyTokenRuns(const QVector<TokenRun>& runs) {
+  for (const auto& run : runs) {
+    if (QTextCharFormat* fmt = format(run.scopeId)) {
+      setFormat(run.offset, run.length, *fmt);
     }
-    idx++;
   }
+}
 
-  if (node != m_lastScopeNode && node.region.fullyCovers(search)) {
-    if (!node.name.isEmpty()) {
-      if (m_lastScopeBuf.length() > 0) {
-        m_lastScopeBuf.append(' ');
+void SyntaxHighlighter::reformatBlock(const QTextBlock& block) {
+  m_reformatting = true;
+  rehighlightBlock(block);
+  m_reformatting = false;
+}
+
+void SyntaxHighlighter::reformatBlocks() {
+  if (!document()) {
+    return;
+  }
+
+  int generation = ++m_reformatGeneration;
+
+  for (const QPair<int, int>& blocks : m_visibleBlocks) {
+    QTextBlock block = document()->findBlockByNumber(blocks.first);
+    for (; block.isValid() && block.blockNumber() <= blocks.second; block = block.next()) {
+      auto data = static_cast<TokenRunsData*>(block.userData());
+      if (!data || data->generation != generation) {
+        reformatBlock(block);
       }
-      m_lastScopeBuf.append(node.name);
     }
-    return node;
   }
 
-  return boost::none;
+  reformatPendingBlocks(0, generation);
 }
 
-void SyntaxHighlighter::updateScope(int point) {
-  //  qDebug("updateScope(point: %d)", point);
+void SyntaxHighlighter::setVisibleBlocks(const QObject* view, int firstBlock, int lastBlock) {
+  if (firstBlock < 0) {
+    m_visibleBlocks.remove(view);
+    return;
+  }
+
+  if (!m_visibleBlocks.contains(view)) {
+    connect(view, &QObject::destroyed, this,
+            [this](QObject* destroyed) { m_visibleBlocks.remove(destroyed); });
+  }
+  m_visibleBlocks.insert(view, qMakePair(firstBlock, lastBlock));
+}
 
-  if (!m_rootNode) {
-    //    qDebug("root node is null");
+void SyntaxHighlighter::reformatPendingBlocks(int blockNumber, int generation) {
+  // Another theme or font change started a new reformat
+  if (generation != m_reformatGeneration || !document()) {
     return;
   }
 
-  Region search(point, point + 1);
-  if (m_lastScopeNode && m_lastScopeNode->region.fullyCovers(search)) {
-    if (m_lastScopeNode->children.size() != 0) {
-      auto no = findScope(search, *m_lastScopeNode);
-      if (no && no != m_lastScopeNode) {
-        m_lastScopeNode = no;
-        m_lastScopeName = QString(m_lastScopeBuf);
-      }
+  QTextBlock block = document()->findBlockByNumber(blockNumber);
+  for (int count = 0; block.isValid() && count < REFORMAT_BATCH_SIZE; block = block.next()) {
+    auto data = static_cast<TokenRunsData*>(block.userData());
+    if (!data || data->generation != generation) {
+      reformatBlock(block);
+      count++;
     }
-    return;
   }
 
-  m_lastScopeNode = boost::none;
-  m_lastScopeBuf.clear();
-  if (m_rootNode) {
-    m_lastScopeNode = findScope(search, *m_rootNode);
+  if (block.isValid()) {
+    int next = block.blockNumber();
+    QTimer::singleShot(0, this, [=] { reformatPendingBlocks(next, generation); });
   }
-  m_lastScopeName = QString(m_lastScopeBuf);
 }
 
 void SyntaxHighlighter::changeTheme(Theme* theme) {
@@ -310,13 +364,15 @@ void SyntaxHighlighter::changeTheme(Theme* theme) {
     theme->setFont(*m_theme->font());
   }
   m_theme = theme;
-  rehighlight();
+  m_formats.clear();
+  reformatBlocks();
 }
 
 void SyntaxHighlighter::changeFont(const QFont& font) {
   if (m_theme) {
+    // Theme updates the cached formats in place, so m_formats is still valid.
     m_theme->setFont(font);
-    rehighlight();
+    reformatBlocks();
   }
 }
 
@@ -389,6 +445,7 @@ void SyntaxHighlighterThread::parse(SyntaxHighlighter* highlighter, LanguagePars
       return;
     }
 
+    TRACE_SCOPE("SyntaxHighlighterThread::fullParse");
     m_activeParser = parser;
     auto rootNode = parser.parse();
     if (rootNode) {
@@ -404,7 +461,7 @@ void SyntaxHighlighterThread::parse(SyntaxHighlighter* highlighter, LanguagePars
 
 void SyntaxHighlighterThread::parse(SyntaxHighlighter* highlighter,
                                     LanguageParser parser,
-                                    QList<Node> children,
+                                    QVector<Region> childRegions,
                                     Region region) {
   if (highlighter) {
     if (m_activeParser) {
@@ -420,14 +477,15 @@ void SyntaxHighlighterThread::parse(SyntaxHighlighter* highlighter,
         region = m_parsingRegion ? m_parsingRegion->sum(region) : region;
         m_activeParser->cancel();
         // Start partial parsing with a new text and region
-        QTimer::singleShot(0, this, [&] { parse(highlighter, parser, children, region); });
+        QTimer::singleShot(0, this, [=] { parse(highlighter, parser, childRegions, region); });
         return;
       }
     }
 
+    TRACE_SCOPE("SyntaxHighlighterThread::partialParse");
     m_activeParser = parser;
     m_parsingRegion = region;
-    auto result = parser.parse(children, region);
+    auto result = parser.parse(childRegions, region);
     m_parsingRegion = boost::none;
 
     if (result) {
@@ -442,6 +500,7 @@ void SyntaxHighlighterThread::parse(SyntaxHighlighter* highlighter,
 }
 
 SyntaxHighlighterThread::SyntaxHighlighterThread() : m_thread(new QThread(this)) {
+  m_thread->setObjectName(QStringLiteral("SyntaxHighlighterThread"));
   moveToThread(m_thread);
   m_thread->start();
 }
@@ -2,19 +2,45 @@
 
 #include <boost/optional.hpp>
 #include <memory>
+#include <QHash>
+#include <QPair>
 #include <QSyntaxHighlighter>
+#include <QTextBlockUserData>
 #include <QThread>
 
 #include "macros.h"
+#include "BracketPairs.h"
+#include "FoldingRanges.h"
 #include "LanguageParser.h"
 #include "Singleton.h"
 #include "Region.h"
+#include "ScopeCursor.h"
+#include "ScopeTree.h"
+#include "SymbolTable.h"
 
 namespace core {
 
 class Theme;
 class SyntaxHighlighter;
 
+// A run of characters in a block which share the same full scope name
+struct TokenRun {
+  int offset;
+  int length;
+  // scope stack id in ScopeStackTable of SyntaxHighlighter
+  int scopeId;
+};
+
+// Token runs of a block computed from the scope tree in the last highlightBlock.
+// These are kept to reformat the block without walking the scope tree again when only a theme or
+// font is changed.
+class TokenRunsData : public QTextBlockUserData {
+ public:
+  QVector<TokenRun> runs;
+  // reformat generation in which this block was formatted last time
+  int generation = 0;
+};
+
 class SyntaxHighlighterThread : public QObject, public Singleton<SyntaxHighlighterThread> {
   Q_OBJECT
  public:
@@ -25,7 +51,7 @@ class SyntaxHighlighterThread : public QObject, public Singleton<SyntaxHighlight
   void parse(SyntaxHighlighter* highlighter, LanguageParser parser);
   void parse(SyntaxHighlighter* highlighter,
              LanguageParser parser,
-             QList<Node> children,
+             QVector<Region> childRegions,
              Region region);
 
  signals:
@@ -55,7 +81,10 @@ class SyntaxHighlighter : public QSyntaxHighlighter {
   DEFAULT_MOVE(SyntaxHighlighter)
 
   // accessor
-  RootNode rootNode() { return *m_rootNode; }
+  RootNode rootNode() { return m_scopeTree ? m_scopeTree->toRootNode() : RootNode(); }
+  const SymbolTable& symbolTable() const { return m_symbols; }
+  FoldingRanges& foldingRanges() { return m_foldingRanges; }
+  const BracketPairs& bracketPairs() const { return m_brackets; }
 
   void setParser(LanguageParser parser);
 
@@ -71,6 +100,10 @@ class SyntaxHighlighter : public QSyntaxHighlighter {
 
   void highlight(const Region& region);
 
+  // Tells that view shows the blocks in [firstBlock, lastBlock]. reformatBlocks reformats them
+  // before the other blocks. firstBlock < 0 means view doesn't show the document any more.
+  void setVisibleBlocks(const QObject* view, int firstBlock, int lastBlock);
+
  signals:
   void parseFinished();
 
@@ -83,19 +116,31 @@ class SyntaxHighlighter : public QSyntaxHighlighter {
   void highlightBlock(const QString& text) override;
 
  private:
-  boost::optional<RootNode> m_rootNode;
-  boost::optional<Node> m_lastScopeNode;
-  QByteArray m_lastScopeBuf;
-  QString m_lastScopeName;
+  boost::optional<ScopeTree> m_scopeTree;
+  SymbolTable m_symbols;
+  FoldingRanges m_foldingRanges;
+  BracketPairs m_brackets;
   boost::optional<LanguageParser> m_parser;
   Theme* m_theme;
-
-  // Given a text region, returns the innermost node covering that region.
-  // Side-effects: Writes to m_lastScopeBuf...
-  boost::optional<Node> findScope(const Region& search, const Node& node);
-
-  // Caches the full concatenated nested scope name and the innermost node that covers "point".
-  void updateScope(int point);
+  ScopeStackTable m_scopeStacks;
+  ScopeCursor m_scopeCursor;
+  // formats of the current theme indexed by scope id. Filled lazily.
+  QVector<QTextCharFormat*> m_formats;
+  // true while blocks are reformatted from their token runs
+  bool m_reformatting;
+  int m_reformatGeneration;
+  // first and last visible block numbers of each view of the document
+  QHash<const QObject*, QPair<int, int>> m_visibleBlocks;
+
+  void resetScopeCursor();
+  QTextCharFormat* format(int scopeId);
+  void applyTokenRuns(const QVector<TokenRun>& runs);
+
+  // Reapplies formats to all the blocks from their token runs. The visible blocks of each view are
+  // reformatted first and the rest are reformatted in batches in later event loop iterations.
+  void reformatBlocks();
+  void reformatBlock(const QTextBlock& block);
+  void reformatPendingBlocks(int blockNumber, int generation);
 
  private slots:
   void changeTheme(Theme* theme);
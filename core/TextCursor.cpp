@@ -1,12 +1,12 @@
 #include <unicode/brkiter.h>
-#include <unicode/uchriter.h>
 #include <algorithm>
 #include <QTextBlock>
+#include <QTextDocument>
 #include <QDebug>
 
 #include "TextCursor.h"
 #include "IcuUtil.h"
-#include "scoped_guard.h"
+#include "WordSegmenter.h"
 #include "Config.h"
 
 namespace {
@@ -14,6 +14,43 @@ bool isWhiteSpaceOrAscii(const QString& str) {
   return std::all_of(str.constBegin(), str.constEnd(),
                      [](QChar ch) { return ch.isSpace() || ch.unicode() <= 127; });
 }
+
+// Returns the word boundaries in (begin, end) of doc. text is the text in [begin, end).
+// Whitespace at both ends of text is excluded from the range.
+QVector<int> innerWordBoundaries(QTextDocument* doc, int begin, int end, const QString& text) {
+  int first = 0, last = text.size();
+  while (first < last && text[first].isSpace()) {
+    first++;
+  }
+  while (last > first && text[last - 1].isSpace()) {
+    last--;
+  }
+
+  const QString locale = core::Config::singleton().locale();
+  const int rangeBegin = begin + first;
+  const int rangeEnd = begin + last;
+  QVector<int> positions;
+
+  // Use the cached boundaries of the block when the range is in a block
+  const QTextBlock block = doc->findBlock(rangeBegin);
+  if (block.isValid() && rangeEnd < block.position() + block.length()) {
+    for (int pos : core::WordSegmenter::boundaries(block, locale)) {
+      pos += block.position();
+      if (rangeBegin < pos && pos < rangeEnd) {
+        positions.append(pos);
+      }
+    }
+    return positions;
+  }
+
+  for (int pos : core::WordSegmenter::boundaries(text.mid(first, last - first), locale)) {
+    pos += rangeBegin;
+    if (rangeBegin < pos && pos < rangeEnd) {
+      positions.append(pos);
+    }
+  }
+  return positions;
+}
 }
 
 namespace core {
@@ -40,19 +77,10 @@ bool TextCursor::customMovePosition(QTextCursor& cursor,
         return true;
       }
 
-      // When moving a cursor by word, the text may include a space like "a ". So trim it.
-      text = text.trimmed();
-      Q_ASSERT(!text.isEmpty());
-
+      // Stop at the first word boundary in the text
       auto boundaries =
-          IcuUtil::wordBoundaries(text, IcuUtil::icuLocale(Config::singleton().locale()));
-
-      // When the text is split by word, the size of boundaries must be over 2
-      if (boundaries.size() > 2) {
-        cursor.setPosition(cursor.position() + boundaries[1], mode);
-      } else {
-        cursor.setPosition(newCursor.position(), mode);
-      }
+          innerWordBoundaries(cursor.document(), cursor.position(), newCursor.position(), text);
+      cursor.setPosition(boundaries.isEmpty() ? newCursor.position() : boundaries.first(), mode);
       return true;
     }
     case MoveOperation::PreviousWord: {
@@ -69,18 +97,10 @@ bool TextCursor::customMovePosition(QTextCursor& cursor,
         return true;
       }
 
-      text = text.trimmed();
-      Q_ASSERT(!text.isEmpty());
-
+      // Stop at the last word boundary in the text
       auto boundaries =
-          IcuUtil::wordBoundaries(text, IcuUtil::icuLocale(Config::singleton().locale()));
-
-      if (boundaries.size() > 2) {
-        cursor.setPosition(cursor.position() - text.size() + boundaries[boundaries.size() - 2],
-                           mode);
-      } else {
-        cursor.setPosition(newCursor.position(), mode);
-      }
+          innerWordBoundaries(cursor.document(), newCursor.position(), cursor.position(), text);
+      cursor.setPosition(boundaries.isEmpty() ? newCursor.position() : boundaries.last(), mode);
       return true;
     }
     case MoveOperation::StartOfWord: {
@@ -91,18 +111,17 @@ bool TextCursor::customMovePosition(QTextCursor& cursor,
       newCursor.clearSelection();
       newCursor.movePosition(QTextCursor::WordRight, QTextCursor::KeepAnchor, 2);
       const auto& text = newCursor.selectedText();
-      UErrorCode status = U_ZERO_ERROR;
-      auto boundary = BreakIterator::createWordInstance(
-          IcuUtil::icuLocale(Config::singleton().locale()), status);
-      scoped_guard guard([=] { delete boundary; });
-      boundary->setText(IcuUtil::toIcuString(text));
-      int32_t pos = 0;
 
       // When the cursor is at the end, move it as PreviousWord
       if (lengthFromLeft == text.size()) {
         return customMovePosition(cursor, QTextCursor::PreviousWord, mode, n);
       }
 
+      BreakIterator* boundary = WordSegmenter::iterator(Config::singleton().locale());
+      const UnicodeString icuText = IcuUtil::toIcuString(text);
+      boundary->setText(icuText);
+      int32_t pos = 0;
+
       // isBoundary has a side effect. The current position of the iterator is set
       // to the first boundary position at or following the specified offset.
       if (!boundary->isBoundary(lengthFromLeft)) {
@@ -124,18 +143,17 @@ bool TextCursor::customMovePosition(QTextCursor& cursor,
       newCursor.clearSelection();
       newCursor.movePosition(QTextCursor::WordRight, QTextCursor::KeepAnchor, 2);
       const auto& text = newCursor.selectedText();
-      UErrorCode status = U_ZERO_ERROR;
-      auto boundary = BreakIterator::createWordInstance(
-          IcuUtil::icuLocale(Config::singleton().locale()), status);
-      scoped_guard guard([=] { delete boundary; });
-      boundary->setText(IcuUtil::toIcuString(text));
-      int32_t pos = 0;
 
       // When the cursor is at the start, move it as NextWord
       if (lengthFromLeft == 0) {
         return customMovePosition(cursor, QTextCursor::NextWord, mode, n);
       }
 
+      BreakIterator* boundary = WordSegmenter::iterator(Config::singleton().locale());
+      const UnicodeString icuText = IcuUtil::toIcuString(text);
+      boundary->setText(icuText);
+      int32_t pos = 0;
+
       if (!boundary->isBoundary(lengthFromLeft)) {
         pos = boundary->current();
         if (pos == BreakIterator::DONE) {
@@ -0,0 +1,346 @@
+#include <algorithm>
+
+#include "TokenPairs.h"
+#include "Tracer.h"
+
+namespace core {
+
+namespace {
+bool isOpening(int kind) {
+  return kind % 2 == 0;
+}
+}
+
+// The innermost pair enclosing the gap before index at each depth opens at the last paired
+// opening token of the depth before index. The pairs ending in [index, end) enclose nothing there.
+int TokenPairs::enclosingOpen(int index, int end) const {
+  for (int depth = depthBefore(index) - 1; depth >= 0; depth--) {
+    const Values& opens = m_opens[depth];
+    const int open = valueAt(opens, lowerBound(opens, index) - 1);
+    if (open + m_offsets[open] >= end) {
+      return open;
+    }
+  }
+  return -1;
+}
+
+void TokenPairs::reset(const QVector<int>& positions, const QVector<quint8>& kinds) {
+  m_positions.clear();
+  m_positions.replace(0, 0, positions);
+  m_kinds = kinds;
+  m_offsets = pairAll();
+  m_depths.fill(0, positions.size());
+  m_opens.clear();
+  m_unpaired.clear();
+  updateDepths(0, positions.size(), 0, 0);
+}
+
+// The pairs enclosing the replaced tokens are found before they change. The following tokens keep
+// their pending delta, and the new ones have actual positions.
+//
+// Only the innermost pair enclosing the new tokens is paired again unless it fails, and the outer
+// pairs end after the same tokens as before. If every enclosing pair fails, the pass starts at the
+// outermost pair enclosing the replaced tokens, which may also end among them.
+QPair<int, int> TokenPairs::splice(int first,
+                                   int last,
+                                   const QVector<int>& positions,
+                                   const QVector<quint8>& kinds,
+                                   int delta) {
+  const bool isChanged = last > first || !positions.isEmpty();
+  QVector<int> opens;
+  QVector<int> closes;
+  int topLevel = first;
+  if (isChanged) {
+    for (int open = enclosingOpen(first, last); open >= 0; open = enclosingOpen(open, last)) {
+      opens.append(open);
+      closes.append(open + m_offsets[open]);
+    }
+    if (depthBefore(first) > 0) {
+      topLevel = valueAt(m_opens[0], lowerBound(m_opens[0], first) - 1);
+    }
+  }
+
+  const int count = positions.size();
+  m_positions.replace(first, last, positions);
+  m_positions.shift(first + count, delta);
+  m_kinds.remove(first, last - first);
+  m_kinds.insert(first, count, 0);
+  std::copy(kinds.begin(), kinds.end(), m_kinds.begin() + first);
+  m_offsets.remove(first, last - first);
+  m_offsets.insert(first, count, 0);
+  m_depths.remove(first, last - first);
+  m_depths.insert(first, count, 0);
+
+  if (!isChanged) {
+    return qMakePair(first, first);
+  }
+  const int countDelta = count - (last - first);
+  QVector<int> offsets;
+  int level = 0;
+  while (level < opens.size() && !pairRange(opens[level], closes[level] + countDelta, offsets)) {
+    level++;
+  }
+  if (level == opens.size()) {
+    int begin = topLevel;
+    const int end = pairTopLevel(begin, first, count, last, offsets);
+    const QPair<int, int> changed = setOffsets(begin, offsets, first, count, last);
+    updateDepths(begin, end, end - countDelta, 0);
+    return changed;
+  }
+
+  const int open = opens[level];
+  const QPair<int, int> changed = setOffsets(open, offsets, first, count, last);
+  updateDepths(open, closes[level] + countDelta + 1, closes[level] + 1, m_depths[open]);
+  for (int i = level + 1; i < opens.size(); i++) {
+    const int offset = closes[i] + countDelta - opens[i];
+    m_offsets[opens[i]] = offset;
+    m_offsets[opens[i] + offset] = -offset;
+  }
+  return changed;
+}
+
+int TokenPairs::lowerBound(const Values& values, int value) {
+  int lo = 0;
+  int hi = values.size();
+  while (lo < hi) {
+    const int mid = lo + (hi - lo) / 2;
+    if (valueAt(values, mid) < value) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+void TokenPairs::replaceValues(Values& values,
+                               int begin,
+                               int oldEnd,
+                               const QVector<int>& items,
+                               int delta) {
+  const int first = lowerBound(values, begin);
+  values.replace(first, lowerBound(values, oldEnd), items);
+  values.shift(first + items.size(), delta);
+}
+
+int TokenPairs::depthBefore(int index) const {
+  if (index == 0) {
+    return 0;
+  }
+  return m_depths[index - 1] + (m_offsets[index - 1] > 0 ? 1 : 0);
+}
+
+// A closing token pairs with the innermost opening token of its kind, and the opening tokens
+// inside them are left unpaired like "(" in "{ ( }". It's skipped if there is none. The count of
+// each kind in the stack keeps the pass linear.
+QVector<int> TokenPairs::pairAll() const {
+  TRACE_SCOPE("TokenPairs::pairAll");
+  const int size = m_positions.size();
+  QVector<int> offsets(size, 0);
+  QVector<int> opens;
+  int openCounts[KIND_COUNT / 2] = {};
+  for (int i = 0; i < size; i++) {
+    const int kind = m_kinds[i];
+    if (isOpening(kind)) {
+      opens.append(i);
+      openCounts[kind / 2]++;
+      continue;
+    }
+    if (openCounts[kind / 2] > 0) {
+      int open;
+      do {
+        open = opens.takeLast();
+        openCounts[m_kinds[open] / 2]--;
+      } while (m_kinds[open] != (kind ^ 1));
+      offsets[open] = i - open;
+      offsets[i] = open - i;
+    }
+  }
+  return offsets;
+}
+
+// Same as pairAll with the stack starting with open. The pairs outside don't change if every
+// closing token finds its kind in the stack and the one at close pairs with open, because the
+// stack after close is the same as before open.
+bool TokenPairs::pairRange(int open, int close, QVector<int>& offsets) const {
+  offsets.fill(0, close - open + 1);
+  QVector<int> opens{open};
+  int openCounts[KIND_COUNT / 2] = {};
+  openCounts[m_kinds[open] / 2]++;
+  for (int i = open + 1; i <= close; i++) {
+    const int kind = m_kinds[i];
+    if (isOpening(kind)) {
+      opens.append(i);
+      openCounts[kind / 2]++;
+      continue;
+    }
+    if (openCounts[kind / 2] == 0) {
+      return false;
+    }
+    int paired;
+    do {
+      paired = opens.takeLast();
+      openCounts[m_kinds[paired] / 2]--;
+    } while (m_kinds[paired] != (kind ^ 1));
+    if (paired == open && i != close) {
+      return false;
+    }
+    offsets[paired - open] = i - paired;
+    offsets[i - open] = paired - i;
+  }
+  return offsets[0] != 0;
+}
+
+// Same as pairAll with the stack starting with the unpaired opening tokens at depth 0 before
+// begin. If one of them is paired, the pass starts again from it.
+//
+// The pass stops before an old token after the new ones when no old pair encloses the gap and no
+// kind in the stack has an unpaired closing token after it. The stack is then the same as before
+// for the following tokens except for the kinds which pair with nothing there.
+int TokenPairs::pairTopLevel(int& begin,
+                             int first,
+                             int count,
+                             int last,
+                             QVector<int>& offsets) const {
+  TRACE_SCOPE("TokenPairs::pairTopLevel");
+  const int countDelta = count - (last - first);
+  const int size = m_positions.size();
+  int oldStrayCounts[KIND_COUNT / 2] = {};
+  for (int j = lowerBound(m_unpaired, last); j < m_unpaired.size(); j++) {
+    const int kind = m_kinds[valueAt(m_unpaired, j) + countDelta];
+    if (!isOpening(kind)) {
+      oldStrayCounts[kind / 2]++;
+    }
+  }
+
+  for (;;) {
+    QVector<int> opens;
+    int openCounts[KIND_COUNT / 2] = {};
+    for (int j = 0; j < m_unpaired.size() && valueAt(m_unpaired, j) < begin; j++) {
+      const int i = valueAt(m_unpaired, j);
+      if (m_depths[i] == 0 && isOpening(m_kinds[i])) {
+        opens.append(i);
+        openCounts[m_kinds[i] / 2]++;
+      }
+    }
+    int strayCounts[KIND_COUNT / 2];
+    std::copy(oldStrayCounts, oldStrayCounts + KIND_COUNT / 2, strayCounts);
+    offsets.clear();
+
+    int restart = -1;
+    int i = begin;
+    for (; i < size; i++) {
+      const int kind = m_kinds[i];
+      if (i >= first + count) {
+        bool isSettled = m_depths[i] == 0 && m_offsets[i] >= 0;
+        for (int k = 0; k < KIND_COUNT / 2 && isSettled; k++) {
+          isSettled = openCounts[k] == 0 || strayCounts[k] == 0;
+        }
+        if (isSettled) {
+          break;
+        }
+        if (m_offsets[i] == 0 && !isOpening(kind)) {
+          strayCounts[kind / 2]--;
+        }
+      }
+
+      offsets.append(0);
+      if (isOpening(kind)) {
+        opens.append(i);
+        openCounts[kind / 2]++;
+        continue;
+      }
+      if (openCounts[kind / 2] == 0) {
+        continue;
+      }
+      int open;
+      do {
+        open = opens.takeLast();
+        openCounts[m_kinds[open] / 2]--;
+      } while (m_kinds[open] != (kind ^ 1));
+      if (open < begin) {
+        restart = open;
+        break;
+      }
+      offsets[open - begin] = i - open;
+      offsets[i - begin] = open - i;
+    }
+    if (restart < 0) {
+      return i;
+    }
+    begin = restart;
+  }
+}
+
+// A token outside the new ones keeps its pair if the old offset, which is relative to its old
+// index, leads to the same token as the new one.
+QPair<int, int> TokenPairs::setOffsets(int begin,
+                                       const QVector<int>& offsets,
+                                       int first,
+                                       int count,
+                                       int last) {
+  const int countDelta = count - (last - first);
+  int changedFirst = first;
+  int changedLast = first + count;
+  for (int j = 0; j < offsets.size(); j++) {
+    const int i = begin + j;
+    const int oldOffset = m_offsets[i];
+    m_offsets[i] = offsets[j];
+    if (i >= first && i < first + count) {
+      continue;
+    }
+
+    bool isSame = oldOffset == offsets[j];
+    if (oldOffset != 0 && offsets[j] != 0) {
+      int oldPair = (i < first ? i : i - countDelta) + oldOffset;
+      if (oldPair >= last) {
+        oldPair += countDelta;
+      } else if (oldPair >= first) {
+        oldPair = -1;
+      }
+      isSame = oldPair == i + offsets[j];
+    }
+    if (!isSame) {
+      changedFirst = std::min(changedFirst, i);
+      changedLast = std::max(changedLast, i + 1);
+    }
+  }
+  return qMakePair(changedFirst, changedLast);
+}
+
+// The depth goes down at a closing token and up after an opening one. The entries of the lists in
+// the span are replaced and the following ones are moved like the tokens.
+void TokenPairs::updateDepths(int begin, int end, int oldEnd, int depth) {
+  QVector<QVector<int>> opens;
+  QVector<int> unpaired;
+  for (int i = begin; i < end; i++) {
+    const int offset = m_offsets[i];
+    if (offset < 0) {
+      depth--;
+    }
+    m_depths[i] = depth;
+    if (offset == 0) {
+      unpaired.append(i);
+    } else if (offset > 0) {
+      if (opens.size() <= depth) {
+        opens.resize(depth + 1);
+      }
+      opens[depth].append(i);
+      depth++;
+    }
+  }
+
+  const int delta = end - oldEnd;
+  if (m_opens.size() < opens.size()) {
+    m_opens.resize(opens.size());
+  }
+  for (int d = 0; d < m_opens.size(); d++) {
+    replaceValues(m_opens[d], begin, oldEnd, d < opens.size() ? opens[d] : QVector<int>(), delta);
+  }
+  while (!m_opens.isEmpty() && m_opens.last().isEmpty()) {
+    m_opens.removeLast();
+  }
+  replaceValues(m_unpaired, begin, oldEnd, unpaired, delta);
+}
+
+}  // namespace core
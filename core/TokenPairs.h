@@ -0,0 +1,110 @@
+#pragma once
+
+#include <QPair>
+#include <QVector>
+
+#include "macros.h"
+#include "PartitionedVector.h"
+
+namespace core {
+
+// Opening and closing tokens sorted by position and their pairs, such as the brackets of
+// BracketPairs and the indentation marks of FoldingRanges.
+//
+// The positions are moved lazily with the pending delta of PartitionedVector. The tokens are
+// paired with a stack in one pass on reset. When tokens are removed or inserted, only the ones in
+// the innermost pair enclosing them are paired again and the pairs enclosing it are moved. A token
+// closing one outside the pair, like "]" typed in "[{}]", widens the pass to the next enclosing
+// pair. Without an enclosing pair, the pass starts at the outermost pair around the tokens and
+// stops at the first point after them where the old pairs following it can't change.
+//
+// The pair of a token is kept as an offset, and the depth of each token as the number of the pairs
+// enclosing it. The opening tokens of the pairs are listed by depth, so the innermost pair
+// enclosing a position is found by binary search in the list of the depth there, and the one
+// enclosing that in the list of the depth above it.
+class TokenPairs {
+ public:
+  TokenPairs() = default;
+  ~TokenPairs() = default;
+  DEFAULT_COPY_AND_MOVE(TokenPairs)
+
+  // Kinds are less than KIND_COUNT. Opening ones are even and k ^ 1 closes k.
+  static const int KIND_COUNT = 6;
+
+  int size() const { return m_positions.size(); }
+  int positionAt(int i) const { return valueAt(m_positions, i); }
+  int kindAt(int i) const { return m_kinds[i]; }
+  // Returns the index of the token paired with the i-th one, or -1 if it's unpaired
+  int pairOf(int i) const { return m_offsets[i] != 0 ? i + m_offsets[i] : -1; }
+  // Returns the index of the first token at or after pos
+  int lowerBound(int pos) const { return lowerBound(m_positions, pos); }
+  // Returns the innermost paired opening token before index whose pair ends at or after end,
+  // or -1
+  int enclosingOpen(int index, int end) const;
+
+  // Replaces all the tokens and pairs them
+  void reset(const QVector<int>& positions, const QVector<quint8>& kinds);
+  // Replaces the tokens in [first, last) with the ones at actual positions, moves the following
+  // ones by delta and pairs them again. Returns the span [begin, end) of the tokens whose pairs
+  // have changed, including the new ones. The pairs which are only moved don't count.
+  QPair<int, int> splice(int first,
+                         int last,
+                         const QVector<int>& positions,
+                         const QVector<quint8>& kinds,
+                         int delta);
+
+ private:
+  struct Shift {
+    void operator()(int& value, int delta) const { value += delta; }
+  };
+  using Values = PartitionedVector<int, Shift>;
+
+  Values m_positions;
+  QVector<quint8> m_kinds;
+  // Offset from each token to its paired one, or 0. It doesn't change when tokens are inserted or
+  // removed outside the pair.
+  QVector<int> m_offsets;
+  // Number of the pairs enclosing each token, not counting its own
+  QVector<int> m_depths;
+  // Indices of the paired opening tokens at each depth
+  QVector<Values> m_opens;
+  // Indices of the unpaired tokens, which are few in most documents. The opening ones at depth 0
+  // are the stack between the pairs at depth 0.
+  Values m_unpaired;
+
+  static int valueAt(const Values& values, int i) {
+    return values.raw(i) + values.pendingDelta(i);
+  }
+  static int lowerBound(const Values& values, int value);
+  // Replaces the values in [begin, oldEnd) with the sorted items and moves the following ones by
+  // delta
+  static void replaceValues(Values& values,
+                            int begin,
+                            int oldEnd,
+                            const QVector<int>& items,
+                            int delta);
+
+  // Returns the number of the pairs enclosing the gap before index
+  int depthBefore(int index) const;
+
+  QVector<int> pairAll() const;
+  // Pairs the tokens from the opening one at open to close again into offsets. Returns false if
+  // open isn't paired with close anymore or a token may pair with one before open.
+  bool pairRange(int open, int close, QVector<int>& offsets) const;
+  // Pairs the tokens from begin, which no pair encloses, into offsets after the new tokens
+  // [first, first + count) have replaced the ones up to the old index last. begin may be moved
+  // back. Returns the end of the pass.
+  int pairTopLevel(int& begin, int first, int count, int last, QVector<int>& offsets) const;
+  // Sets the offsets of the tokens from begin after the new tokens [first, first + count) have
+  // replaced the ones up to the old index last, and returns the span of the changed pairs
+  QPair<int, int> setOffsets(int begin,
+                             const QVector<int>& offsets,
+                             int first,
+                             int count,
+                             int last);
+  // Updates the depths and the lists of the tokens in [begin, end) after they are paired again.
+  // They were the tokens up to the old index oldEnd and depth is the depth at begin.
+  void updateDepths(int begin, int end, int oldEnd, int depth);
+};
+
+}  // namespace core
@@ -0,0 +1,196 @@
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+#include <QVector>
+
+#include "Tracer.h"
+
+namespace core {
+
+namespace {
+// events kept per thread. Older events are overwritten.
+const int BUFFER_CAPACITY = 1 << 16;
+
+const QElapsedTimer& clock() {
+  static QElapsedTimer s_clock = [] {
+    QElapsedTimer timer;
+    timer.start();
+    return timer;
+  }();
+  return s_clock;
+}
+
+double toUsecs(qint64 nsecs) {
+  return nsecs / 1000.0;
+}
+}
+
+class Tracer::ThreadBuffer {
+  DISABLE_COPY_AND_MOVE(ThreadBuffer)
+
+ public:
+  ThreadBuffer(int tid, const QString& threadName)
+      : tid(tid), threadName(threadName), m_events(new Event[BUFFER_CAPACITY]), m_count(0) {}
+
+  const int tid;
+  const QString threadName;
+
+  void append(const Event& event) {
+    const quint64 count = m_count.load(std::memory_order_relaxed);
+    m_events[count % BUFFER_CAPACITY] = event;
+    m_count.store(count + 1, std::memory_order_release);
+  }
+
+  QVector<Event> events() const {
+    const quint64 count = m_count.load(std::memory_order_acquire);
+    const quint64 first = count > BUFFER_CAPACITY ? count - BUFFER_CAPACITY : 0;
+    QVector<Event> events;
+    events.reserve(count - first);
+    for (quint64 i = first; i < count; i++) {
+      events.append(m_events[i % BUFFER_CAPACITY]);
+    }
+    return events;
+  }
+
+  void clear() { m_count.store(0, std::memory_order_relaxed); }
+
+ private:
+  std::unique_ptr<Event[]> m_events;
+  std::atomic<quint64> m_count;
+};
+
+std::atomic<bool> Tracer::s_enabled(false);
+QMutex Tracer::s_mutex;
+std::vector<std::unique_ptr<Tracer::ThreadBuffer>> Tracer::s_buffers;
+
+qint64 Tracer::now() {
+  return clock().nsecsElapsed();
+}
+
+// Buffers are kept after their threads finish so that their events can be saved
+Tracer::ThreadBuffer* Tracer::threadBuffer() {
+  static thread_local ThreadBuffer* t_buffer = nullptr;
+  if (t_buffer) {
+    return t_buffer;
+  }
+
+  QThread* thread = QThread::currentThread();
+  QString name = thread->objectName();
+  if (QCoreApplication::instance() && thread == QCoreApplication::instance()->thread()) {
+    name = QStringLiteral("main");
+  }
+
+  QMutexLocker locker(&s_mutex);
+  const int tid = static_cast<int>(s_buffers.size()) + 1;
+  if (name.isEmpty()) {
+    name = QStringLiteral("thread %1").arg(tid);
+  }
+  s_buffers.push_back(std::unique_ptr<ThreadBuffer>(new ThreadBuffer(tid, name)));
+  t_buffer = s_buffers.back().get();
+  return t_buffer;
+}
+
+void Tracer::record(const char* name, char phase, qint64 timestamp, qint64 value) {
+  threadBuffer()->append(Event{name, phase, timestamp, value});
+}
+
+void Tracer::complete(const char* name, qint64 begin, qint64 end) {
+  record(name, 'X', begin, end - begin);
+}
+
+void Tracer::instant(const char* name) {
+  if (isEnabled()) {
+    record(name, 'i', now(), 0);
+  }
+}
+
+void Tracer::counter(const char* name, qint64 value) {
+  if (isEnabled()) {
+    record(name, 'C', now(), value);
+  }
+}
+
+void Tracer::start() {
+#ifndef SILK_TRACING
+  qWarning("tracing macros are disabled in this build. Build with ENABLE_TRACING=ON.");
+#endif
+  clock();
+  s_enabled.store(true, std::memory_order_relaxed);
+}
+
+void Tracer::stop() {
+  s_enabled.store(false, std::memory_order_relaxed);
+}
+
+bool Tracer::isRunning() {
+  return isEnabled();
+}
+
+void Tracer::reset() {
+  QMutexLocker locker(&s_mutex);
+  for (auto& buffer : s_buffers) {
+    buffer->clear();
+  }
+}
+
+QByteArray Tracer::toJson() {
+  const qint64 pid = QCoreApplication::applicationPid();
+  QJsonArray traceEvents;
+
+  QMutexLocker locker(&s_mutex);
+  for (const auto& buffer : s_buffers) {
+    QJsonObject metadata;
+    metadata.insert(QStringLiteral("name"), QStringLiteral("thread_name"));
+    metadata.insert(QStringLiteral("ph"), QStringLiteral("M"));
+    metadata.insert(QStringLiteral("pid"), pid);
+    metadata.insert(QStringLiteral("tid"), buffer->tid);
+    metadata.insert(QStringLiteral("args"),
+                    QJsonObject{{QStringLiteral("name"), buffer->threadName}});
+    traceEvents.append(metadata);
+
+    for (const Event& event : buffer->events()) {
+      QJsonObject obj;
+      obj.insert(QStringLiteral("name"), QString::fromLatin1(event.name));
+      obj.insert(QStringLiteral("ph"), QString(QLatin1Char(event.phase)));
+      obj.insert(QStringLiteral("pid"), pid);
+      obj.insert(QStringLiteral("tid"), buffer->tid);
+      obj.insert(QStringLiteral("ts"), toUsecs(event.timestamp));
+      switch (event.phase) {
+        case 'X':
+          obj.insert(QStringLiteral("dur"), toUsecs(event.value));
+          break;
+        case 'i':
+          obj.insert(QStringLiteral("s"), QStringLiteral("t"));
+          break;
+        case 'C':
+          obj.insert(QStringLiteral("args"),
+                     QJsonObject{{QStringLiteral("value"), static_cast<double>(event.value)}});
+          break;
+        default:
+          break;
+      }
+      traceEvents.append(obj);
+    }
+  }
+
+  QJsonObject root;
+  root.insert(QStringLiteral("traceEvents"), traceEvents);
+  root.insert(QStringLiteral("displayTimeUnit"), QStringLiteral("ns"));
+  return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
+
+bool Tracer::save(const QString& path) {
+  QFile file(path);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    qWarning() << "failed to open" << path;
+    return false;
+  }
+  return file.write(toJson()) >= 0;
+}
+
+}  // namespace core
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <QObject>
+#include <QMutex>
+#include <QString>
+
+#include "macros.h"
+#include "Singleton.h"
+
+// Tracing macros. They expand to nothing unless SILK_TRACING is defined
+// (cmake -DENABLE_TRACING=ON), so their arguments are not evaluated in normal builds.
+// name must be a string literal.
+#ifdef SILK_TRACING
+#define TRACE_CONCAT_INNER(x, y) x##y
+#define TRACE_CONCAT(x, y) TRACE_CONCAT_INNER(x, y)
+#define TRACE_SCOPE(name) core::TraceScope TRACE_CONCAT(traceScope_, __LINE__)(name)
+#define TRACE_INSTANT(name) core::Tracer::instant(name)
+#define TRACE_COUNTER(name, value) core::Tracer::counter(name, value)
+#else
+#define TRACE_SCOPE(name)
+#define TRACE_INSTANT(name)
+#define TRACE_COUNTER(name, value)
+#endif
+
+namespace core {
+
+// Records spans, instant events and counters in a ring buffer per thread and writes them in the
+// Chrome trace event format (chrome://tracing).
+//
+// Recording doesn't take a lock and doesn't allocate. When the tracer is stopped, the cost of a
+// span is a relaxed atomic load.
+class Tracer : public QObject, public Singleton<Tracer> {
+  Q_OBJECT
+
+ public:
+  struct Event {
+    // string literal
+    const char* name;
+    // 'X' (complete), 'i' (instant) or 'C' (counter)
+    char phase;
+    qint64 timestamp;
+    // duration in ns for 'X' and value for 'C'
+    qint64 value;
+  };
+
+  static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+  // nanoseconds since the app started
+  static qint64 now();
+
+  static void complete(const char* name, qint64 begin, qint64 end);
+  static void instant(const char* name);
+  static void counter(const char* name, qint64 value);
+
+  ~Tracer() = default;
+
+  // Returns the recorded events in the Chrome trace event format
+  QByteArray toJson();
+
+ public slots:
+  void start();
+  void stop();
+  bool isRunning();
+  // Call while stopped. Otherwise events being recorded may survive.
+  void reset();
+  bool save(const QString& path);
+
+ private:
+  friend class Singleton<Tracer>;
+
+  // Written only by its thread
+  class ThreadBuffer;
+
+  static std::atomic<bool> s_enabled;
+  static QMutex s_mutex;
+  static std::vector<std::unique_ptr<ThreadBuffer>> s_buffers;
+
+  static ThreadBuffer* threadBuffer();
+  static void record(const char* name, char phase, qint64 timestamp, qint64 value);
+
+  Tracer() = default;
+};
+
+// Records the time between its construction and destruction as a span
+class TraceScope {
+  DISABLE_COPY_AND_MOVE(TraceScope)
+
+ public:
+  explicit TraceScope(const char* name)
+      : m_name(Tracer::isEnabled() ? name : nullptr), m_begin(m_name ? Tracer::now() : 0) {}
+
+  ~TraceScope() {
+    if (m_name) {
+      Tracer::complete(m_name, m_begin, Tracer::now());
+    }
+  }
+
+ private:
+  const char* m_name;
+  qint64 m_begin;
+};
+
+}  // namespace core
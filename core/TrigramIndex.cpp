@@ -0,0 +1,932 @@
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QRegExp>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QTextCodec>
+
+#include "TrigramIndex.h"
+#include "Constants.h"
+#include "ProjectFileSystem.h"
+#include "Tracer.h"
+#include "Util.h"
+
+namespace core {
+
+namespace {
+const quint32 MAGIC = 0x49525453;  // "STRI"
+const quint32 VERSION = 1;
+// The index is rebuilt when more files than this have been changed since it was built
+const int REBUILD_THRESHOLD = 1000;
+// Same as ProjectSearch. Larger files are never searched.
+const qint64 MAX_FILE_SIZE = 32 * 1024 * 1024;
+const int BINARY_CHECK_LENGTH = 8000;
+// files read in parallel at a time while building
+const int BATCH_SIZE = 256;
+const int UTF8_MIB = 106;
+
+// Index file layout. Integers are in the native byte order.
+//
+// Header | FileEntry[fileCount] | TrigramEntry[trigramCount] (sorted by trigram) | postings |
+// paths | root path
+//
+// A posting list is the ids of the files containing the trigram in ascending order. The first id
+// and the deltas between ids are stored as varints.
+struct Header {
+  quint32 magic;
+  quint32 version;
+  quint32 fileCount;
+  quint32 trigramCount;
+  quint64 filesOffset;
+  quint64 trigramsOffset;
+  quint64 postingsOffset;
+  quint64 pathsOffset;
+  quint64 rootOffset;
+  quint64 rootSize;
+};
+
+enum FileFlag : quint32 {
+  Indexed = 0,
+  // not UTF-8. Always a candidate.
+  Unindexed = 1,
+  // binary, too large or unreadable. Never a candidate.
+  Skipped = 2,
+};
+
+struct FileEntry {
+  qint64 mtime;
+  qint64 size;
+  // relative to pathsOffset
+  quint32 pathOffset;
+  quint32 pathSize;
+  quint32 flags;
+  quint32 reserved;
+};
+
+struct TrigramEntry {
+  quint32 trigram;
+  quint32 count;
+  // relative to postingsOffset
+  quint64 offset;
+};
+
+struct FileInfo {
+  // relative to the root
+  QString path;
+  qint64 mtime;
+  qint64 size;
+};
+
+struct Posting {
+  Posting() : lastId(0), count(0) {}
+
+  quint32 lastId;
+  quint32 count;
+  QByteArray data;
+};
+
+bool isUtf8(const QByteArray& bytes) {
+  const uchar* p = reinterpret_cast<const uchar*>(bytes.constData());
+  const uchar* end = p + bytes.size();
+  while (p < end) {
+    if (*p < 0x80) {
+      p++;
+      continue;
+    }
+
+    int length;
+    if ((*p & 0xE0) == 0xC0 && *p >= 0xC2) {
+      length = 2;
+    } else if ((*p & 0xF0) == 0xE0) {
+      length = 3;
+    } else if ((*p & 0xF8) == 0xF0 && *p <= 0xF4) {
+      length = 4;
+    } else {
+      return false;
+    }
+    if (end - p < length) {
+      return false;
+    }
+    for (int i = 1; i < length; i++) {
+      if ((p[i] & 0xC0) != 0x80) {
+        return false;
+      }
+    }
+    p += length;
+  }
+  return true;
+}
+
+void appendVarint(QByteArray& out, quint32 value) {
+  while (value >= 0x80) {
+    out.append(static_cast<char>((value & 0x7F) | 0x80));
+    value >>= 7;
+  }
+  out.append(static_cast<char>(value));
+}
+
+bool readVarint(const uchar*& p, const uchar* end, quint32& value) {
+  value = 0;
+  for (int shift = 0; p < end && shift < 35; shift += 7) {
+    const uchar byte = *p++;
+    value |= static_cast<quint32>(byte & 0x7F) << shift;
+    if (!(byte & 0x80)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool isQuantifier(const QChar& ch) {
+  return ch == '?' || ch == '*' || ch == '+' || ch == '{';
+}
+
+// Returns the position after the quantifier at i
+int skipQuantifier(const QString& pattern, int i) {
+  if (i < pattern.size() && pattern[i] == '{') {
+    const int end = pattern.indexOf('}', i);
+    i = end < 0 ? pattern.size() : end + 1;
+  } else if (i < pattern.size() && isQuantifier(pattern[i])) {
+    i++;
+  }
+  // lazy or possessive
+  if (i < pattern.size() && (pattern[i] == '?' || pattern[i] == '+')) {
+    i++;
+  }
+  return i;
+}
+
+// Returns the position after the character class at i
+int skipClass(const QString& pattern, int i) {
+  i++;
+  if (i < pattern.size() && pattern[i] == '^') {
+    i++;
+  }
+  // ']' right after '[' is a literal
+  if (i < pattern.size() && pattern[i] == ']') {
+    i++;
+  }
+  int depth = 1;
+  while (i < pattern.size()) {
+    const QChar ch = pattern[i];
+    if (ch == '\\') {
+      i += 2;
+      continue;
+    }
+    i++;
+    if (ch == '[') {
+      depth++;
+    } else if (ch == ']' && --depth == 0) {
+      return i;
+    }
+  }
+  return pattern.size();
+}
+
+// Returns the position after the group at i
+int skipGroup(const QString& pattern, int i) {
+  int depth = 0;
+  while (i < pattern.size()) {
+    const QChar ch = pattern[i];
+    if (ch == '\\') {
+      i += 2;
+    } else if (ch == '[') {
+      i = skipClass(pattern, i);
+    } else {
+      i++;
+      if (ch == '(') {
+        depth++;
+      } else if (ch == ')' && --depth == 0) {
+        return i;
+      }
+    }
+  }
+  return pattern.size();
+}
+
+bool hasTopLevelAlternation(const QString& pattern) {
+  for (int i = 0; i < pattern.size();) {
+    const QChar ch = pattern[i];
+    if (ch == '|') {
+      return true;
+    } else if (ch == '\\') {
+      i += 2;
+    } else if (ch == '[') {
+      i = skipClass(pattern, i);
+    } else if (ch == '(') {
+      i = skipGroup(pattern, i);
+    } else {
+      i++;
+    }
+  }
+  return false;
+}
+
+// Returns literal strings which every match of the regex contains. Groups, classes and optional
+// characters are skipped, so the result may be empty even if the regex has such literals.
+QStringList requiredLiterals(const QString& pattern) {
+  // Inline options like (?x) change the meaning of the following characters
+  static const QRegExp s_options(QStringLiteral("\\(\\?[a-zA-Z-]"));
+  if (hasTopLevelAlternation(pattern) || QRegExp(s_options).indexIn(pattern) >= 0) {
+    return QStringList();
+  }
+
+  QStringList literals;
+  QString current;
+  auto flush = [&] {
+    if (!current.isEmpty()) {
+      literals.append(current);
+      current.clear();
+    }
+  };
+
+  int i = 0;
+  while (i < pattern.size()) {
+    const QChar ch = pattern[i];
+    QString literal;
+    if (ch == '\\') {
+      if (i + 1 >= pattern.size()) {
+        break;
+      }
+      const QChar escaped = pattern[i + 1];
+      i += 2;
+      if (!escaped.isLetterOrNumber()) {
+        literal = escaped;
+      } else {
+        flush();
+        // skip arguments of escapes like \x41, \p{Alpha} and \k<name>
+        if (escaped.isDigit() || QStringLiteral("xuopPkgcCM").contains(escaped)) {
+          while (i < pattern.size() &&
+                 (pattern[i].isLetterOrNumber() || QStringLiteral("{}<>-'").contains(pattern[i]))) {
+            i++;
+          }
+        }
+        i = skipQuantifier(pattern, i);
+        continue;
+      }
+    } else if (ch == '[' || ch == '(') {
+      flush();
+      i = ch == '[' ? skipClass(pattern, i) : skipGroup(pattern, i);
+      i = skipQuantifier(pattern, i);
+      continue;
+    } else if (ch == '.' || ch == '^' || ch == '$' || ch == ')' || isQuantifier(ch)) {
+      flush();
+      i = isQuantifier(ch) ? skipQuantifier(pattern, i) : i + 1;
+      continue;
+    } else if (ch.isHighSurrogate() && i + 1 < pattern.size()) {
+      literal = pattern.mid(i, 2);
+      i += 2;
+    } else {
+      literal = ch;
+      i++;
+    }
+
+    if (i < pattern.size() && isQuantifier(pattern[i])) {
+      // The character may not appear
+      if (pattern[i] != '+') {
+        flush();
+      } else {
+        current += literal;
+        flush();
+      }
+      i = skipQuantifier(pattern, i);
+    } else {
+      current += literal;
+    }
+  }
+  flush();
+
+  return literals;
+}
+
+bool writeIndex(const QString& indexPath,
+                const QString& rootPath,
+                const QVector<FileInfo>& files,
+                const QVector<quint32>& flags,
+                const std::unordered_map<quint32, Posting>& postings) {
+  QVector<quint32> trigrams;
+  trigrams.reserve(static_cast<int>(postings.size()));
+  for (const auto& pair : postings) {
+    trigrams.append(pair.first);
+  }
+  std::sort(trigrams.begin(), trigrams.end());
+
+  QVector<QByteArray> paths;
+  paths.reserve(files.size());
+  quint64 pathsSize = 0;
+  for (const FileInfo& file : files) {
+    paths.append(file.path.toUtf8());
+    pathsSize += paths.last().size();
+  }
+  quint64 postingsSize = 0;
+  for (const auto& pair : postings) {
+    postingsSize += pair.second.data.size();
+  }
+  const QByteArray root = rootPath.toUtf8();
+
+  Header header;
+  std::memset(&header, 0, sizeof(header));
+  header.magic = MAGIC;
+  header.version = VERSION;
+  header.fileCount = files.size();
+  header.trigramCount = trigrams.size();
+  header.filesOffset = sizeof(Header);
+  header.trigramsOffset = header.filesOffset + sizeof(FileEntry) * files.size();
+  header.postingsOffset = header.trigramsOffset + sizeof(TrigramEntry) * trigrams.size();
+  header.pathsOffset = header.postingsOffset + postingsSize;
+  header.rootOffset = header.pathsOffset + pathsSize;
+  header.rootSize = root.size();
+
+  QDir().mkpath(QFileInfo(indexPath).path());
+  QSaveFile file(indexPath);
+  if (!file.open(QIODevice::WriteOnly)) {
+    qWarning() << "failed to open" << indexPath;
+    return false;
+  }
+
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  quint32 pathOffset = 0;
+  for (int i = 0; i < files.size(); i++) {
+    FileEntry entry;
+    std::memset(&entry, 0, sizeof(entry));
+    entry.mtime = files[i].mtime;
+    entry.size = files[i].size;
+    entry.pathOffset = pathOffset;
+    entry.pathSize = paths[i].size();
+    entry.flags = flags[i];
+    file.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+    pathOffset += entry.pathSize;
+  }
+
+  quint64 postingOffset = 0;
+  for (quint32 trigram : trigrams) {
+    const Posting& posting = postings.at(trigram);
+    TrigramEntry entry{trigram, posting.count, postingOffset};
+    file.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+    postingOffset += posting.data.size();
+  }
+  for (quint32 trigram : trigrams) {
+    file.write(postings.at(trigram).data);
+  }
+  for (const QByteArray& path : paths) {
+    file.write(path);
+  }
+  file.write(root);
+
+  return file.commit();
+}
+
+// Reads a file and collects its trigrams
+class ExtractTask : public QRunnable {
+ public:
+  ExtractTask(const QString& path, QVector<quint32>* trigrams, quint32* flag)
+      : m_path(path), m_trigrams(trigrams), m_flag(flag) {}
+
+  void run() override { *m_flag = extract(); }
+
+ private:
+  QString m_path;
+  QVector<quint32>* m_trigrams;
+  quint32* m_flag;
+
+  quint32 extract() {
+    QFile file(m_path);
+    if (!file.open(QIODevice::ReadOnly)) {
+      return Skipped;
+    }
+    const qint64 size = file.size();
+    if (size > MAX_FILE_SIZE) {
+      return Skipped;
+    }
+    if (size == 0) {
+      return Indexed;
+    }
+
+    QByteArray bytes;
+    if (uchar* data = file.map(0, size)) {
+      bytes = QByteArray::fromRawData(reinterpret_cast<const char*>(data), size);
+    } else {
+      bytes = file.readAll();
+    }
+
+    if (QTextCodec* codec = QTextCodec::codecForUtfText(bytes, nullptr)) {
+      // UTF-16 and UTF-32
+      if (codec->mibEnum() != UTF8_MIB) {
+        return Unindexed;
+      }
+    } else if (std::memchr(bytes.constData(), 0, std::min(bytes.size(), BINARY_CHECK_LENGTH))) {
+      return Skipped;
+    }
+    if (!isUtf8(bytes)) {
+      return Unindexed;
+    }
+
+    *m_trigrams = TrigramIndex::trigrams(bytes);
+    return Indexed;
+  }
+};
+}
+
+class TrigramIndex::Table {
+  DISABLE_COPY_AND_MOVE(Table)
+
+ public:
+  // Returns null if the file doesn't exist or is broken
+  static std::shared_ptr<const Table> load(const QString& indexPath, const QString& rootPath) {
+    std::shared_ptr<Table> table(new Table(indexPath));
+    return table->init(rootPath) ? table : nullptr;
+  }
+
+  int fileCount() const { return m_header->fileCount; }
+
+  QString path(quint32 id) const {
+    const FileEntry& entry = m_files[id];
+    return QString::fromUtf8(m_paths + entry.pathOffset, entry.pathSize);
+  }
+
+  // -1 if the file isn't in the index
+  int id(const QString& path) const { return m_ids.value(path, -1); }
+
+  bool isUpToDate(int id, qint64 mtime, qint64 size) const {
+    return m_files[id].mtime == mtime && m_files[id].size == size;
+  }
+
+  const QVector<quint32>& unindexedIds() const { return m_unindexedIds; }
+
+  // Returns the sorted ids of indexed files containing all trigrams
+  QVector<quint32> lookup(const QVector<quint32>& trigrams) const {
+    QVector<const TrigramEntry*> entries;
+    const TrigramEntry* end = m_trigrams + m_header->trigramCount;
+    for (quint32 trigram : trigrams) {
+      const TrigramEntry* entry =
+          std::lower_bound(m_trigrams, end, trigram, [](const TrigramEntry& e, quint32 t) {
+            return e.trigram < t;
+          });
+      if (entry == end || entry->trigram != trigram) {
+        return QVector<quint32>();
+      }
+      entries.append(entry);
+    }
+    if (entries.isEmpty()) {
+      return QVector<quint32>();
+    }
+
+    // Intersect from the shortest list
+    std::sort(entries.begin(), entries.end(),
+              [](const TrigramEntry* x, const TrigramEntry* y) { return x->count < y->count; });
+    QVector<quint32> ids = decode(*entries[0]);
+    for (int i = 1; i < entries.size() && !ids.isEmpty(); i++) {
+      const QVector<quint32> other = decode(*entries[i]);
+      QVector<quint32> intersection;
+      std::set_intersection(ids.begin(), ids.end(), other.begin(), other.end(),
+                            std::back_inserter(intersection));
+      ids.swap(intersection);
+    }
+    return ids;
+  }
+
+ private:
+  QFile m_file;
+  const Header* m_header;
+  const FileEntry* m_files;
+  const TrigramEntry* m_trigrams;
+  const uchar* m_postings;
+  const uchar* m_postingsEnd;
+  const char* m_paths;
+  QHash<QString, int> m_ids;
+  QVector<quint32> m_unindexedIds;
+
+  explicit Table(const QString& indexPath)
+      : m_file(indexPath),
+        m_header(nullptr),
+        m_files(nullptr),
+        m_trigrams(nullptr),
+        m_postings(nullptr),
+        m_postingsEnd(nullptr),
+        m_paths(nullptr) {}
+
+  bool init(const QString& rootPath) {
+    if (!m_file.open(QIODevice::ReadOnly)) {
+      return false;
+    }
+    const quint64 size = m_file.size();
+    if (size < sizeof(Header)) {
+      return false;
+    }
+    const uchar* data = m_file.map(0, size);
+    if (!data) {
+      return false;
+    }
+
+    m_header = reinterpret_cast<const Header*>(data);
+    const Header& h = *m_header;
+    if (h.magic != MAGIC || h.version != VERSION || h.filesOffset != sizeof(Header) ||
+        h.trigramsOffset != h.filesOffset + sizeof(FileEntry) * quint64(h.fileCount) ||
+        h.postingsOffset != h.trigramsOffset + sizeof(TrigramEntry) * quint64(h.trigramCount) ||
+        h.pathsOffset < h.postingsOffset || h.rootOffset < h.pathsOffset ||
+        h.rootOffset + h.rootSize != size) {
+      qWarning() << m_file.fileName() << "is broken";
+      return false;
+    }
+    if (QString::fromUtf8(reinterpret_cast<const char*>(data + h.rootOffset), h.rootSize) !=
+        rootPath) {
+      return false;
+    }
+
+    m_files = reinterpret_cast<const FileEntry*>(data + h.filesOffset);
+    m_trigrams = reinterpret_cast<const TrigramEntry*>(data + h.trigramsOffset);
+    m_postings = data + h.postingsOffset;
+    m_postingsEnd = data + h.pathsOffset;
+    m_paths = reinterpret_cast<const char*>(data + h.pathsOffset);
+
+    const quint64 pathsSize = h.rootOffset - h.pathsOffset;
+    m_ids.reserve(h.fileCount);
+    for (quint32 id = 0; id < h.fileCount; id++) {
+      const FileEntry& entry = m_files[id];
+      if (quint64(entry.pathOffset) + entry.pathSize > pathsSize) {
+        qWarning() << m_file.fileName() << "is broken";
+        return false;
+      }
+      m_ids.insert(path(id), id);
+      if (entry.flags == Unindexed) {
+        m_unindexedIds.append(id);
+      }
+    }
+    return true;
+  }
+
+  QVector<quint32> decode(const TrigramEntry& entry) const {
+    QVector<quint32> ids;
+    if (entry.offset >= quint64(m_postingsEnd - m_postings)) {
+      return ids;
+    }
+
+    ids.reserve(entry.count);
+    const uchar* p = m_postings + entry.offset;
+    quint32 id = 0;
+    for (quint32 i = 0; i < entry.count; i++) {
+      quint32 delta;
+      if (!readVarint(p, m_postingsEnd, delta)) {
+        break;
+      }
+      id += delta;
+      if (id >= m_header->fileCount) {
+        break;
+      }
+      ids.append(id);
+    }
+    return ids;
+  }
+};
+
+TrigramIndex::Snapshot::Snapshot(const QString& rootPath,
+                                 std::shared_ptr<const Table> table,
+                                 const QSet<QString>& changedPaths)
+    : m_rootPath(rootPath), m_table(std::move(table)), m_changedPaths(changedPaths) {}
+
+bool TrigramIndex::Snapshot::toPrefix(const QString& dirPath, QString& prefix) const {
+  const QString dir = QDir::cleanPath(dirPath);
+  prefix.clear();
+  if (dir != m_rootPath) {
+    if (!dir.startsWith(m_rootPath + QLatin1Char('/'))) {
+      return false;
+    }
+    prefix = dir.mid(m_rootPath.size() + 1) + QLatin1Char('/');
+  }
+  return true;
+}
+
+bool TrigramIndex::Snapshot::canNarrow(const QString& text,
+                                       Document::FindFlags flags,
+                                       const QString& dirPath) const {
+  QString prefix;
+  return toPrefix(dirPath, prefix) && !queryTrigrams(text, flags).isEmpty();
+}
+
+boost::optional<QStringList> TrigramIndex::Snapshot::candidates(const QString& text,
+                                                                Document::FindFlags flags,
+                                                                const QString& dirPath) const {
+  const QVector<quint32> trigrams = queryTrigrams(text, flags);
+  QString prefix;
+  if (trigrams.isEmpty() || !toPrefix(dirPath, prefix)) {
+    return boost::none;
+  }
+
+  QStringList paths;
+  auto append = [&](const QString& path) {
+    if (path.startsWith(prefix)) {
+      paths.append(m_rootPath + QLatin1Char('/') + path);
+    }
+  };
+
+  QVector<quint32> ids = m_table->lookup(trigrams);
+  ids += m_table->unindexedIds();
+  for (quint32 id : ids) {
+    const QString path = m_table->path(id);
+    if (!m_changedPaths.contains(path)) {
+      append(path);
+    }
+  }
+  for (const QString& path : m_changedPaths) {
+    append(path);
+  }
+  return paths;
+}
+
+// table is null if the index couldn't be written or loaded
+struct TrigramIndex::BuildResult {
+  std::shared_ptr<const Table> table;
+  QSet<QString> changedPaths;
+};
+
+class TrigramIndex::BuildTask : public QRunnable {
+ public:
+  BuildTask(TrigramIndex* index, bool rebuild)
+      : m_index(index),
+        m_rootPath(index->m_rootPath),
+        m_indexPath(index->m_indexPath),
+        m_table(rebuild ? nullptr : index->m_table),
+        m_rebuild(rebuild) {
+    for (const ProjectFileSystem::Entry& entry : index->m_fileSystem->files()) {
+      m_files.append(FileInfo{entry.name, entry.mtime, entry.size});
+    }
+  }
+
+  void run() override {
+    TRACE_SCOPE("TrigramIndex::BuildTask");
+    std::unique_ptr<BuildResult> result(new BuildResult());
+
+    std::shared_ptr<const Table> table = m_table;
+    if (!table && !m_rebuild) {
+      table = Table::load(m_indexPath, m_rootPath);
+    }
+    if (table) {
+      QSet<QString> changedPaths;
+      for (const FileInfo& file : m_files) {
+        const int id = table->id(file.path);
+        if (id < 0 || !table->isUpToDate(id, file.mtime, file.size)) {
+          changedPaths.insert(file.path);
+        }
+      }
+      if (changedPaths.size() <= REBUILD_THRESHOLD) {
+        result->table = table;
+        result->changedPaths = changedPaths;
+        deliver(std::move(result));
+        return;
+      }
+    }
+
+    switch (build(m_files)) {
+      case BuildStatus::Canceled:
+        // The index is being destroyed
+        return;
+      case BuildStatus::Failed:
+        break;
+      case BuildStatus::Built:
+        result->table = Table::load(m_indexPath, m_rootPath);
+        break;
+    }
+    deliver(std::move(result));
+  }
+
+ private:
+  TrigramIndex* m_index;
+  const QString m_rootPath;
+  const QString m_indexPath;
+  const std::shared_ptr<const Table> m_table;
+  const bool m_rebuild;
+  QVector<FileInfo> m_files;
+
+  enum class BuildStatus { Built, Canceled, Failed };
+
+  BuildStatus build(const QVector<FileInfo>& files) {
+    TRACE_SCOPE("TrigramIndex::build");
+    QVector<quint32> flags(files.size());
+    std::unordered_map<quint32, Posting> postings;
+    QThreadPool workers;
+
+    // Files are read in parallel and their trigrams are added in the order of ids, so posting
+    // lists are sorted without sorting.
+    for (int begin = 0; begin < files.size(); begin += BATCH_SIZE) {
+      if (m_index->m_canceled.load(std::memory_order_relaxed)) {
+        return BuildStatus::Canceled;
+      }
+
+      const int end = std::min(begin + BATCH_SIZE, files.size());
+      QVector<QVector<quint32>> trigrams(end - begin);
+      for (int id = begin; id < end; id++) {
+        workers.start(new ExtractTask(m_rootPath + QLatin1Char('/') + files[id].path,
+                                      &trigrams[id - begin], &flags[id]));
+      }
+      workers.waitForDone();
+
+      for (int id = begin; id < end; id++) {
+        for (quint32 trigram : trigrams[id - begin]) {
+          Posting& posting = postings[trigram];
+          appendVarint(posting.data, posting.count == 0 ? id : id - posting.lastId);
+          posting.lastId = id;
+          posting.count++;
+        }
+      }
+    }
+
+    return writeIndex(m_indexPath, m_rootPath, files, flags, postings) ? BuildStatus::Built
+                                                                       : BuildStatus::Failed;
+  }
+
+  void deliver(std::unique_ptr<BuildResult> result) {
+    {
+      QMutexLocker locker(&m_index->m_resultMutex);
+      m_index->m_result = std::move(result);
+    }
+    QMetaObject::invokeMethod(m_index, "onBuilt", Qt::QueuedConnection);
+  }
+};
+
+QString TrigramIndex::defaultIndexPath(const QString& rootPath) {
+  const QByteArray hash =
+      QCryptographicHash::hash(QDir::cleanPath(rootPath).toUtf8(), QCryptographicHash::Sha1);
+  return Constants::singleton().indexDirPath() + QLatin1Char('/') +
+         QString::fromLatin1(hash.toHex()) + QStringLiteral(".trigrams");
+}
+
+QVector<quint32> TrigramIndex::queryTrigrams(const QString& text, Document::FindFlags flags) {
+  const bool isRegex = flags & Document::FindFlag::FindRegex;
+  const QStringList literals = isRegex ? requiredLiterals(text) : QStringList(text);
+  // Non-ASCII characters are folded by Unicode rules in case insensitive search, so they are used
+  // only in case sensitive search.
+  const bool useNonAscii = flags & Document::FindFlag::FindCaseSensitively;
+
+  QVector<quint32> trigrams;
+  for (const QString& literal : literals) {
+    const QByteArray bytes = literal.toUtf8();
+    for (int i = 0; i + 3 <= bytes.size(); i++) {
+      const uchar b0 = Util::toAsciiLower(static_cast<uchar>(bytes[i]));
+      const uchar b1 = Util::toAsciiLower(static_cast<uchar>(bytes[i + 1]));
+      const uchar b2 = Util::toAsciiLower(static_cast<uchar>(bytes[i + 2]));
+      if (!useNonAscii && (b0 >= 0x80 || b1 >= 0x80 || b2 >= 0x80)) {
+        continue;
+      }
+      trigrams.append(b0 << 16 | b1 << 8 | b2);
+    }
+  }
+
+  std::sort(trigrams.begin(), trigrams.end());
+  trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+  return trigrams;
+}
+
+QVector<quint32> TrigramIndex::trigrams(const QByteArray& bytes) {
+  // A bitmap of all trigrams to deduplicate them without sorting every occurrence
+  static thread_local std::vector<quint64> t_seen;
+  if (t_seen.empty()) {
+    t_seen.resize((1 << 24) / 64);
+  }
+
+  QVector<quint32> trigrams;
+  if (bytes.size() < 3) {
+    return trigrams;
+  }
+
+  const uchar* data = reinterpret_cast<const uchar*>(bytes.constData());
+  quint32 trigram =
+      Util::toAsciiLower(data[0]) << 8 | Util::toAsciiLower(data[1]);
+  for (int i = 2; i < bytes.size(); i++) {
+    trigram = (trigram << 8 | Util::toAsciiLower(data[i])) & 0xFFFFFF;
+    quint64& word = t_seen[trigram >> 6];
+    const quint64 bit = quint64(1) << (trigram & 63);
+    if (!(word & bit)) {
+      word |= bit;
+      trigrams.append(trigram);
+    }
+  }
+
+  for (quint32 t : trigrams) {
+    t_seen[t >> 6] &= ~(quint64(1) << (t & 63));
+  }
+  std::sort(trigrams.begin(), trigrams.end());
+  return trigrams;
+}
+
+TrigramIndex::TrigramIndex(ProjectFileSystem* fileSystem, const QString& indexPath, QObject* parent)
+    : QObject(parent),
+      m_fileSystem(fileSystem),
+      m_rootPath(fileSystem->rootPath()),
+      m_indexPath(indexPath),
+      m_canceled(false),
+      m_updateRequested(false),
+      m_building(false) {
+  m_pool.setMaxThreadCount(1);
+  connect(fileSystem, &ProjectFileSystem::ready, this, [=] {
+    if (m_updateRequested) {
+      startBuild(false);
+    }
+  });
+  connect(fileSystem, &ProjectFileSystem::changed, this, &TrigramIndex::onFilesChanged);
+}
+
+TrigramIndex::~TrigramIndex() {
+  m_canceled.store(true, std::memory_order_relaxed);
+  m_pool.waitForDone();
+}
+
+std::shared_ptr<const TrigramIndex::Snapshot> TrigramIndex::snapshot() const {
+  if (!m_table) {
+    return nullptr;
+  }
+  return std::make_shared<const Snapshot>(m_rootPath, m_table, m_changedPaths);
+}
+
+void TrigramIndex::update() {
+  // The files are compared with the index after the first crawl
+  m_updateRequested = true;
+  if (m_fileSystem->isReady()) {
+    startBuild(false);
+  }
+}
+
+void TrigramIndex::markChanged(const QString& path) {
+  QString relativePath;
+  if (!m_fileSystem->toRelativePath(path, relativePath) || relativePath.isEmpty()) {
+    return;
+  }
+
+  for (const QString& name : relativePath.split(QLatin1Char('/'))) {
+    if (m_fileSystem->isIgnored(name)) {
+      return;
+    }
+  }
+  addChanged(relativePath);
+  rebuildIfNeeded();
+}
+
+void TrigramIndex::startBuild(bool rebuild) {
+  if (m_building) {
+    return;
+  }
+
+  m_building = true;
+  m_changedWhileBuilding.clear();
+  m_pool.start(new BuildTask(this, rebuild));
+}
+
+void TrigramIndex::rebuildIfNeeded() {
+  if (m_table && m_changedPaths.size() > REBUILD_THRESHOLD) {
+    startBuild(true);
+  }
+}
+
+void TrigramIndex::onBuilt() {
+  std::unique_ptr<BuildResult> result;
+  {
+    QMutexLocker locker(&m_resultMutex);
+    result = std::move(m_result);
+  }
+  if (!result) {
+    return;
+  }
+
+  m_building = false;
+  // The current table and the changed paths are kept. The next update or rebuildIfNeeded retries.
+  if (!result->table) {
+    qWarning("failed to build the index of %s", qPrintable(m_rootPath));
+    m_changedWhileBuilding.clear();
+    return;
+  }
+
+  m_table = result->table;
+  m_changedPaths = result->changedPaths;
+  m_changedPaths.unite(m_changedWhileBuilding);
+  m_changedWhileBuilding.clear();
+  emit ready();
+  rebuildIfNeeded();
+}
+
+void TrigramIndex::onFilesChanged(const ProjectFileSystem::Changes& changes) {
+  // The files found by the first crawl are compared with the index by BuildTask
+  if (!m_fileSystem->isReady()) {
+    return;
+  }
+
+  for (const QStringList* paths : {&changes.addedFiles, &changes.modifiedFiles}) {
+    for (const QString& path : *paths) {
+      addChanged(path);
+    }
+  }
+  rebuildIfNeeded();
+}
+
+void TrigramIndex::addChanged(const QString& relativePath) {
+  m_changedPaths.insert(relativePath);
+  if (m_building) {
+    m_changedWhileBuilding.insert(relativePath);
+  }
+}
+
+}  // namespace core
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <boost/optional.hpp>
+#include <QMutex>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+#include <QThreadPool>
+#include <QVector>
+
+#include "macros.h"
+#include "Document.h"
+#include "ProjectFileSystem.h"
+
+namespace core {
+
+// Trigram index of the files in a project directory.
+//
+// The index maps each trigram (3 bytes with ASCII letters in lower case) of file contents to the
+// files containing it. ProjectSearch runs Regexp only on the files which contain all trigrams of
+// a query.
+//
+// The index is built in the background and saved in a file which is mapped on the next launch.
+// Files changed after the build are tracked from ProjectFileSystem and markChanged, and are
+// searched without the index until it's rebuilt.
+class TrigramIndex : public QObject {
+  Q_OBJECT
+  DISABLE_COPY(TrigramIndex)
+
+ public:
+  // Index data mapped from an index file. Immutable.
+  class Table;
+
+  // The index at some point. Thread safe.
+  class Snapshot {
+   public:
+    Snapshot(const QString& rootPath,
+             std::shared_ptr<const Table> table,
+             const QSet<QString>& changedPaths);
+
+    // Returns true if candidates narrows the files for the query. It only looks at the query, so
+    // it's cheap enough for the GUI thread, unlike candidates.
+    bool canNarrow(const QString& text, Document::FindFlags flags, const QString& dirPath) const;
+
+    // Returns the files under dirPath which may contain matches of the query.
+    // Returns none if the query can't be narrowed.
+    boost::optional<QStringList> candidates(const QString& text,
+                                            Document::FindFlags flags,
+                                            const QString& dirPath) const;
+
+   private:
+    const QString m_rootPath;
+
+    // Sets prefix to the relative path of dirPath with a trailing slash. Returns false if dirPath
+    // isn't under the root.
+    bool toPrefix(const QString& dirPath, QString& prefix) const;
+
+    const std::shared_ptr<const Table> m_table;
+    // relative paths
+    const QSet<QString> m_changedPaths;
+  };
+
+  static QString defaultIndexPath(const QString& rootPath);
+
+  // Returns sorted trigrams every match of the query contains. Empty if there is no such trigram.
+  static QVector<quint32> queryTrigrams(const QString& text, Document::FindFlags flags);
+  // Returns sorted unique trigrams of bytes
+  static QVector<quint32> trigrams(const QByteArray& bytes);
+
+  // The files are taken from fileSystem, which must outlive the index
+  TrigramIndex(ProjectFileSystem* fileSystem, const QString& indexPath, QObject* parent = nullptr);
+  // Waits for the build
+  ~TrigramIndex();
+  DEFAULT_MOVE(TrigramIndex)
+
+  QString rootPath() const { return m_rootPath; }
+  bool isReady() const { return m_table != nullptr; }
+  // null if the index isn't ready
+  std::shared_ptr<const Snapshot> snapshot() const;
+
+ public slots:
+  // Loads the index file and checks files changed since it was saved in the background once the
+  // file system is ready. The index is rebuilt if it doesn't exist or many files have been changed.
+  void update();
+  // The file is searched without the index until the index is rebuilt
+  void markChanged(const QString& path);
+
+ signals:
+  void ready();
+
+ private:
+  struct BuildResult;
+  class BuildTask;
+
+  ProjectFileSystem* m_fileSystem;
+  const QString m_rootPath;
+  const QString m_indexPath;
+  QThreadPool m_pool;
+  std::atomic<bool> m_canceled;
+  bool m_updateRequested;
+  bool m_building;
+  std::shared_ptr<const Table> m_table;
+  // relative paths of changed files
+  QSet<QString> m_changedPaths;
+  // relative paths marked while building
+  QSet<QString> m_changedWhileBuilding;
+
+  QMutex m_resultMutex;
+  std::unique_ptr<BuildResult> m_result;
+
+  void startBuild(bool rebuild);
+  void rebuildIfNeeded();
+  void addChanged(const QString& relativePath);
+
+ private slots:
+  void onBuilt();
+  void onFilesChanged(const core::ProjectFileSystem::Changes& changes);
+};
+
+}  // namespace core
@@ -79,6 +79,14 @@ int Util::binarySearch(int last, std::function<bool(int)> fn) {
   return low;
 }
 
+QByteArray Util::toAsciiLower(const QByteArray& bytes) {
+  QByteArray lowerBytes = bytes;
+  for (char& ch : lowerBytes) {
+    ch = toAsciiLower(ch);
+  }
+  return lowerBytes;
+}
+
 void Util::ensureDir(const QString& path) {
   QDir::root().mkpath(QFileInfo(path).dir().path());
 }
@@ -20,6 +20,12 @@ class Util {
 
  public:
   static int binarySearch(int last, std::function<bool(int)> fn);
+
+  // Lowers ASCII letters only, so UTF-8 bytes keep their lengths and offsets
+  static char toAsciiLower(char ch) { return ch >= 'A' && ch <= 'Z' ? ch + ('a' - 'A') : ch; }
+  static uchar toAsciiLower(uchar ch) { return toAsciiLower(static_cast<char>(ch)); }
+  static QByteArray toAsciiLower(const QByteArray& bytes);
+
   static void ensureDir(const QString& path);
 
   /**
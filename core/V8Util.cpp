@@ -1,7 +1,9 @@
+#include <algorithm>
 #include <node_buffer.h>
 #include <sstream>
 #include <QDebug>
 #include <QLoggingCategory>
+#include <QCoreApplication>
 
 #include "V8Util.h"
 #include "ObjectStore.h"
@@ -40,10 +42,68 @@ using v8::Null;
 using v8::FunctionTemplate;
 using v8::TryCatch;
 
+namespace {
+
+// Returns the type of QVariant which V8Util::toVariant returns for value if it's a primitive type.
+// Otherwise returns QMetaType::UnknownType.
+int primitiveTypeId(v8::Local<v8::Value> value) {
+  if (value->IsBoolean()) {
+    return QMetaType::Bool;
+  } else if (value->IsInt32()) {
+    return QMetaType::Int;
+  } else if (value->IsUint32()) {
+    return QMetaType::UInt;
+  } else if (value->IsNumber()) {
+    return QMetaType::Double;
+  } else if (value->IsString()) {
+    return QMetaType::QString;
+  }
+  return QMetaType::UnknownType;
+}
+
+bool isPrimitiveType(int typeId) {
+  return typeId == QMetaType::Bool || typeId == QMetaType::Int || typeId == QMetaType::UInt ||
+         typeId == QMetaType::Double || typeId == QMetaType::QString;
+}
+
+// Holds QString to share its UTF-16 buffer with a JS string
+class QStringResource : public v8::String::ExternalStringResource {
+ public:
+  QStringResource(v8::Isolate* isolate, const QString& str) : m_isolate(isolate), m_str(str) {
+    m_isolate->AdjustAmountOfExternalAllocatedMemory(byteLength());
+  }
+
+  ~QStringResource() { m_isolate->AdjustAmountOfExternalAllocatedMemory(-byteLength()); }
+
+  const uint16_t* data() const override {
+    return reinterpret_cast<const uint16_t*>(m_str.constData());
+  }
+
+  size_t length() const override { return m_str.size(); }
+
+ private:
+  v8::Isolate* m_isolate;
+  const QString m_str;
+
+  int64_t byteLength() const { return m_str.size() * sizeof(QChar); }
+};
+
+bool inherits(const QMetaObject* metaObj, const QMetaObject* superMetaObj) {
+  for (; metaObj; metaObj = metaObj->superClass()) {
+    if (metaObj == superMetaObj) {
+      return true;
+    }
+  }
+  return false;
+}
+}
+
 namespace core {
 
 v8::Persistent<v8::String> V8Util::s_hiddenQObjectKey;
 v8::Persistent<v8::String> V8Util::s_constructorKey;
+QHash<QPair<const QMetaObject*, QByteArray>, BoundMethod*> V8Util::s_boundMethods;
+QMutex V8Util::s_boundMethodsMutex;
 
 v8::Local<v8::String> V8Util::hiddenQObjectKey(Isolate* isolate) {
   if (s_hiddenQObjectKey.IsEmpty()) {
@@ -158,6 +218,13 @@ v8::Local<v8::Value> V8Util::toV8Value(v8::Isolate* isolate, const QVariant& var
       array->Set(i++, toV8Value(isolate, v));
     }
     return array;
+  } else if (var.type() == QVariant::Map) {
+    const QVariantMap& map = var.toMap();
+    Local<Object> obj = Object::New(isolate);
+    for (auto it = map.constBegin(); it != map.constEnd(); it++) {
+      obj->Set(toV8String(isolate, it.key()), toV8Value(isolate, it.value()));
+    }
+    return obj;
   } else if (var.canConvert<JSNull>()) {
     return v8::Null(isolate);
   } else if (isEnum(var)) {
@@ -296,10 +363,55 @@ void V8Util::throwError(v8::Isolate* isolate, const char* msg) {
       v8::String::NewFromUtf8(isolate, msg, v8::NewStringType::kNormal).ToLocalChecked()));
 }
 
-void V8Util::invokeQObjectMethod(const v8::FunctionCallbackInfo<v8::Value>& args) {
+v8::Local<v8::String> V8Util::toV8String(v8::Isolate* isolate, const QString& str) {
+  if (str.size() < EXTERNAL_STRING_MIN_LENGTH) {
+    return String::NewFromTwoByte(isolate, str.utf16(), v8::NewStringType::kNormal, str.size())
+        .ToLocalChecked();
+  }
+
+  QStringResource* resource = new QStringResource(isolate, str);
+  MaybeLocal<String> maybeStr = String::NewExternalTwoByte(isolate, resource);
+  if (maybeStr.IsEmpty()) {
+    // too long
+    delete resource;
+    qWarning() << "Failed to create an external string. length:" << str.size();
+    return String::Empty(isolate);
+  }
+  return maybeStr.ToLocalChecked();
+}
+
+const BoundMethod* V8Util::bindMethod(const QMetaObject* metaObj, const QByteArray& name) {
+  const auto key = qMakePair(metaObj, name);
+  QMutexLocker locker(&s_boundMethodsMutex);
+  if (BoundMethod* method = s_boundMethods.value(key)) {
+    return method;
+  }
+
+  BoundMethod* method = new BoundMethod();
+  method->metaObj = metaObj;
+  method->name = name;
+  method->methodInfos = QObjectUtil::methods(metaObj, QString::fromLatin1(name));
+  for (const auto& methodInfo : method->methodInfos) {
+    const QMetaMethod& metaMethod = metaObj->method(methodInfo.first);
+    BoundMethod::Overload overload;
+    overload.index = methodInfo.first;
+    overload.returnType = metaMethod.returnType();
+    overload.isFast = metaMethod.access() == QMetaMethod::Public &&
+                      (overload.returnType == QMetaType::Void ||
+                       isPrimitiveType(overload.returnType));
+    for (int i = 0; i < metaMethod.parameterCount(); i++) {
+      overload.parameterTypeIds.append(metaMethod.parameterType(i));
+      overload.isFast = overload.isFast && isPrimitiveType(metaMethod.parameterType(i));
+    }
+    method->overloads.append(overload);
+  }
+
+  s_boundMethods.insert(key, method);
+  return method;
+}
+
+void V8Util::invokeBoundQObjectMethod(const v8::FunctionCallbackInfo<v8::Value>& args) {
   Isolate* isolate = args.GetIsolate();
-  //  const QString& funcName = toQString(args.Callee()->GetName()->ToString());
-  //  qDebug() << "invoking" << funcName;
 
   QObject* obj = ObjectStore::unwrap(args.Holder());
   if (!obj) {
@@ -307,6 +419,39 @@ void V8Util::invokeQObjectMethod(const v8::FunctionCallbackInfo<v8::Value>& args
     return;
   }
 
+  Q_ASSERT(args.Data()->IsExternal());
+  const BoundMethod* method =
+      static_cast<const BoundMethod*>(args.Data().As<v8::External>()->Value());
+  Q_ASSERT(method);
+
+  // The function can be applied to an object of another class (e.g. with Function.prototype.call)
+  const bool isBound = inherits(obj->metaObject(), method->metaObj);
+
+  // Fast path. QObjectUtil accepts null for any parameter, so the overload can be decided here only
+  // when all the arguments are primitive. The overloads are tried in the same order as QObjectUtil.
+  if (isBound && args.Length() <= MAX_ARGS_COUNT) {
+    int typeIds[MAX_ARGS_COUNT];
+    bool isPrimitive = true;
+    for (int i = 0; i < args.Length() && isPrimitive; i++) {
+      typeIds[i] = primitiveTypeId(args[i]);
+      isPrimitive = typeIds[i] != QMetaType::UnknownType;
+    }
+
+    for (int i = 0; isPrimitive && i < method->overloads.size(); i++) {
+      const BoundMethod::Overload& overload = method->overloads[i];
+      if (!overload.isFast) {
+        break;
+      }
+
+      if (overload.parameterTypeIds.size() == args.Length() &&
+          std::equal(overload.parameterTypeIds.constBegin(), overload.parameterTypeIds.constEnd(),
+                     typeIds)) {
+        invokeFast(obj, overload, args);
+        return;
+      }
+    }
+  }
+
   // convert args to QVariantList
   QVariantList varArgs;
   for (int i = 0; i < args.Length(); i++) {
@@ -314,8 +459,10 @@ void V8Util::invokeQObjectMethod(const v8::FunctionCallbackInfo<v8::Value>& args
   }
 
   try {
-    QVariant result = QObjectUtil::invokeQObjectMethodInternal(
-        obj, toQString(args.Callee()->GetName()->ToString()), varArgs);
+    QVariant result =
+        isBound ? QObjectUtil::invokeQObjectMethodInternal(obj, method->methodInfos, varArgs)
+                : QObjectUtil::invokeQObjectMethodInternal(obj, QString::fromLatin1(method->name),
+                                                           varArgs);
     if (result.isValid()) {
       args.GetReturnValue().Set(toV8Value(isolate, result));
     }
@@ -326,6 +473,84 @@ void V8Util::invokeQObjectMethod(const v8::FunctionCallbackInfo<v8::Value>& args
   }
 }
 
+// Calls qt_metacall directly with the arguments converted from JS values without QVariant
+void V8Util::invokeFast(QObject* obj,
+                        const BoundMethod::Overload& overload,
+                        const v8::FunctionCallbackInfo<v8::Value>& args) {
+  union Primitive {
+    bool b;
+    int i;
+    uint u;
+    double d;
+  };
+
+  // index 0 is for the return value
+  Primitive primitives[MAX_ARGS_COUNT + 1];
+  QString strings[MAX_ARGS_COUNT + 1];
+  void* argv[MAX_ARGS_COUNT + 1];
+
+  switch (overload.returnType) {
+    case QMetaType::Void:
+      argv[0] = nullptr;
+      break;
+    case QMetaType::QString:
+      argv[0] = &strings[0];
+      break;
+    default:
+      argv[0] = &primitives[0];
+      break;
+  }
+
+  for (int i = 0; i < args.Length(); i++) {
+    switch (overload.parameterTypeIds[i]) {
+      case QMetaType::Bool:
+        primitives[i + 1].b = args[i].As<Boolean>()->Value();
+        argv[i + 1] = &primitives[i + 1].b;
+        break;
+      case QMetaType::Int:
+        primitives[i + 1].i = args[i].As<v8::Int32>()->Value();
+        argv[i + 1] = &primitives[i + 1].i;
+        break;
+      case QMetaType::UInt:
+        primitives[i + 1].u = args[i].As<v8::Uint32>()->Value();
+        argv[i + 1] = &primitives[i + 1].u;
+        break;
+      case QMetaType::Double:
+        primitives[i + 1].d = args[i].As<v8::Number>()->Value();
+        argv[i + 1] = &primitives[i + 1].d;
+        break;
+      default:
+        Q_ASSERT(overload.parameterTypeIds[i] == QMetaType::QString);
+        strings[i + 1] = toQString(args[i].As<String>());
+        argv[i + 1] = &strings[i + 1];
+        break;
+    }
+  }
+
+  Q_ASSERT(obj->thread() == QCoreApplication::instance()->thread());
+  QMetaObject::metacall(obj, QMetaObject::InvokeMetaMethod, overload.index, argv);
+
+  switch (overload.returnType) {
+    case QMetaType::Bool:
+      args.GetReturnValue().Set(primitives[0].b);
+      break;
+    case QMetaType::Int:
+      args.GetReturnValue().Set(static_cast<int32_t>(primitives[0].i));
+      break;
+    case QMetaType::UInt:
+      args.GetReturnValue().Set(static_cast<uint32_t>(primitives[0].u));
+      break;
+    case QMetaType::Double:
+      args.GetReturnValue().Set(primitives[0].d);
+      break;
+    case QMetaType::QString:
+      args.GetReturnValue().Set(toV8String(args.GetIsolate(), strings[0]));
+      break;
+    default:
+      break;
+  }
+}
+
 void V8Util::emitQObjectSignal(const v8::FunctionCallbackInfo<v8::Value>& args) {
   //  qDebug() << "emitQObjectSignal";
 
@@ -8,6 +8,10 @@
 #include <QCache>
 #include <QMultiHash>
 #include <QKeyEvent>
+#include <QHash>
+#include <QMutex>
+#include <QPair>
+#include <QVector>
 
 #include "CommandArgument.h"
 #include "Util.h"
@@ -16,6 +20,28 @@
 namespace core {
 
 constexpr int MAX_ARGS_COUNT = 10;
+// Copying a short string is cheaper than allocating an external string resource
+constexpr int EXTERNAL_STRING_MIN_LENGTH = 1024;
+
+// Overloads of a method of a class resolved when the method is bound to a JS function.
+// A pointer to this is set in the data slot of the function template, so calling the method doesn't
+// look up the method by its name.
+struct BoundMethod {
+  struct Overload {
+    int index;
+    QVector<int> parameterTypeIds;
+    int returnType;
+    // true if the parameters and the return value are primitive types which can be converted
+    // directly from and to JS values without QVariant
+    bool isFast;
+  };
+
+  const QMetaObject* metaObj;
+  QByteArray name;
+  // in the order in which QObjectUtil tries them
+  QList<Overload> overloads;
+  QList<std::pair<int, ParameterTypes>> methodInfos;
+};
 
 // static class
 class V8Util {
@@ -35,9 +61,9 @@ class V8Util {
     return *value;
   }
 
-  static v8::Local<v8::String> toV8String(v8::Isolate* isolate, const QString& str) {
-    return v8::String::NewFromTwoByte(isolate, str.utf16());
-  }
+  // A string longer than EXTERNAL_STRING_MIN_LENGTH isn't copied. The JS string refers to the
+  // buffer of str and keeps it alive (QString is implicitly shared) until it's collected.
+  static v8::Local<v8::String> toV8String(v8::Isolate* isolate, const QString& str);
 
   static v8::Local<v8::String> toV8String(v8::Isolate* isolate, const std::string& str) {
     return v8::String::NewFromUtf8(isolate, str.c_str());
@@ -56,7 +82,11 @@ class V8Util {
   static void throwError(v8::Isolate* isolate, const std::string& msg);
   static void throwError(v8::Isolate* isolate, const char* msg);
 
-  static void invokeQObjectMethod(const v8::FunctionCallbackInfo<v8::Value>& args);
+  // Returns the method of the class resolved for invokeBoundQObjectMethod. The result is cached and
+  // lives until the app quits.
+  static const BoundMethod* bindMethod(const QMetaObject* metaObj, const QByteArray& name);
+  // Invokes the BoundMethod set as the data of the callee function template
+  static void invokeBoundQObjectMethod(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void emitQObjectSignal(const v8::FunctionCallbackInfo<v8::Value>& args);
 
   static QVariant callJSFunc(v8::Isolate* isolate,
@@ -76,12 +106,18 @@ class V8Util {
 
   static v8::Persistent<v8::String> s_hiddenQObjectKey;
   static v8::Persistent<v8::String> s_constructorKey;
+  // Shared by the isolates of workers, so it's guarded by s_boundMethodsMutex
+  static QHash<QPair<const QMetaObject*, QByteArray>, BoundMethod*> s_boundMethods;
+  static QMutex s_boundMethodsMutex;
 
   static void cacheMethods(const QMetaObject* metaObj);
   static v8::MaybeLocal<v8::Object> newInstance(v8::Isolate* isolate,
                                                 v8::Local<v8::Function> constructor,
                                                 void* sourceObj);
   static bool isEnum(QVariant var);
+  static void invokeFast(QObject* obj,
+                         const BoundMethod::Overload& overload,
+                         const v8::FunctionCallbackInfo<v8::Value>& args);
 };
 
 }  // namespace core
@@ -0,0 +1,106 @@
+#include <memory>
+#include <unordered_map>
+#include <unicode/brkiter.h>
+#include <QCache>
+#include <QDebug>
+#include <QPair>
+#include <QTextBlock>
+#include <QThreadStorage>
+
+#include "WordSegmenter.h"
+#include "IcuUtil.h"
+#include "stlSpecialization.h"
+
+namespace core {
+
+namespace {
+// max # of blocks whose boundaries are cached per thread
+const int BLOCK_CACHE_SIZE = 256;
+
+typedef QPair<const QTextDocument*, int> BlockKey;
+
+struct BlockBoundaries {
+  int revision;
+  QString locale;
+  QString text;
+  QVector<int> boundaries;
+};
+
+struct ThreadCache {
+  std::unordered_map<QString, std::unique_ptr<BreakIterator>> iterators;
+  QCache<BlockKey, BlockBoundaries> blocks;
+
+  ThreadCache() : blocks(BLOCK_CACHE_SIZE) {}
+};
+
+QThreadStorage<ThreadCache*> s_caches;
+
+ThreadCache& threadCache() {
+  if (!s_caches.hasLocalData()) {
+    s_caches.setLocalData(new ThreadCache());
+  }
+  return *s_caches.localData();
+}
+
+BreakIterator* createWordInstance(const QString& locale) {
+  UErrorCode status = U_ZERO_ERROR;
+  BreakIterator* iterator = BreakIterator::createWordInstance(IcuUtil::icuLocale(locale), status);
+  if (!iterator) {
+    qWarning() << "Failed to createWordInstance using locale:" << locale
+               << "use en_US locale instead";
+    status = U_ZERO_ERROR;
+    iterator = BreakIterator::createWordInstance(Locale::getUS(), status);
+    if (!iterator) {
+      throw std::runtime_error("Failed to createWordInstance using en_US locale");
+    }
+  }
+  return iterator;
+}
+}
+
+BreakIterator* WordSegmenter::iterator(const QString& locale) {
+  auto& iterators = threadCache().iterators;
+  auto it = iterators.find(locale);
+  if (it != iterators.end()) {
+    return it->second.get();
+  }
+
+  BreakIterator* iterator = createWordInstance(locale);
+  iterators[locale] = std::unique_ptr<BreakIterator>(iterator);
+  return iterator;
+}
+
+QVector<int> WordSegmenter::boundaries(const QString& text, const QString& locale) {
+  BreakIterator* boundary = iterator(locale);
+  const UnicodeString icuText = IcuUtil::toIcuString(text);
+  boundary->setText(icuText);
+
+  QVector<int> positions;
+  for (int32_t pos = boundary->first(); pos != BreakIterator::DONE; pos = boundary->next()) {
+    positions.append(pos);
+  }
+  return positions;
+}
+
+QVector<int> WordSegmenter::boundaries(const QTextBlock& block, const QString& locale) {
+  if (!block.isValid()) {
+    return QVector<int>();
+  }
+
+  // Block numbers are shifted by edits above, so the text is compared too
+  const QString text = block.text();
+  const BlockKey key(block.document(), block.blockNumber());
+  auto& blocks = threadCache().blocks;
+  if (BlockBoundaries* cached = blocks.object(key)) {
+    if (cached->revision == block.revision() && cached->locale == locale &&
+        cached->text == text) {
+      return cached->boundaries;
+    }
+  }
+
+  QVector<int> positions = boundaries(text, locale);
+  blocks.insert(key, new BlockBoundaries{block.revision(), locale, text, positions});
+  return positions;
+}
+
+}  // namespace core
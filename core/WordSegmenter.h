@@ -0,0 +1,32 @@
+#pragma once
+
+#include <unicode/brkiter.h>
+#include <QString>
+#include <QVector>
+
+class QTextBlock;
+
+namespace core {
+
+// Finds word boundaries with ICU (e.g. to split Japanese text into words).
+//
+// Creating a word break iterator is expensive because it loads dictionary data, so iterators are
+// kept per thread and locale. Boundaries of a block are cached until the block is changed.
+class WordSegmenter {
+ public:
+  // Returns the word boundaries in text. They include 0 and text.size().
+  static QVector<int> boundaries(const QString& text, const QString& locale);
+
+  // Same as above for the text of block (positions are relative to the block)
+  static QVector<int> boundaries(const QTextBlock& block, const QString& locale);
+
+  // Returns the word break iterator for locale owned by the current thread. Don't delete it.
+  // It keeps a reference to the text passed to setText, so the text must outlive its use.
+  static icu::BreakIterator* iterator(const QString& locale);
+
+ private:
+  WordSegmenter() = delete;
+  ~WordSegmenter() = delete;
+};
+
+}  // namespace core
@@ -0,0 +1,315 @@
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+
+#include "Worker.h"
+#include "Document.h"
+#include "V8Util.h"
+
+using v8::Isolate;
+using v8::Local;
+using v8::MaybeLocal;
+using v8::Context;
+using v8::Value;
+using v8::String;
+using v8::Object;
+using v8::Array;
+using v8::Function;
+using v8::FunctionTemplate;
+using v8::ObjectTemplate;
+using v8::HandleScope;
+using v8::TryCatch;
+
+namespace core {
+
+namespace {
+
+class ArrayBufferAllocator : public v8::ArrayBuffer::Allocator {
+ public:
+  void* Allocate(size_t length) override { return calloc(length, 1); }
+  void* AllocateUninitialized(size_t length) override { return malloc(length); }
+  void Free(void* data, size_t) override { free(data); }
+};
+
+// V8Util::toV8Value can't be used because it depends on ObjectStore of the main isolate
+Local<Value> toPlainValue(Isolate* isolate, const QVariant& var) {
+  switch (var.type()) {
+    case QVariant::Invalid:
+      return v8::Null(isolate);
+    case QVariant::Bool:
+      return v8::Boolean::New(isolate, var.toBool());
+    case QVariant::Int:
+      return v8::Int32::New(isolate, var.toInt());
+    case QVariant::UInt:
+      return v8::Uint32::NewFromUnsigned(isolate, var.toUInt());
+    case QVariant::LongLong:
+    case QVariant::ULongLong:
+    case QVariant::Double:
+      return v8::Number::New(isolate, var.toDouble());
+    case QVariant::String:
+      // a large string (e.g. a document snapshot) is shared without copying
+      return V8Util::toV8String(isolate, var.toString());
+    case QVariant::StringList:
+    case QVariant::List: {
+      const QVariantList& list = var.toList();
+      Local<Array> array = Array::New(isolate, list.size());
+      for (int i = 0; i < list.size(); i++) {
+        array->Set(i, toPlainValue(isolate, list[i]));
+      }
+      return array;
+    }
+    case QVariant::Map: {
+      const QVariantMap& map = var.toMap();
+      Local<Object> obj = Object::New(isolate);
+      for (auto it = map.constBegin(); it != map.constEnd(); it++) {
+        obj->Set(V8Util::toV8String(isolate, it.key()), toPlainValue(isolate, it.value()));
+      }
+      return obj;
+    }
+    default:
+      qWarning() << "can't pass" << var.typeName() << "to a worker";
+      return v8::Undefined(isolate);
+  }
+}
+
+QVariant toPlainVariant(Isolate* isolate, Local<Value> value) {
+  if (value->IsBoolean()) {
+    return QVariant::fromValue(value->ToBoolean()->Value());
+  } else if (value->IsInt32()) {
+    return QVariant::fromValue(value->ToInt32()->Value());
+  } else if (value->IsUint32()) {
+    return QVariant::fromValue(value->ToUint32()->Value());
+  } else if (value->IsNumber()) {
+    return QVariant::fromValue(value->ToNumber()->Value());
+  } else if (value->IsString()) {
+    return QVariant::fromValue(V8Util::toQString(value.As<String>()));
+  } else if (value->IsNull() || value->IsUndefined()) {
+    return QVariant();
+  } else if (value->IsArray()) {
+    QVariantList list;
+    Local<Array> arr = value.As<Array>();
+    for (uint32_t i = 0; i < arr->Length(); i++) {
+      list.append(toPlainVariant(isolate, arr->Get(i)));
+    }
+    return list;
+  } else if (value->IsObject() && !value->IsFunction()) {
+    QVariantMap map;
+    Local<Object> obj = value.As<Object>();
+    Local<Array> names = obj->GetOwnPropertyNames();
+    for (uint32_t i = 0; i < names->Length(); i++) {
+      Local<Value> name = names->Get(i);
+      map.insert(V8Util::toQString(name->ToString()), toPlainVariant(isolate, obj->Get(name)));
+    }
+    return map;
+  }
+
+  qWarning() << "can't pass a function or a symbol from a worker";
+  return QVariant();
+}
+
+// Replaces documents with their text
+QVariant toSnapshot(const QVariant& var) {
+  switch (var.type()) {
+    case QVariant::List: {
+      QVariantList list = var.toList();
+      for (QVariant& item : list) {
+        item = toSnapshot(item);
+      }
+      return list;
+    }
+    case QVariant::Map: {
+      QVariantMap map = var.toMap();
+      for (QVariant& value : map) {
+        value = toSnapshot(value);
+      }
+      return map;
+    }
+    default:
+      break;
+  }
+
+  if (var.canConvert<QObject*>()) {
+    if (Document* doc = qobject_cast<Document*>(var.value<QObject*>())) {
+      return doc->text();
+    }
+    qWarning() << "can't pass" << var.typeName() << "to a worker";
+    return QVariant();
+  }
+  return var;
+}
+
+WorkerThread* workerThread(const v8::FunctionCallbackInfo<Value>& args) {
+  return static_cast<WorkerThread*>(args.Data().As<v8::External>()->Value());
+}
+}
+
+WorkerThread::WorkerThread(const QString& scriptPath, QObject* parent)
+    : QThread(parent), m_scriptPath(scriptPath), m_stopped(false), m_isolate(nullptr) {}
+
+void WorkerThread::post(const QVariantMap& message) {
+  QMutexLocker locker(&m_mutex);
+  m_messages.enqueue(message);
+  m_messageAvailable.wakeOne();
+}
+
+void WorkerThread::stop() {
+  QMutexLocker locker(&m_mutex);
+  m_stopped = true;
+  // interrupt a running script
+  if (m_isolate) {
+    m_isolate->TerminateExecution();
+  }
+  m_messageAvailable.wakeOne();
+}
+
+void WorkerThread::run() {
+  ArrayBufferAllocator allocator;
+  Isolate::CreateParams params;
+  params.array_buffer_allocator = &allocator;
+  Isolate* isolate = Isolate::New(params);
+  {
+    QMutexLocker locker(&m_mutex);
+    m_isolate = isolate;
+  }
+
+  {
+    v8::Locker locker(isolate);
+    Isolate::Scope isolate_scope(isolate);
+    HandleScope handle_scope(isolate);
+    Local<Context> context = createContext(isolate);
+    Context::Scope context_scope(context);
+
+    if (runScript(isolate, context)) {
+      while (const boost::optional<QVariantMap> message = takeMessage()) {
+        HandleScope scope(isolate);
+        dispatch(isolate, context, *message);
+      }
+    }
+  }
+
+  {
+    QMutexLocker locker(&m_mutex);
+    m_isolate = nullptr;
+  }
+  isolate->Dispose();
+}
+
+Local<Context> WorkerThread::createContext(Isolate* isolate) {
+  Local<v8::External> data = v8::External::New(isolate, this);
+  Local<ObjectTemplate> global = ObjectTemplate::New(isolate);
+  global->Set(String::NewFromUtf8(isolate, "postMessage"),
+              FunctionTemplate::New(isolate, postMessageCallback, data));
+  global->Set(String::NewFromUtf8(isolate, "close"),
+              FunctionTemplate::New(isolate, closeCallback, data));
+
+  Local<ObjectTemplate> console = ObjectTemplate::New(isolate);
+  console->Set(String::NewFromUtf8(isolate, "log"), FunctionTemplate::New(isolate, logCallback));
+  global->Set(String::NewFromUtf8(isolate, "console"), console);
+
+  return Context::New(isolate, nullptr, global);
+}
+
+bool WorkerThread::runScript(Isolate* isolate, Local<Context> context) {
+  QFile file(m_scriptPath);
+  if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    emit errorOccurred(QStringLiteral("Failed to open %1").arg(m_scriptPath));
+    return false;
+  }
+
+  TryCatch trycatch(isolate);
+  v8::ScriptOrigin origin(V8Util::toV8String(isolate, QFileInfo(m_scriptPath).fileName()));
+  MaybeLocal<v8::Script> maybeScript = v8::Script::Compile(
+      context, V8Util::toV8String(isolate, QString::fromUtf8(file.readAll())), &origin);
+  if (maybeScript.IsEmpty() || maybeScript.ToLocalChecked()->Run(context).IsEmpty()) {
+    reportError(isolate, trycatch);
+    return false;
+  }
+  return true;
+}
+
+void WorkerThread::dispatch(Isolate* isolate, Local<Context> context, const QVariantMap& message) {
+  MaybeLocal<Value> maybeFn =
+      context->Global()->Get(context, String::NewFromUtf8(isolate, "onmessage"));
+  if (maybeFn.IsEmpty() || !maybeFn.ToLocalChecked()->IsFunction()) {
+    qWarning() << "onmessage is not defined in" << m_scriptPath;
+    return;
+  }
+
+  TryCatch trycatch(isolate);
+  Local<Value> argv[1] = {toPlainValue(isolate, message)};
+  if (maybeFn.ToLocalChecked().As<Function>()->Call(context, context->Global(), 1, argv).IsEmpty()) {
+    reportError(isolate, trycatch);
+  }
+}
+
+// Returns none when the worker is stopped
+boost::optional<QVariantMap> WorkerThread::takeMessage() {
+  QMutexLocker locker(&m_mutex);
+  while (!m_stopped && m_messages.isEmpty()) {
+    m_messageAvailable.wait(&m_mutex);
+  }
+
+  if (m_stopped) {
+    return boost::none;
+  }
+  return m_messages.dequeue();
+}
+
+void WorkerThread::reportError(Isolate* isolate, const TryCatch& trycatch) {
+  // TerminateExecution also throws an uncatchable exception
+  if (trycatch.HasTerminated()) {
+    return;
+  }
+
+  const QString& msg = V8Util::getErrorMessage(isolate, trycatch);
+  qWarning().noquote() << msg;
+  emit errorOccurred(msg);
+}
+
+void WorkerThread::postMessageCallback(const v8::FunctionCallbackInfo<Value>& args) {
+  if (args.Length() < 1 || !args[0]->IsObject()) {
+    V8Util::throwError(args.GetIsolate(), "message must be an object");
+    return;
+  }
+
+  const QVariant& message = toPlainVariant(args.GetIsolate(), args[0]);
+  emit workerThread(args)->messagePosted(message.toMap());
+}
+
+void WorkerThread::closeCallback(const v8::FunctionCallbackInfo<Value>& args) {
+  WorkerThread* thread = workerThread(args);
+  QMutexLocker locker(&thread->m_mutex);
+  // stops after the current message without terminating the script
+  thread->m_stopped = true;
+}
+
+void WorkerThread::logCallback(const v8::FunctionCallbackInfo<Value>& args) {
+  QStringList strs;
+  for (int i = 0; i < args.Length(); i++) {
+    strs.append(V8Util::toQString(args[i]->ToString()));
+  }
+  qDebug().noquote() << strs.join(' ');
+}
+
+Worker::Worker(const QString& scriptPath, QObject* parent)
+    : QObject(parent), m_thread(new WorkerThread(scriptPath)) {
+  // emitted in the worker thread and delivered in the thread of this object
+  connect(m_thread.get(), &WorkerThread::messagePosted, this, &Worker::message);
+  connect(m_thread.get(), &WorkerThread::errorOccurred, this, &Worker::error);
+  m_thread->start();
+}
+
+Worker::~Worker() {
+  terminate();
+}
+
+void Worker::postMessage(const QVariantMap& message) {
+  m_thread->post(toSnapshot(message).toMap());
+}
+
+void Worker::terminate() {
+  m_thread->stop();
+  m_thread->wait();
+}
+
+}  // namespace core
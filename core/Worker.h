@@ -0,0 +1,86 @@
+#pragma once
+
+#include <v8.h>
+#include <memory>
+#include <boost/optional.hpp>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QQueue>
+#include <QVariantMap>
+
+#include "macros.h"
+
+namespace core {
+
+// Runs a worker script in its own V8 isolate. Only accessed by Worker.
+class WorkerThread : public QThread {
+  Q_OBJECT
+  DISABLE_COPY(WorkerThread)
+
+ public:
+  explicit WorkerThread(const QString& scriptPath, QObject* parent = nullptr);
+  ~WorkerThread() = default;
+  DEFAULT_MOVE(WorkerThread)
+
+  // These can be called from any thread
+  void post(const QVariantMap& message);
+  void stop();
+
+ signals:
+  void messagePosted(const QVariantMap& message);
+  void errorOccurred(const QString& message);
+
+ protected:
+  void run() override;
+
+ private:
+  static void postMessageCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void closeCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void logCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  const QString m_scriptPath;
+  QMutex m_mutex;
+  QWaitCondition m_messageAvailable;
+  QQueue<QVariantMap> m_messages;
+  bool m_stopped;
+  // available while run() is running
+  v8::Isolate* m_isolate;
+
+  v8::Local<v8::Context> createContext(v8::Isolate* isolate);
+  bool runScript(v8::Isolate* isolate, v8::Local<v8::Context> context);
+  void dispatch(v8::Isolate* isolate, v8::Local<v8::Context> context, const QVariantMap& message);
+  boost::optional<QVariantMap> takeMessage();
+  void reportError(v8::Isolate* isolate, const v8::TryCatch& trycatch);
+};
+
+// Worker runs CPU heavy package code off the main thread.
+//
+// A worker script runs in a separate V8 isolate without Node APIs. The script receives messages
+// with onmessage and replies with postMessage. Messages are objects of plain data (boolean,
+// number, string, array and object). A Document in a message is passed as a text snapshot, so a
+// large document is shared with the worker without copying.
+class Worker : public QObject {
+  Q_OBJECT
+  DISABLE_COPY(Worker)
+
+ public:
+  Q_INVOKABLE explicit Worker(const QString& scriptPath, QObject* parent = nullptr);
+  ~Worker();
+  DEFAULT_MOVE(Worker)
+
+ public slots:
+  void postMessage(const QVariantMap& message);
+  void terminate();
+
+ signals:
+  void message(const QVariantMap& message);
+  void error(const QString& message);
+
+ private:
+  std::unique_ptr<WorkerThread> m_thread;
+};
+
+}  // namespace core
+
+Q_DECLARE_METATYPE(core::Worker*)
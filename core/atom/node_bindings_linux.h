@@ -0,0 +1,34 @@
+// Copyright (c) 2013 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef ATOM_COMMON_NODE_BINDINGS_LINUX_H_
+#define ATOM_COMMON_NODE_BINDINGS_LINUX_H_
+
+#include "node_bindings.h"
+#include "core/macros.h"
+
+namespace atom {
+
+class NodeBindingsLinux : public NodeBindings {
+  DISABLE_COPY(NodeBindingsLinux)
+ public:
+  NodeBindingsLinux();
+  virtual ~NodeBindingsLinux();
+
+  void RunMessageLoop() override;
+
+ protected:
+  void PollEvents() override;
+
+ private:
+  // Called when uv's watcher queue changes.
+  static void OnWatcherQueueChanged(uv_loop_t* loop);
+
+  // Epoll to poll for uv's backend fd.
+  int epoll_;
+};
+
+}  // namespace atom
+
+#endif  // ATOM_COMMON_NODE_BINDINGS_LINUX_H_
@@ -0,0 +1,34 @@
+#include <QtTest/QtTest>
+
+#include "AndConditionExpression.h"
+#include "ConditionManager.h"
+#include "OSCondition.h"
+
+namespace core {
+
+class AndConditionExpressionTest : public QObject {
+  Q_OBJECT
+ private slots:
+  void init() { ConditionManager::singleton().init(); }
+
+  void dynamicConditions() {
+    ConditionExpression os(OSCondition::name, Condition::equalsOperator, "mac");
+    ConditionExpression mode("vim.mode", Condition::equalsOperator, "insert");
+
+    // only static conditions
+    AndConditionExpression staticCond(QSet<ConditionExpression>{os});
+    QVERIFY(!staticCond.dynamicConditions());
+
+    // static conditions are removed
+    AndConditionExpression mixedCond(QSet<ConditionExpression>{os, mode});
+    auto dynamicCond = mixedCond.dynamicConditions();
+    QVERIFY(dynamicCond);
+    QCOMPARE(dynamicCond->size(), 1);
+    QVERIFY(*dynamicCond == AndConditionExpression(QSet<ConditionExpression>{mode}));
+  }
+};
+
+}  // namespace core
+
+QTEST_MAIN(core::AndConditionExpressionTest)
+#include "AndConditionExpressionTest.moc"
@@ -0,0 +1,167 @@
+#include <QtTest/QtTest>
+#include <QTextCursor>
+#include <QTextDocument>
+
+#include "BracketPairs.h"
+#include "LanguageParser.h"
+#include "ScopeTree.h"
+#include "TestUtil.h"
+
+namespace core {
+
+namespace {
+const QString text = "f(a, \"(\", [b]) /* { */ {x}";
+
+RootNode createRootNode(const QString& text) {
+  return TestUtil::createRootNode(
+      "source.js", text.size(),
+      {Node("string.quoted.double.js", Region(text.indexOf('"'), text.lastIndexOf('"') + 1)),
+       Node("comment.block.js", Region(text.indexOf("/*"), text.indexOf("*/") + 2))});
+}
+
+QString toString(const boost::optional<BracketPair>& pair) {
+  return pair ? QString("%1-%2").arg(pair->open).arg(pair->close) : QString();
+}
+}
+
+class BracketPairsTest : public QObject {
+  Q_OBJECT
+
+ private slots:
+  void match() {
+    QTextDocument doc(text);
+    const ScopeTree tree(createRootNode(text));
+    BracketPairs brackets;
+    brackets.reset(&tree, &doc);
+
+    QCOMPARE(brackets.match(1), 13);
+    QCOMPARE(brackets.match(13), 1);
+    QCOMPARE(brackets.match(10), 12);
+    QCOMPARE(brackets.match(23), 25);
+    QCOMPARE(brackets.match(0), -1);
+    // in the string and the comment
+    QCOMPARE(brackets.match(6), -1);
+    QCOMPARE(brackets.match(18), -1);
+  }
+
+  void enclosing() {
+    QTextDocument doc(text);
+    const ScopeTree tree(createRootNode(text));
+    BracketPairs brackets;
+    brackets.reset(&tree, &doc);
+
+    QCOMPARE(toString(brackets.enclosing(11)), QString("10-12"));
+    QCOMPARE(toString(brackets.enclosing(2)), QString("1-13"));
+    QCOMPARE(toString(brackets.enclosing(13)), QString("1-13"));
+    QCOMPARE(toString(brackets.enclosing(7)), QString("1-13"));
+    QCOMPARE(toString(brackets.enclosing(24)), QString("23-25"));
+    QVERIFY(!brackets.enclosing(1));
+    QVERIFY(!brackets.enclosing(14));
+    QVERIFY(!brackets.enclosing(20));
+  }
+
+  void unpaired() {
+    const QString text = "{ ( ] }";
+    QTextDocument doc(text);
+    BracketPairs brackets;
+    brackets.reset(nullptr, &doc);
+
+    QCOMPARE(brackets.match(0), 6);
+    QCOMPARE(brackets.match(2), -1);
+    QCOMPARE(brackets.match(4), -1);
+    // the unpaired bracket doesn't enclose anything
+    QCOMPARE(toString(brackets.enclosing(3)), QString("0-6"));
+    QCOMPARE(toString(brackets.enclosing(5)), QString("0-6"));
+  }
+
+  void update() {
+    QTextDocument doc(text);
+    ScopeTree tree(createRootNode(text));
+    BracketPairs brackets;
+    brackets.reset(&tree, &doc);
+    // The tree is adjusted first like SyntaxHighlighter::updateNode
+    connect(&doc, &QTextDocument::contentsChange,
+            [&](int position, int charsRemoved, int charsAdded) {
+              tree.adjust(position + charsRemoved, charsAdded - charsRemoved);
+              brackets.update(&tree, &doc, position, charsRemoved, charsAdded);
+            });
+
+    QTextCursor cursor(&doc);
+    cursor.insertText("[");
+    QCOMPARE(brackets.match(0), -1);
+    QCOMPARE(brackets.match(2), 14);
+    QCOMPARE(brackets.match(24), 26);
+
+    cursor.movePosition(QTextCursor::End);
+    cursor.insertText("]");
+    QCOMPARE(brackets.match(0), 27);
+
+    // a bracket typed in the comment is ignored
+    cursor.setPosition(doc.toPlainText().indexOf("{ */") + 1);
+    cursor.insertText(")");
+    QCOMPARE(brackets.match(2), 14);
+
+    // removing the comment
+    cursor.setPosition(doc.toPlainText().indexOf("/*"));
+    cursor.setPosition(doc.toPlainText().indexOf("*/") + 2, QTextCursor::KeepAnchor);
+    cursor.removeSelectedText();
+    QCOMPARE(doc.toPlainText(), QString("[f(a, \"(\", [b])  {x}]"));
+    QCOMPARE(brackets.match(17), 19);
+    QCOMPARE(brackets.match(0), 20);
+    QCOMPARE(toString(brackets.enclosing(18)), QString("17-19"));
+  }
+
+  void updatePairs() {
+    QTextDocument doc("[{a} (b)]");
+    BracketPairs brackets;
+    brackets.reset(nullptr, &doc);
+    connect(&doc, &QTextDocument::contentsChange,
+            [&](int position, int charsRemoved, int charsAdded) {
+              brackets.update(nullptr, &doc, position, charsRemoved, charsAdded);
+            });
+
+    // an opening bracket typed in a pair is unpaired and the enclosing pair ends further
+    QTextCursor cursor(&doc);
+    cursor.setPosition(2);
+    cursor.insertText("(");
+    QCOMPARE(brackets.match(1), 4);
+    QCOMPARE(brackets.match(2), -1);
+    QCOMPARE(brackets.match(6), 8);
+    QCOMPARE(brackets.match(0), 9);
+
+    // a closing bracket pairing with one outside the enclosing pair
+    cursor.setPosition(4);
+    cursor.insertText("]");
+    QCOMPARE(doc.toPlainText(), QString("[{(a]} (b)]"));
+    QCOMPARE(brackets.match(0), 4);
+    QCOMPARE(brackets.match(1), -1);
+    QCOMPARE(brackets.match(5), -1);
+    QCOMPARE(brackets.match(7), 9);
+    QCOMPARE(brackets.match(10), -1);
+
+    doc.undo();
+    QCOMPARE(brackets.match(0), 9);
+    QCOMPARE(brackets.match(1), 4);
+    QCOMPARE(toString(brackets.enclosing(7)), QString("6-8"));
+    QCOMPARE(toString(brackets.enclosing(5)), QString("0-9"));
+  }
+
+  void replace() {
+    QTextDocument doc(text);
+    ScopeTree tree(createRootNode(text));
+    BracketPairs brackets;
+    brackets.reset(&tree, &doc);
+
+    // "[b]" is a string after a partial parse
+    tree.replaceChildren(Region(10, 13), QList<Node>{Node("string.regexp.js", Region(10, 13))});
+    brackets.replace(&tree, Region(10, 13), &doc);
+    QCOMPARE(brackets.match(10), -1);
+    QCOMPARE(brackets.match(1), 13);
+    QCOMPARE(toString(brackets.enclosing(11)), QString("1-13"));
+  }
+};
+
+}  // namespace core
+
+QTEST_MAIN(core::BracketPairsTest)
+#include "BracketPairsTest.moc"
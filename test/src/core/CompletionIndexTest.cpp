@@ -0,0 +1,132 @@
+#include <memory>
+#include <QtTest/QtTest>
+#include <QTextCursor>
+
+#include "CompletionIndex.h"
+#include "Document.h"
+#include "LanguageParser.h"
+#include "SyntaxHighlighter.h"
+
+namespace core {
+
+class CompletionIndexTest : public QObject {
+  Q_OBJECT
+
+ private slots:
+  void initTestCase() {
+    qRegisterMetaType<QList<core::Node>>("QList<Node>");
+    qRegisterMetaType<QList<core::Node>>("QList<core::Node>");
+    qRegisterMetaType<core::RootNode>("RootNode");
+    qRegisterMetaType<core::RootNode>("core::RootNode");
+    qRegisterMetaType<core::LanguageParser>("LanguageParser");
+    qRegisterMetaType<core::LanguageParser>("core::LanguageParser");
+    qRegisterMetaType<core::Region>("Region");
+    qRegisterMetaType<core::Region>("core::Region");
+    qRegisterMetaType<core::SyntaxHighlighter*>("SyntaxHighlighter*");
+    qRegisterMetaType<core::SyntaxHighlighter*>("core::SyntaxHighlighter*");
+  }
+
+  void words() {
+    QCOMPARE(CompletionIndex::words("foo(bar_baz, 1, x) + 123abc _id ab"),
+             (QStringList{"foo", "bar_baz", "_id"}));
+    QCOMPARE(CompletionIndex::words("über straße"), (QStringList{"über", "straße"}));
+    QCOMPARE(CompletionIndex::words(QString(65, QLatin1Char('a'))), QStringList());
+  }
+
+  void complete() {
+    std::unique_ptr<Document> doc(Document::createBlank());
+    doc->setPlainText("foobar foobar fooBaz\nfaraway food\nfoo");
+    CompletionIndex& index = CompletionIndex::singleton();
+    index.addDocument(doc.get());
+
+    QCOMPARE(index.count("foobar"), 2);
+    QCOMPARE(index.count("foobar", doc.get()), 2);
+
+    // prefix matches first, more frequent ones first. The word being typed is excluded.
+    QCOMPARE(index.complete("foo"), (QStringList{"foobar", "food", "fooBaz"}));
+    QCOMPARE(index.complete("foo", 1), QStringList{"foobar"});
+    // same case first
+    QCOMPARE(index.complete("fooB").first(), QString("fooBaz"));
+    // fuzzy matches follow prefix matches
+    QVERIFY(index.complete("fb").contains("foobar"));
+    QVERIFY(index.complete("fray").contains("faraway"));
+    QVERIFY(index.complete("xyz").isEmpty());
+  }
+
+  void preferWordsOfDocument() {
+    std::unique_ptr<Document> doc1(Document::createBlank());
+    std::unique_ptr<Document> doc2(Document::createBlank());
+    doc1->setPlainText("alpha1 alpha1 alpha1");
+    doc2->setPlainText("alpha2");
+    CompletionIndex& index = CompletionIndex::singleton();
+    index.addDocument(doc1.get());
+    index.addDocument(doc2.get());
+
+    QCOMPARE(index.complete("alp"), (QStringList{"alpha1", "alpha2"}));
+    QCOMPARE(index.complete("alp", 50, QString(), doc2.get()), (QStringList{"alpha2", "alpha1"}));
+  }
+
+  void update() {
+    std::unique_ptr<Document> doc(Document::createBlank());
+    doc->setPlainText("one two\nthree four\nfive");
+    CompletionIndex& index = CompletionIndex::singleton();
+    index.addDocument(doc.get());
+    QCOMPARE(index.count("three"), 1);
+
+    // insert a line in the middle
+    QTextCursor cursor(doc->findBlockByNumber(1));
+    cursor.insertText("three seven\n");
+    QCOMPARE(index.count("three"), 2);
+    QCOMPARE(index.count("seven"), 1);
+
+    // edit a word
+    cursor.setPosition(doc->findBlockByNumber(2).position());
+    cursor.movePosition(QTextCursor::EndOfWord, QTextCursor::KeepAnchor);
+    cursor.insertText("threes");
+    QCOMPARE(index.count("three"), 1);
+    QCOMPARE(index.count("threes"), 1);
+
+    // remove lines across blocks
+    cursor.setPosition(doc->findBlockByNumber(1).position());
+    cursor.setPosition(doc->findBlockByNumber(3).position(), QTextCursor::KeepAnchor);
+    cursor.removeSelectedText();
+    QCOMPARE(index.count("three"), 0);
+    QCOMPARE(index.count("threes"), 0);
+    QCOMPARE(index.count("seven"), 0);
+    QCOMPARE(index.count("four"), 0);
+    QCOMPARE(index.count("five"), 1);
+    QCOMPARE(index.count("two"), 1);
+
+    // replace the whole text
+    doc->setPlainText("eleven");
+    QCOMPARE(index.count("five"), 0);
+    QCOMPARE(index.count("eleven"), 1);
+  }
+
+  void removeDocument() {
+    CompletionIndex& index = CompletionIndex::singleton();
+    Document* doc = Document::createBlank();
+    doc->setPlainText("removed");
+    index.addDocument(doc);
+    QCOMPARE(index.count("removed"), 1);
+
+    delete doc;
+    QCOMPARE(index.count("removed"), 0);
+    QVERIFY(index.complete("rem").isEmpty());
+  }
+
+  void prefixAt() {
+    std::unique_ptr<Document> doc(Document::createBlank());
+    doc->setPlainText("foo.barBaz qux");
+
+    QCOMPARE(CompletionIndex::prefixAt(doc.get(), 3), QString("foo"));
+    QCOMPARE(CompletionIndex::prefixAt(doc.get(), 7), QString("bar"));
+    QCOMPARE(CompletionIndex::prefixAt(doc.get(), 4), QString(""));
+    QCOMPARE(CompletionIndex::prefixAt(doc.get(), 14), QString("qux"));
+  }
+};
+
+}  // namespace core
+
+QTEST_MAIN(core::CompletionIndexTest)
+#include "CompletionIndexTest.moc"
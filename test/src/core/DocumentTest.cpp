@@ -45,6 +45,43 @@ ccc)";
     QCOMPARE(regions[2], Region(8, 8));
   }
 
+  void text() {
+    Document doc;
+    doc.setPlainText("aaa\nbbb\n\nccc");
+
+    QCOMPARE(doc.text(), QString("aaa\nbbb\n\nccc"));
+    QCOMPARE(doc.text(2, 5), QString("a\nb"));
+    QCOMPARE(doc.text(4, 8), QString("bbb\n"));
+    QCOMPARE(doc.text(4, 4), QString(""));
+    QCOMPARE(doc.text(9), QString("ccc"));
+    QCOMPARE(doc.text(0, 100), doc.text());
+
+    // the whole text is shared while the document isn't changed
+    const QString snapshot = doc.text();
+    QCOMPARE(doc.text().constData(), snapshot.constData());
+    QCOMPARE(doc.text(4, 7), QString("bbb"));
+
+    QTextCursor cursor(&doc);
+    cursor.insertText("x");
+    QCOMPARE(doc.text(), QString("xaaa\nbbb\n\nccc"));
+    QCOMPARE(snapshot, QString("aaa\nbbb\n\nccc"));
+
+    Document empty;
+    QVERIFY(!empty.text().isNull());
+    QCOMPARE(empty.text(), QString(""));
+  }
+
+  void lines() {
+    Document doc;
+    doc.setPlainText("aaa\nbbb\n\nccc");
+
+    QCOMPARE(doc.lines(), QStringList({"aaa", "bbb", "", "ccc"}));
+    QCOMPARE(doc.lines(1, 2), QStringList({"bbb", ""}));
+    QCOMPARE(doc.lines(2, 100), QStringList({"", "ccc"}));
+    QVERIFY(doc.lines(4).isEmpty());
+    QVERIFY(doc.lines(-1).isEmpty());
+  }
+
   void selectGrammerFromExtension() {
     const QVector<QString> files({"testdata/grammers/Plain text.tmLanguage",
                                   "testdata/grammers/Rails/HTML (Rails).plist",
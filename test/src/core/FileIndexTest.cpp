@@ -0,0 +1,87 @@
+#include <QtTest/QtTest>
+#include <QTemporaryDir>
+
+#include "FileIndex.h"
+#include "FuzzyMatcher.h"
+
+namespace core {
+
+namespace {
+void writeFile(const QString& path) {
+  QDir().mkpath(QFileInfo(path).path());
+  QFile file(path);
+  QVERIFY(file.open(QIODevice::WriteOnly));
+}
+
+int score(const QString& query, const QString& path) {
+  const QByteArray bytes = path.toUtf8();
+  const QByteArray lowerBytes = bytes.toLower();
+  return FuzzyMatcher(query).score(bytes.constData(), lowerBytes.constData(), bytes.size(),
+                                   bytes.lastIndexOf('/') + 1);
+}
+}
+
+class FileIndexTest : public QObject {
+  Q_OBJECT
+
+ private slots:
+  void charMask() {
+    const quint64 mask = FuzzyMatcher::charMask("abc", 3);
+    QCOMPARE(FuzzyMatcher::charMask("ABC", 3), mask);
+    QCOMPARE(FuzzyMatcher::charMask("cba", 3) & mask, mask);
+    QVERIFY((FuzzyMatcher::charMask("ab", 2) & mask) != mask);
+  }
+
+  void score() {
+    QVERIFY(core::score("abc", "src/cab.txt") < 0);
+    QVERIFY(core::score("xyz", "src/Foo.cpp") < 0);
+    QVERIFY(core::score("FOO", "src/foo.cpp") >= 0);
+    QVERIFY(core::score("", "src/foo.cpp") >= 0);
+
+    // consecutive characters
+    QVERIFY(core::score("foo", "src/foo.cpp") > core::score("foo", "src/f_o_o.cpp"));
+    // in the file name
+    QVERIFY(core::score("doc", "core/Document.cpp") > core::score("doc", "doc/readme.md"));
+    // at word boundaries
+    QVERIFY(core::score("td", "core/TextDocument.h") > core::score("td", "core/Stdio.h"));
+  }
+
+  void find() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    writeFile(dir.path() + "/core/Document.cpp");
+    writeFile(dir.path() + "/core/Document.h");
+    writeFile(dir.path() + "/core/TextDocument.cpp");
+    writeFile(dir.path() + "/widgets/TextEdit.cpp");
+    writeFile(dir.path() + "/node_modules/Document.js");
+
+    ProjectFileSystem fileSystem(dir.path());
+    QSignalSpy readySpy(&fileSystem, &ProjectFileSystem::ready);
+    FileIndex index(&fileSystem);
+    QSignalSpy updatedSpy(&index, &FileIndex::updated);
+    fileSystem.start();
+    QVERIFY(readySpy.wait());
+    QVERIFY(!updatedSpy.isEmpty());
+    QCOMPARE(index.size(), 4);
+
+    QCOMPARE(index.find("doch", 10), QStringList{"core/Document.h"});
+    QCOMPARE(index.find("doc", 2), (QStringList{"core/Document.h", "core/Document.cpp"}));
+    // extends the last query
+    QCOMPARE(index.find("docc", 10),
+             (QStringList{"core/Document.cpp", "core/TextDocument.cpp"}));
+    QCOMPARE(index.find("tedit", 10), QStringList{"widgets/TextEdit.cpp"});
+    QVERIFY(index.find("", 10).isEmpty());
+    QVERIFY(index.find("zzz", 10).isEmpty());
+
+    // removed files are dropped
+    QVERIFY(QFile::remove(dir.path() + "/core/Document.h"));
+    fileSystem.refresh(dir.path() + "/core");
+    QCOMPARE(index.size(), 3);
+    QVERIFY(index.find("doch", 10).isEmpty());
+  }
+};
+
+}  // namespace core
+
+QTEST_MAIN(core::FileIndexTest)
+#include "FileIndexTest.moc"
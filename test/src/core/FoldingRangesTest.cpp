@@ -0,0 +1,202 @@
+#include <QtTest/QtTest>
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QTextDocument>
+
+#include "FoldingRanges.h"
+#include "LanguageParser.h"
+#include "Metadata.h"
+#include "ScopeTree.h"
+#include "TestUtil.h"
+
+namespace core {
+
+namespace {
+const QString text =
+    "int main() {\n"
+    "  if (a) {\n"
+    "    b();\n"
+    "  }\n"
+    "  /* comment\n"
+    "     more */\n"
+    "}\n"
+    "end";
+
+RootNode createRootNode(const QString& text) {
+  return TestUtil::createRootNode(
+      "source.c++", text.size(),
+      {Node("comment.block.c", Region(text.indexOf("/*"), text.indexOf("*/") + 2))});
+}
+
+QStringList toStringList(const QVector<FoldRange>& ranges) {
+  QStringList list;
+  for (const FoldRange& range : ranges) {
+    list.append(QString("%1-%2").arg(range.first).arg(range.last));
+  }
+  return list;
+}
+
+QStringList hiddenLines(const QTextDocument& doc) {
+  QStringList lines;
+  for (QTextBlock block = doc.begin(); block.isValid(); block = block.next()) {
+    if (!block.isVisible()) {
+      lines.append(QString::number(block.blockNumber()));
+    }
+  }
+  return lines;
+}
+}
+
+class FoldingRangesTest : public QObject {
+  Q_OBJECT
+
+ private slots:
+  void initTestCase() { Metadata::load("testdata/CppIndentation Rules.tmPreferences"); }
+
+  void ranges() {
+    QTextDocument doc(text);
+    ScopeTree tree(createRootNode(text));
+    FoldingRanges ranges;
+    ranges.reset(&tree, &doc);
+
+    // from the indentation patterns and the comment node
+    QCOMPARE(toStringList(ranges.ranges()), (QStringList{"0-5", "1-2", "4-5"}));
+    QCOMPARE(ranges.find(1)->last, 2);
+    QCOMPARE(ranges.find(4)->last, 5);
+    QVERIFY(!ranges.find(2));
+  }
+
+  void fold() {
+    QTextDocument doc(text);
+    ScopeTree tree(createRootNode(text));
+    FoldingRanges ranges;
+    ranges.reset(&tree, &doc);
+    QSignalSpy spy(&doc, &QTextDocument::contentsChange);
+
+    QVERIFY(ranges.fold(1));
+    QVERIFY(!ranges.fold(1));
+    QVERIFY(!ranges.fold(2));
+    QCOMPARE(hiddenLines(doc), QStringList{"2"});
+    // folding isn't an edit
+    QCOMPARE(spy.count(), 0);
+
+    QVERIFY(ranges.fold(0));
+    QCOMPARE(hiddenLines(doc), (QStringList{"1", "2", "3", "4", "5"}));
+
+    // the inner folded range stays folded
+    QVERIFY(ranges.unfold(0));
+    QVERIFY(!ranges.isFolded(0));
+    QVERIFY(ranges.isFolded(1));
+    QCOMPARE(hiddenLines(doc), QStringList{"2"});
+
+    ranges.reveal(2);
+    QVERIFY(!ranges.isFolded(1));
+    QVERIFY(hiddenLines(doc).isEmpty());
+  }
+
+  void foldAll() {
+    QTextDocument doc(text);
+    ScopeTree tree(createRootNode(text));
+    FoldingRanges ranges;
+    ranges.reset(&tree, &doc);
+
+    ranges.fold(4);
+    ranges.foldAll();
+    QVERIFY(ranges.isFolded(0));
+    QVERIFY(!ranges.isFolded(1));
+    QVERIFY(ranges.isFolded(4));
+    QCOMPARE(hiddenLines(doc), (QStringList{"1", "2", "3", "4", "5"}));
+
+    ranges.unfoldAll();
+    QVERIFY(!ranges.isFolded(4));
+    QVERIFY(hiddenLines(doc).isEmpty());
+  }
+
+  void update() {
+    QTextDocument doc(text);
+    ScopeTree tree(createRootNode(text));
+    FoldingRanges ranges;
+    ranges.reset(&tree, &doc);
+    connect(&doc, &QTextDocument::contentsChange,
+            [&](int position, int charsRemoved, int charsAdded) {
+              tree.adjust(position + charsRemoved, charsAdded - charsRemoved);
+              ranges.update(&tree, position, charsRemoved, charsAdded);
+            });
+
+    // a new line before a folded range moves it
+    ranges.fold(4);
+    QTextCursor cursor(doc.findBlockByNumber(2));
+    cursor.movePosition(QTextCursor::EndOfBlock);
+    cursor.insertText("\n");
+    QCOMPARE(toStringList(ranges.ranges()), (QStringList{"0-6", "1-3", "5-6"}));
+    QVERIFY(ranges.isFolded(5));
+    QCOMPARE(hiddenLines(doc), QStringList{"6"});
+
+    // editing the first line keeps the range folded
+    ranges.fold(1);
+    cursor.setPosition(doc.findBlockByNumber(1).position());
+    cursor.insertText("x");
+    QVERIFY(ranges.isFolded(1));
+    QCOMPARE(hiddenLines(doc), (QStringList{"2", "3", "6"}));
+
+    // editing a folded line unfolds it
+    cursor.setPosition(doc.findBlockByNumber(2).position());
+    cursor.insertText("x");
+    QVERIFY(!ranges.isFolded(1));
+    QCOMPARE(hiddenLines(doc), QStringList{"6"});
+
+    // a range which is gone is unfolded
+    cursor.setPosition(doc.findBlockByNumber(1).position());
+    cursor.movePosition(QTextCursor::EndOfBlock, QTextCursor::KeepAnchor);
+    cursor.insertText("if (a)");
+    ranges.fold(0);
+    cursor.setPosition(doc.findBlockByNumber(0).position());
+    cursor.movePosition(QTextCursor::EndOfBlock, QTextCursor::KeepAnchor);
+    cursor.removeSelectedText();
+    QVERIFY(!ranges.isFolded(0));
+    QCOMPARE(hiddenLines(doc), QStringList{"6"});
+  }
+
+  void updatePairs() {
+    QTextDocument doc(text);
+    ScopeTree tree(createRootNode(text));
+    FoldingRanges ranges;
+    ranges.reset(&tree, &doc);
+    connect(&doc, &QTextDocument::contentsChange,
+            [&](int position, int charsRemoved, int charsAdded) {
+              tree.adjust(position + charsRemoved, charsAdded - charsRemoved);
+              ranges.update(&tree, position, charsRemoved, charsAdded);
+            });
+
+    // a new "}" closes the inner range and the outer one ends at the "}" after it
+    QTextCursor cursor(doc.findBlockByNumber(1));
+    cursor.movePosition(QTextCursor::EndOfBlock);
+    cursor.insertText("\n  }");
+    QCOMPARE(toStringList(ranges.ranges()), (QStringList{"0-3", "5-6"}));
+
+    // the ranges after the changed lines are rebuilt when they are paired again
+    doc.undo();
+    QCOMPARE(toStringList(ranges.ranges()), (QStringList{"0-5", "1-2", "4-5"}));
+  }
+
+  void replace() {
+    QTextDocument doc(text);
+    ScopeTree tree(createRootNode(text));
+    FoldingRanges ranges;
+    ranges.reset(&tree, &doc);
+    ranges.fold(4);
+
+    // the comment is gone after a partial parse
+    const Region region(doc.findBlockByNumber(4).position(), doc.findBlockByNumber(6).position());
+    tree.replaceChildren(region, QList<Node>());
+    ranges.replace(&tree, region);
+    QCOMPARE(toStringList(ranges.ranges()), (QStringList{"0-5", "1-2"}));
+    QVERIFY(!ranges.isFolded(4));
+    QVERIFY(hiddenLines(doc).isEmpty());
+  }
+};
+
+}  // namespace core
+
+QTEST_MAIN(core::FoldingRangesTest)
+#include "FoldingRangesTest.moc"
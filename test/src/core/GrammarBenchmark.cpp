@@ -0,0 +1,376 @@
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <new>
+#include <numeric>
+#include <algorithm>
+#include <QtTest/QtTest>
+#include <QTextDocument>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include "LanguageParser.h"
+#include "SyntaxHighlighter.h"
+#include "Theme.h"
+#include "core/Config.h"
+
+// Grammar throughput and latency benchmark.
+//
+// Each grammar is run against its corpus in test/testdata for full parse, single character edits,
+// paste and theme switch. A summary is printed and the results are written as JSON to the path in
+// SILK_BENCHMARK_OUTPUT (GrammarBenchmark.json next to the executable by default) so that they can
+// be compared across commits.
+
+namespace {
+std::atomic<qint64> s_allocations(0);
+}
+
+// Count allocations of the whole process including the parser thread
+void* operator new(std::size_t size) {
+  s_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* p = std::malloc(size ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+  return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+  std::free(p);
+}
+
+namespace core {
+
+namespace {
+
+// Small corpora are repeated to this length to get stable numbers
+const int MIN_CORPUS_LENGTH = 64 * 1024;
+const int FULL_PARSE_COUNT = 5;
+const int EDIT_COUNT = 50;
+const int PASTE_COUNT = 10;
+const int PASTE_LENGTH = 2048;
+const int THEME_SWITCH_COUNT = 10;
+const int WAIT_TIMEOUT = 60000;
+
+struct Samples {
+  QVector<double> msecs;
+  qint64 allocations = 0;
+};
+
+double percentile(QVector<double> msecs, double p) {
+  if (msecs.isEmpty()) {
+    return 0;
+  }
+  std::sort(msecs.begin(), msecs.end());
+  int rank = qMax(1, static_cast<int>(std::ceil(p / 100 * msecs.size())));
+  return msecs[qMin(rank, msecs.size()) - 1];
+}
+
+double mean(const QVector<double>& msecs) {
+  if (msecs.isEmpty()) {
+    return 0;
+  }
+  return std::accumulate(msecs.begin(), msecs.end(), 0.0) / msecs.size();
+}
+
+QString readCorpus(const QString& path) {
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    return QString();
+  }
+
+  QTextStream in(&file);
+  const QString text = in.readAll();
+  if (text.isEmpty()) {
+    return text;
+  }
+
+  QString corpus = text;
+  while (corpus.length() < MIN_CORPUS_LENGTH) {
+    corpus += text;
+  }
+  return corpus;
+}
+
+// Reformatting after a theme switch is done when the last block has the same generation as the
+// first one, which is always reformatted in the first batch.
+bool isReformatted(QTextDocument* doc) {
+  auto first = static_cast<TokenRunsData*>(doc->firstBlock().userData());
+  auto last = static_cast<TokenRunsData*>(doc->lastBlock().userData());
+  return !first || !last || first->generation == last->generation;
+}
+
+// Returns a deterministic pseudo random number in [0, max)
+int nextPosition(quint32* seed, int max) {
+  *seed = *seed * 1103515245 + 12345;
+  return static_cast<int>((*seed >> 8) % static_cast<quint32>(qMax(1, max)));
+}
+}
+
+class GrammarBenchmark : public QObject {
+  Q_OBJECT
+ private:
+  Theme* theme = Theme::loadTheme("testdata/Solarized (Dark).tmTheme");
+  Theme* otherTheme = Theme::loadTheme("testdata/Monokai.tmTheme");
+  QFont font = QFont("Helvetica", 12);
+  QJsonArray m_results;
+
+  void addCorpusRows() {
+    QTest::addColumn<QStringList>("grammars");
+    QTest::addColumn<QString>("scope");
+    QTest::addColumn<QString>("corpus");
+
+    const QString dir = QStringLiteral("testdata/grammers/");
+    const QStringList cpp({dir + "C.tmLanguage", dir + "C++.tmLanguage"});
+    QTest::newRow("c++/Benchmark_1007") << cpp << "source.c++"
+                                        << "testdata/Benchmark_1007.cpp";
+    QTest::newRow("c++/Benchmark_12867") << cpp << "source.c++"
+                                         << "testdata/Benchmark_12867.cpp";
+    QTest::newRow("c++/cppTest") << cpp << "source.c++"
+                                 << "testdata/cppTest.cpp";
+    QTest::newRow("css") << QStringList(dir + "CSS.plist") << "source.css"
+                         << "testdata/benchmark/corpus.css";
+    QTest::newRow("java-properties") << QStringList(dir + "JavaProperties.plist")
+                                     << "source.java-properties"
+                                     << "testdata/javaProperties.properties";
+    QTest::newRow("makefile") << QStringList(dir + "Makefile.plist") << "source.makefile"
+                              << "testdata/Makefile";
+    QTest::newRow("plain-text") << QStringList(dir + "Plain text.tmLanguage") << "text.plain"
+                                << "testdata/test.txt";
+    QTest::newRow("plist") << QStringList(dir + "Property List (XML).tmLanguage")
+                           << "text.xml.plist" << QString(dir + "Ruby.plist");
+    QTest::newRow("python") << QStringList(dir + "Python.tmLanguage") << "source.python"
+                            << "testdata/benchmark/corpus.py";
+    QTest::newRow("ruby") << QStringList(dir + "Ruby.plist") << "source.ruby"
+                          << "testdata/benchmark/corpus.rb";
+    QTest::newRow("shell") << QStringList(dir + "Shell-Unix-Bash.tmLanguage") << "source.shell"
+                           << "testdata/benchmark/corpus.sh";
+    QTest::newRow("sql") << QStringList(dir + "SQL.plist") << "source.sql"
+                         << "testdata/benchmark/corpus.sql";
+    QTest::newRow("xml") << QStringList(dir + "XML.tmLanguage") << "text.xml"
+                         << QString(dir + "C++.tmLanguage");
+    QTest::newRow("yaml") << QStringList(dir + "YAML.plist") << "source.yaml"
+                          << "testdata/benchmark/corpus.yaml";
+  }
+
+  QString loadCorpus() {
+    QFETCH(QStringList, grammars);
+    QFETCH(QString, corpus);
+    for (const QString& grammar : grammars) {
+      if (!LanguageProvider::loadLanguage(grammar)) {
+        return QString();
+      }
+    }
+    return readCorpus(corpus);
+  }
+
+  void record(const QString& benchmark, const QString& text, const Samples& samples) {
+    QFETCH(QString, scope);
+    const int bytes = text.toUtf8().size();
+    const double p50 = percentile(samples.msecs, 50);
+    const double p99 = percentile(samples.msecs, 99);
+    const double allocationsPerOp =
+        samples.msecs.isEmpty() ? 0 : double(samples.allocations) / samples.msecs.size();
+
+    QJsonObject result;
+    result.insert("benchmark", benchmark);
+    result.insert("name", QString(QTest::currentDataTag()));
+    result.insert("scope", scope);
+    result.insert("bytes", bytes);
+    result.insert("samples", samples.msecs.size());
+    result.insert("p50Ms", p50);
+    result.insert("p99Ms", p99);
+    result.insert("meanMs", mean(samples.msecs));
+    result.insert("allocationsPerOp", allocationsPerOp);
+    if (benchmark == "fullParse" && p50 > 0) {
+      result.insert("mbPerSec", bytes / (1024.0 * 1024.0) / (p50 / 1000));
+    }
+    m_results.append(result);
+
+    qDebug("%-12s %-20s %8d bytes  p50 %9.2f ms  p99 %9.2f ms  %10.0f allocs/op",
+           qPrintable(benchmark), QTest::currentDataTag(), bytes, p50, p99, allocationsPerOp);
+  }
+
+ private slots:
+  void initTestCase() {
+    qRegisterMetaType<QList<core::Node>>("QList<Node>");
+    qRegisterMetaType<QList<core::Node>>("QList<core::Node>");
+    qRegisterMetaType<core::RootNode>("RootNode");
+    qRegisterMetaType<core::RootNode>("core::RootNode");
+    qRegisterMetaType<core::LanguageParser>("LanguageParser");
+    qRegisterMetaType<core::LanguageParser>("core::LanguageParser");
+    qRegisterMetaType<core::Region>("Region");
+    qRegisterMetaType<core::Region>("core::Region");
+    qRegisterMetaType<QVector<core::Region>>("QVector<Region>");
+    qRegisterMetaType<QVector<core::Region>>("QVector<core::Region>");
+    qRegisterMetaType<core::SyntaxHighlighter*>("SyntaxHighlighter*");
+    qRegisterMetaType<core::SyntaxHighlighter*>("core::SyntaxHighlighter*");
+
+    QVERIFY(theme);
+    QVERIFY(otherTheme);
+    Config::singleton().setTheme(theme, true);
+  }
+
+  void cleanupTestCase() {
+    QJsonObject root;
+    root.insert("qtVersion", QString(qVersion()));
+    root.insert("date", QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+    root.insert("results", m_results);
+
+    QString path = QString::fromLocal8Bit(qgetenv("SILK_BENCHMARK_OUTPUT"));
+    if (path.isEmpty()) {
+      path = QCoreApplication::applicationDirPath() + "/GrammarBenchmark.json";
+    }
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    file.write(QJsonDocument(root).toJson());
+    qDebug("results are written to %s", qPrintable(path));
+  }
+
+  void fullParse_data() { addCorpusRows(); }
+
+  void fullParse() {
+    QFETCH(QString, scope);
+    const QString text = loadCorpus();
+    QVERIFY(!text.isEmpty());
+
+    Samples samples;
+    for (int i = 0; i < FULL_PARSE_COUNT; i++) {
+      std::unique_ptr<LanguageParser> parser(LanguageParser::create(scope, text));
+      QVERIFY(parser);
+
+      qint64 allocations = s_allocations.load();
+      QElapsedTimer timer;
+      timer.start();
+      QVERIFY(parser->parse());
+      samples.msecs.append(timer.nsecsElapsed() / 1000000.0);
+      samples.allocations += s_allocations.load() - allocations;
+    }
+    record("fullParse", text, samples);
+  }
+
+  void edit_data() { addCorpusRows(); }
+
+  // Inserts a character at a random position and removes it. Each sample is the time until the
+  // partial parse finishes.
+  void edit() {
+    QFETCH(QString, scope);
+    const QString text = loadCorpus();
+    QVERIFY(!text.isEmpty());
+
+    QTextDocument doc(text);
+    std::unique_ptr<LanguageParser> parser(LanguageParser::create(scope, doc.toPlainText()));
+    QVERIFY(parser);
+    SyntaxHighlighter highlighter(&doc, std::move(parser), theme, font);
+    QSignalSpy spy(&highlighter, &SyntaxHighlighter::parseFinished);
+    QVERIFY(spy.wait(WAIT_TIMEOUT));
+
+    Samples samples;
+    quint32 seed = 1;
+    QTextCursor cursor(&doc);
+    for (int i = 0; i < EDIT_COUNT; i++) {
+      cursor.setPosition(nextPosition(&seed, doc.characterCount() - 1));
+
+      qint64 allocations = s_allocations.load();
+      QElapsedTimer timer;
+      timer.start();
+      cursor.insertText("x");
+      QVERIFY(spy.wait(WAIT_TIMEOUT));
+      samples.msecs.append(timer.nsecsElapsed() / 1000000.0);
+
+      timer.restart();
+      cursor.deletePreviousChar();
+      QVERIFY(spy.wait(WAIT_TIMEOUT));
+      samples.msecs.append(timer.nsecsElapsed() / 1000000.0);
+      samples.allocations += s_allocations.load() - allocations;
+    }
+    QCOMPARE(doc.toPlainText(), text);
+    record("edit", text, samples);
+  }
+
+  void paste_data() { addCorpusRows(); }
+
+  // Pastes the beginning of the corpus in the middle of the document
+  void paste() {
+    QFETCH(QString, scope);
+    const QString text = loadCorpus();
+    QVERIFY(!text.isEmpty());
+
+    QTextDocument doc(text);
+    std::unique_ptr<LanguageParser> parser(LanguageParser::create(scope, doc.toPlainText()));
+    QVERIFY(parser);
+    SyntaxHighlighter highlighter(&doc, std::move(parser), theme, font);
+    QSignalSpy spy(&highlighter, &SyntaxHighlighter::parseFinished);
+    QVERIFY(spy.wait(WAIT_TIMEOUT));
+
+    const QString chunk = text.left(PASTE_LENGTH);
+    const int pos = doc.findBlock(doc.characterCount() / 2).position();
+    Samples samples;
+    QTextCursor cursor(&doc);
+    for (int i = 0; i < PASTE_COUNT; i++) {
+      cursor.setPosition(pos);
+
+      qint64 allocations = s_allocations.load();
+      QElapsedTimer timer;
+      timer.start();
+      cursor.insertText(chunk);
+      QVERIFY(spy.wait(WAIT_TIMEOUT));
+      samples.msecs.append(timer.nsecsElapsed() / 1000000.0);
+      samples.allocations += s_allocations.load() - allocations;
+
+      cursor.setPosition(pos);
+      cursor.setPosition(pos + chunk.length(), QTextCursor::KeepAnchor);
+      cursor.removeSelectedText();
+      QVERIFY(spy.wait(WAIT_TIMEOUT));
+    }
+    QCOMPARE(doc.toPlainText(), text);
+    record("paste", text, samples);
+  }
+
+  void changeTheme_data() { addCorpusRows(); }
+
+  // Each sample is the time until all the blocks are reformatted
+  void changeTheme() {
+    QFETCH(QString, scope);
+    const QString text = loadCorpus();
+    QVERIFY(!text.isEmpty());
+
+    QTextDocument doc(text);
+    std::unique_ptr<LanguageParser> parser(LanguageParser::create(scope, doc.toPlainText()));
+    QVERIFY(parser);
+    SyntaxHighlighter highlighter(&doc, std::move(parser), theme, font);
+    QSignalSpy spy(&highlighter, &SyntaxHighlighter::parseFinished);
+    QVERIFY(spy.wait(WAIT_TIMEOUT));
+
+    Samples samples;
+    for (int i = 0; i < THEME_SWITCH_COUNT; i++) {
+      qint64 allocations = s_allocations.load();
+      QElapsedTimer timer;
+      timer.start();
+      Config::singleton().setTheme(i % 2 == 0 ? otherTheme : theme, true);
+      while (!isReformatted(&doc) && timer.elapsed() < WAIT_TIMEOUT) {
+        QCoreApplication::processEvents();
+      }
+      QVERIFY(isReformatted(&doc));
+      samples.msecs.append(timer.nsecsElapsed() / 1000000.0);
+      samples.allocations += s_allocations.load() - allocations;
+    }
+    Config::singleton().setTheme(theme, true);
+    record("changeTheme", text, samples);
+  }
+};
+
+}  // namespace core
+
+QTEST_MAIN(core::GrammarBenchmark)
+#include "GrammarBenchmark.moc"
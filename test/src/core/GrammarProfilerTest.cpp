@@ -0,0 +1,101 @@
+#include <limits>
+#include <QtTest/QtTest>
+
+#include "GrammarProfiler.h"
+#include "LanguageParser.h"
+
+namespace core {
+
+class GrammarProfilerTest : public QObject {
+  Q_OBJECT
+ private slots:
+  void init() {
+    GrammarProfiler::singleton().reset();
+    GrammarProfiler::singleton().stop();
+  }
+
+  void report() {
+    QVERIFY(LanguageProvider::loadLanguage("testdata/grammers/C.tmLanguage"));
+    QVERIFY(LanguageProvider::loadLanguage("testdata/grammers/C++.tmLanguage"));
+
+    QString in = R"(int hoge() {
+  nullptr;
+}
+)";
+    std::unique_ptr<LanguageParser> parser(LanguageParser::create("source.c++", in));
+    QVERIFY(parser);
+    GrammarProfiler::singleton().start();
+    QVERIFY(GrammarProfiler::singleton().isRunning());
+    QVERIFY(parser->parse());
+    GrammarProfiler::singleton().stop();
+
+    const QVariantList report = GrammarProfiler::singleton().report();
+    QVERIFY(!report.isEmpty());
+
+    bool hasBlock = false;
+    double prevTime = std::numeric_limits<double>::max();
+    for (const QVariant& var : report) {
+      const QVariantMap map = var.toMap();
+      const int searches = map.value("searches").toInt();
+      QVERIFY(searches > 0);
+      QCOMPARE(map.value("matches").toInt() + map.value("misses").toInt(), searches);
+      QVERIFY(map.value("file").toString().endsWith(".tmLanguage"));
+
+      // sorted by time in descending order
+      const double time = map.value("time").toDouble();
+      QVERIFY(time <= prevTime);
+      prevTime = time;
+
+      if (map.value("grammar").toString() == "source.c" &&
+          map.value("repositoryKey").toString() == "block" &&
+          map.value("regex").toString() == "\\{") {
+        hasBlock = true;
+        QVERIFY(map.value("matches").toInt() > 0);
+      }
+    }
+    QVERIFY(hasBlock);
+
+    // limit
+    QCOMPARE(GrammarProfiler::singleton().report(1).size(), 1);
+  }
+
+  void recompile() {
+    QVERIFY(LanguageProvider::loadLanguage("testdata/grammers/Ruby.plist"));
+
+    QString in = R"(a = <<EOS
+foo
+EOS
+)";
+    std::unique_ptr<LanguageParser> parser(LanguageParser::create("source.ruby", in));
+    QVERIFY(parser);
+    GrammarProfiler::singleton().start();
+    QVERIFY(parser->parse());
+    GrammarProfiler::singleton().stop();
+
+    bool found = false;
+    for (const QVariant& var : GrammarProfiler::singleton().report()) {
+      const QVariantMap map = var.toMap();
+      if (map.value("regex").toString() == "^\\1$") {
+        found = true;
+        QVERIFY(map.value("recompiles").toInt() > 0);
+        QCOMPARE(map.value("searches").toInt(), map.value("recompiles").toInt());
+      }
+    }
+    QVERIFY(found);
+  }
+
+  void disabled() {
+    QVERIFY(LanguageProvider::loadLanguage("testdata/grammers/C.tmLanguage"));
+
+    std::unique_ptr<LanguageParser> parser(LanguageParser::create("source.c", "int a;"));
+    QVERIFY(parser);
+    QVERIFY(!GrammarProfiler::singleton().isRunning());
+    QVERIFY(parser->parse());
+    QVERIFY(GrammarProfiler::singleton().report().isEmpty());
+  }
+};
+
+}  // namespace core
+
+QTEST_MAIN(core::GrammarProfilerTest)
+#include "GrammarProfilerTest.moc"
@@ -0,0 +1,173 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <QtTest/QtTest>
+
+#include "atom/node_bindings_linux.h"
+
+namespace atom {
+
+namespace {
+
+// Allowed delay of a wakeup. This is generous for loaded CI machines.
+constexpr int TOLERANCE_MS = 50;
+
+class TestNodeBindings : public NodeBindingsLinux {
+ public:
+  using NodeBindingsLinux::PollEvents;
+  using NodeBindings::WakeupEmbedThread;
+
+  uv_loop_t* loop() { return uv_loop_; }
+};
+
+// Keeps all the cores busy while it's alive
+class CpuLoad {
+ public:
+  CpuLoad() : m_stopped(false) {
+    for (int i = 0; i < QThread::idealThreadCount(); i++) {
+      m_threads.emplace_back([this] {
+        volatile quint64 n = 0;
+        while (!m_stopped.load(std::memory_order_relaxed)) {
+          n++;
+        }
+      });
+    }
+  }
+
+  ~CpuLoad() {
+    m_stopped = true;
+    for (auto& thread : m_threads) {
+      thread.join();
+    }
+  }
+
+ private:
+  std::atomic<bool> m_stopped;
+  std::vector<std::thread> m_threads;
+};
+
+void countCallback(uv_timer_t* handle) {
+  (*static_cast<int*>(handle->data))++;
+}
+
+void readCallback(uv_poll_t* handle, int status, int events) {
+  if (status == 0 && (events & UV_READABLE)) {
+    char c;
+    if (read(handle->io_watcher.fd, &c, 1) == 1) {
+      (*static_cast<int*>(handle->data))++;
+    }
+  }
+}
+}
+
+class NodeBindingsLinuxTest : public QObject {
+  Q_OBJECT
+
+ private:
+  std::unique_ptr<TestNodeBindings> m_bindings;
+
+ private slots:
+  void initTestCase() {
+    m_bindings.reset(new TestNodeBindings());
+    m_bindings->PrepareMessageLoop();
+    // register the watchers to uv's backend fd
+    uv_run(m_bindings->loop(), UV_RUN_NOWAIT);
+  }
+
+  void cleanupTestCase() { m_bindings.reset(); }
+
+  void timerLatency() {
+    CpuLoad load;
+    int count = 0;
+    uv_timer_t timer;
+    uv_timer_init(m_bindings->loop(), &timer);
+    timer.data = &count;
+
+    for (int i = 0; i < 10; i++) {
+      uv_update_time(m_bindings->loop());
+      uv_timer_start(&timer, countCallback, 20, 0);
+
+      QElapsedTimer elapsed;
+      elapsed.start();
+      m_bindings->PollEvents();
+      const qint64 msecs = elapsed.elapsed();
+      // doesn't return early
+      QVERIFY2(msecs >= 19, qPrintable(QString::number(msecs)));
+      QVERIFY2(msecs < 20 + TOLERANCE_MS, qPrintable(QString::number(msecs)));
+
+      uv_run(m_bindings->loop(), UV_RUN_NOWAIT);
+      QCOMPARE(count, i + 1);
+    }
+
+    uv_close(reinterpret_cast<uv_handle_t*>(&timer), nullptr);
+    uv_run(m_bindings->loop(), UV_RUN_NOWAIT);
+  }
+
+  void ioLatency() {
+    int fds[2];
+    QCOMPARE(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+
+    CpuLoad load;
+    int count = 0;
+    uv_poll_t poll;
+    uv_poll_init(m_bindings->loop(), &poll, fds[0]);
+    poll.data = &count;
+    uv_poll_start(&poll, UV_READABLE, readCallback);
+    uv_run(m_bindings->loop(), UV_RUN_NOWAIT);
+
+    qint64 maxLatency = 0;
+    for (int i = 0; i < 20; i++) {
+      QElapsedTimer elapsed;
+      elapsed.start();
+      std::thread writer([&] {
+        QThread::msleep(10);
+        if (write(fds[1], "x", 1) != 1) {
+          qWarning("write failed");
+        }
+      });
+      m_bindings->PollEvents();
+      maxLatency = qMax(maxLatency, elapsed.elapsed() - 10);
+      writer.join();
+
+      uv_run(m_bindings->loop(), UV_RUN_NOWAIT);
+      QCOMPARE(count, i + 1);
+    }
+    qDebug("max I/O callback latency: %lld ms", maxLatency);
+    QVERIFY(maxLatency >= 0);
+    QVERIFY(maxLatency < TOLERANCE_MS);
+
+    uv_close(reinterpret_cast<uv_handle_t*>(&poll), nullptr);
+    uv_run(m_bindings->loop(), UV_RUN_NOWAIT);
+    close(fds[0]);
+    close(fds[1]);
+  }
+
+  // PollEvents blocks without busy looping until something happens
+  void idle() {
+    std::atomic<bool> returned(false);
+    std::thread poller([&] {
+      m_bindings->PollEvents();
+      returned = true;
+    });
+
+    QThread::msleep(100);
+    QVERIFY(!returned);
+
+    QElapsedTimer elapsed;
+    elapsed.start();
+    m_bindings->WakeupEmbedThread();
+    poller.join();
+    QVERIFY(returned);
+    QVERIFY(elapsed.elapsed() < TOLERANCE_MS);
+
+    // handle the wakeup
+    uv_run(m_bindings->loop(), UV_RUN_NOWAIT);
+  }
+};
+
+}  // namespace atom
+
+QTEST_MAIN(atom::NodeBindingsLinuxTest)
+#include "NodeBindingsLinuxTest.moc"
@@ -0,0 +1,148 @@
+#include <QtTest/QtTest>
+#include <QTemporaryDir>
+
+#include "ProjectFileSystem.h"
+
+namespace core {
+
+namespace {
+void writeFile(const QString& path, const QByteArray& contents = QByteArray()) {
+  QDir().mkpath(QFileInfo(path).path());
+  QFile file(path);
+  QVERIFY(file.open(QIODevice::WriteOnly));
+  file.write(contents);
+}
+
+QStringList names(const QVector<ProjectFileSystem::Entry>& entries) {
+  QStringList names;
+  for (const ProjectFileSystem::Entry& entry : entries) {
+    names.append(entry.name);
+  }
+  return names;
+}
+}
+
+class ProjectFileSystemTest : public QObject {
+  Q_OBJECT
+
+ private slots:
+  void initTestCase() { qRegisterMetaType<ProjectFileSystem::Changes>(); }
+
+  void crawl() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    writeFile(dir.path() + "/b.txt");
+    writeFile(dir.path() + "/A.txt");
+    writeFile(dir.path() + "/sub/c.txt");
+    writeFile(dir.path() + "/sub/deep/d.txt");
+    writeFile(dir.path() + "/.git/e.txt");
+    writeFile(dir.path() + "/node_modules/f.txt");
+    writeFile(dir.path() + "/logo.png");
+
+    ProjectFileSystem fileSystem(dir.path());
+    QSignalSpy readySpy(&fileSystem, &ProjectFileSystem::ready);
+    QVERIFY(!fileSystem.isReady());
+    fileSystem.start();
+    QVERIFY(readySpy.wait());
+    QVERIFY(fileSystem.isReady());
+
+    // directories first, then by name ignoring case
+    // ignored entries are listed but not crawled or indexed, and version control metadata isn't
+    // listed at all
+    const auto entries = fileSystem.entries("");
+    QCOMPARE(names(entries), (QStringList{"node_modules", "sub", "A.txt", "b.txt", "logo.png"}));
+    QVERIFY(entries[0].isIgnored);
+    QVERIFY(!entries[1].isIgnored);
+    QVERIFY(entries[4].isIgnored);
+    QCOMPARE(names(fileSystem.entries("sub")), (QStringList{"deep", "c.txt"}));
+    QVERIFY(fileSystem.entries(".git").isEmpty());
+    QVERIFY(fileSystem.entries("node_modules").isEmpty());
+
+    QStringList files = names(fileSystem.files());
+    files.sort();
+    QCOMPARE(files, (QStringList{"A.txt", "b.txt", "sub/c.txt", "sub/deep/d.txt"}));
+
+    // the entries under an ignored directory are ignored too
+    QSignalSpy changedSpy(&fileSystem, &ProjectFileSystem::changed);
+    fileSystem.fetch("node_modules");
+    QVERIFY(changedSpy.wait());
+    const auto changes = changedSpy[0][0].value<ProjectFileSystem::Changes>();
+    QCOMPARE(changes.changedDirs, QStringList{"node_modules"});
+    QVERIFY(changes.addedFiles.isEmpty());
+    QCOMPARE(names(fileSystem.entries("node_modules")), QStringList{"f.txt"});
+    QVERIFY(fileSystem.entries("node_modules")[0].isIgnored);
+    QCOMPARE(fileSystem.files().size(), 4);
+
+    QString relativePath;
+    QVERIFY(fileSystem.toRelativePath(dir.path() + "/sub/c.txt", relativePath));
+    QCOMPARE(relativePath, QString("sub/c.txt"));
+    QVERIFY(!fileSystem.toRelativePath(dir.path() + "2/c.txt", relativePath));
+    QCOMPARE(fileSystem.absolutePath("sub"), dir.path() + "/sub");
+  }
+
+  void refresh() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    writeFile(dir.path() + "/a.txt");
+    writeFile(dir.path() + "/b.txt");
+    writeFile(dir.path() + "/sub/c.txt");
+
+    ProjectFileSystem fileSystem(dir.path());
+    QSignalSpy readySpy(&fileSystem, &ProjectFileSystem::ready);
+    fileSystem.start();
+    QVERIFY(readySpy.wait());
+
+    QSignalSpy changedSpy(&fileSystem, &ProjectFileSystem::changed);
+    writeFile(dir.path() + "/a.txt", "modified");
+    writeFile(dir.path() + "/new.txt");
+    QVERIFY(QFile::remove(dir.path() + "/b.txt"));
+    QVERIFY(QDir(dir.path() + "/sub").removeRecursively());
+    fileSystem.refresh(dir.path());
+
+    QCOMPARE(changedSpy.size(), 1);
+    const auto changes = changedSpy[0][0].value<ProjectFileSystem::Changes>();
+    QCOMPARE(changes.addedFiles, QStringList{"new.txt"});
+    QCOMPARE(changes.modifiedFiles, QStringList{"a.txt"});
+    QStringList removedFiles = changes.removedFiles;
+    removedFiles.sort();
+    QCOMPARE(removedFiles, (QStringList{"b.txt", "sub/c.txt"}));
+    QVERIFY(changes.changedDirs.contains(""));
+    QVERIFY(changes.changedDirs.contains("sub"));
+    QCOMPARE(names(fileSystem.entries("")), (QStringList{"a.txt", "new.txt"}));
+
+    // nothing has changed since
+    fileSystem.refresh(dir.path());
+    QCOMPARE(changedSpy.size(), 1);
+  }
+
+  void watch() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    writeFile(dir.path() + "/sub/a.txt");
+
+    ProjectFileSystem fileSystem(dir.path());
+    QSignalSpy readySpy(&fileSystem, &ProjectFileSystem::ready);
+    fileSystem.start();
+    QVERIFY(readySpy.wait());
+
+    // a new directory is crawled from a notification of its parent
+    QSignalSpy changedSpy(&fileSystem, &ProjectFileSystem::changed);
+    writeFile(dir.path() + "/sub/new/b.txt");
+    QTRY_VERIFY(fileSystem.entries("sub/new").size() == 1);
+    QVERIFY(!changedSpy.isEmpty());
+
+#ifdef Q_OS_LINUX
+    // a file written in place doesn't change the entries of its directory
+    changedSpy.clear();
+    writeFile(dir.path() + "/sub/a.txt", "modified");
+    QTRY_VERIFY(!changedSpy.isEmpty() &&
+                changedSpy.last()[0].value<ProjectFileSystem::Changes>().modifiedFiles ==
+                    QStringList{"sub/a.txt"});
+#endif
+  }
+};
+
+}  // namespace core
+
+QTEST_MAIN(core::ProjectFileSystemTest)
+#include "ProjectFileSystemTest.moc"
@@ -0,0 +1,180 @@
+#include <QtTest/QtTest>
+#include <QTemporaryDir>
+#include <QTextCodec>
+
+#include "ProjectSearch.h"
+#include "Regexp.h"
+
+namespace core {
+
+namespace {
+void writeFile(const QString& path, const QByteArray& contents) {
+  QDir().mkpath(QFileInfo(path).path());
+  QFile file(path);
+  QVERIFY(file.open(QIODevice::WriteOnly));
+  file.write(contents);
+}
+}
+
+class ProjectSearchTest : public QObject {
+  Q_OBJECT
+
+ private slots:
+  void initTestCase() { qRegisterMetaType<QVector<ProjectSearch::FileResult>>(); }
+
+  void search() {
+    auto regexp = Regexp::compile("foo");
+    auto matches = ProjectSearch::search(regexp.get(), "foo bar\r\nbaz\nbar foo foo");
+    QCOMPARE(matches.size(), 3);
+    QCOMPARE(matches[0].line, 0);
+    QCOMPARE(matches[0].column, 0);
+    QCOMPARE(matches[0].length, 3);
+    QCOMPARE(matches[0].lineText, QString("foo bar"));
+    QCOMPARE(matches[1].line, 2);
+    QCOMPARE(matches[1].column, 4);
+    QCOMPARE(matches[1].lineText, QString("bar foo foo"));
+    QCOMPARE(matches[2].line, 2);
+    QCOMPARE(matches[2].column, 8);
+
+    // empty matches are ignored
+    regexp = Regexp::compile("x*");
+    QVERIFY(ProjectSearch::search(regexp.get(), "abc").isEmpty());
+    regexp = Regexp::compile("b*");
+    QCOMPARE(ProjectSearch::search(regexp.get(), "abbcb").size(), 2);
+
+    // stops at maxCount
+    regexp = Regexp::compile("foo");
+    matches = ProjectSearch::search(regexp.get(), "foo bar\r\nbaz\nbar foo foo", 2);
+    QCOMPARE(matches.size(), 2);
+    QCOMPARE(matches[1].column, 4);
+  }
+
+  void decode() {
+    QString text;
+    QVERIFY(ProjectSearch::decode(u8"あいう", text));
+    QCOMPARE(text, QString(u8"あいう"));
+
+    // UTF-16 with BOM
+    QVERIFY(ProjectSearch::decode(QTextCodec::codecForName("UTF-16LE")->fromUnicode(
+                                      QString(QChar(QChar::ByteOrderMark)) + "abc"),
+                                  text));
+    QCOMPARE(text, QString("abc"));
+
+    // binary
+    QVERIFY(!ProjectSearch::decode(QByteArray("ab\0cd", 5), text));
+  }
+
+  void start() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    writeFile(dir.path() + "/a.txt", "hello world\nHello again\n");
+    writeFile(dir.path() + "/sub/b.txt", "nothing here\n");
+    writeFile(dir.path() + "/sub/c.txt", "say hello\n");
+    writeFile(dir.path() + "/.git/d.txt", "hello from git\n");
+    writeFile(dir.path() + "/node_modules/e.txt", "hello from node_modules\n");
+    writeFile(dir.path() + "/f.bin", QByteArray("hello\0", 6));
+
+    ProjectSearch search;
+    QSignalSpy foundSpy(&search, &ProjectSearch::found);
+    QSignalSpy finishedSpy(&search, &ProjectSearch::finished);
+    QVERIFY(search.start(dir.path(), "hello"));
+    QVERIFY(search.isRunning());
+    QVERIFY(finishedSpy.wait());
+    QVERIFY(!search.isRunning());
+
+    QMap<QString, int> matchCounts;
+    for (const QList<QVariant>& args : foundSpy) {
+      for (const auto& result : args[0].value<QVector<ProjectSearch::FileResult>>()) {
+        matchCounts[QDir(dir.path()).relativeFilePath(result.path)] = result.matches.size();
+      }
+    }
+    QMap<QString, int> expected{{"a.txt", 2}, {"sub/c.txt", 1}};
+    QCOMPARE(matchCounts, expected);
+
+    QCOMPARE(finishedSpy.size(), 1);
+    QCOMPARE(finishedSpy[0][0].toInt(), 4);  // a.txt, b.txt, c.txt and f.bin
+    QCOMPARE(finishedSpy[0][1].toInt(), 3);
+    QCOMPARE(finishedSpy[0][2].toBool(), false);
+    QCOMPARE(finishedSpy[0][3].toBool(), false);
+  }
+
+  void caseSensitive() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    writeFile(dir.path() + "/a.txt", "hello world\nHello again\n");
+
+    ProjectSearch search;
+    QSignalSpy finishedSpy(&search, &ProjectSearch::finished);
+    QVERIFY(search.start(dir.path(), "Hello", Document::FindFlag::FindCaseSensitively));
+    QVERIFY(finishedSpy.wait());
+    QCOMPARE(finishedSpy[0][1].toInt(), 1);
+  }
+
+  void maxMatchCount() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    writeFile(dir.path() + "/a.txt", "a a a a a\n");
+
+    ProjectSearch search;
+    search.setMaxMatchCount(3);
+    QSignalSpy finishedSpy(&search, &ProjectSearch::finished);
+    QVERIFY(search.start(dir.path(), "a"));
+    QVERIFY(finishedSpy.wait());
+    QCOMPARE(finishedSpy[0][1].toInt(), 3);
+    QCOMPARE(finishedSpy[0][3].toBool(), true);
+  }
+
+  void cancel() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    writeFile(dir.path() + "/a.txt", "a\n");
+
+    ProjectSearch search;
+    QSignalSpy foundSpy(&search, &ProjectSearch::found);
+    QSignalSpy finishedSpy(&search, &ProjectSearch::finished);
+    QVERIFY(search.start(dir.path(), "a"));
+    search.cancel();
+    QVERIFY(!search.isRunning());
+    QCOMPARE(finishedSpy.size(), 1);
+    QCOMPARE(finishedSpy[0][2].toBool(), true);
+
+    // nothing arrives after cancel
+    QTest::qWait(100);
+    QCOMPARE(foundSpy.size(), 0);
+    QCOMPARE(finishedSpy.size(), 1);
+  }
+
+  void restart() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    writeFile(dir.path() + "/a.txt", "a\n");
+
+    ProjectSearch search;
+    int canceledCount = 0;
+    connect(&search, &ProjectSearch::finished, &search,
+            [&](int, int, bool canceled, bool) { canceledCount += canceled ? 1 : 0; },
+            Qt::QueuedConnection);
+    QSignalSpy finishedSpy(&search, &ProjectSearch::finished);
+    QVERIFY(search.start(dir.path(), "a"));
+    QVERIFY(search.start(dir.path(), "a"));
+    QVERIFY(search.start(dir.path(), "a"));
+    QTRY_COMPARE(finishedSpy.size(), 3);
+    QCOMPARE(finishedSpy[2][1].toInt(), 1);
+    QCOMPARE(finishedSpy[2][2].toBool(), false);
+    // Queued calls of other slots aren't dropped by the restarts
+    QTRY_COMPARE(canceledCount, 2);
+  }
+
+  void invalid() {
+    QTemporaryDir dir;
+    ProjectSearch search;
+    QVERIFY(!search.start(dir.path(), "(", Document::FindFlag::FindRegex));
+    QVERIFY(!search.start(dir.path() + "/missing", "a"));
+    QVERIFY(!search.isRunning());
+  }
+};
+
+}  // namespace core
+
+QTEST_MAIN(core::ProjectSearchTest)
+#include "ProjectSearchTest.moc"
@@ -0,0 +1,94 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <QtTest/QtTest>
+
+#include "RingBuffer.h"
+
+namespace core {
+
+class RingBufferTest : public QObject {
+  Q_OBJECT
+
+ private slots:
+  void pushAndPop() {
+    RingBuffer<QString> buffer(4);
+    QString str;
+    QVERIFY(!buffer.tryPop(str));
+
+    buffer.push("a");
+    buffer.push("b");
+    QVERIFY(buffer.tryPop(str));
+    QCOMPARE(str, QString("a"));
+    QVERIFY(buffer.tryPop(str));
+    QCOMPARE(str, QString("b"));
+    QVERIFY(!buffer.tryPop(str));
+    QCOMPARE(buffer.takeDroppedCount(), 0);
+  }
+
+  void dropOldest() {
+    RingBuffer<int> buffer(4);
+    for (int i = 0; i < 10; i++) {
+      buffer.push(i);
+    }
+    QCOMPARE(buffer.takeDroppedCount(), 6);
+    QCOMPARE(buffer.takeDroppedCount(), 0);
+
+    int n;
+    for (int i = 6; i < 10; i++) {
+      QVERIFY(buffer.tryPop(n));
+      QCOMPARE(n, i);
+    }
+    QVERIFY(!buffer.tryPop(n));
+  }
+
+  void tryPushWhenFull() {
+    RingBuffer<int> buffer(2);
+    int n = 1;
+    QVERIFY(buffer.tryPush(n));
+    QVERIFY(buffer.tryPush(n));
+    QVERIFY(!buffer.tryPush(n));
+  }
+
+  // every pushed element is either popped or counted as dropped
+  void multipleProducers() {
+    const int producerCount = 4;
+    const int countPerProducer = 100000;
+    RingBuffer<int> buffer(256);
+    std::atomic<bool> finished(false);
+    std::atomic<int> popped(0);
+
+    std::thread consumer([&] {
+      int n;
+      while (!finished) {
+        while (buffer.tryPop(n)) {
+          popped++;
+        }
+      }
+      while (buffer.tryPop(n)) {
+        popped++;
+      }
+    });
+
+    std::vector<std::thread> producers;
+    for (int i = 0; i < producerCount; i++) {
+      producers.emplace_back([&] {
+        for (int j = 0; j < countPerProducer; j++) {
+          buffer.push(j);
+        }
+      });
+    }
+    for (auto& producer : producers) {
+      producer.join();
+    }
+    finished = true;
+    consumer.join();
+
+    QCOMPARE(popped + buffer.takeDroppedCount(), producerCount * countPerProducer);
+  }
+};
+
+}  // namespace core
+
+QTEST_MAIN(core::RingBufferTest)
+#include "RingBufferTest.moc"
@@ -0,0 +1,175 @@
+#include <QtTest/QtTest>
+
+#include "LanguageParser.h"
+#include "ScopeCursor.h"
+#include "ScopeTree.h"
+
+namespace core {
+
+namespace {
+// 0-20: "source"
+//   2-8: "string"
+//     2-3: "begin"
+//     7-8: "end"
+//   8-10: ""
+//     9-10: "keyword"
+//   12-15: "comment"
+RootNode createTree() {
+  Node str("string", Region(2, 8));
+  str.append(Node("begin", Region(2, 3)));
+  str.append(Node("end", Region(7, 8)));
+
+  Node unnamed("", Region(8, 10));
+  unnamed.append(Node("keyword", Region(9, 10)));
+
+  RootNode root("source");
+  root.region = Region(0, 20);
+  root.append(str);
+  root.append(unnamed);
+  root.append(Node("comment", Region(12, 15)));
+  return root;
+}
+}
+
+class ScopeCursorTest : public QObject {
+  Q_OBJECT
+ private slots:
+  void seekForward();
+  void seekBackward();
+  void runEnd();
+  void contentNameChildren();
+  void largeContentName();
+  void scopeStackTable();
+};
+
+void ScopeCursorTest::seekForward() {
+  ScopeTree tree(createTree());
+  ScopeStackTable table;
+  ScopeCursor cursor(&table);
+  cursor.reset(&tree);
+
+  QCOMPARE(table.name(cursor.seek(0)), QString("source"));
+  QCOMPARE(table.name(cursor.seek(2)), QString("source string begin"));
+  QCOMPARE(cursor.region(), Region(2, 3));
+  QCOMPARE(table.name(cursor.seek(3)), QString("source string"));
+  QCOMPARE(table.name(cursor.seek(7)), QString("source string end"));
+  // unnamed node doesn't add a scope name
+  QCOMPARE(table.name(cursor.seek(8)), QString("source"));
+  QCOMPARE(cursor.region(), Region(8, 10));
+  QCOMPARE(table.name(cursor.seek(9)), QString("source keyword"));
+  QCOMPARE(table.name(cursor.seek(13)), QString("source comment"));
+  QCOMPARE(table.name(cursor.seek(19)), QString("source"));
+  QCOMPARE(cursor.seek(20), -1);
+  QVERIFY(!cursor.node());
+}
+
+void ScopeCursorTest::seekBackward() {
+  ScopeTree tree(createTree());
+  ScopeStackTable table;
+  ScopeCursor cursor(&table);
+  cursor.reset(&tree);
+
+  QCOMPARE(table.name(cursor.seek(13)), QString("source comment"));
+  QCOMPARE(table.name(cursor.seek(7)), QString("source string end"));
+  QCOMPARE(table.name(cursor.seek(2)), QString("source string begin"));
+}
+
+void ScopeCursorTest::runEnd() {
+  ScopeTree tree(createTree());
+  ScopeStackTable table;
+  ScopeCursor cursor(&table);
+  cursor.reset(&tree);
+
+  cursor.seek(0);
+  QCOMPARE(cursor.runEnd(), 2);
+  cursor.seek(3);
+  QCOMPARE(cursor.runEnd(), 7);
+  cursor.seek(9);
+  QCOMPARE(cursor.runEnd(), 10);
+  cursor.seek(15);
+  QCOMPARE(cursor.runEnd(), 20);
+}
+
+void ScopeCursorTest::contentNameChildren() {
+  // 0-20: "source"
+  //   2-15: "body" (contentName)
+  //   5-8: "keyword"
+  //   10-12: "string"
+  RootNode root("source");
+  root.region = Region(0, 20);
+  root.append(Node("body", Region(2, 15)));
+  root.append(Node("keyword", Region(5, 8)));
+  root.append(Node("string", Region(10, 12)));
+  ScopeTree tree(root);
+  // body covers the others, so they become its children
+  QCOMPARE(tree.root().childCount(), 1);
+  QCOMPARE(tree.root().child(0).childCount(), 2);
+
+  ScopeStackTable table;
+  ScopeCursor cursor(&table);
+  cursor.reset(&tree);
+
+  QCOMPARE(table.name(cursor.seek(3)), QString("source body"));
+  QCOMPARE(cursor.runEnd(), 5);
+  QCOMPARE(table.name(cursor.seek(5)), QString("source body keyword"));
+  QCOMPARE(table.name(cursor.seek(8)), QString("source body"));
+  QCOMPARE(cursor.runEnd(), 10);
+  QCOMPARE(table.name(cursor.seek(11)), QString("source body string"));
+  QCOMPARE(table.name(cursor.seek(13)), QString("source body"));
+  QCOMPARE(cursor.runEnd(), 15);
+  QCOMPARE(table.name(cursor.seek(16)), QString("source"));
+  QCOMPARE(table.name(cursor.seek(6)), QString("source body keyword"));
+}
+
+void ScopeCursorTest::largeContentName() {
+  // A heredoc or a block comment with contentName may contain thousands of pattern nodes, which the
+  // parser appends before the contentName node
+  const int count = 10000;
+  RootNode root("source");
+  root.region = Region(0, count * 4 + 4);
+  for (int i = 0; i < count; i++) {
+    root.append(Node("keyword", Region(i * 4 + 3, i * 4 + 5)));
+  }
+  root.append(Node("body", Region(1, count * 4 + 2)));
+  root.append(Node("end", Region(count * 4 + 2, count * 4 + 3)));
+  // overlaps the end of body
+  root.children[count - 1].region = Region(count * 4 - 1, count * 4 + 3);
+  ScopeTree tree(root);
+  QCOMPARE(tree.root().childCount(), 2);
+  QCOMPARE(tree.root().child(0).childCount(), count);
+
+  ScopeStackTable table;
+  ScopeCursor cursor(&table);
+  cursor.reset(&tree);
+
+  QCOMPARE(table.name(cursor.seek(0)), QString("source"));
+  QCOMPARE(cursor.runEnd(), 1);
+  for (int i = 0; i < count - 1; i++) {
+    QCOMPARE(table.name(cursor.seek(i * 4 + 3)), QString("source body keyword"));
+    QCOMPARE(cursor.runEnd(), i * 4 + 5);
+    QCOMPARE(table.name(cursor.seek(i * 4 + 5)), QString("source body"));
+    QCOMPARE(cursor.runEnd(), i * 4 + 7);
+  }
+  // The last keyword is clipped to body
+  QCOMPARE(table.name(cursor.seek(count * 4 - 1)), QString("source body keyword"));
+  QCOMPARE(cursor.runEnd(), count * 4 + 2);
+  QCOMPARE(table.name(cursor.seek(count * 4 + 2)), QString("source end"));
+  QCOMPARE(table.name(cursor.seek(count * 2 + 3)), QString("source body keyword"));
+}
+
+void ScopeCursorTest::scopeStackTable() {
+  ScopeStackTable table;
+  int source = table.push(ScopeStackTable::EMPTY_ID, "source");
+  QCOMPARE(table.push(ScopeStackTable::EMPTY_ID, "source"), source);
+  QCOMPARE(table.push(source, ""), source);
+
+  int str = table.push(source, "string");
+  QVERIFY(str != source);
+  QCOMPARE(table.name(str), QString("source string"));
+  QVERIFY(table.push(ScopeStackTable::EMPTY_ID, "string") != str);
+}
+
+}  // namespace core
+
+QTEST_MAIN(core::ScopeCursorTest)
+#include "ScopeCursorTest.moc"
@@ -0,0 +1,227 @@
+#include <QtTest/QtTest>
+
+#include "LanguageParser.h"
+#include "ScopeTree.h"
+
+namespace core {
+
+namespace {
+// 0-40: "source"
+//   2-12: "block"
+//     2-3: "begin"
+//     4-8: "string"
+//       4-5: "quote"
+//     11-12: "end"
+//   14-20: "comment"
+//   22-30: "function"
+//     22-26: "name"
+//   32-34: "keyword"
+RootNode createTree() {
+  Node str("string", Region(4, 8));
+  str.append(Node("quote", Region(4, 5)));
+
+  Node block("block", Region(2, 12));
+  block.append(Node("begin", Region(2, 3)));
+  block.append(str);
+  block.append(Node("end", Region(11, 12)));
+
+  Node function("function", Region(22, 30));
+  function.append(Node("name", Region(22, 26)));
+
+  RootNode root("source");
+  root.region = Region(0, 40);
+  root.append(block);
+  root.append(Node("comment", Region(14, 20)));
+  root.append(function);
+  root.append(Node("keyword", Region(32, 34)));
+  return root;
+}
+
+// Adjusts every node in the tree like RootNode::adjust did
+void adjust(Node& node, int pos, int delta) {
+  for (auto& child : node.children) {
+    child.region.adjust(pos, delta);
+    adjust(child, pos, delta);
+  }
+}
+
+void adjust(RootNode& root, int pos, int delta) {
+  root.region.setEnd(root.region.end() + delta);
+  adjust(static_cast<Node&>(root), pos, delta);
+}
+
+QString toString(const Node& node) {
+  return node.toString(QString());
+}
+}
+
+class ScopeTreeTest : public QObject {
+  Q_OBJECT
+ private slots:
+  void toRootNode();
+  void adjust_data();
+  void adjust();
+  void adjustConsecutively();
+  void nestCoveredChildren();
+  void replaceChildren();
+  void replaceOverlappedChildren();
+  void childRegions();
+  void visit();
+};
+
+void ScopeTreeTest::toRootNode() {
+  RootNode root = createTree();
+  ScopeTree tree(root);
+  QCOMPARE(toString(tree.toRootNode()), toString(root));
+}
+
+void ScopeTreeTest::adjust_data() {
+  QTest::addColumn<int>("pos");
+  QTest::addColumn<int>("delta");
+
+  QTest::newRow("insert before all") << 0 << 3;
+  QTest::newRow("insert in nested node") << 6 << 2;
+  QTest::newRow("insert at the end of node") << 8 << 1;
+  QTest::newRow("insert between nodes") << 21 << 5;
+  QTest::newRow("remove in nested node") << 7 << -2;
+  QTest::newRow("remove across nodes") << 16 << -8;
+  QTest::newRow("remove whole node") << 20 << -6;
+}
+
+void ScopeTreeTest::adjust() {
+  QFETCH(int, pos);
+  QFETCH(int, delta);
+
+  RootNode root = createTree();
+  ScopeTree tree(root);
+  tree.adjust(pos, delta);
+  core::adjust(root, pos, delta);
+  QCOMPARE(toString(tree.toRootNode()), toString(root));
+}
+
+void ScopeTreeTest::adjustConsecutively() {
+  RootNode root = createTree();
+  ScopeTree tree(root);
+
+  // typing forward, then moving backward and removing
+  const QVector<QPair<int, int>> edits({{15, 1}, {16, 1}, {17, 1}, {24, 2}, {5, 1}, {3, -1}, {36, -2}});
+  for (const auto& edit : edits) {
+    tree.adjust(edit.first, edit.second);
+    core::adjust(root, edit.first, edit.second);
+    QCOMPARE(toString(tree.toRootNode()), toString(root));
+  }
+}
+
+void ScopeTreeTest::nestCoveredChildren() {
+  // contentName node covers a sibling node
+  Node str("string", Region(2, 12));
+  str.append(Node("begin", Region(2, 3)));
+  str.append(Node("escape", Region(5, 7)));
+  str.append(Node("content", Region(3, 11)));
+  str.append(Node("end", Region(11, 12)));
+
+  RootNode root("source");
+  root.region = Region(0, 20);
+  root.append(str);
+  ScopeTree tree(root);
+
+  // escape becomes a child of content
+  Node content("content", Region(3, 11));
+  content.append(Node("escape", Region(5, 7)));
+  Node nestedStr("string", Region(2, 12));
+  nestedStr.append(Node("begin", Region(2, 3)));
+  nestedStr.append(content);
+  nestedStr.append(Node("end", Region(11, 12)));
+  RootNode nested("source");
+  nested.region = Region(0, 20);
+  nested.append(nestedStr);
+  QCOMPARE(toString(tree.toRootNode()), toString(nested));
+
+  tree.adjust(4, 2);
+  core::adjust(nested, 4, 2);
+  QCOMPARE(toString(tree.toRootNode()), toString(nested));
+
+  tree.adjust(8, -3);
+  core::adjust(nested, 8, -3);
+  QCOMPARE(toString(tree.toRootNode()), toString(nested));
+}
+
+void ScopeTreeTest::replaceChildren() {
+  RootNode root = createTree();
+  ScopeTree tree(root);
+  tree.adjust(16, 2);
+  core::adjust(root, 16, 2);
+
+  // replace comment and function with new nodes
+  QList<Node> newNodes;
+  newNodes.append(Node("comment", Region(14, 18)));
+  Node function("function", Region(19, 32));
+  function.append(Node("name", Region(24, 28)));
+  newNodes.append(function);
+  // the removed comment and function extend past the region
+  QCOMPARE(tree.replaceChildren(Region(16, 26), newNodes), Region(14, 32));
+
+  RootNode expected("source");
+  expected.region = root.region;
+  expected.append(root.children[0]);
+  expected.append(newNodes[0]);
+  expected.append(newNodes[1]);
+  expected.append(root.children[3]);
+  QCOMPARE(toString(tree.toRootNode()), toString(expected));
+
+  // nodes after the replaced ones still move
+  tree.adjust(33, 1);
+  core::adjust(expected, 33, 1);
+  QCOMPARE(toString(tree.toRootNode()), toString(expected));
+}
+
+void ScopeTreeTest::replaceOverlappedChildren() {
+  RootNode root = createTree();
+  ScopeTree tree(root);
+
+  // The new comment extends past the region into function and keyword, so they are removed too
+  QList<Node> newNodes;
+  newNodes.append(Node("comment", Region(14, 33)));
+  QCOMPARE(tree.replaceChildren(Region(16, 18), newNodes), Region(14, 34));
+
+  RootNode expected("source");
+  expected.region = root.region;
+  expected.append(root.children[0]);
+  expected.append(newNodes[0]);
+  QCOMPARE(toString(tree.toRootNode()), toString(expected));
+}
+
+void ScopeTreeTest::childRegions() {
+  ScopeTree tree(createTree());
+  tree.adjust(13, 2);
+  QCOMPARE(tree.childRegions(Region(0, 40)),
+           QVector<Region>({Region(2, 12), Region(16, 22), Region(24, 32), Region(34, 36)}));
+  // the nodes after the neighbors are covered by one region
+  QCOMPARE(tree.childRegions(Region(17, 18)),
+           QVector<Region>({Region(2, 12), Region(16, 22), Region(24, 32), Region(32, 36)}));
+  QCOMPARE(tree.childRegions(Region(13, 14)),
+           QVector<Region>({Region(2, 12), Region(16, 22), Region(22, 36)}));
+  QCOMPARE(tree.childRegions(Region(35, 36)), QVector<Region>({Region(24, 32), Region(34, 36)}));
+}
+
+void ScopeTreeTest::visit() {
+  ScopeTree tree(createTree());
+  tree.adjust(13, 2);
+  QStringList visited;
+  tree.visit(Region(4, 25), [&](const ScopeNode& node, const Region& region) {
+    visited.append(node.name() + " " + region.toString());
+    return node.name() != "string";
+  });
+  // "begin" ends before the region and the children of "string" are skipped
+  QCOMPARE(visited, (QStringList{"block " + Region(2, 12).toString(),
+                                 "string " + Region(4, 8).toString(),
+                                 "end " + Region(11, 12).toString(),
+                                 "comment " + Region(16, 22).toString(),
+                                 "function " + Region(24, 32).toString(),
+                                 "name " + Region(24, 28).toString()}));
+}
+
+}  // namespace core
+
+QTEST_MAIN(core::ScopeTreeTest)
+#include "ScopeTreeTest.moc"
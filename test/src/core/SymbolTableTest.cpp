@@ -0,0 +1,154 @@
+#include <QtTest/QtTest>
+#include <QTextDocument>
+
+#include "SymbolTable.h"
+#include "LanguageParser.h"
+#include "Metadata.h"
+#include "TestUtil.h"
+
+namespace core {
+
+namespace {
+const QString text =
+    "func foo\n"
+    "tag bar\n"
+    "hidden func baz\n"
+    "func qux";
+
+// The tmPreferences loaded by initTestCase apply to source.test
+RootNode createRootNode(const QString& scope = "source.test") {
+  Node function("meta.function", Region(0, 8));
+  function.append(Node("entity.name.function.test", Region(5, 8)));
+  Node hidden("meta.hidden", Region(17, 32));
+  hidden.append(Node("entity.name.function", Region(29, 32)));
+  return TestUtil::createRootNode(scope, text.size(),
+                                  {function, Node("entity.name.tag", Region(13, 16)), hidden,
+                                   Node("entity.name.function", Region(38, 41))});
+}
+
+QStringList names(const SymbolTable& table) {
+  QStringList names;
+  for (const Symbol& symbol : table.symbols()) {
+    names.append(symbol.name);
+  }
+  return names;
+}
+}
+
+class SymbolTableTest : public QObject {
+  Q_OBJECT
+
+ private slots:
+  void initTestCase() {
+    Metadata::load("testdata/Symbol List Tag.tmPreferences");
+    Metadata::load("testdata/Symbol List Hidden.tmPreferences");
+    Metadata::load("testdata/Symbol List Comma.tmPreferences");
+  }
+
+  void defaultSelectors() {
+    QTextDocument doc;
+    doc.setPlainText(text);
+    SymbolTable table;
+    table.reset(createRootNode("source.other"), &doc);
+
+    QCOMPARE(names(table), (QStringList{"foo", "baz", "qux"}));
+    QCOMPARE(table.symbols()[0].scope, QString("entity.name.function.test"));
+    QCOMPARE(table.symbols()[0].region, Region(5, 8));
+  }
+
+  void showInSymbolList() {
+    QStringList selectors = Metadata::symbolListSelectors(true);
+    selectors.sort();
+    QCOMPARE(selectors,
+             (QStringList{"source.test entity.name.label, source.test entity.name.constant",
+                          "source.test entity.name.tag"}));
+    QCOMPARE(Metadata::symbolListSelectors(false),
+             QStringList{"source.test meta.hidden entity.name.function"});
+
+    QTextDocument doc;
+    doc.setPlainText(text);
+    SymbolTable table;
+    table.reset(createRootNode(), &doc);
+    QCOMPARE(names(table), (QStringList{"foo", "bar", "qux"}));
+  }
+
+  // A scope selector of tmPreferences can list several selectors separated by commas
+  void commaSeparatedSelectors() {
+    QTextDocument doc;
+    doc.setPlainText(text);
+    SymbolTable table;
+    table.reset(TestUtil::createRootNode("source.test", text.size(),
+                                         {Node("entity.name.label", Region(0, 4)),
+                                          Node("entity.name.constant", Region(9, 12))}),
+                &doc);
+    QCOMPARE(names(table), (QStringList{"func", "tag"}));
+  }
+
+  void indexAt() {
+    QTextDocument doc;
+    doc.setPlainText(text);
+    SymbolTable table;
+    table.reset(createRootNode(), &doc);
+
+    QCOMPARE(table.indexAt(0), -1);
+    QCOMPARE(table.indexAt(5), 0);
+    QCOMPARE(table.indexAt(12), 0);
+    QCOMPARE(table.indexAt(13), 1);
+    QCOMPARE(table.indexAt(100), 2);
+  }
+
+  void adjust() {
+    QTextDocument doc;
+    doc.setPlainText(text);
+    SymbolTable table;
+    table.reset(createRootNode(), &doc);
+
+    // insert 2 characters at the beginning of the second line
+    table.adjust(9, 2);
+    QCOMPARE(table.symbols()[0].region, Region(5, 8));
+    QCOMPARE(table.symbols()[1].region, Region(15, 18));
+    QCOMPARE(table.symbols()[2].region, Region(40, 43));
+
+    // remove them
+    table.adjust(11, -2);
+    QCOMPARE(table.symbols()[1].region, Region(13, 16));
+    QCOMPARE(table.symbols()[2].region, Region(38, 41));
+
+    // insert a character in the first symbol. The following ones are found with the pending delta.
+    table.adjust(6, 1);
+    QCOMPARE(table.indexAt(14), 1);
+    QCOMPARE(table.symbol(2).region, Region(39, 42));
+    QCOMPARE(table.symbols()[0].region, Region(5, 9));
+    QCOMPARE(table.symbols()[1].region, Region(14, 17));
+  }
+
+  void replace() {
+    QTextDocument doc;
+    doc.setPlainText(text);
+    SymbolTable table;
+    table.reset(createRootNode(), &doc);
+
+    // "func qux" -> "func quux"
+    QTextCursor cursor(&doc);
+    cursor.setPosition(40);
+    cursor.insertText("u");
+    table.adjust(40, 1);
+    table.replace(Region(33, 42), QList<Node>{Node("entity.name.function", Region(38, 42))}, &doc);
+    QCOMPARE(names(table), (QStringList{"foo", "bar", "quux"}));
+
+    // a new symbol in the middle
+    table.replace(Region(0, 8), QList<Node>{Node("entity.name.type", Region(0, 4)),
+                                            Node("entity.name.function", Region(5, 8))},
+                  &doc);
+    QCOMPARE(names(table), (QStringList{"func", "foo", "bar", "quux"}));
+
+    // The region covers the removed nodes past the new ones
+    table.replace(Region(0, 16), QList<Node>{Node("entity.name.function", Region(5, 8))}, &doc);
+    QCOMPARE(names(table), (QStringList{"foo", "quux"}));
+  }
+};
+
+}  // namespace core
+
+QTEST_MAIN(core::SymbolTableTest)
+#include "SymbolTableTest.moc"
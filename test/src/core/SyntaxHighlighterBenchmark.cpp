@@ -25,6 +25,8 @@ class SyntaxHighliterBenchmark : public QObject {
     qRegisterMetaType<core::LanguageParser>("core::LanguageParser");
     qRegisterMetaType<core::Region>("Region");
     qRegisterMetaType<core::Region>("core::Region");
+    qRegisterMetaType<QVector<core::Region>>("QVector<Region>");
+    qRegisterMetaType<QVector<core::Region>>("QVector<core::Region>");
     qRegisterMetaType<core::SyntaxHighlighter*>("SyntaxHighlighter*");
     qRegisterMetaType<core::SyntaxHighlighter*>("core::SyntaxHighlighter*");
   }
@@ -40,6 +40,8 @@ class SyntaxHighlighterTest : public QObject {
     qRegisterMetaType<core::LanguageParser>("core::LanguageParser");
     qRegisterMetaType<core::Region>("Region");
     qRegisterMetaType<core::Region>("core::Region");
+    qRegisterMetaType<QVector<core::Region>>("QVector<Region>");
+    qRegisterMetaType<QVector<core::Region>>("QVector<core::Region>");
     qRegisterMetaType<core::SyntaxHighlighter*>("SyntaxHighlighter*");
     qRegisterMetaType<core::SyntaxHighlighter*>("core::SyntaxHighlighter*");
   }
@@ -146,6 +148,59 @@ class hoge {
     checkRegion(cppHighlighter.rootNode(), cppHighlighter.rootNode().region);
   }
 
+  // The symbols of the nodes removed by a partial parse are removed even if they extend past the
+  // reparsed region
+  void partialParseSymbolsTest() {
+    const QVector<QString> files(
+        {"testdata/grammers/C.tmLanguage", "testdata/grammers/C++.tmLanguage"});
+    foreach (QString fn, files) { QVERIFY(LanguageProvider::loadLanguage(fn)); }
+
+    auto symbols = [](const SyntaxHighlighter& highlighter) {
+      QStringList symbols;
+      for (const Symbol& symbol : highlighter.symbolTable().symbols()) {
+        symbols.append(QString("%1 %2").arg(symbol.name, symbol.region.toString()));
+      }
+      return symbols;
+    };
+    auto parsedSymbols = [&](const QString& text) {
+      QTextDocument doc(text);
+      std::unique_ptr<LanguageParser> parser(LanguageParser::create("source.c++", text));
+      SyntaxHighlighter highlighter(&doc, std::move(parser), theme, font);
+      QSignalSpy spy(&highlighter, &SyntaxHighlighter::parseFinished);
+      return spy.wait() ? symbols(highlighter) : QStringList();
+    };
+
+    const QString text = "int foo() {}\n/*\nint bar() {}\nint baz() {}\n*/\nint qux() {}";
+    QTextDocument doc(text);
+    std::unique_ptr<LanguageParser> parser(
+        LanguageParser::create("source.c++", doc.toPlainText()));
+    SyntaxHighlighter highlighter(&doc, std::move(parser), theme, font);
+    QSignalSpy spy(&highlighter, &SyntaxHighlighter::parseFinished);
+    QVERIFY(spy.wait());
+    QCOMPARE(symbols(highlighter), parsedSymbols(doc.toPlainText()));
+
+    // The comment closed early leaves bar and baz out of it
+    QTextCursor cursor(&doc);
+    cursor.setPosition(text.indexOf("*/"));
+    cursor.deleteChar();
+    cursor.deleteChar();
+    highlighter.updateNode(text.indexOf("*/"), 2, 0);
+    QVERIFY(spy.wait());
+    cursor.setPosition(text.indexOf("/*") + 2);
+    cursor.insertText("*/");
+    highlighter.updateNode(text.indexOf("/*") + 2, 0, 2);
+    QVERIFY(spy.wait());
+    QCOMPARE(symbols(highlighter), parsedSymbols(doc.toPlainText()));
+
+    // and the comment opened again covers them
+    cursor.setPosition(text.indexOf("/*") + 2);
+    cursor.deleteChar();
+    cursor.deleteChar();
+    highlighter.updateNode(text.indexOf("/*") + 2, 2, 0);
+    QVERIFY(spy.wait());
+    QCOMPARE(symbols(highlighter), parsedSymbols(doc.toPlainText()));
+  }
+
   void updateNodeWithPaste() {
     const QVector<QString> files({"testdata/grammers/CSS.plist"});
 
@@ -273,6 +328,35 @@ StatusBar QComboBox::down-arrow {
     QCOMPARE(highlighter.asHtml(), resInOutput.readAll());
   }
 
+  void reformatVisibleBlocksFirstTest() {
+    QVERIFY(LanguageProvider::loadLanguage("testdata/grammers/CSS.plist"));
+    QString text;
+    for (int i = 0; i < 3000; i++) {
+      text += "a { color: red; }\n";
+    }
+    QTextDocument doc(text);
+    std::unique_ptr<LanguageParser> parser(LanguageParser::create("source.css", doc.toPlainText()));
+    SyntaxHighlighter highlighter(&doc, std::move(parser), theme, font);
+    QSignalSpy spy(&highlighter, &SyntaxHighlighter::parseFinished);
+    QVERIFY(spy.wait());
+
+    QObject view;
+    highlighter.setVisibleBlocks(&view, 2000, 2010);
+    Theme* monokai = Theme::loadTheme("testdata/Monokai.tmTheme");
+    QVERIFY(monokai);
+    Config::singleton().setTheme(monokai, true);
+
+    // The visible blocks and the first batch are reformatted at once and the rest later
+    auto generation = [&](int blockNumber) {
+      return static_cast<TokenRunsData*>(doc.findBlockByNumber(blockNumber).userData())->generation;
+    };
+    QCOMPARE(generation(2000), generation(0));
+    QCOMPARE(generation(2010), generation(0));
+    QVERIFY(generation(1500) != generation(0));
+    QVERIFY(generation(2011) != generation(0));
+    Config::singleton().setTheme(theme, true);
+  }
+
   void cppHighlightTest() {
     const QVector<QString> files(
         {"testdata/grammers/C.tmLanguage", "testdata/grammers/C++.tmLanguage"});
@@ -0,0 +1,118 @@
+#include <thread>
+#include <QtTest/QtTest>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include "Tracer.h"
+
+namespace core {
+
+namespace {
+QJsonArray traceEvents() {
+  return QJsonDocument::fromJson(Tracer::singleton().toJson())
+      .object()
+      .value("traceEvents")
+      .toArray();
+}
+
+QList<QJsonObject> findEvents(const QJsonArray& events, const QString& name) {
+  QList<QJsonObject> found;
+  for (const QJsonValue& value : events) {
+    if (value.toObject().value("name").toString() == name) {
+      found.append(value.toObject());
+    }
+  }
+  return found;
+}
+}
+
+class TracerTest : public QObject {
+  Q_OBJECT
+ private slots:
+  void init() {
+    Tracer::singleton().stop();
+    Tracer::singleton().reset();
+  }
+
+  void span() {
+    Tracer::singleton().start();
+    QVERIFY(Tracer::singleton().isRunning());
+    {
+      TraceScope outer("outer");
+      TraceScope inner("inner");
+      QThread::msleep(5);
+    }
+    Tracer::singleton().stop();
+
+    const QJsonArray events = traceEvents();
+    const auto outer = findEvents(events, "outer");
+    const auto inner = findEvents(events, "inner");
+    QCOMPARE(outer.size(), 1);
+    QCOMPARE(inner.size(), 1);
+    QCOMPARE(outer[0].value("ph").toString(), QString("X"));
+
+    // ts and dur are in microseconds
+    QVERIFY(inner[0].value("dur").toDouble() >= 5000);
+    QVERIFY(outer[0].value("ts").toDouble() <= inner[0].value("ts").toDouble());
+    QVERIFY(outer[0].value("dur").toDouble() >= inner[0].value("dur").toDouble());
+    QCOMPARE(outer[0].value("tid").toInt(), inner[0].value("tid").toInt());
+  }
+
+  void counterAndInstant() {
+    Tracer::singleton().start();
+    Tracer::counter("counter", 42);
+    Tracer::instant("instant");
+    Tracer::singleton().stop();
+
+    const QJsonArray events = traceEvents();
+    const auto counters = findEvents(events, "counter");
+    QCOMPARE(counters.size(), 1);
+    QCOMPARE(counters[0].value("ph").toString(), QString("C"));
+    QCOMPARE(counters[0].value("args").toObject().value("value").toInt(), 42);
+    QCOMPARE(findEvents(events, "instant").size(), 1);
+  }
+
+  void stopped() {
+    {
+      TraceScope scope("stopped");
+    }
+    Tracer::counter("stoppedCounter", 1);
+    const QJsonArray events = traceEvents();
+    QVERIFY(findEvents(events, "stopped").isEmpty());
+    QVERIFY(findEvents(events, "stoppedCounter").isEmpty());
+  }
+
+  void threads() {
+    Tracer::singleton().start();
+    {
+      TraceScope scope("main");
+    }
+    std::thread thread([] { TraceScope scope("other"); });
+    thread.join();
+    Tracer::singleton().stop();
+
+    const QJsonArray events = traceEvents();
+    const auto main = findEvents(events, "main");
+    const auto other = findEvents(events, "other");
+    QCOMPARE(main.size(), 1);
+    QCOMPARE(other.size(), 1);
+    QVERIFY(main[0].value("tid").toInt() != other[0].value("tid").toInt());
+    QVERIFY(!findEvents(events, "thread_name").isEmpty());
+  }
+
+  void save() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.path() + "/trace.json";
+    QVERIFY(Tracer::singleton().save(path));
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QVERIFY(QJsonDocument::fromJson(file.readAll()).object().contains("traceEvents"));
+  }
+};
+
+}  // namespace core
+
+QTEST_MAIN(core::TracerTest)
+#include "TracerTest.moc"
@@ -0,0 +1,116 @@
+#include <QtTest/QtTest>
+#include <QTemporaryDir>
+
+#include "TrigramIndex.h"
+
+namespace core {
+
+namespace {
+void writeFile(const QString& path, const QByteArray& contents) {
+  QDir().mkpath(QFileInfo(path).path());
+  QFile file(path);
+  QVERIFY(file.open(QIODevice::WriteOnly));
+  file.write(contents);
+}
+
+quint32 trigram(const char* str) {
+  return quint8(str[0]) << 16 | quint8(str[1]) << 8 | quint8(str[2]);
+}
+
+QStringList relativePaths(const QDir& dir, const boost::optional<QStringList>& paths) {
+  QStringList relativePaths;
+  for (const QString& path : *paths) {
+    relativePaths.append(dir.relativeFilePath(path));
+  }
+  relativePaths.sort();
+  return relativePaths;
+}
+}
+
+class TrigramIndexTest : public QObject {
+  Q_OBJECT
+
+ private slots:
+  void trigrams() {
+    QCOMPARE(TrigramIndex::trigrams("ab"), QVector<quint32>());
+    QCOMPARE(TrigramIndex::trigrams("abcAbc"),
+             (QVector<quint32>{trigram("abc"), trigram("bca"), trigram("cab")}));
+  }
+
+  void queryTrigrams() {
+    QCOMPARE(TrigramIndex::queryTrigrams("Abcd", 0),
+             (QVector<quint32>{trigram("abc"), trigram("bcd")}));
+    QVERIFY(TrigramIndex::queryTrigrams("ab", 0).isEmpty());
+
+    const Document::FindFlags regex = Document::FindFlag::FindRegex;
+    QCOMPARE(TrigramIndex::queryTrigrams("abc.*def", regex),
+             (QVector<quint32>{trigram("abc"), trigram("def")}));
+    // 'd' is optional
+    QCOMPARE(TrigramIndex::queryTrigrams("abcd?", regex), QVector<quint32>{trigram("abc")});
+    QCOMPARE(TrigramIndex::queryTrigrams("ab\\.c", regex),
+             (QVector<quint32>{trigram("ab."), trigram("b.c")}));
+    QCOMPARE(TrigramIndex::queryTrigrams("\\bfoo\\b", regex), QVector<quint32>{trigram("foo")});
+    QCOMPARE(TrigramIndex::queryTrigrams("(x|y)abc[de]", regex), QVector<quint32>{trigram("abc")});
+    QVERIFY(TrigramIndex::queryTrigrams("abc|def", regex).isEmpty());
+    QVERIFY(TrigramIndex::queryTrigrams("(?x)a b c", regex).isEmpty());
+  }
+
+  void candidates() {
+    QTemporaryDir dir;
+    QTemporaryDir indexDir;
+    QVERIFY(dir.isValid());
+    QVERIFY(indexDir.isValid());
+    writeFile(dir.path() + "/a.txt", "hello world\n");
+    writeFile(dir.path() + "/sub/b.txt", "nothing here\n");
+    writeFile(dir.path() + "/sub/c.txt", "say HELLO\n");
+    writeFile(dir.path() + "/node_modules/d.txt", "hello\n");
+    writeFile(dir.path() + "/e.bin", QByteArray("hello\0", 6));
+    // not UTF-8
+    writeFile(dir.path() + "/f.txt", "\xff\xfe\xfd");
+
+    const QString indexPath = indexDir.path() + "/index";
+    {
+      ProjectFileSystem fileSystem(dir.path());
+      TrigramIndex index(&fileSystem, indexPath);
+      QSignalSpy readySpy(&index, &TrigramIndex::ready);
+      index.update();
+      QVERIFY(!index.isReady());
+      // The index is built after the first crawl
+      fileSystem.start();
+      QVERIFY(readySpy.wait());
+      QVERIFY(index.isReady());
+      QVERIFY(QFileInfo(indexPath).exists());
+
+      auto snapshot = index.snapshot();
+      QCOMPARE(relativePaths(dir.path(), snapshot->candidates("hello", 0, dir.path())),
+               (QStringList{"a.txt", "f.txt", "sub/c.txt"}));
+      QCOMPARE(relativePaths(dir.path(), snapshot->candidates("hello", 0, dir.path() + "/sub")),
+               QStringList{"sub/c.txt"});
+      QVERIFY(!snapshot->candidates("he", 0, dir.path()));
+      QVERIFY(snapshot->canNarrow("hello", 0, dir.path() + "/sub"));
+      QVERIFY(!snapshot->canNarrow("he", 0, dir.path()));
+      QVERIFY(!snapshot->canNarrow("hello", 0, QDir::tempPath() + "/outside"));
+
+      // a changed file is a candidate until the index is rebuilt
+      writeFile(dir.path() + "/sub/b.txt", "hello\n");
+      index.markChanged(dir.path() + "/sub/b.txt");
+      QCOMPARE(relativePaths(dir.path(), index.snapshot()->candidates("hello", 0, dir.path())),
+               (QStringList{"a.txt", "f.txt", "sub/b.txt", "sub/c.txt"}));
+    }
+
+    // The saved index is loaded and files changed since then are candidates
+    ProjectFileSystem fileSystem(dir.path());
+    TrigramIndex index(&fileSystem, indexPath);
+    QSignalSpy readySpy(&index, &TrigramIndex::ready);
+    fileSystem.start();
+    index.update();
+    QVERIFY(readySpy.wait());
+    QCOMPARE(relativePaths(dir.path(), index.snapshot()->candidates("world", 0, dir.path())),
+             (QStringList{"a.txt", "f.txt", "sub/b.txt"}));
+  }
+};
+
+}  // namespace core
+
+QTEST_MAIN(core::TrigramIndexTest)
+#include "TrigramIndexTest.moc"
@@ -47,6 +47,13 @@ class UtilTest : public QObject {
     QCOMPARE(idx, 0);
   }
 
+  void toAsciiLower() {
+    // non-ASCII bytes are kept as they are
+    QCOMPARE(Util::toAsciiLower(QByteArray("FooBar_1/\xC3\x84")), QByteArray("foobar_1/\xC3\x84"));
+    QCOMPARE(Util::toAsciiLower('Z'), 'z');
+    QCOMPARE(Util::toAsciiLower(uchar(0xC4)), uchar(0xC4));
+  }
+
   void toStdStringList() {
     const QStringList qStrList = {"user/local", "sys/bin", "var/lib/hoge_fuga"};
     std::list<std::string> stdStringList = Util::toStdStringList(qStrList);
@@ -0,0 +1,53 @@
+#include <QtTest/QtTest>
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QTextDocument>
+#include <unicode/putil.h>
+
+#include "WordSegmenter.h"
+
+namespace core {
+
+class WordSegmenterTest : public QObject {
+  Q_OBJECT
+
+ private slots:
+  void initTestCase() {
+    u_setDataDirectory(QCoreApplication::applicationDirPath().toUtf8().constData());
+  }
+
+  void boundaries() {
+    QCOMPARE(WordSegmenter::boundaries(u8"単語単位に分割する", "ja_JP"),
+             QVector<int>({0, 2, 4, 5, 7, 9}));
+    QCOMPARE(WordSegmenter::boundaries("A brown", "en_US"), QVector<int>({0, 1, 2, 7}));
+    QCOMPARE(WordSegmenter::boundaries("", "en_US"), QVector<int>({0}));
+  }
+
+  void iteratorIsReused() {
+    QCOMPARE(WordSegmenter::iterator("ja_JP"), WordSegmenter::iterator("ja_JP"));
+  }
+
+  void blockBoundaries() {
+    QTextDocument doc(u8"abc\n単語単位に分割する");
+    QTextBlock block = doc.findBlockByNumber(1);
+    QCOMPARE(WordSegmenter::boundaries(block, "ja_JP"), QVector<int>({0, 2, 4, 5, 7, 9}));
+    // cached
+    QCOMPARE(WordSegmenter::boundaries(block, "ja_JP"), QVector<int>({0, 2, 4, 5, 7, 9}));
+
+    // The cache is updated after an edit
+    QTextCursor cursor(block);
+    cursor.movePosition(QTextCursor::EndOfBlock);
+    cursor.insertText(" abc");
+    QCOMPARE(WordSegmenter::boundaries(doc.findBlockByNumber(1), "ja_JP"),
+             QVector<int>({0, 2, 4, 5, 7, 9, 10, 13}));
+
+    // A new block above shifts block numbers
+    QTextCursor(&doc).insertText("new\n");
+    QCOMPARE(WordSegmenter::boundaries(doc.findBlockByNumber(1), "ja_JP"), QVector<int>({0, 3}));
+  }
+};
+
+}  // namespace core
+
+QTEST_MAIN(core::WordSegmenterTest)
+#include "WordSegmenterTest.moc"
@@ -0,0 +1,120 @@
+#include <libplatform/libplatform.h>
+#include <node.h>
+#include <QtTest/QtTest>
+#include <QTemporaryDir>
+
+#include "Worker.h"
+#include "Document.h"
+
+using namespace v8;
+
+namespace core {
+
+class WorkerTest : public QObject {
+  Q_OBJECT
+
+ private:
+  Platform* m_platform;
+  QTemporaryDir m_dir;
+
+  QString writeScript(const QString& name, const QString& script) {
+    const QString& path = m_dir.path() + "/" + name;
+    QFile file(path);
+    if (file.open(QIODevice::WriteOnly)) {
+      file.write(script.toUtf8());
+    }
+    return path;
+  }
+
+ private slots:
+  void initTestCase() {
+    V8::InitializeICU();
+    // v8::CreateDefaultPlatform is not exposed in dll
+    m_platform = node::CreateDefaultPlatform();
+    V8::InitializePlatform(m_platform);
+    V8::Initialize();
+    QVERIFY(m_dir.isValid());
+  }
+
+  void cleanupTestCase() {
+    V8::Dispose();
+    V8::ShutdownPlatform();
+    delete m_platform;
+  }
+
+  void postMessage() {
+    const QString& path = writeScript("echo.js", R"(
+onmessage = function(message) {
+  postMessage({lines: message.text.split('\n').length, sum: message.a + message.b, list: [1, 'a']});
+};
+)");
+    Worker worker(path);
+    QSignalSpy spy(&worker, SIGNAL(message(QVariantMap)));
+
+    QStringList lines;
+    for (int i = 0; i < 2000; i++) {
+      lines.append(QString("line %1").arg(i));
+    }
+    worker.postMessage(QVariantMap{{"text", lines.join('\n')}, {"a", 1}, {"b", 2.5}});
+
+    QVERIFY(spy.wait());
+    const QVariantMap& result = spy[0][0].toMap();
+    QCOMPARE(result.value("lines").toInt(), 2000);
+    QCOMPARE(result.value("sum").toDouble(), 3.5);
+    QCOMPARE(result.value("list").toList(), QVariantList({1, "a"}));
+  }
+
+  void document() {
+    const QString& path = writeScript("document.js", R"(
+onmessage = function(message) {
+  postMessage({text: message.doc});
+};
+)");
+    Document doc;
+    doc.setPlainText("aaa\nbbb");
+    Worker worker(path);
+    QSignalSpy spy(&worker, SIGNAL(message(QVariantMap)));
+    worker.postMessage(QVariantMap{{"doc", QVariant::fromValue<QObject*>(&doc)}});
+
+    QVERIFY(spy.wait());
+    QCOMPARE(spy[0][0].toMap().value("text").toString(), QString("aaa\nbbb"));
+  }
+
+  void error() {
+    const QString& path = writeScript("error.js", R"(
+onmessage = function(message) {
+  throw new Error('boom');
+};
+)");
+    Worker worker(path);
+    QSignalSpy spy(&worker, SIGNAL(error(QString)));
+    worker.postMessage(QVariantMap());
+
+    QVERIFY(spy.wait());
+    QVERIFY(spy[0][0].toString().contains("boom"));
+  }
+
+  void terminate() {
+    const QString& path = writeScript("loop.js", R"(
+onmessage = function(message) {
+  while (true) {}
+};
+)");
+    Worker worker(path);
+    QSignalSpy spy(&worker, SIGNAL(error(QString)));
+    worker.postMessage(QVariantMap());
+    QTest::qWait(100);
+
+    QElapsedTimer timer;
+    timer.start();
+    worker.terminate();
+    QVERIFY(timer.elapsed() < 1000);
+    // termination isn't an error
+    QCOMPARE(spy.count(), 0);
+  }
+};
+
+}  // namespace core
+
+QTEST_MAIN(core::WorkerTest)
+#include "WorkerTest.moc"
@@ -14,3 +14,14 @@ void TestUtil::compareLineByLine(const QString& str1, const QString& str2) {
     QCOMPARE(list1.at(i).trimmed(), list2.at(i).trimmed());
   }
 }
+
+core::RootNode TestUtil::createRootNode(const QString& scope,
+                                        int size,
+                                        const QList<core::Node>& nodes) {
+  core::RootNode root(scope);
+  root.region = core::Region(0, size);
+  for (const core::Node& node : nodes) {
+    root.append(node);
+  }
+  return root;
+}
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <QList>
 #include <QString>
 
+#include "core/LanguageParser.h"
 #include "core/macros.h"
 
 class TestUtil {
@@ -9,6 +11,11 @@ class TestUtil {
 
  public:
   static void compareLineByLine(const QString& str1, const QString& str2);
+  // Returns the root of a scope tree for a text of size characters with nodes at the top level,
+  // like the result of LanguageParser
+  static core::RootNode createRootNode(const QString& scope,
+                                       int size,
+                                       const QList<core::Node>& nodes);
 
  private:
   TestUtil() = delete;
@@ -0,0 +1,92 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+"""Benchmark corpus for source.python."""
+
+import os
+import re
+import sys
+from collections import defaultdict, namedtuple
+
+Token = namedtuple('Token', ['kind', 'value', 'line', 'column'])
+
+KEYWORDS = {'if', 'then', 'else', 'end', 'while', 'do', 'return'}
+TOKEN_SPECIFICATION = [
+    ('NUMBER', r'\d+(\.\d*)?'),
+    ('ASSIGN', r':='),
+    ('END', r';'),
+    ('ID', r'[A-Za-z]+'),
+    ('OP', r'[+\-*/]'),
+    ('NEWLINE', r'\n'),
+    ('SKIP', r'[ \t]+'),
+    ('MISMATCH', r'.'),
+]
+
+
+class TokenizeError(Exception):
+    pass
+
+
+class Tokenizer(object):
+    """Splits a source string into tokens."""
+
+    def __init__(self, code, keywords=KEYWORDS):
+        self.code = code
+        self.keywords = keywords
+        self._regex = re.compile('|'.join('(?P<%s>%s)' % pair for pair in TOKEN_SPECIFICATION))
+
+    def __iter__(self):
+        line_num = 1
+        line_start = 0
+        for mo in self._regex.finditer(self.code):
+            kind = mo.lastgroup
+            value = mo.group()
+            column = mo.start() - line_start
+            if kind == 'NUMBER':
+                value = float(value) if '.' in value else int(value)
+            elif kind == 'ID' and value in self.keywords:
+                kind = value
+            elif kind == 'NEWLINE':
+                line_start = mo.end()
+                line_num += 1
+                continue
+            elif kind == 'SKIP':
+                continue
+            elif kind == 'MISMATCH':
+                raise TokenizeError('%r unexpected on line %d' % (value, line_num))
+            yield Token(kind, value, line_num, column)
+
+
+@staticmethod
+def count_words(paths, min_length=3):
+    counts = defaultdict(int)
+    for path in paths:
+        with open(path) as f:
+            for line in f:
+                for word in line.split():
+                    if len(word) >= min_length and not word.startswith('#'):
+                        counts[word.lower()] += 1
+    return sorted(counts.items(), key=lambda kv: (-kv[1], kv[0]))
+
+
+def main(argv=None):
+    argv = argv or sys.argv[1:]
+    statements = '''
+        IF quantity THEN
+            total := total + price * quantity;
+            tax := price * 0.05;
+        ENDIF;
+    '''
+    try:
+        for token in Tokenizer(statements):
+            print("{0.kind:>10} {0.value!r:<12} {0.line}:{0.column}".format(token))
+    except TokenizeError as e:
+        sys.stderr.write(u"error: %s\n" % e)
+        return 1
+    squares = [x ** 2 for x in range(10) if x % 2 == 0]
+    lookup = {k: v for k, v in zip('abcdef', squares)}
+    print(lookup, os.path.join('a', 'b'), 0x1F, 1e-3, 10L if False else None)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,63 @@
+# Benchmark corpus for source.ruby
+require 'set'
+require_relative 'lib/helper'
+
+module Silk
+  class Buffer
+    include Enumerable
+    attr_reader :lines, :name
+
+    DEFAULT_NAME = "untitled".freeze
+
+    def initialize(name = DEFAULT_NAME, text = '')
+      @name = name
+      @lines = text.split(/\r?\n/)
+      @@count ||= 0
+      @@count += 1
+    end
+
+    def each(&block)
+      @lines.each_with_index { |line, i| block.call(line, i + 1) }
+    end
+
+    def find_all(pattern)
+      select { |line, _| line =~ pattern }.map { |line, no| "#{@name}:#{no}: #{line.strip}" }
+    end
+
+    def self.from_file(path)
+      new(File.basename(path), File.read(path, encoding: 'UTF-8'))
+    rescue Errno::ENOENT => e
+      warn "cannot open #{path}: #{e.message}"
+      nil
+    end
+
+    def to_s
+      <<-EOS
+Buffer #{name}
+  lines: #{lines.size}
+      EOS
+    end
+
+    private
+
+    def normalize!(options = {})
+      tab = options.fetch(:tab_width, 4)
+      @lines.map! do |line|
+        line.gsub(/\t/, ' ' * tab).rstrip
+      end
+      self
+    end
+  end
+end
+
+query = <<SQL
+SELECT * FROM buffers WHERE name = 'untitled'
+SQL
+
+symbols = %w(alpha beta gamma).map(&:to_sym)
+hash = { key: :value, 'string' => 42, 3.14 => [1, 2, 3] }
+buffer = Silk::Buffer.new("main.rb", "puts 'hello'\nputs \"world\"\n")
+buffer.find_all(/puts/).each do |result|
+  puts result unless result.nil?
+end
+printf("%05d %s\n", 42, symbols.inspect) if hash.key?(:key)
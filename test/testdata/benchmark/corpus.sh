@@ -0,0 +1,54 @@
+#!/bin/bash
+# Benchmark corpus for source.shell
+set -euo pipefail
+
+readonly SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+BUILD_DIR=${BUILD_DIR:-"$SCRIPT_DIR/build"}
+JOBS=$(getconf _NPROCESSORS_ONLN 2>/dev/null || echo 4)
+
+usage() {
+  cat <<USAGE
+Usage: $0 [-c] [-t type] target...
+  -c  clean before build
+  -t  build type (Debug|Release)
+USAGE
+  exit 1
+}
+
+log() {
+  local level=$1; shift
+  printf '[%s] %s\n' "$level" "$*" >&2
+}
+
+clean=0
+build_type=Release
+while getopts "ct:h" opt; do
+  case $opt in
+    c) clean=1 ;;
+    t) build_type=$OPTARG ;;
+    h|*) usage ;;
+  esac
+done
+shift $((OPTIND - 1))
+
+if [[ $clean -eq 1 && -d "$BUILD_DIR" ]]; then
+  log INFO "removing $BUILD_DIR"
+  rm -rf "$BUILD_DIR"
+fi
+
+mkdir -p "$BUILD_DIR" && cd "$BUILD_DIR"
+cmake -DCMAKE_BUILD_TYPE="$build_type" .. > /dev/null
+
+for target in "${@:-all}"; do
+  start=$(date +%s)
+  if ! make -j"$JOBS" "$target"; then
+    log ERROR "failed to build $target"
+    exit 2
+  fi
+  elapsed=$(( $(date +%s) - start ))
+  log INFO "built $target in ${elapsed}s"
+done
+
+files=( $(find . -name '*.a' -o -name '*.so') )
+echo "${#files[@]} libraries" | tee -a build.log
+[ -f test/unit_test ] && ./test/unit_test || true
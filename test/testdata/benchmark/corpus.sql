@@ -0,0 +1,44 @@
+-- Benchmark corpus for source.sql
+CREATE TABLE IF NOT EXISTS documents (
+  id INTEGER PRIMARY KEY AUTOINCREMENT,
+  path VARCHAR(1024) NOT NULL UNIQUE,
+  encoding VARCHAR(32) DEFAULT 'UTF-8',
+  size BIGINT NOT NULL DEFAULT 0,
+  modified_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP
+);
+
+CREATE INDEX idx_documents_modified ON documents (modified_at DESC);
+
+/* Insert some rows */
+INSERT INTO documents (path, encoding, size) VALUES
+  ('/home/user/main.cpp', 'UTF-8', 31233),
+  ('/home/user/README.md', 'UTF-8', 1846),
+  ('/home/user/legacy.txt', 'Shift_JIS', 474);
+
+SELECT d.id,
+       d.path,
+       COUNT(l.id) AS line_count,
+       SUM(LENGTH(l.text)) / 1024.0 AS kb
+  FROM documents d
+  LEFT OUTER JOIN lines l ON l.document_id = d.id
+ WHERE d.encoding <> 'UTF-16'
+   AND d.path LIKE '%.cpp'
+   AND d.size BETWEEN 1 AND 1000000
+ GROUP BY d.id, d.path
+HAVING COUNT(l.id) > 10
+ ORDER BY kb DESC, d.path ASC
+ LIMIT 20 OFFSET 0;
+
+UPDATE documents SET size = size + 1, modified_at = NOW() WHERE id IN (SELECT document_id FROM lines WHERE text IS NULL);
+
+DELETE FROM documents WHERE modified_at < DATE_SUB(NOW(), INTERVAL 30 DAY);
+
+CREATE OR REPLACE VIEW recent_documents AS
+  SELECT * FROM documents WHERE modified_at > '2016-01-01 00:00:00';
+
+BEGIN TRANSACTION;
+  ALTER TABLE documents ADD COLUMN language VARCHAR(64);
+  UPDATE documents SET language = CASE WHEN path LIKE '%.rb' THEN 'ruby' WHEN path LIKE '%.py' THEN "python" ELSE NULL END;
+COMMIT;
+
+DROP TABLE IF EXISTS tmp_documents;
@@ -18,10 +18,13 @@
 #include "KeymapManager.h"
 #include "Helper.h"
 #include "core/ObjectStore.h"
+#include "core/Tracer.h"
+#include "core/Config.h"
 #include "core/Constants.h"
 #include "core/SyntaxHighlighter.h"
 #include "core/Util.h"
 
+using core::Config;
 using core::Constants;
 using core::ObjectStore;
 using core::SyntaxHighlighterThread;
@@ -150,8 +153,8 @@ bool App::notify(QObject* receiver, QEvent* event) {
       // KeyPress event is sent multiple times to each different receivers.
       // We hadle key press event only when receiver is window type
       if (receiver->isWindowType()) {
+        TRACE_SCOPE("App::keyPress");
         auto keyEvent = static_cast<QKeyEvent*>(event);
-        qDebug() << keyEvent;
         if (keyEvent && KeymapManager::singleton().handle(keyEvent)) {
           keyEvent->accept();
           return true;
@@ -198,6 +201,8 @@ void App::cleanup() {
 
   Helper::singleton().cleanup();
 
+  Config::singleton().flush();
+
   m_isCleanedUp = true;
 }
 
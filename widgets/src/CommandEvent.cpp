@@ -28,6 +28,7 @@ CommandEvent::CommandEvent(const QString& name,
     : m_cmdName(name),
       m_args(args),
       m_condition(condition),
+      m_dynamicCondition(condition ? condition->dynamicConditions() : boost::none),
       m_source(source),
       m_priority(priority) {}
 
@@ -44,5 +45,5 @@ bool CommandEvent::hasCondition() {
 }
 
 bool CommandEvent::isSatisfied() {
-  return !m_condition || (m_condition && m_condition->isSatisfied());
+  return !m_dynamicCondition || m_dynamicCondition->isSatisfied();
 }
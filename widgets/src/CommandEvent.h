@@ -47,6 +47,8 @@ class CommandEvent {
   QString m_cmdName;
   CommandArgument m_args;
   boost::optional<core::AndConditionExpression> m_condition;
+  // conditions evaluated in isSatisfied. Static ones like os are checked when keymaps are loaded.
+  boost::optional<core::AndConditionExpression> m_dynamicCondition;
 
   /**
    * @brief The source where this command event is defined.
@@ -7,6 +7,7 @@
 #include "commands/CrashCommand.h"
 #include "core/V8Util.h"
 #include "core/MessageHandler.h"
+#include "core/Tracer.h"
 #include "core/atom/node_includes.h"
 
 using core::V8Util;
@@ -42,15 +43,6 @@ CommandArgument toCommandArgument(QVariantMap map) {
 
   return arg;
 }
-
-std::string toString(const CommandArgument& arg) {
-  std::stringstream ss;
-  for (const auto& pair : arg) {
-    ss << pair.first.c_str() << ": " << pair.second.toString().toUtf8().constData() << std::endl;
-  }
-
-  return ss.str();
-}
 }
 
 QString CommandManager::cmdDescription(const QString& name) {
@@ -143,23 +135,24 @@ bool CommandManager::runCommandEventFilter(QString& cmdName, CommandArgument& cm
 }
 
 void CommandManager::runCommand(QString name, CommandArgument args, int repeat) {
+  TRACE_SCOPE("CommandManager::runCommand");
   // check hidden commands first
   if (m_hiddenCommands.find(name) != m_hiddenCommands.end()) {
     m_hiddenCommands[name]->run(args, repeat);
     return;
   }
 
-  bool result = runCommandEventFilter(name, args);
-  if (result) {
+  runNativeCommandFilters(name, args);
+
+  // Skip the JS filter to avoid converting args to JS when no package uses it
+  if (m_jsCmdEventFilterEnabled && !m_jsCmdEventFilter.IsEmpty() &&
+      runCommandEventFilter(name, args)) {
     qDebug() << name << "is handled by an event filter";
     return;
   }
 
   if (m_commands.find(name) != m_commands.end()) {
-    qDebug() << "Start command: " << name << "args: " << toString(args).c_str()
-             << "repeat: " << repeat;
     m_commands[name]->run(args, repeat);
-    qDebug() << "End command: " << name;
   } else {
     QLoggingCategory category(SILKEDIT_CATEGORY);
     qCWarning(category) << "Can't find a command: " << name;
@@ -179,11 +172,44 @@ void CommandManager::remove(const QString& name) {
   emit commandRemoved(name);
 }
 
+void CommandManager::runNativeCommandFilters(QString& cmdName, CommandArgument& cmdArgs) {
+  auto alias = m_aliases.find(cmdName);
+  if (alias != m_aliases.end()) {
+    cmdName = alias->second;
+  }
+
+  auto defaultArgs = m_defaultArgs.find(cmdName);
+  if (defaultArgs != m_defaultArgs.end()) {
+    // insert doesn't overwrite the args which are passed
+    cmdArgs.insert(defaultArgs->second.begin(), defaultArgs->second.end());
+  }
+}
+
+void CommandManager::addAlias(const QString& from, const QString& to) {
+  m_aliases[from] = to;
+}
+
+void CommandManager::removeAlias(const QString& from) {
+  m_aliases.erase(from);
+}
+
+void CommandManager::setDefaultArgs(const QString& name, QVariantMap args) {
+  m_defaultArgs[name] = toCommandArgument(args);
+}
+
+void CommandManager::removeDefaultArgs(const QString& name) {
+  m_defaultArgs.erase(name);
+}
+
 void CommandManager::_assignJSCommandEventFilter(FunctionInfo info) {
   m_jsCmdEventFilter.Reset(info.isolate, info.fn);
 }
 
-CommandManager::CommandManager() {
+void CommandManager::_setJSCommandEventFilterEnabled(bool enabled) {
+  m_jsCmdEventFilterEnabled = enabled;
+}
+
+CommandManager::CommandManager() : m_jsCmdEventFilterEnabled(false) {
   addHidden(std::unique_ptr<ICommand>(new CrashCommand()));
 }
 
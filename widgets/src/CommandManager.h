@@ -9,6 +9,7 @@
 #include <unordered_map>
 #include <QString>
 #include <QVariant>
+#include <QVariantMap>
 
 #include "ICommand.h"
 #include "core/macros.h"
@@ -36,8 +37,18 @@ class CommandManager : public QObject, public core::Singleton<CommandManager> {
   void add(const QString& name, const QString& description);
   void remove(const QString& name);
 
+  // Native command filters. They cover common cases of command event filters without calling JS.
+  // Runs command 'to' instead of 'from'
+  void addAlias(const QString& from, const QString& to);
+  void removeAlias(const QString& from);
+  // args are used when the command runs without them
+  void setDefaultArgs(const QString& name, QVariantMap args);
+  void removeDefaultArgs(const QString& name);
+
   // internal (only used in initialization in JS side)
   void _assignJSCommandEventFilter(core::FunctionInfo info);
+  // JS side enables the filter only while a package adds a command event filter
+  void _setJSCommandEventFilterEnabled(bool enabled);
 
  signals:
   void commandRemoved(const QString& name);
@@ -53,7 +64,12 @@ class CommandManager : public QObject, public core::Singleton<CommandManager> {
   // hidden commands
   std::unordered_map<QString, std::unique_ptr<ICommand>> m_hiddenCommands;
 
+  std::unordered_map<QString, QString> m_aliases;
+  std::unordered_map<QString, CommandArgument> m_defaultArgs;
+
   v8::UniquePersistent<v8::Function> m_jsCmdEventFilter;
+  bool m_jsCmdEventFilterEnabled;
 
+  void runNativeCommandFilters(QString& cmdName, CommandArgument& cmdArgs);
   bool runCommandEventFilter(QString& cmdName, CommandArgument& cmdArg);
 };
@@ -16,6 +16,10 @@ using core::Theme;
 using core::Config;
 using core::Util;
 
+namespace {
+constexpr int MAX_LINES = 10000;
+}
+
 Console::Console(QWidget* parent) : CustomWidget(parent), ui(new Ui::Console) {
   ui->setupUi(this);
   ui->layout->setContentsMargins(0, 0, 0, 0);
@@ -27,26 +31,10 @@ Console::Console(QWidget* parent) : CustomWidget(parent), ui(new Ui::Console) {
   completer->setModel(&m_historyModel);
   ui->input->setCompleter(completer);
 
-  connect(&MessageHandler::singleton(), &MessageHandler::message, this,
-          [=](QtMsgType type, QString msg) {
-            const QString& htmlMsg = msg.replace(QStringLiteral("\n"), QStringLiteral("<br>"));
-            QString text = QStringLiteral("<div style='color:%1;'>%2</div>");
-            QString color;
-            switch (type) {
-              case QtDebugMsg:
-              case QtInfoMsg:
-                color = QStringLiteral("black");
-                break;
-              case QtWarningMsg:
-                color = QStringLiteral("#9F6000");
-                break;
-              case QtCriticalMsg:
-              case QtFatalMsg:
-                color = QStringLiteral("red");
-                break;
-            }
-            ui->output->append(text.arg(color).arg(htmlMsg));
-          });
+  // keep the memory bounded
+  ui->output->document()->setMaximumBlockCount(MAX_LINES);
+  connect(&MessageHandler::singleton(), &MessageHandler::messagesFormatted, ui->output,
+          &QTextBrowser::append);
 
   connect(ui->input, &QLineEdit::returnPressed, this, [=] {
     runJSCode(ui->input->text());
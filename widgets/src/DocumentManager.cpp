@@ -4,16 +4,19 @@
 #include <QFileDialog>
 #include <QDebug>
 #include <QMessageBox>
-#include <QTimer>
 
 #include "DocumentManager.h"
 #include "App.h"
 #include "TabView.h"
 #include "Window.h"
 #include "OpenRecentItemManager.h"
+#include "core/CompletionIndex.h"
 #include "core/Document.h"
+#include "core/ProjectFileSystem.h"
+#include "core/SymbolIndex.h"
 
 using core::Document;
+using core::ProjectFileSystem;
 
 const QString DocumentManager::DEFAULT_FILE_NAME = "untitled";
 
@@ -32,44 +35,87 @@ int DocumentManager::open(const QString& filename) {
   }
 }
 
+DocumentManager::FileStamp DocumentManager::FileStamp::of(const QString& path) {
+  const QFileInfo info(path);
+  if (!info.exists()) {
+    return FileStamp{-1, -1};
+  }
+  return FileStamp{info.lastModified().toMSecsSinceEpoch(), info.size()};
+}
+
 DocumentManager::DocumentManager() : m_watcher(new QFileSystemWatcher(this)) {
-  connect(m_watcher, &QFileSystemWatcher::fileChanged, [=](const QString& path) {
-    qDebug() << "fileChanged" << path;
-    if (!m_pathDocHash.contains(path)) {
-      qCritical() << path << "is not registered";
-      return;
-    }
+  connect(m_watcher, &QFileSystemWatcher::fileChanged, this, &DocumentManager::onFileChanged);
+}
 
-    // doc sometimes becomes nullptr...
-    auto doc = m_pathDocHash[path].lock();
-    if (!doc) {
-      qWarning() << "m_pathDocHash contains" << path << "but failed to get a document...";
-      return;
+void DocumentManager::addFileSystem(ProjectFileSystem* fileSystem) {
+  connect(fileSystem, &ProjectFileSystem::changed, this,
+          [=](const ProjectFileSystem::Changes& changes) {
+            for (const QStringList* paths : {&changes.modifiedFiles, &changes.removedFiles}) {
+              for (const QString& path : *paths) {
+                const QString absolutePath = fileSystem->absolutePath(path);
+                if (m_pathDocHash.contains(absolutePath)) {
+                  onFileChanged(absolutePath);
+                }
+              }
+            }
+          });
+}
+
+void DocumentManager::watch(const QString& path) {
+  m_stamps[path] = FileStamp::of(path);
+  // QFileSystemWatcher stops watching a file when it's replaced
+  if (!m_watcher->files().contains(path)) {
+    m_watcher->addPath(path);
+  }
+}
+
+void DocumentManager::onFileChanged(const QString& path) {
+  qDebug() << "fileChanged" << path;
+  if (!m_pathDocHash.contains(path)) {
+    qCritical() << path << "is not registered";
+    return;
+  }
+
+  // doc sometimes becomes nullptr...
+  auto doc = m_pathDocHash[path].lock();
+  if (!doc) {
+    qWarning() << "m_pathDocHash contains" << path << "but failed to get a document...";
+    return;
+  }
+  Q_ASSERT(doc);
+
+  // Our own saves and the same change reported by the watcher and a file system are ignored
+  const FileStamp stamp = FileStamp::of(path);
+  if (m_stamps.contains(path) && m_stamps.value(path) == stamp) {
+    return;
+  }
+  m_stamps[path] = stamp;
+
+  if (stamp.size >= 0) {
+    qDebug() << "file is changed";
+    if (!m_watcher->files().contains(path)) {
+      m_watcher->addPath(path);
     }
-    Q_ASSERT(doc);
 
-    if (QFileInfo::exists(path)) {
-      qDebug() << "file is changed";
-      auto result = QMessageBox::NoButton;
-      if (doc->isModified()) {
-        result = QMessageBox::question(
-            nullptr, "", tr("%1 \n\nhas changed on disk. Do you want to reload?").arg(path));
-      }
+    auto result = QMessageBox::NoButton;
+    if (doc->isModified()) {
+      result = QMessageBox::question(
+          nullptr, "", tr("%1 \n\nhas changed on disk. Do you want to reload?").arg(path));
+    }
 
-      if (!doc->isModified() || result == QMessageBox::Yes) {
-        doc->reload(doc->encoding());
-      }
-    } else {
-      qDebug() << "file is removed";
-      OpenRecentItemManager::singleton().removeOpenRecentItem(path);
-      auto result = QMessageBox::question(
-          nullptr, "",
-          tr("%1 \n\nhas been removed on disk. Do you want to close its tab?").arg(path));
-      if (result == QMessageBox::Yes) {
-        Window::closeTabIncludingDoc(doc.get());
-      }
+    if (!doc->isModified() || result == QMessageBox::Yes) {
+      doc->reload(doc->encoding());
+    }
+  } else {
+    qDebug() << "file is removed";
+    OpenRecentItemManager::singleton().removeOpenRecentItem(path);
+    auto result = QMessageBox::question(
+        nullptr, "",
+        tr("%1 \n\nhas been removed on disk. Do you want to close its tab?").arg(path));
+    if (result == QMessageBox::Yes) {
+      Window::closeTabIncludingDoc(doc.get());
     }
-  });
+  }
 }
 
 bool DocumentManager::save(Document* doc, bool beforeClose) {
@@ -94,9 +140,6 @@ bool DocumentManager::save(Document* doc, bool beforeClose) {
 
   QFile outFile(doc->path());
   if (outFile.open(QIODevice::WriteOnly)) {
-    // remove path from QFileSystemWatcher to prevent reloading after save
-    m_watcher->removePath(doc->path());
-
     QTextStream out(&outFile);
     out.setCodec(doc->encoding().codec());
     out.setGenerateByteOrderMark(doc->bom().bomSwitch());
@@ -109,14 +152,10 @@ bool DocumentManager::save(Document* doc, bool beforeClose) {
       }
     }
 
-    if (!beforeClose) {
-      // calling addPath immediately still fires fileChanged signal on Windows.
-      QTimer::singleShot(0, this, [=] {
-        if (doc) {
-          m_watcher->addPath(doc->path());
-        }
-      });
-    }
+    out.flush();
+    // The notification of this write is ignored since the file is the same as recorded here
+    watch(doc->path());
+    emit saved(doc->path());
 
     return true;
   } else {
@@ -147,16 +186,19 @@ std::shared_ptr<core::Document> DocumentManager::registerDoc(Document* doc) {
 
     if (!path.isEmpty()) {
       m_pathDocHash[path] = std::weak_ptr<Document>(sharedDoc);
-      m_watcher->addPath(path);
+      watch(path);
     }
     if (!doc->objectName().isEmpty()) {
       m_objectNameDocHash[doc->objectName()] = std::weak_ptr<Document>(sharedDoc);
     }
+    core::CompletionIndex::singleton().addDocument(doc);
+    core::SymbolIndex::singleton().addDocument(doc);
 
     connect(doc, &Document::destroying, [this, doc](const QString& path) {
       if (!path.isEmpty()) {
         qDebug() << "document (" << path << ") is destroying.";
         m_pathDocHash.remove(path);
+        m_stamps.remove(path);
         m_watcher->removePath(path);
       }
       if (!doc->objectName().isEmpty()) {
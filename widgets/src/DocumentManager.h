@@ -13,6 +13,7 @@
 class TabView;
 namespace core {
 class Document;
+class ProjectFileSystem;
 }
 
 class DocumentManager : public QObject, public core::Singleton<DocumentManager> {
@@ -30,12 +31,31 @@ class DocumentManager : public QObject, public core::Singleton<DocumentManager>
   // may throw a runtime_error
   std::shared_ptr<core::Document> getOrCreate(QSettings& settings);
   std::shared_ptr<core::Document> find(const QString& objectName);
+  // Open documents are also checked with the changes the file system reports
+  void addFileSystem(core::ProjectFileSystem* fileSystem);
 
  public slots:
   int open(const QString& filename);
 
+ signals:
+  void saved(const QString& path);
+
  private:
+  // the last seen state of a file
+  struct FileStamp {
+    static FileStamp of(const QString& path);
+
+    // -1 if the file doesn't exist
+    qint64 mtime;
+    qint64 size;
+
+    bool operator==(const FileStamp& other) const {
+      return mtime == other.mtime && size == other.size;
+    }
+  };
+
   QFileSystemWatcher* m_watcher;
+  QHash<QString, FileStamp> m_stamps;
   QHash<QString, std::weak_ptr<core::Document>> m_pathDocHash;
   QHash<QString, std::weak_ptr<core::Document>> m_objectNameDocHash;
 
@@ -43,4 +63,8 @@ class DocumentManager : public QObject, public core::Singleton<DocumentManager>
   DocumentManager();
 
   std::shared_ptr<core::Document> registerDoc(core::Document* doc);
+  // Watches a file and records its current state
+  void watch(const QString& path);
+  // Reloads or closes the document of a changed file unless the file is the same as last seen
+  void onFileChanged(const QString& path);
 };
@@ -32,6 +32,9 @@ using atom::NodeBindings;
 
 namespace {
 
+// Batched signals are forwarded to JS at most once per this interval (a frame at 60 fps)
+constexpr int SIGNAL_BATCH_INTERVAL_MS = 16;
+
 QStringList helperArgs() {
   QStringList args;
   args << QCoreApplication::applicationFilePath();
@@ -83,6 +86,86 @@ void HelperPrivate::emitSignal(QObject* obj, const QString& signal, QVariantList
   return JSHandler::emitSignal(env->isolate(), obj, signal, args);
 }
 
+bool HelperPrivate::isBatched(QObject* obj, int signalIndex, bool& immediate) {
+  auto it = m_batchedSignals.constFind(obj);
+  if (it == m_batchedSignals.constEnd()) {
+    return false;
+  }
+  auto signalIt = it->constFind(signalIndex);
+  if (signalIt == it->constEnd()) {
+    return false;
+  }
+  immediate = signalIt.value();
+  return true;
+}
+
+void HelperPrivate::setDelivery(QObject* obj, int signalIndex, bool immediate, bool batched) {
+  if (batched) {
+    if (!m_batchedSignals.contains(obj)) {
+      connect(obj, &QObject::destroyed, this, &HelperPrivate::removeBatchedSignals);
+    }
+    m_batchedSignals[obj].insert(signalIndex, immediate);
+  } else if (m_batchedSignals.contains(obj)) {
+    // Keep the empty hash because the destroyed signal is already connected
+    m_batchedSignals[obj].remove(signalIndex);
+  }
+}
+
+// Every emission in a batch is queued in order and delivered together
+void HelperPrivate::queueSignal(QObject* obj, int signalIndex, const QVariantList& args) {
+  const auto key = qMakePair(obj, signalIndex);
+  auto it = m_pendingSignalIndices.constFind(key);
+  if (it != m_pendingSignalIndices.constEnd()) {
+    m_pendingSignals[*it].argsList.append(QVariant(args));
+    return;
+  }
+
+  m_pendingSignalIndices.insert(key, m_pendingSignals.size());
+  m_pendingSignals.append(
+      PendingSignal{obj, QString::fromLatin1(obj->metaObject()->method(signalIndex).name()),
+                    QVariantList{QVariant(args)}});
+  if (!m_flushTimer.isActive()) {
+    m_flushTimer.start();
+  }
+}
+
+void HelperPrivate::flushSignals() {
+  // Listeners may emit signals again
+  QVector<PendingSignal> pendingSignals;
+  pendingSignals.swap(m_pendingSignals);
+  m_pendingSignalIndices.clear();
+
+  node::Environment* env = q->m_nodeBindings->uv_env();
+  if (!env) {
+    qDebug() << "NodeBinding is not yet initialized";
+    return;
+  }
+
+  v8::Locker locker(env->isolate());
+  v8::HandleScope handle_scope(env->isolate());
+  v8::Context::Scope context_scope(env->context());
+
+  for (const PendingSignal& pendingSignal : pendingSignals) {
+    // The object may be destroyed by a listener of another signal
+    if (pendingSignal.obj) {
+      v8::HandleScope scope(env->isolate());
+      JSHandler::emitSignalBatch(env->isolate(), pendingSignal.obj, pendingSignal.name,
+                                 pendingSignal.argsList);
+    }
+  }
+}
+
+void HelperPrivate::removeBatchedSignals(QObject* obj) {
+  m_batchedSignals.remove(obj);
+  for (auto it = m_pendingSignalIndices.begin(); it != m_pendingSignalIndices.end();) {
+    if (it.key().first == obj) {
+      it = m_pendingSignalIndices.erase(it);
+    } else {
+      it++;
+    }
+  }
+}
+
 QVariant HelperPrivate::callFunc(const QString& funcName, QVariantList args) {
   node::Environment* env = q->m_nodeBindings->uv_env();
   if (!env) {
@@ -101,7 +184,11 @@ void HelperPrivate::init() {
   startNodeEventLoop();
 }
 
-HelperPrivate::HelperPrivate(Helper* q_ptr) : q(q_ptr) {}
+HelperPrivate::HelperPrivate(Helper* q_ptr) : q(q_ptr) {
+  m_flushTimer.setSingleShot(true);
+  m_flushTimer.setInterval(SIGNAL_BATCH_INTERVAL_MS);
+  connect(&m_flushTimer, &QTimer::timeout, this, &HelperPrivate::flushSignals);
+}
 
 Helper::~Helper() {
   qDebug("~Helper");
@@ -130,7 +217,16 @@ void Helper::emitSignalInternal(const QVariantList& args) {
 
   Q_ASSERT(obj->thread() == QThread::currentThread());
 
-  const QMetaMethod& method = obj->metaObject()->method(QObject::senderSignalIndex());
+  const int signalIndex = QObject::senderSignalIndex();
+  bool immediate = true;
+  if (d->isBatched(obj, signalIndex, immediate)) {
+    d->queueSignal(obj, signalIndex, args);
+    if (!immediate) {
+      return;
+    }
+  }
+
+  const QMetaMethod& method = obj->metaObject()->method(signalIndex);
   if (!method.isValid()) {
     qWarning() << "signal method is invalid";
     return;
@@ -182,6 +278,10 @@ void Helper::deactivatePackages() {
   d->callFunc("deactivatePackages");
 }
 
+void Helper::setSignalDelivery(QObject* obj, int signalIndex, bool immediate, bool batched) {
+  d->setDelivery(obj, signalIndex, immediate, batched);
+}
+
 node::Environment* Helper::uvEnv() {
   return m_nodeBindings->uv_env();
 }
@@ -220,6 +320,11 @@ void Helper::emitSignal(WebChannel* obj) {
   emitSignalInternal(args);
 }
 
+void Helper::emitSignal(const QVariantMap& map) {
+  QVariantList args{QVariant::fromValue(map)};
+  emitSignalInternal(args);
+}
+
 template <typename T>
 T HelperPrivate::callFunc(const QString& funcName, QVariantList args, T defaultValue) {
   node::Environment* env = q->m_nodeBindings->uv_env();
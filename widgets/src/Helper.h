@@ -80,6 +80,11 @@ class Helper : public QObject, public core::Singleton<Helper> {
   void deactivatePackages();
   node::Environment* uvEnv();
 
+  // Sets how emissions of the signal are forwarded to JS. Immediate listeners are called on each
+  // emission. Emissions for batched listeners are queued and delivered at most once per frame as
+  // a list of the arguments of each emission.
+  void setSignalDelivery(QObject* obj, int signalIndex, bool immediate, bool batched);
+
  public slots:
   void uvRunOnce();
 
@@ -100,4 +105,5 @@ class Helper : public QObject, public core::Singleton<Helper> {
   void emitSignal(bool b);
   void emitSignal(QWidget* old, QWidget* now);
   void emitSignal(WebChannel* obj);
+  void emitSignal(const QVariantMap& map);
 };
@@ -1,5 +1,11 @@
 #pragma once
 
+#include <QHash>
+#include <QPair>
+#include <QPointer>
+#include <QTimer>
+#include <QVector>
+
 #include "Helper.h"
 
 class HelperPrivate : public QObject {
@@ -17,8 +23,32 @@ class HelperPrivate : public QObject {
 
   void startNodeEventLoop();
   void emitSignal(QObject* obj, const QString& signal, QVariantList args);
+  // Returns true if the signal has batched listeners. immediate is set to true if it also has
+  // listeners called on each emission.
+  bool isBatched(QObject* obj, int signalIndex, bool& immediate);
+  void setDelivery(QObject* obj, int signalIndex, bool immediate, bool batched);
+  void queueSignal(QObject* obj, int signalIndex, const QVariantList& args);
+  void flushSignals();
   QVariant callFunc(const QString& funcName, QVariantList args = QVariantList());
 
   template <typename T>
   T callFunc(const QString& funcName, QVariantList args, T defaultValue);
+
+ private:
+  struct PendingSignal {
+    QPointer<QObject> obj;
+    QString name;
+    // arguments of each emission as QVariantList
+    QVariantList argsList;
+  };
+
+  // signal indices of each object which have batched listeners. The value is true if the signal has
+  // immediate listeners too.
+  QHash<QObject*, QHash<int, bool>> m_batchedSignals;
+  // in the order of the first emission in the batch
+  QVector<PendingSignal> m_pendingSignals;
+  QHash<QPair<QObject*, int>, int> m_pendingSignalIndices;
+  QTimer m_flushTimer;
+
+  void removeBatchedSignals(QObject* obj);
 };
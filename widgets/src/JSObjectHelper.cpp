@@ -87,8 +87,14 @@ void JSObjectHelper::connectOrDisconnect(const v8::FunctionCallbackInfo<v8::Valu
   if (emitSignal.isValid()) {
     if (connect) {
       QObject::connect(obj, method, &Helper::singleton(), emitSignal, Qt::UniqueConnection);
+      // The optional second and third arguments tell whether the signal has immediate and batched
+      // listeners
+      const bool immediate = args.Length() <= 1 || args[1]->BooleanValue();
+      const bool batched = args.Length() > 2 && args[2]->BooleanValue();
+      Helper::singleton().setSignalDelivery(obj, index, immediate, batched);
     } else {
       QObject::disconnect(obj, method, &Helper::singleton(), emitSignal);
+      Helper::singleton().setSignalDelivery(obj, index, true, false);
     }
   } else {
     std::stringstream ss;
@@ -24,6 +24,7 @@
 #include "core/modifiers.h"
 #include "core/V8Util.h"
 #include "core/KeyEvent.h"
+#include "core/Tracer.h"
 #include "util/YamlUtil.h"
 #include "core/FunctionInfo.h"
 #include "core/atom/node_includes.h"
@@ -81,6 +82,15 @@ QKeySequence toSequence(const QKeyEvent& ev) {
   return QKeySequence(keyInt);
 }
 
+// QKeySequence has up to 4 keys
+QKeySequence toSequence(const std::vector<int>& keys) {
+  int k[4] = {0, 0, 0, 0};
+  for (int i = 0; i < qMin(static_cast<int>(keys.size()), 4); i++) {
+    k[i] = keys[i];
+  }
+  return QKeySequence(k[0], k[1], k[2], k[3]);
+}
+
 CommandArgument parseArgs(const YAML::Node& argsNode) {
   CommandArgument args;
   for (auto argsIter = argsNode.begin(); argsIter != argsNode.end(); argsIter++) {
@@ -171,6 +181,7 @@ void KeymapManager::load(const QString& filename, const QString& source) {
 void KeymapManager::unload(const QString& source) {
   erase_with_source(m_emptyCmdKeymap, source);
   erase_with_source(m_keymaps, source);
+  invalidateTrie();
 
   for (auto it = m_cmdKeymapHash.begin(); it != m_cmdKeymapHash.end();) {
     if (it->second.cmd.source() == source) {
@@ -182,68 +193,61 @@ void KeymapManager::unload(const QString& source) {
 }
 
 bool KeymapManager::dispatch(QKeyEvent* event, int repeat) {
-  QKeySequence key = toSequence(*event);
-  qDebug() << "key: " << key;
-
-  if (!m_partiallyMatchedKeyString.isEmpty()) {
-    qDebug() << "partially matched key:" << m_partiallyMatchedKeyString;
-    key = QKeySequence(m_partiallyMatchedKeyString + "," + key.toString());
-    qDebug() << "combinded key:" << key;
+  TRACE_SCOPE("KeymapManager::dispatch");
+  const int key = toSequence(*event)[0];
+  if (!m_trie) {
+    buildTrie();
   }
 
-  // check exact match
-  if (m_keymaps.find(key) != m_keymaps.end()) {
-    if (!m_partiallyMatchedKeyString.isEmpty()) {
-      if (auto window = App::instance()->activeMainWindow()) {
-        window->statusBar()->clearMessage();
-      }
-    }
-    m_partiallyMatchedKeyString.clear();
-    auto range = m_keymaps.equal_range(key);
-    QVector<CommandEvent*> events;
-    for (auto it = range.first; it != range.second; it++) {
-      CommandEvent& ev = it->second;
-      if (ev.isSatisfied()) {
-        events.push_back(&ev);
+  bool partiallyMatched = m_partialNode != nullptr;
+  const TrieNode* parent = partiallyMatched ? m_partialNode : m_trie.get();
+  auto found = parent->children.find(key);
+  const TrieNode* node = found != parent->children.end() ? found->second.get() : nullptr;
+
+  if (node) {
+    // check exact match. Copy satisfied events because a command can change keymaps.
+    std::vector<CommandEvent> events;
+    for (CommandEvent* ev : node->events) {
+      if (ev->isSatisfied()) {
+        events.push_back(*ev);
       }
     }
 
-    if (!events.isEmpty()) {
-      for (auto ev : events) {
-        ev->execute(repeat);
+    if (!events.empty()) {
+      clearPartialMatch();
+      for (auto& ev : events) {
+        ev.execute(repeat);
       }
       return true;
     }
-  }
 
-  // check partial match
-  auto partiallyMatchedKey =
-      std::find_if(m_keymaps.begin(), m_keymaps.end(),
-                   [key](const std::unordered_map<QKeySequence, CommandEvent>::value_type& p) {
-                     return key.matches(p.first) == QKeySequence::PartialMatch;
-                   });
+    // The key exists but its conditions are not satisfied. Don't cancel dispatch in this case.
+    if (!node->events.empty()) {
+      partiallyMatched = false;
+    }
 
-  if (partiallyMatchedKey != m_keymaps.end()) {
-    qDebug("partial match");
-    m_partiallyMatchedKeyString = key.toString();
-    if (auto window = App::instance()->activeMainWindow()) {
-      window->statusBar()->showMessage(Util::toString(key));
-      return true;
+    // check partial match
+    if (!node->children.empty()) {
+      if (auto window = App::instance()->activeMainWindow()) {
+        m_partialNode = node;
+        m_partialKeys.push_back(key);
+        window->statusBar()->showMessage(Util::toString(toSequence(m_partialKeys)));
+        return true;
+      }
     }
   }
 
   // no match
   // When partially matched key exists, cancel dispatch
-  if (!m_partiallyMatchedKeyString.isEmpty()) {
-    if (auto window = App::instance()->activeMainWindow()) {
+  if (partiallyMatched) {
+    if (App::instance()->activeMainWindow()) {
       qDebug("cancel partial match");
-      window->statusBar()->clearMessage();
-      m_partiallyMatchedKeyString.clear();
+      clearPartialMatch();
       return true;
     }
   }
 
-  m_partiallyMatchedKeyString.clear();
+  clearPartialMatch();
   return false;
 }
 
@@ -253,7 +257,11 @@ void KeymapManager::_assignJSKeyEventFilter(core::FunctionInfo info) {
   m_jsKeyEventFilter.Reset(info.isolate, info.fn);
 }
 
-KeymapManager::KeymapManager() {
+void KeymapManager::_setJSKeyEventFilterEnabled(bool enabled) {
+  m_jsKeyEventFilterEnabled = enabled;
+}
+
+KeymapManager::KeymapManager() : m_partialNode(nullptr), m_jsKeyEventFilterEnabled(false) {
   connect(&PackageManager::singleton(), &PackageManager::packageRemoved, this,
           [=](const Package& pkg) {
             for (auto it = m_keymaps.begin(); it != m_keymaps.end();) {
@@ -263,6 +271,7 @@ KeymapManager::KeymapManager() {
                 ++it;
               }
             }
+            invalidateTrie();
             emit keymapUpdated();
           });
 
@@ -279,6 +288,39 @@ void KeymapManager::removeKeymap() {
   m_emptyCmdKeymap.clear();
   m_cmdKeymapHash.clear();
   m_keymaps.clear();
+  invalidateTrie();
+}
+
+void KeymapManager::buildTrie() {
+  m_trie.reset(new TrieNode());
+  for (auto& pair : m_keymaps) {
+    TrieNode* node = m_trie.get();
+    for (int i = 0; i < static_cast<int>(pair.first.count()); i++) {
+      auto& child = node->children[pair.first[i]];
+      if (!child) {
+        child.reset(new TrieNode());
+      }
+      node = child.get();
+    }
+    node->events.push_back(&pair.second);
+  }
+}
+
+// Call whenever m_keymaps is changed because the trie points to its values
+void KeymapManager::invalidateTrie() {
+  m_trie.reset();
+  m_partialNode = nullptr;
+  m_partialKeys.clear();
+}
+
+void KeymapManager::clearPartialMatch() {
+  if (m_partialNode) {
+    if (auto window = App::instance()->activeMainWindow()) {
+      window->statusBar()->clearMessage();
+    }
+  }
+  m_partialNode = nullptr;
+  m_partialKeys.clear();
 }
 
 void KeymapManager::loadUserKeymap() {
@@ -309,7 +351,7 @@ QString KeymapManager::findCmdName(QKeySequence key) {
     auto range = m_keymaps.equal_range(key);
     for (auto it = range.first; it != range.second; it++) {
       CommandEvent& ev = it->second;
-      if (!ev.condition() || ev.condition()->isSatisfied()) {
+      if (ev.isSatisfied()) {
         return ev.cmdName();
       }
     }
@@ -333,8 +375,8 @@ QKeySequence KeymapManager::findShortcut(QString cmdName) {
 }
 
 bool KeymapManager::handle(QKeyEvent* event) {
-  bool result = runJSKeyEventFilter(event);
-  if (result) {
+  // Without filters, key events don't go to JS at all
+  if (m_jsKeyEventFilterEnabled && !m_jsKeyEventFilter.IsEmpty() && runJSKeyEventFilter(event)) {
     qDebug() << "key event is handled by an event filter";
     return true;
   }
@@ -410,6 +452,7 @@ void KeymapManager::add(const QKeySequence& key, CommandEvent cmdEvent) {
           m_cmdKeymapHash.erase(ev.cmdName());
         }
         m_keymaps.erase(it);
+        invalidateTrie();
         break;
       } else {
         // Ignore keymap defined in package keymap.yml
@@ -421,4 +464,5 @@ void KeymapManager::add(const QKeySequence& key, CommandEvent cmdEvent) {
   addShortcut(key, cmdEvent);
 
   m_keymaps.insert(std::make_pair(key, cmdEvent));
+  invalidateTrie();
 }
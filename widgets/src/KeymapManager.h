@@ -1,8 +1,10 @@
 #pragma once
 
 #include <v8.h>
+#include <memory>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 #include <QObject>
 
 #include "CommandEvent.h"
@@ -35,6 +37,8 @@ class KeymapManager : public QObject, public core::Singleton<KeymapManager> {
 
   // internal (only used in initialization in JS side)
   void _assignJSKeyEventFilter(core::FunctionInfo info);
+  // JS side enables the filter only while a package adds a key event filter
+  void _setJSKeyEventFilterEnabled(bool enabled);
 
  signals:
   void shortcutUpdated(const QString& cmdName, const QKeySequence& key);
@@ -42,6 +46,15 @@ class KeymapManager : public QObject, public core::Singleton<KeymapManager> {
 
  private:
   friend class core::Singleton<KeymapManager>;
+
+  // m_keymaps compiled into a trie of key combinations.
+  // e.g. 'ctrl+k, ctrl+c' is stored at root -> ctrl+k -> ctrl+c
+  struct TrieNode {
+    std::unordered_map<int, std::unique_ptr<TrieNode>> children;
+    // keymaps whose key ends at this node. They point to the values in m_keymaps.
+    std::vector<CommandEvent*> events;
+  };
+
   KeymapManager();
 
   void add(const QKeySequence& key, CommandEvent cmdEvent);
@@ -62,11 +75,19 @@ class KeymapManager : public QObject, public core::Singleton<KeymapManager> {
   // In this case, lower priority's keymap is removed
   std::unordered_multimap<QString, Keymap> m_cmdKeymapHash;
 
-  QString m_partiallyMatchedKeyString;
+  // null until dispatch needs it after keymaps are changed
+  std::unique_ptr<TrieNode> m_trie;
+  // node reached by the keys pressed so far in a multi-stroke key
+  const TrieNode* m_partialNode;
+  std::vector<int> m_partialKeys;
   std::unordered_map<QKeySequence, CommandEvent> m_emptyCmdKeymap;
   v8::UniquePersistent<v8::Function> m_jsKeyEventFilter;
+  bool m_jsKeyEventFilterEnabled;
 
   void removeKeymap();
+  void buildTrie();
+  void invalidateTrie();
+  void clearPartialMatch();
   void removeShortcut(const QString& cmdName);
   void addShortcut(const QKeySequence& key, CommandEvent cmdEvent);
   QString findCmdName(QKeySequence keySeq);
@@ -1,3 +1,6 @@
+#include <QMouseEvent>
+#include <QPainter>
+
 #include "LineNumberArea.h"
 #include "TextEdit.h"
 #include "core/Theme.h"
@@ -9,6 +12,7 @@ using core::Config;
 
 LineNumberArea::LineNumberArea(TextEdit* editor) : CustomWidget(editor), m_codeEditor(editor) {
   connect(&Config::singleton(), &Config::themeChanged, this, &LineNumberArea::setTheme);
+  connect(&Config::singleton(), &Config::fontChanged, this, [=] { m_digits = QPixmap(); });
   // Set default values
   setTheme(Config::singleton().theme());
 }
@@ -48,12 +52,24 @@ void LineNumberArea::paintEvent(QPaintEvent* event) {
   m_codeEditor->lineNumberAreaPaintEvent(event);
 }
 
+void LineNumberArea::mousePressEvent(QMouseEvent* event) {
+  if (event->button() != Qt::LeftButton || event->pos().x() < width() - FOLD_MARKER_WIDTH) {
+    CustomWidget::mousePressEvent(event);
+    return;
+  }
+
+  const QTextCursor cursor = m_codeEditor->cursorForPosition(QPoint(0, event->pos().y()));
+  m_codeEditor->toggleFold(cursor.blockNumber());
+  event->accept();
+}
+
 QColor LineNumberArea::lineNumberColor() const {
   return m_lineNumberColor;
 }
 
 void LineNumberArea::setLineNumberColor(QColor color) {
   m_lineNumberColor = color;
+  m_digits = QPixmap();
 }
 
 QColor LineNumberArea::backgroundColor() const {
@@ -63,3 +79,64 @@ QColor LineNumberArea::backgroundColor() const {
 void LineNumberArea::setBackgroundColor(QColor color) {
   m_backgroundColor = color;
 }
+
+void LineNumberArea::drawNumber(QPainter& painter, int number, int right, int top) {
+  if (m_digits.isNull() || m_digits.devicePixelRatio() != devicePixelRatioF()) {
+    updateDigits();
+  }
+
+  const qreal dpr = m_digits.devicePixelRatio();
+  const qreal height = m_digits.height() / dpr;
+  int x = right;
+  do {
+    const int digit = number % 10;
+    x -= m_digitWidths[digit];
+    painter.drawPixmap(QRectF(x, top, m_digitWidths[digit], height), m_digits,
+                       QRectF(m_digitOffsets[digit] * dpr, 0, m_digitWidths[digit] * dpr,
+                              m_digits.height()));
+    number /= 10;
+  } while (number > 0);
+}
+
+void LineNumberArea::drawFoldMarker(QPainter& painter, bool folded, int top, int height) {
+  const qreal size = FOLD_MARKER_WIDTH / 2.0;
+  const QPointF center(width() - FOLD_MARKER_WIDTH / 2.0, top + height / 2.0);
+  QPolygonF triangle;
+  if (folded) {
+    triangle << center + QPointF(-size / 3, -size / 2) << center + QPointF(size * 2 / 3, 0)
+             << center + QPointF(-size / 3, size / 2);
+  } else {
+    triangle << center + QPointF(-size / 2, -size / 3) << center + QPointF(size / 2, -size / 3)
+             << center + QPointF(0, size * 2 / 3);
+  }
+
+  painter.save();
+  painter.setRenderHint(QPainter::Antialiasing);
+  painter.setPen(Qt::NoPen);
+  painter.setBrush(m_lineNumberColor);
+  painter.drawPolygon(triangle);
+  painter.restore();
+}
+
+void LineNumberArea::updateDigits() {
+  const QFont& font = Config::singleton().font();
+  const QFontMetrics metrics(font);
+  int width = 0;
+  for (int i = 0; i < 10; i++) {
+    m_digitOffsets[i] = width;
+    m_digitWidths[i] = metrics.width(QLatin1Char('0' + i));
+    width += m_digitWidths[i];
+  }
+
+  const qreal dpr = devicePixelRatioF();
+  m_digits = QPixmap(QSize(width, metrics.height()) * dpr);
+  m_digits.setDevicePixelRatio(dpr);
+  m_digits.fill(Qt::transparent);
+
+  QPainter painter(&m_digits);
+  painter.setFont(font);
+  painter.setPen(m_lineNumberColor);
+  for (int i = 0; i < 10; i++) {
+    painter.drawText(m_digitOffsets[i], metrics.ascent(), QString(QLatin1Char('0' + i)));
+  }
+}
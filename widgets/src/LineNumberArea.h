@@ -1,5 +1,7 @@
 #pragma once
 
+#include <QPixmap>
+
 #include "CustomWidget.h"
 
 class TextEdit;
@@ -10,6 +12,8 @@ class Theme;
 class LineNumberArea : public CustomWidget {
  public:
   static const int PADDING_RIGHT = 5;
+  // width of the column of fold markers at the right
+  static const int FOLD_MARKER_WIDTH = 12;
   explicit LineNumberArea(TextEdit* editor);
   QSize sizeHint() const override;
 
@@ -20,8 +24,15 @@ class LineNumberArea : public CustomWidget {
   QColor currentLineBackgroundColor() const { return m_currentLineBackgroundColor; }
   void setCurrentLineBackgroundColor(QColor color) { m_currentLineBackgroundColor = color; }
 
+  // Draws number right-aligned to right with the digits rendered in advance
+  void drawNumber(QPainter& painter, int number, int right, int top);
+  // Draws a triangle pointing right if folded, or down if not, in the fold marker column
+  void drawFoldMarker(QPainter& painter, bool folded, int top, int height);
+
  protected:
   void paintEvent(QPaintEvent* event) override;
+  // A click on a fold marker toggles the fold
+  void mousePressEvent(QMouseEvent* event) override;
 
  private:
   TextEdit* m_codeEditor;
@@ -29,5 +40,12 @@ class LineNumberArea : public CustomWidget {
   QColor m_backgroundColor;
   QColor m_currentLineBackgroundColor;
 
+  // '0' to '9' rendered side by side with the current font, color and device pixel ratio.
+  // Null when it needs to be rendered again.
+  QPixmap m_digits;
+  int m_digitOffsets[10];
+  int m_digitWidths[10];
+
   void setTheme(core::Theme* theme);
+  void updateDigits();
 };
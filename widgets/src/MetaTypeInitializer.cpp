@@ -9,6 +9,8 @@
 #include "Console.h"
 #include "TextEdit.h"
 #include "FindReplaceView.h"
+#include "ProjectSearchView.h"
+#include "QuickOpenView.h"
 #include "WebPage.h"
 #include "WebChannel.h"
 #include "core/Condition.h"
@@ -28,6 +30,7 @@
 #include "core/ModelIndex.h"
 #include "core/ItemSelectionModel.h"
 #include "core/QtEnums.h"
+#include "core/Worker.h"
 
 void MetaTypeInitializer::init() {
   qRegisterMetaType<TabView*>();
@@ -46,6 +49,8 @@ void MetaTypeInitializer::init() {
   qRegisterMetaType<QEvent*>();
   qRegisterMetaType<QEvent::Type>("QEvent::Type");
   qRegisterMetaType<FindReplaceView*>();
+  qRegisterMetaType<ProjectSearchView*>();
+  qRegisterMetaType<QuickOpenView*>();
   qRegisterMetaType<QtMsgType>();
   qRegisterMetaType<const QValidator*>();  // for LineEdit::setValidator(const QValidator*)
   qRegisterMetaType<WebChannel*>();
@@ -62,6 +67,7 @@ void MetaTypeInitializer::init() {
   qRegisterMetaType<core::RootNode>("RootNode");
   qRegisterMetaType<core::LanguageParser>("LanguageParser");
   qRegisterMetaType<core::Region>("Region");
+  qRegisterMetaType<QVector<core::Region>>("QVector<Region>");
   qRegisterMetaType<core::SyntaxHighlighter*>("SyntaxHighlighter*");
   qRegisterMetaType<core::TextOption*>("core::TextOption*");
   qRegisterMetaType<core::TextOption::Flag>("Flag");
@@ -71,6 +77,7 @@ void MetaTypeInitializer::init() {
   qRegisterMetaType<core::QAbstractItemViewWrap*>("core::QAbstractItemViewWrap*");
   qRegisterMetaType<core::Rect*>("core::Rect");
   qRegisterMetaType<core::StringListModel*>("core::StringListModel*");
+  qRegisterMetaType<core::Worker*>("core::Worker*");
   qRegisterMetaType<core::ModelIndex*>("core::ModelIndex*");
   qRegisterMetaType<core::ItemSelectionModel*>("core::ItemSelectionModel*");
   qRegisterMetaType<core::ItemSelectionModel*>("ItemSelectionModel*");
@@ -0,0 +1,218 @@
+#include <algorithm>
+#include <QCheckBox>
+#include <QCompleter>
+#include <QDir>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QPushButton>
+#include <QTextBlock>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+#include "ProjectSearchView.h"
+#include "App.h"
+#include "DocumentManager.h"
+#include "LineEdit.h"
+#include "TextEdit.h"
+#include "core/Document.h"
+
+using core::Document;
+using core::ProjectSearch;
+using core::TrigramIndex;
+
+namespace {
+const char* FIND_TEXT = QT_TRANSLATE_NOOP("ProjectSearchView", "Find");
+const char* CANCEL_TEXT = QT_TRANSLATE_NOOP("ProjectSearchView", "Cancel");
+
+// data roles of result items
+const int PATH_ROLE = Qt::UserRole;
+const int LINE_ROLE = Qt::UserRole + 1;
+const int COLUMN_ROLE = Qt::UserRole + 2;
+const int LENGTH_ROLE = Qt::UserRole + 3;
+}
+
+ProjectSearchView::ProjectSearchView(QWidget* parent)
+    : CustomWidget(parent),
+      m_lineEdit(new LineEdit(this)),
+      m_regexChk(new QCheckBox(tr("Regex"), this)),
+      m_caseSensitiveChk(new QCheckBox(tr("Match Case"), this)),
+      m_wholeWordChk(new QCheckBox(tr("Whole Word"), this)),
+      m_findButton(new QPushButton(tr(FIND_TEXT), this)),
+      m_statusLabel(new QLabel(this)),
+      m_resultView(new QTreeWidget(this)) {
+  m_lineEdit->setAttribute(Qt::WA_MacShowFocusRect, 0);
+  QCompleter* completer = new QCompleter(this);
+  completer->setModel(&m_historyModel);
+  m_lineEdit->setCompleter(completer);
+
+  m_resultView->setHeaderHidden(true);
+  m_resultView->setUniformRowHeights(true);
+  m_resultView->header()->setStretchLastSection(true);
+
+  QHBoxLayout* inputLayout = new QHBoxLayout();
+  inputLayout->setContentsMargins(3, 1, 3, 1);
+  inputLayout->addWidget(m_lineEdit);
+  inputLayout->addWidget(m_regexChk);
+  inputLayout->addWidget(m_caseSensitiveChk);
+  inputLayout->addWidget(m_wholeWordChk);
+  inputLayout->addWidget(m_findButton);
+
+  QVBoxLayout* layout = new QVBoxLayout(this);
+  layout->setContentsMargins(0, 0, 0, 0);
+  layout->setSpacing(0);
+  layout->addLayout(inputLayout);
+  layout->addWidget(m_resultView);
+  layout->addWidget(m_statusLabel);
+  setLayout(layout);
+
+  connect(m_lineEdit, &LineEdit::returnPressed, this, &ProjectSearchView::find);
+  connect(m_findButton, &QPushButton::clicked, this, [=] {
+    if (m_search.isRunning()) {
+      cancel();
+    } else {
+      find();
+    }
+  });
+  connect(m_resultView, &QTreeWidget::itemActivated, this, &ProjectSearchView::openMatch);
+  connect(&m_search, &ProjectSearch::found, this, &ProjectSearchView::addResults);
+  connect(&m_search, &ProjectSearch::finished, this, &ProjectSearchView::onFinished);
+}
+
+void ProjectSearchView::setFileSystem(core::ProjectFileSystem* fileSystem) {
+  const QString rootPath = fileSystem->rootPath();
+  m_index.reset(new TrigramIndex(fileSystem, TrigramIndex::defaultIndexPath(rootPath)));
+  m_search.setIndex(m_index.get());
+  m_search.setFileSystem(fileSystem);
+  connect(&DocumentManager::singleton(), &DocumentManager::saved, m_index.get(),
+          &TrigramIndex::markChanged);
+  m_index->update();
+  setDirPath(rootPath);
+}
+
+void ProjectSearchView::setDirPath(const QString& dirPath) {
+  m_dirPath = dirPath;
+}
+
+void ProjectSearchView::show() {
+  QWidget::show();
+  m_lineEdit->setFocus();
+  m_lineEdit->selectAll();
+}
+
+void ProjectSearchView::find() {
+  const QString text = m_lineEdit->text();
+  if (text.isEmpty() || m_dirPath.isEmpty()) {
+    return;
+  }
+
+  m_historyModel.prepend(text);
+  m_resultView->clear();
+  if (!m_search.start(m_dirPath, text, findFlags())) {
+    m_statusLabel->setText(tr("Invalid search: %1").arg(text));
+    return;
+  }
+
+  m_findButton->setText(tr(CANCEL_TEXT));
+  m_statusLabel->setText(tr("Searching %1...").arg(QDir::toNativeSeparators(m_dirPath)));
+}
+
+void ProjectSearchView::cancel() {
+  m_search.cancel();
+}
+
+void ProjectSearchView::hideEvent(QHideEvent*) {
+  if (auto textEdit = App::instance()->activeTextEdit()) {
+    textEdit->setFocus();
+  }
+}
+
+Document::FindFlags ProjectSearchView::findFlags() {
+  Document::FindFlags flags;
+  if (m_regexChk->isChecked()) {
+    flags |= Document::FindFlag::FindRegex;
+  }
+  if (m_caseSensitiveChk->isChecked()) {
+    flags |= Document::FindFlag::FindCaseSensitively;
+  }
+  if (m_wholeWordChk->isChecked()) {
+    flags |= Document::FindFlag::FindWholeWords;
+  }
+  return flags;
+}
+
+void ProjectSearchView::addResults(const QVector<ProjectSearch::FileResult>& results) {
+  const QDir dir(m_dirPath);
+  QList<QTreeWidgetItem*> fileItems;
+  for (const ProjectSearch::FileResult& result : results) {
+    QTreeWidgetItem* fileItem = new QTreeWidgetItem();
+    fileItem->setText(0, QStringLiteral("%1 (%2)")
+                             .arg(QDir::toNativeSeparators(dir.relativeFilePath(result.path)))
+                             .arg(result.matches.size()));
+    fileItem->setData(0, PATH_ROLE, result.path);
+
+    for (const ProjectSearch::Match& match : result.matches) {
+      QTreeWidgetItem* item = new QTreeWidgetItem(fileItem);
+      item->setText(0, QStringLiteral("%1: %2").arg(match.line + 1).arg(match.lineText.trimmed()));
+      item->setData(0, LINE_ROLE, match.line);
+      item->setData(0, COLUMN_ROLE, match.column);
+      item->setData(0, LENGTH_ROLE, match.length);
+    }
+    fileItems.append(fileItem);
+  }
+
+  // adding items at once is much faster than adding them one by one
+  m_resultView->addTopLevelItems(fileItems);
+  for (QTreeWidgetItem* fileItem : fileItems) {
+    fileItem->setExpanded(true);
+  }
+}
+
+void ProjectSearchView::onFinished(int fileCount,
+                                   int matchCount,
+                                   bool canceled,
+                                   bool limitReached) {
+  m_findButton->setText(tr(FIND_TEXT));
+
+  QString status = tr("%1 matches in %2 files (%3 files searched)")
+                       .arg(matchCount)
+                       .arg(m_resultView->topLevelItemCount())
+                       .arg(fileCount);
+  if (canceled) {
+    status += tr(" - canceled");
+  } else if (limitReached) {
+    status += tr(" - too many matches. The search was stopped.");
+  }
+  m_statusLabel->setText(status);
+}
+
+void ProjectSearchView::openMatch(QTreeWidgetItem* item) {
+  QTreeWidgetItem* fileItem = item->parent() ? item->parent() : item;
+  if (DocumentManager::singleton().open(fileItem->data(0, PATH_ROLE).toString()) <= 0 ||
+      fileItem == item) {
+    return;
+  }
+
+  TextEdit* textEdit = App::instance()->activeTextEdit();
+  if (!textEdit) {
+    return;
+  }
+
+  // The file may have been changed after the search
+  const int line = item->data(0, LINE_ROLE).toInt();
+  const QTextBlock block = textEdit->document()->findBlockByNumber(line);
+  if (!block.isValid()) {
+    return;
+  }
+  const int lineEnd = block.position() + block.length() - 1;
+  const int begin = std::min(block.position() + item->data(0, COLUMN_ROLE).toInt(), lineEnd);
+  const int end = std::min(begin + item->data(0, LENGTH_ROLE).toInt(),
+                           textEdit->document()->characterCount() - 1);
+
+  QTextCursor cursor(block);
+  cursor.setPosition(begin);
+  cursor.setPosition(end, QTextCursor::KeepAnchor);
+  textEdit->setTextCursor(cursor);
+  textEdit->centerCursor();
+  textEdit->setFocus();
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <memory>
+#include <QWidget>
+
+#include "CustomWidget.h"
+#include "core/macros.h"
+#include "core/HistoryModel.h"
+#include "core/ProjectFileSystem.h"
+#include "core/ProjectSearch.h"
+#include "core/TrigramIndex.h"
+
+class LineEdit;
+class QCheckBox;
+class QLabel;
+class QPushButton;
+class QTreeWidget;
+class QTreeWidgetItem;
+
+// Searches files in a project directory and lists matches as they are found
+class ProjectSearchView : public CustomWidget {
+  Q_OBJECT
+  DISABLE_COPY(ProjectSearchView)
+
+ public:
+  explicit ProjectSearchView(QWidget* parent = nullptr);
+  ~ProjectSearchView() = default;
+  DEFAULT_MOVE(ProjectSearchView)
+
+  // Searches the project of the file system with its index. Sets dirPath to the root.
+  void setFileSystem(core::ProjectFileSystem* fileSystem);
+
+ public slots:
+  QString dirPath() const { return m_dirPath; }
+  void setDirPath(const QString& dirPath);
+  void show();
+  void find();
+  void cancel();
+
+ protected:
+  void hideEvent(QHideEvent* event) override;
+
+ private:
+  LineEdit* m_lineEdit;
+  QCheckBox* m_regexChk;
+  QCheckBox* m_caseSensitiveChk;
+  QCheckBox* m_wholeWordChk;
+  QPushButton* m_findButton;
+  QLabel* m_statusLabel;
+  QTreeWidget* m_resultView;
+  core::HistoryModel m_historyModel;
+  core::ProjectSearch m_search;
+  // index of the project
+  std::unique_ptr<core::TrigramIndex> m_index;
+  QString m_dirPath;
+
+  core::Document::FindFlags findFlags();
+  void addResults(const QVector<core::ProjectSearch::FileResult>& results);
+  void onFinished(int fileCount, int matchCount, bool canceled, bool limitReached);
+  void openMatch(QTreeWidgetItem* item);
+};
+
+Q_DECLARE_METATYPE(ProjectSearchView*)
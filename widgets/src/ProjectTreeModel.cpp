@@ -0,0 +1,311 @@
+#include <algorithm>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSet>
+
+#include "ProjectTreeModel.h"
+
+using core::ProjectFileSystem;
+
+ProjectTreeModel::ProjectTreeModel(ProjectFileSystem* fileSystem, QObject* parent)
+    : QAbstractItemModel(parent),
+      m_fileSystem(fileSystem),
+      m_root(Node{QString(), true, false, nullptr, 0, true, {}}),
+      m_dirIcon(m_iconProvider.icon(QFileIconProvider::Folder)) {
+  QString name = QDir(fileSystem->rootPath()).dirName();
+  if (name.isEmpty()) {
+    // "/" and "C:/"
+    name = QDir::toNativeSeparators(fileSystem->rootPath());
+  }
+  m_root.children.emplace_back(new Node{name, true, false, &m_root, 0, false, {}});
+  connect(fileSystem, &ProjectFileSystem::changed, this, &ProjectTreeModel::onFilesChanged);
+}
+
+ProjectTreeModel::~ProjectTreeModel() {}
+
+QString ProjectTreeModel::filePath(const QModelIndex& index) const {
+  if (!m_fileSystem || !index.isValid()) {
+    return QString();
+  }
+  return m_fileSystem->absolutePath(relativePath(node(index)));
+}
+
+bool ProjectTreeModel::isDir(const QModelIndex& index) const {
+  return index.isValid() && node(index)->isDir;
+}
+
+QModelIndex ProjectTreeModel::index(const QString& path) {
+  QString relativePath;
+  if (!m_fileSystem || !m_fileSystem->toRelativePath(path, relativePath)) {
+    return QModelIndex();
+  }
+
+  Node* current = m_root.children.front().get();
+  if (relativePath.isEmpty()) {
+    return indexOf(current);
+  }
+
+  for (const QString& name : relativePath.split(QLatin1Char('/'))) {
+    if (!current->isDir) {
+      return QModelIndex();
+    }
+    if (!current->fetched) {
+      fetchMore(indexOf(current));
+    }
+    auto it = std::find_if(current->children.begin(), current->children.end(),
+                           [&](const std::unique_ptr<Node>& child) { return child->name == name; });
+    if (it == current->children.end()) {
+      return QModelIndex();
+    }
+    current = it->get();
+  }
+  return indexOf(current);
+}
+
+QModelIndex ProjectTreeModel::index(int row, int column, const QModelIndex& parent) const {
+  const Node* parentNode = parent.isValid() ? node(parent) : &m_root;
+  if (column != 0 || row < 0 || row >= static_cast<int>(parentNode->children.size())) {
+    return QModelIndex();
+  }
+  return createIndex(row, column, parentNode->children[row].get());
+}
+
+QModelIndex ProjectTreeModel::parent(const QModelIndex& child) const {
+  if (!child.isValid()) {
+    return QModelIndex();
+  }
+  return indexOf(node(child)->parent);
+}
+
+int ProjectTreeModel::rowCount(const QModelIndex& parent) const {
+  if (parent.column() > 0) {
+    return 0;
+  }
+  return static_cast<int>((parent.isValid() ? node(parent) : &m_root)->children.size());
+}
+
+int ProjectTreeModel::columnCount(const QModelIndex&) const {
+  return 1;
+}
+
+// Directories show an expander before they are populated
+bool ProjectTreeModel::hasChildren(const QModelIndex& parent) const {
+  if (!parent.isValid()) {
+    return true;
+  }
+  const Node* parentNode = node(parent);
+  return parentNode->isDir && (!parentNode->fetched || !parentNode->children.empty());
+}
+
+bool ProjectTreeModel::canFetchMore(const QModelIndex& parent) const {
+  return parent.isValid() && node(parent)->isDir && !node(parent)->fetched;
+}
+
+void ProjectTreeModel::fetchMore(const QModelIndex& parent) {
+  if (!canFetchMore(parent) || !m_fileSystem) {
+    return;
+  }
+
+  Node* dir = node(parent);
+  dir->fetched = true;
+  const QVector<ProjectFileSystem::Entry> entries = m_fileSystem->entries(relativePath(dir));
+  if (entries.isEmpty()) {
+    // The rows are inserted by onFilesChanged
+    if (dir->isIgnored) {
+      m_fileSystem->fetch(relativePath(dir));
+    }
+    return;
+  }
+
+  beginInsertRows(parent, 0, entries.size() - 1);
+  for (const ProjectFileSystem::Entry& entry : entries) {
+    const int row = static_cast<int>(dir->children.size());
+    dir->children.emplace_back(
+        new Node{entry.name, entry.isDir, entry.isIgnored, dir, row, false, {}});
+  }
+  endInsertRows();
+}
+
+QVariant ProjectTreeModel::data(const QModelIndex& index, int role) const {
+  if (!index.isValid()) {
+    return QVariant();
+  }
+
+  const Node* current = node(index);
+  switch (role) {
+    case Qt::DisplayRole:
+    case Qt::EditRole:
+      return current->name;
+    case Qt::DecorationRole:
+      return icon(current);
+    default:
+      return QVariant();
+  }
+}
+
+bool ProjectTreeModel::setData(const QModelIndex& index, const QVariant& value, int role) {
+  if (!index.isValid() || role != Qt::EditRole || !m_fileSystem) {
+    return false;
+  }
+
+  const QString newName = value.toString();
+  const Node* current = node(index);
+  if (newName.isEmpty() || newName == current->name || newName.contains(QLatin1Char('/'))) {
+    return false;
+  }
+
+  const QString path = filePath(index);
+  const QString dirPath = filePath(index.parent());
+  if (!QFile::rename(path, QDir(dirPath).filePath(newName))) {
+    qWarning("failed to rename %s to %s", qPrintable(path), qPrintable(newName));
+    return false;
+  }
+
+  // The item is replaced after the editor is closed
+  QMetaObject::invokeMethod(m_fileSystem, "refresh", Qt::QueuedConnection, Q_ARG(QString, dirPath));
+  return true;
+}
+
+Qt::ItemFlags ProjectTreeModel::flags(const QModelIndex& index) const {
+  if (!index.isValid()) {
+    return Qt::NoItemFlags;
+  }
+
+  Qt::ItemFlags flags = Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+  const Node* current = node(index);
+  if (current->parent != &m_root) {
+    flags |= Qt::ItemIsEditable;
+  }
+  if (!current->isDir) {
+    flags |= Qt::ItemNeverHasChildren;
+  }
+  return flags;
+}
+
+ProjectTreeModel::Node* ProjectTreeModel::node(const QModelIndex& index) const {
+  return static_cast<Node*>(index.internalPointer());
+}
+
+QModelIndex ProjectTreeModel::indexOf(const Node* node) const {
+  if (!node || node == &m_root) {
+    return QModelIndex();
+  }
+  return createIndex(node->row, 0, const_cast<Node*>(node));
+}
+
+QString ProjectTreeModel::relativePath(const Node* node) const {
+  QStringList names;
+  for (; node && node->parent != &m_root && node != &m_root; node = node->parent) {
+    names.prepend(node->name);
+  }
+  return names.join(QLatin1Char('/'));
+}
+
+ProjectTreeModel::Node* ProjectTreeModel::findDir(const QString& relativePath) const {
+  Node* current = m_root.children.front().get();
+  if (relativePath.isEmpty()) {
+    return current->fetched ? current : nullptr;
+  }
+
+  for (const QString& name : relativePath.split(QLatin1Char('/'))) {
+    auto it = std::find_if(current->children.begin(), current->children.end(),
+                           [&](const std::unique_ptr<Node>& child) {
+                             return child->isDir && child->name == name;
+                           });
+    if (it == current->children.end()) {
+      return nullptr;
+    }
+    current = it->get();
+  }
+  return current->fetched ? current : nullptr;
+}
+
+// The children are a subsequence of the previous listing, which is sorted in the same order as the
+// new one. Removed runs are dropped first and then new runs are inserted in one pass each.
+void ProjectTreeModel::update(Node* dir) {
+  const QVector<ProjectFileSystem::Entry> entries = m_fileSystem->entries(relativePath(dir));
+  const QModelIndex parent = indexOf(dir);
+  auto matches = [](const Node& node, const ProjectFileSystem::Entry& entry) {
+    return node.isDir == entry.isDir && node.name == entry.name;
+  };
+
+  QSet<QString> dirNames;
+  QSet<QString> fileNames;
+  for (const ProjectFileSystem::Entry& entry : entries) {
+    (entry.isDir ? dirNames : fileNames).insert(entry.name);
+  }
+  auto isRemoved = [&](const std::unique_ptr<Node>& node) {
+    return !(node->isDir ? dirNames : fileNames).contains(node->name);
+  };
+
+  auto& children = dir->children;
+  for (int last = static_cast<int>(children.size()) - 1; last >= 0; last--) {
+    if (!isRemoved(children[last])) {
+      continue;
+    }
+    int first = last;
+    while (first > 0 && isRemoved(children[first - 1])) {
+      first--;
+    }
+    beginRemoveRows(parent, first, last);
+    children.erase(children.begin() + first, children.begin() + last + 1);
+    endRemoveRows();
+    last = first;
+  }
+  for (size_t row = 0; row < children.size(); row++) {
+    children[row]->row = static_cast<int>(row);
+  }
+
+  int row = 0;
+  int i = 0;
+  while (i < entries.size()) {
+    if (row < static_cast<int>(children.size()) && matches(*children[row], entries[i])) {
+      row++;
+      i++;
+      continue;
+    }
+
+    int end = i;
+    while (end < entries.size() &&
+           (row == static_cast<int>(children.size()) || !matches(*children[row], entries[end]))) {
+      end++;
+    }
+    const int count = end - i;
+    beginInsertRows(parent, row, row + count - 1);
+    std::vector<std::unique_ptr<Node>> nodes;
+    for (; i < end; i++) {
+      nodes.emplace_back(
+          new Node{entries[i].name, entries[i].isDir, entries[i].isIgnored, dir, 0, false, {}});
+    }
+    children.insert(children.begin() + row, std::make_move_iterator(nodes.begin()),
+                    std::make_move_iterator(nodes.end()));
+    for (size_t j = row; j < children.size(); j++) {
+      children[j]->row = static_cast<int>(j);
+    }
+    endInsertRows();
+    row += count;
+  }
+}
+
+QIcon ProjectTreeModel::icon(const Node* node) const {
+  if (node->isDir) {
+    return m_dirIcon;
+  }
+
+  const QFileInfo info(m_fileSystem ? m_fileSystem->absolutePath(relativePath(node)) : node->name);
+  const QString suffix = info.suffix();
+  auto it = m_fileIcons.find(suffix);
+  if (it == m_fileIcons.end()) {
+    it = m_fileIcons.insert(suffix, m_iconProvider.icon(info));
+  }
+  return it.value();
+}
+
+void ProjectTreeModel::onFilesChanged(const ProjectFileSystem::Changes& changes) {
+  for (const QString& dirPath : changes.changedDirs) {
+    if (Node* dir = findDir(dirPath)) {
+      update(dir);
+    }
+  }
+}
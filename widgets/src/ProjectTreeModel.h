@@ -0,0 +1,82 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <QAbstractItemModel>
+#include <QFileIconProvider>
+#include <QHash>
+#include <QIcon>
+#include <QPointer>
+
+#include "core/macros.h"
+#include "core/ProjectFileSystem.h"
+
+// Directory tree of a project for ProjectTreeView.
+//
+// Directories are populated lazily from the listings of ProjectFileSystem when they are expanded,
+// so the model never touches the disk. Ignored directories such as node_modules aren't crawled,
+// so they're fetched from the file system when they're expanded. Changes reported by the file
+// system are applied to the populated directories as row insertions and removals.
+//
+// The top level has a single item, the project directory.
+class ProjectTreeModel : public QAbstractItemModel {
+  Q_OBJECT
+  DISABLE_COPY(ProjectTreeModel)
+
+ public:
+  explicit ProjectTreeModel(core::ProjectFileSystem* fileSystem, QObject* parent = nullptr);
+  ~ProjectTreeModel();
+  DEFAULT_MOVE(ProjectTreeModel)
+
+  core::ProjectFileSystem* fileSystem() const { return m_fileSystem; }
+  QModelIndex rootIndex() const { return index(0, 0); }
+  // Returns the absolute path of an item
+  QString filePath(const QModelIndex& index) const;
+  bool isDir(const QModelIndex& index) const;
+  // Returns the item of an absolute path. Its ancestors are populated if needed.
+  QModelIndex index(const QString& path);
+
+  QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const override;
+  QModelIndex parent(const QModelIndex& child) const override;
+  int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+  int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+  bool hasChildren(const QModelIndex& parent = QModelIndex()) const override;
+  bool canFetchMore(const QModelIndex& parent) const override;
+  void fetchMore(const QModelIndex& parent) override;
+  QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+  // Renames a file or a directory
+  bool setData(const QModelIndex& index, const QVariant& value, int role = Qt::EditRole) override;
+  Qt::ItemFlags flags(const QModelIndex& index) const override;
+
+ private:
+  struct Node {
+    QString name;
+    bool isDir;
+    bool isIgnored;
+    Node* parent;
+    int row;
+    // true if the children have been populated
+    bool fetched;
+    std::vector<std::unique_ptr<Node>> children;
+  };
+
+  QPointer<core::ProjectFileSystem> m_fileSystem;
+  // invisible root whose only child is the project directory
+  Node m_root;
+  QFileIconProvider m_iconProvider;
+  QIcon m_dirIcon;
+  // suffix -> icon. The provider looks up the type of a file, so an icon is shared by a suffix.
+  mutable QHash<QString, QIcon> m_fileIcons;
+
+  Node* node(const QModelIndex& index) const;
+  QModelIndex indexOf(const Node* node) const;
+  // relative to the project directory
+  QString relativePath(const Node* node) const;
+  // Returns a populated directory. null if it isn't populated.
+  Node* findDir(const QString& relativePath) const;
+  void update(Node* dir);
+  QIcon icon(const Node* node) const;
+
+ private slots:
+  void onFilesChanged(const core::ProjectFileSystem::Changes& changes);
+};
@@ -9,18 +9,23 @@
 #include <QMessageBox>
 
 #include "ProjectTreeView.h"
+#include "ProjectTreeModel.h"
 #include "DocumentManager.h"
 #include "PlatformUtil.h"
+#include "ProjectSearchView.h"
+#include "Window.h"
 #include "core/Config.h"
 #include "core/Theme.h"
 #include "core/Util.h"
 #include "core/Constants.h"
+#include "core/ProjectFileSystem.h"
 
 using core::Util;
 using core::Config;
 using core::Theme;
 using core::ColorSettings;
 using core::Constants;
+using core::ProjectFileSystem;
 
 namespace {
 
@@ -61,44 +66,22 @@ ProjectTreeView::ProjectTreeView(QWidget* parent) : QTreeView(parent), m_model(n
   connect(&Config::singleton(), &Config::themeChanged, this, &ProjectTreeView::setTheme);
 }
 
-bool ProjectTreeView::openDirOrExpand(const QString& dirPath) {
-  QDir targetDir(dirPath);
-  if (targetDir.exists()) {
-    if (m_model) {
-      m_model->deleteLater();
-      m_model = nullptr;
-    }
-
-    m_model = new MyFileSystemModel(this);
-    m_connection =
-        connect(m_model, &QFileSystemModel::directoryLoaded, this, [=](const QString& path) {
-          qDebug() << "directoryLoaded" << path;
-          QObject::disconnect(m_connection);
-          focusRootDirectory(path);
-        });
-
-    FilterModel* const filter = new FilterModel(this, dirPath);
-    filter->setSourceModel(m_model);
-
-    setModel(filter);
-    if (targetDir.isRoot()) {
-      // To show all drives on Windows, set "" as root path
-      m_model->setRootPath("");
-      setRootIndex(filter->mapFromSource(m_model->index(m_model->rootPath())));
-    } else {
-      m_model->setRootPath(dirPath);
-      QDir parentDir(dirPath);
-      parentDir.cdUp();
-      QModelIndex rootIndex = filter->mapFromSource(m_model->index(parentDir.absolutePath()));
-      setRootIndex(rootIndex);
-    }
-
-    expandAll();
-    return true;
-  } else {
-    qWarning("%s doesn't exist", qPrintable(dirPath));
-    return false;
+void ProjectTreeView::setFileSystem(ProjectFileSystem* fileSystem) {
+  QAbstractItemModel* oldModel = model();
+  m_model = new ProjectTreeModel(fileSystem, this);
+  setModel(m_model);
+  if (oldModel) {
+    oldModel->deleteLater();
   }
+
+  const QModelIndex rootIndex = m_model->rootIndex();
+  expand(rootIndex);
+  // it causes crash somehow...
+  // This seems to be related to these issues which seem to be related with QAccessibleTableCell
+  // https://bugreports.qt.io/browse/QTBUG-43796
+  // https://bugreports.qt.io/browse/QTBUG-49907
+  //  setFocus();
+  selectionModel()->select(rootIndex, QItemSelectionModel::Select | QItemSelectionModel::Rows);
 }
 
 void ProjectTreeView::edit(const QModelIndex& index) {
@@ -106,8 +89,8 @@ void ProjectTreeView::edit(const QModelIndex& index) {
 }
 
 QString ProjectTreeView::dirPath() const {
-  if (auto filterModel = qobject_cast<FilterModel*>(model())) {
-    return filterModel->dirPath();
+  if (m_model && m_model->fileSystem()) {
+    return m_model->fileSystem()->rootPath();
   }
 
   return QString();
@@ -172,6 +155,7 @@ void ProjectTreeView::contextMenuEvent(QContextMenuEvent* event) {
   menu.addAction(tr("New File"), this, SLOT(createNewFile()));
   menu.addAction(tr("New Folder"), this, SLOT(createNewDir()));
   menu.addAction(PlatformUtil::showInFinderText(), this, SLOT(showInFinder()));
+  menu.addAction(tr("Find in Folder..."), this, SLOT(findInFolder()));
   menu.exec(event->globalPos());
 }
 
@@ -207,13 +191,11 @@ void ProjectTreeView::openOrExpand(QModelIndex index) {
     return;
   }
 
-  FilterModel* filter = qobject_cast<FilterModel*>(model());
-  if (filter && m_model) {
-    QString path = m_model->filePath(filter->mapToSource(index));
-    if (QFileInfo(path).isFile()) {
-      DocumentManager::singleton().open(path);
-    } else {
+  if (m_model) {
+    if (m_model->isDir(index)) {
       setExpanded(index, !isExpanded(index));
+    } else {
+      DocumentManager::singleton().open(m_model->filePath(index));
     }
   }
 }
@@ -224,46 +206,47 @@ void ProjectTreeView::rename() {
 
 void ProjectTreeView::remove() {
   QModelIndexList indices = selectedIndexes();
-  foreach (const QModelIndex& filterIndex, indices) {
-    FilterModel* filter = qobject_cast<FilterModel*>(model());
-    if (filter && m_model) {
-      QModelIndex index = filter->mapToSource(filterIndex);
-      QString filePath = m_model->filePath(index);
-      QFileInfo info(filePath);
-
-      // Ask user
-      auto reply = QMessageBox::question(this, "", tr("Delete '%1' ?").arg(info.fileName()));
-      if (reply == QMessageBox::No) {
-        return;
-      }
+  QStringList filePaths;
+  foreach (const QModelIndex& index, indices) {
+    if (m_model) {
+      filePaths.append(m_model->filePath(index));
+    }
+  }
+
+  // Removing a file removes its item from the model, so indices aren't used after that
+  foreach (const QString& filePath, filePaths) {
+    QFileInfo info(filePath);
+
+    // Ask user
+    auto reply = QMessageBox::question(this, "", tr("Delete '%1' ?").arg(info.fileName()));
+    if (reply == QMessageBox::No) {
+      return;
+    }
 
-      if (info.isFile()) {
-        if (!m_model->remove(index)) {
-          qDebug("failed to remove %s", qPrintable(filePath));
-        }
-      } else if (info.isDir()) {
-        if (!QDir(filePath).removeRecursively()) {
-          qDebug("failed to remove %s", qPrintable(filePath));
-        }
-      } else {
-        qWarning("%s is neither file nor directory", qPrintable(filePath));
+    if (info.isFile()) {
+      if (!QFile::remove(filePath)) {
+        qDebug("failed to remove %s", qPrintable(filePath));
+      }
+    } else if (info.isDir()) {
+      if (!QDir(filePath).removeRecursively()) {
+        qDebug("failed to remove %s", qPrintable(filePath));
       }
+    } else {
+      qWarning("%s is neither file nor directory", qPrintable(filePath));
     }
+    refresh(info.path());
   }
 }
 
 void ProjectTreeView::showInFinder() {
-  FilterModel* filter = qobject_cast<FilterModel*>(model());
-  if (filter && m_model) {
-    QString filePath = m_model->filePath(filter->mapToSource(currentIndex()));
-    PlatformUtil::showInFinder(filePath);
+  if (m_model) {
+    PlatformUtil::showInFinder(m_model->filePath(currentIndex()));
   }
 }
 
 void ProjectTreeView::createNewFile() {
-  FilterModel* filter = qobject_cast<FilterModel*>(model());
-  if (filter && m_model) {
-    QString filePath = m_model->filePath(filter->mapToSource(currentIndex()));
+  if (m_model) {
+    QString filePath = m_model->filePath(currentIndex());
     QFileInfo info(filePath);
     if (info.isDir()) {
       createNewFile(QDir(filePath));
@@ -276,9 +259,8 @@ void ProjectTreeView::createNewFile() {
 }
 
 void ProjectTreeView::createNewDir() {
-  FilterModel* filter = qobject_cast<FilterModel*>(model());
-  if (filter && m_model) {
-    QString filePath = m_model->filePath(filter->mapToSource(currentIndex()));
+  if (m_model) {
+    QString filePath = m_model->filePath(currentIndex());
     QFileInfo info(filePath);
     if (info.isDir()) {
       createNewDir(QDir(filePath));
@@ -290,64 +272,43 @@ void ProjectTreeView::createNewDir() {
   }
 }
 
-void ProjectTreeView::focusRootDirectory(const QString& path) {
-  FilterModel* filter = qobject_cast<FilterModel*>(model());
-  // it causes crash somehow...
-  // This seems to be related to these issues which seem to be related with QAccessibleTableCell
-  // https://bugreports.qt.io/browse/QTBUG-43796
-  // https://bugreports.qt.io/browse/QTBUG-49907
-  //  setFocus();
-  selectionModel()->select(filter->mapFromSource(m_model->index(path)),
-                           QItemSelectionModel::Select | QItemSelectionModel::Rows);
+void ProjectTreeView::findInFolder() {
+  Window* win = qobject_cast<Window*>(window());
+  if (m_model && win) {
+    QFileInfo info(m_model->filePath(currentIndex()));
+    ProjectSearchView* view = win->projectSearchView();
+    view->setDirPath(info.isDir() ? info.filePath() : info.path());
+    view->show();
+  }
+}
+
+void ProjectTreeView::refresh(const QString& dirPath) {
+  if (m_model && m_model->fileSystem()) {
+    m_model->fileSystem()->refresh(dirPath);
+  }
 }
 
 void ProjectTreeView::createNewFile(const QDir& dir) {
-  FilterModel* filter = qobject_cast<FilterModel*>(model());
   QFile newFile(getUniqueFileName(dir.absoluteFilePath(QStringLiteral("untitled"))));
   if (!newFile.open(QIODevice::WriteOnly))
     return;
   newFile.close();
-  expand(currentIndex());
-  QModelIndex index = filter->mapFromSource(m_model->index(newFile.fileName()));
+  refresh(dir.absolutePath());
+  expand(m_model->index(dir.absolutePath()));
+  QModelIndex index = m_model->index(newFile.fileName());
   edit(index);
 }
 
 void ProjectTreeView::createNewDir(const QDir& dir) {
-  FilterModel* filter = qobject_cast<FilterModel*>(model());
   QDir newDir(getUniqueDirName(dir.absoluteFilePath(QStringLiteral("untitled folder"))));
   if (dir.mkdir(newDir.dirName())) {
-    expand(currentIndex());
-    QModelIndex index = filter->mapFromSource(m_model->index(newDir.absolutePath()));
+    refresh(dir.absolutePath());
+    expand(m_model->index(dir.absolutePath()));
+    QModelIndex index = m_model->index(newDir.absolutePath());
     edit(index);
   }
 }
 
-MyFileSystemModel::MyFileSystemModel(QObject* parent) : QFileSystemModel(parent) {
-  setReadOnly(false);
-  removeColumns(1, 3);
-}
-
-int MyFileSystemModel::columnCount(const QModelIndex&) const {
-  return 1;
-}
-
-QVariant MyFileSystemModel::data(const QModelIndex& index, int role) const {
-  if (index.column() == 0) {
-    return QFileSystemModel::data(index, role);
-  } else {
-    return QVariant();
-  }
-}
-
 ProjectTreeView::~ProjectTreeView() {
   qDebug("~ProjectTreeView");
 }
-
-// Show only specific directory content
-bool FilterModel::filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const {
-  QModelIndex pathIndex = sourceModel()->index(sourceRow, 0, sourceParent);
-  // Without trailing /, can't distinguish hoge from hoge2
-  QString path = sourceModel()->data(pathIndex, QFileSystemModel::FilePathRole).toString() +
-                 QStringLiteral("/");
-  return dir.startsWith(path, Qt::CaseInsensitive) || path.startsWith(dir, Qt::CaseInsensitive);
-}
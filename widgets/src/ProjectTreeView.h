@@ -1,14 +1,13 @@
 #pragma once
 
+#include <QDir>
 #include <QTreeView>
-#include <QFileSystemModel>
-#include <QSortFilterProxyModel>
-#include <QSettings>
 
 #include "core/macros.h"
 
-class MyFileSystemModel;
+class ProjectTreeModel;
 namespace core {
+class ProjectFileSystem;
 class Theme;
 }
 
@@ -21,7 +20,8 @@ class ProjectTreeView : public QTreeView {
   ~ProjectTreeView();
   DEFAULT_MOVE(ProjectTreeView)
 
-  bool openDirOrExpand(const QString& dirName);
+  // Shows the tree of the file system and expands its root
+  void setFileSystem(core::ProjectFileSystem* fileSystem);
   void edit(const QModelIndex& index);
   QString dirPath() const;
 
@@ -33,8 +33,7 @@ class ProjectTreeView : public QTreeView {
   void resizeEvent(QResizeEvent* event) override;
 
  private:
-  MyFileSystemModel* m_model;
-  QMetaObject::Connection m_connection;
+  ProjectTreeModel* m_model;
 
   void setTheme(const core::Theme* theme);
   void setFont();
@@ -43,7 +42,8 @@ class ProjectTreeView : public QTreeView {
 
  private:
   void openOrExpand(QModelIndex index);
-  void focusRootDirectory(const QString& path);
+  // Lists the directory again to show the change immediately
+  void refresh(const QString& dirPath);
 
  private slots:
   void rename();
@@ -51,43 +51,5 @@ class ProjectTreeView : public QTreeView {
   void showInFinder();
   void createNewFile();
   void createNewDir();
-};
-
-/**
-*@brief Show only file system hierarchy
-*
-* QFileSystemModel provides not only file system hierarchy but other info like size, type, etc.
-*
-*/
-class MyFileSystemModel : public QFileSystemModel {
-  Q_OBJECT
-  DISABLE_COPY(MyFileSystemModel)
-
- public:
-  MyFileSystemModel(QObject* parent);
-  ~MyFileSystemModel() = default;
-  DEFAULT_MOVE(MyFileSystemModel)
-
-  int columnCount(const QModelIndex& parent = QModelIndex()) const override;
-  QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
-};
-
-class FilterModel : public QSortFilterProxyModel {
-  Q_OBJECT
-
- public:
-  FilterModel(QObject* parent, const QString& targetDir)
-      : QSortFilterProxyModel(parent), dir(targetDir) {
-    if (!dir.endsWith(QStringLiteral("/"))) {
-      dir += QStringLiteral("/");
-    }
-  }
-
-  QString dirPath() { return dir; }
-
- protected:
-  virtual bool filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const;
-
- private:
-  QString dir;
+  void findInFolder();
 };
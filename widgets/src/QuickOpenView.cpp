@@ -0,0 +1,118 @@
+#include <algorithm>
+#include <QApplication>
+#include <QDir>
+#include <QKeyEvent>
+#include <QListWidget>
+#include <QVBoxLayout>
+
+#include "QuickOpenView.h"
+#include "DocumentManager.h"
+#include "LineEdit.h"
+#include "core/Tracer.h"
+
+using core::FileIndex;
+
+namespace {
+const int MAX_RESULT_COUNT = 50;
+const int WIDTH = 500;
+const int MAX_HEIGHT = 400;
+}
+
+QuickOpenView::QuickOpenView(QWidget* parent)
+    : CustomWidget(parent, Qt::Popup),
+      m_lineEdit(new LineEdit(this)),
+      m_listWidget(new QListWidget(this)) {
+  m_lineEdit->setAttribute(Qt::WA_MacShowFocusRect, 0);
+  m_lineEdit->installEventFilter(this);
+  m_listWidget->setUniformItemSizes(true);
+  m_listWidget->setFocusPolicy(Qt::NoFocus);
+
+  QVBoxLayout* layout = new QVBoxLayout(this);
+  layout->setContentsMargins(3, 3, 3, 3);
+  layout->setSpacing(3);
+  layout->addWidget(m_lineEdit);
+  layout->addWidget(m_listWidget);
+  setLayout(layout);
+
+  connect(m_lineEdit, &LineEdit::textChanged, this, &QuickOpenView::updateList);
+  connect(m_listWidget, &QListWidget::itemActivated, this, &QuickOpenView::openSelected);
+}
+
+QString QuickOpenView::dirPath() const {
+  return m_index ? m_index->rootPath() : QString();
+}
+
+void QuickOpenView::setFileSystem(core::ProjectFileSystem* fileSystem) {
+  m_index.reset(new FileIndex(fileSystem));
+  // show files found by the crawler while typing
+  connect(m_index.get(), &FileIndex::updated, this, [=] {
+    if (isVisible()) {
+      updateList();
+    }
+  });
+}
+
+void QuickOpenView::show() {
+  if (!m_index) {
+    return;
+  }
+
+  // at the top center of the window
+  if (QWidget* window = parentWidget() ? parentWidget()->window() : nullptr) {
+    const int width = std::min(WIDTH, window->width());
+    const QPoint topLeft = window->mapToGlobal(QPoint((window->width() - width) / 2, 0));
+    setGeometry(topLeft.x(), topLeft.y(), width, MAX_HEIGHT);
+  }
+
+  m_lineEdit->clear();
+  m_listWidget->clear();
+  QWidget::show();
+  m_lineEdit->setFocus();
+}
+
+bool QuickOpenView::eventFilter(QObject* watched, QEvent* event) {
+  if (watched != m_lineEdit || event->type() != QEvent::KeyPress) {
+    return CustomWidget::eventFilter(watched, event);
+  }
+
+  auto keyEvent = static_cast<QKeyEvent*>(event);
+  switch (keyEvent->key()) {
+    case Qt::Key_Up:
+    case Qt::Key_Down:
+    case Qt::Key_PageUp:
+    case Qt::Key_PageDown:
+      QApplication::sendEvent(m_listWidget, event);
+      return true;
+    case Qt::Key_Return:
+    case Qt::Key_Enter:
+      openSelected();
+      return true;
+    case Qt::Key_Escape:
+      hide();
+      return true;
+    default:
+      return CustomWidget::eventFilter(watched, event);
+  }
+}
+
+void QuickOpenView::updateList() {
+  TRACE_SCOPE("QuickOpenView::updateList");
+  const QStringList paths = m_index->find(m_lineEdit->text(), MAX_RESULT_COUNT);
+  m_listWidget->clear();
+  for (const QString& path : paths) {
+    QListWidgetItem* item = new QListWidgetItem(QDir::toNativeSeparators(path), m_listWidget);
+    item->setData(Qt::UserRole, path);
+  }
+  m_listWidget->setCurrentRow(0);
+}
+
+void QuickOpenView::openSelected() {
+  QListWidgetItem* item = m_listWidget->currentItem();
+  if (!item || !m_index) {
+    return;
+  }
+
+  const QString path = m_index->rootPath() + QLatin1Char('/') + item->data(Qt::UserRole).toString();
+  hide();
+  DocumentManager::singleton().open(path);
+}
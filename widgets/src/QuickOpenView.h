@@ -0,0 +1,40 @@
+#pragma once
+
+#include <memory>
+#include <QWidget>
+
+#include "CustomWidget.h"
+#include "core/macros.h"
+#include "core/FileIndex.h"
+
+class LineEdit;
+class QListWidget;
+
+// Popup to open a file in the project by typing a part of its path (go to file)
+class QuickOpenView : public CustomWidget {
+  Q_OBJECT
+  DISABLE_COPY(QuickOpenView)
+
+ public:
+  explicit QuickOpenView(QWidget* parent = nullptr);
+  ~QuickOpenView() = default;
+  DEFAULT_MOVE(QuickOpenView)
+
+  bool eventFilter(QObject* watched, QEvent* event) override;
+  // Lists the files of the file system
+  void setFileSystem(core::ProjectFileSystem* fileSystem);
+
+ public slots:
+  QString dirPath() const;
+  void show();
+
+ private:
+  LineEdit* m_lineEdit;
+  QListWidget* m_listWidget;
+  std::unique_ptr<core::FileIndex> m_index;
+
+  void updateList();
+  void openSelected();
+};
+
+Q_DECLARE_METATYPE(QuickOpenView*)
@@ -23,6 +23,9 @@
 #include "core/Util.h"
 #include "core/TextCursor.h"
 #include "core/scoped_guard.h"
+#include "core/Tracer.h"
+#include "core/FoldingRanges.h"
+#include "core/BracketPairs.h"
 
 using core::Document;
 using core::Encoding;
@@ -111,6 +114,21 @@ void TextEditPrivate::updateLineNumberArea(const QRect& rect, int dy) {
 
   if (rect.contains(q_ptr->viewport()->rect()))
     updateLineNumberAreaWidth(0);
+
+  // Cursor blinks update a small rect and don't change the visible blocks
+  if (dy || rect.contains(q_ptr->viewport()->rect()))
+    updateVisibleBlocks();
+}
+
+void TextEditPrivate::updateVisibleBlocks() {
+  if (!m_document) {
+    return;
+  }
+
+  const QTextBlock first = q_ptr->firstVisibleBlock();
+  const QTextBlock last =
+      q_ptr->cursorForPosition(QPoint(0, q_ptr->viewport()->height() - 1)).block();
+  m_document->setVisibleBlocks(q_ptr, first.blockNumber(), last.blockNumber());
 }
 
 void TextEditPrivate::setTheme(Theme* theme) {
@@ -194,6 +212,7 @@ void TextEditPrivate::setupConnections(std::shared_ptr<core::Document> document)
   Q_Q(TextEdit);
 
   if (m_document) {
+    m_document->setVisibleBlocks(q, -1, -1);
     // QObject::disconnect from old document
     QObject::disconnect(m_document.get(), &Document::pathUpdated, q, &TextEdit::pathUpdated);
     QObject::disconnect(m_document.get(), &Document::languageChanged, q,
@@ -205,6 +224,8 @@ void TextEditPrivate::setupConnections(std::shared_ptr<core::Document> document)
     QObject::disconnect(m_document.get(), &Document::bomChanged, q, &TextEdit::bomChanged);
     QObject::disconnect(m_document.get(), SIGNAL(contentsChanged()), q,
                         SLOT(outdentCurrentLineIfNecessary()));
+    QObject::disconnect(m_document.get(), SIGNAL(parseFinished()), m_lineNumberArea,
+                        SLOT(update()));
   }
 
   m_document = document;
@@ -216,6 +237,53 @@ void TextEditPrivate::setupConnections(std::shared_ptr<core::Document> document)
   QObject::connect(m_document.get(), &Document::bomChanged, q, &TextEdit::bomChanged);
   QObject::connect(m_document.get(), SIGNAL(contentsChanged()), q,
                    SLOT(outdentCurrentLineIfNecessary()));
+  // fold markers
+  QObject::connect(m_document.get(), SIGNAL(parseFinished()), m_lineNumberArea, SLOT(update()));
+}
+
+core::FoldingRanges* TextEditPrivate::foldingRanges() {
+  return m_document ? m_document->foldingRanges() : nullptr;
+}
+
+void TextEditPrivate::moveCursorOutOf(const core::FoldRange& range) {
+  Q_Q(TextEdit);
+  const int line = q->textCursor().blockNumber();
+  if (range.first < line && line <= range.last) {
+    QTextCursor cursor(m_document->findBlockByNumber(range.first));
+    cursor.movePosition(QTextCursor::EndOfBlock);
+    q->setTextCursor(cursor);
+  }
+}
+
+void TextEditPrivate::revealCursor() {
+  Q_Q(TextEdit);
+  const QTextBlock block = q->textCursor().block();
+  core::FoldingRanges* ranges = foldingRanges();
+  if (ranges && !block.isVisible()) {
+    ranges->reveal(block.blockNumber());
+    m_lineNumberArea->update();
+  }
+}
+
+const core::BracketPairs* TextEditPrivate::bracketPairs() {
+  return m_document ? m_document->bracketPairs() : nullptr;
+}
+
+boost::optional<core::BracketPair> TextEditPrivate::bracketPairAtCursor() {
+  Q_Q(TextEdit);
+  const core::BracketPairs* brackets = bracketPairs();
+  if (!brackets) {
+    return boost::none;
+  }
+
+  const int pos = q->textCursor().position();
+  for (int bracketPos : {pos, pos - 1}) {
+    const int matched = brackets->match(bracketPos);
+    if (matched >= 0) {
+      return core::BracketPair{std::min(bracketPos, matched), std::max(bracketPos, matched)};
+    }
+  }
+  return boost::none;
 }
 
 boost::optional<Region> TextEditPrivate::find(const QString& text,
@@ -335,6 +403,9 @@ TextEdit::TextEdit(QWidget* parent)
           [=](const QString&) { update(); });
   connect(this, SIGNAL(saved()), this, SLOT(clearDirtyMarker()));
   connect(&Config::singleton(), SIGNAL(wordWrapChanged(bool)), this, SLOT(setWordWrap(bool)));
+  connect(this, SIGNAL(cursorPositionChanged()), this, SLOT(revealCursor()));
+  // repaint the highlight of the brackets at the cursor
+  connect(this, SIGNAL(cursorPositionChanged()), viewport(), SLOT(update()));
 
   // Set default values
   d->updateLineNumberAreaWidth(0);
@@ -365,6 +436,117 @@ Document* TextEdit::document() {
   return d_ptr->m_document ? d_ptr->m_document.get() : nullptr;
 }
 
+bool TextEdit::fold(int line) {
+  core::FoldingRanges* ranges = d_ptr->foldingRanges();
+  if (line < 0) {
+    line = textCursor().blockNumber();
+  }
+  const boost::optional<core::FoldRange> range =
+      ranges ? ranges->find(line) : boost::optional<core::FoldRange>();
+  if (!range || ranges->isFolded(line)) {
+    return false;
+  }
+
+  d_ptr->moveCursorOutOf(*range);
+  ranges->fold(line);
+  d_ptr->m_lineNumberArea->update();
+  return true;
+}
+
+bool TextEdit::unfold(int line) {
+  core::FoldingRanges* ranges = d_ptr->foldingRanges();
+  if (line < 0) {
+    line = textCursor().blockNumber();
+  }
+  if (!ranges || !ranges->unfold(line)) {
+    return false;
+  }
+
+  d_ptr->m_lineNumberArea->update();
+  return true;
+}
+
+void TextEdit::toggleFold(int line) {
+  if (!unfold(line)) {
+    fold(line);
+  }
+}
+
+void TextEdit::foldAll() {
+  core::FoldingRanges* ranges = d_ptr->foldingRanges();
+  if (!ranges) {
+    return;
+  }
+
+  // The outermost range containing the cursor comes first
+  const int line = textCursor().blockNumber();
+  for (const core::FoldRange& range : ranges->ranges()) {
+    if (range.first < line && line <= range.last) {
+      d_ptr->moveCursorOutOf(range);
+      break;
+    }
+  }
+  ranges->foldAll();
+  d_ptr->m_lineNumberArea->update();
+}
+
+void TextEdit::unfoldAll() {
+  if (core::FoldingRanges* ranges = d_ptr->foldingRanges()) {
+    ranges->unfoldAll();
+    d_ptr->m_lineNumberArea->update();
+  }
+}
+
+bool TextEdit::jumpToMatchingBracket() {
+  const core::BracketPairs* brackets = d_ptr->bracketPairs();
+  if (!brackets) {
+    return false;
+  }
+
+  QTextCursor cursor = textCursor();
+  const int pos = cursor.position();
+  int target;
+  if (const auto pair = d_ptr->bracketPairAtCursor()) {
+    target = pair->open == pos || pair->open == pos - 1 ? pair->close + 1 : pair->open;
+  } else if (const auto enclosing = brackets->enclosing(pos)) {
+    target = enclosing->close;
+  } else {
+    return false;
+  }
+
+  cursor.setPosition(target);
+  setTextCursor(cursor);
+  return true;
+}
+
+bool TextEdit::selectInsideBrackets() {
+  const core::BracketPairs* brackets = d_ptr->bracketPairs();
+  if (!brackets) {
+    return false;
+  }
+
+  QTextCursor cursor = textCursor();
+  const int start = cursor.selectionStart();
+  const int end = cursor.selectionEnd();
+  auto pair = brackets->enclosing(start);
+  while (pair && pair->close < end) {
+    pair = brackets->enclosing(pair->open);
+  }
+  if (!pair) {
+    return false;
+  }
+
+  if (start == pair->open + 1 && end == pair->close) {
+    cursor.setPosition(pair->open);
+    cursor.setPosition(pair->close + 1, QTextCursor::KeepAnchor);
+  } else {
+    cursor.setPosition(pair->open + 1);
+    cursor.setPosition(pair->close, QTextCursor::KeepAnchor);
+  }
+  setTextCursor(cursor);
+  return true;
+}
+
 QRect TextEdit::cursorRect() const {
   return QPlainTextEdit::cursorRect();
 }
@@ -527,7 +709,8 @@ int TextEdit::lineNumberAreaWidth() {
     ++digits;
   }
 
-  int space = 10 + Config::singleton().fontMetrics().width(QLatin1Char('9')) * digits;
+  int space = 10 + Config::singleton().fontMetrics().width(QLatin1Char('9')) * digits +
+              LineNumberArea::FOLD_MARKER_WIDTH;
 
   return space;
 }
@@ -545,6 +728,7 @@ void TextEdit::lineNumberAreaPaintEvent(QPaintEvent* event) {
     return;
   }
 
+  TRACE_SCOPE("TextEdit::lineNumberAreaPaintEvent");
   QPainter painter(d_ptr->m_lineNumberArea);
 
   // fill the entire background
@@ -563,14 +747,17 @@ void TextEdit::lineNumberAreaPaintEvent(QPaintEvent* event) {
   top = (int)blockBoundingGeometry(block).translated(contentOffset()).top();
   int bottom = top + (int)blockBoundingRect(block).height();
 
-  while (block.isValid() && top <= event->rect().bottom()) {
-    if (block.isVisible() && bottom >= event->rect().top()) {
-      QString number = QString::number(blockNumber + 1);
-      painter.setFont(Config::singleton().font());
-      painter.setPen(d_ptr->m_lineNumberArea->lineNumberColor());
-      painter.drawText(0, top,
-                       d_ptr->m_lineNumberArea->width() - d_ptr->m_lineNumberArea->PADDING_RIGHT,
-                       height, Qt::AlignRight, number);
+  const QRect& rect = event->rect();
+  const int right = d_ptr->m_lineNumberArea->width() - LineNumberArea::PADDING_RIGHT -
+                    LineNumberArea::FOLD_MARKER_WIDTH;
+  core::FoldingRanges* ranges = d_ptr->foldingRanges();
+  while (block.isValid() && top <= rect.bottom()) {
+    if (block.isVisible() && bottom >= rect.top()) {
+      d_ptr->m_lineNumberArea->drawNumber(painter, blockNumber + 1, right, top);
+      if (ranges && ranges->find(blockNumber)) {
+        d_ptr->m_lineNumberArea->drawFoldMarker(painter, ranges->isFolded(blockNumber), top,
+                                                height);
+      }
     }
 
     block = block.next();
@@ -581,6 +768,7 @@ void TextEdit::lineNumberAreaPaintEvent(QPaintEvent* event) {
 }
 
 void TextEdit::paintEvent(QPaintEvent* e) {
+  TRACE_SCOPE("TextEdit::paintEvent");
   QPlainTextEdit::paintEvent(e);
 
   QPainter painter(viewport());
@@ -619,6 +807,25 @@ void TextEdit::paintEvent(QPaintEvent* e) {
     } while (true);
   }
 
+  // highlight the bracket at the cursor and its pair
+  if (const auto pair = d_ptr->bracketPairAtCursor()) {
+    for (int pos : {pair->open, pair->close}) {
+      QTextBlock block = document()->findBlock(pos);
+      if (!block.isVisible() || !block.layout()) {
+        continue;
+      }
+      const int posInBlock = pos - block.position();
+      QTextLine textLine = block.layout()->lineForTextPosition(posInBlock);
+      if (textLine.isValid()) {
+        QRectF rect = textLine.naturalTextRect();
+        rect.setLeft(textLine.cursorToX(posInBlock));
+        rect.setRight(textLine.cursorToX(posInBlock + 1));
+        rect = rect.translated(blockBoundingGeometry(block).topLeft() + contentOffset());
+        painter.drawRoundedRect(rect.translated(0.5, 0.5), 2.0, 2.0);
+      }
+    }
+  }
+
   if (Config::singleton().showInvisibles()) {
     // draw an EOL string
     const int bottom = viewport()->rect().height();
@@ -626,6 +833,7 @@ void TextEdit::paintEvent(QPaintEvent* e) {
     QColor invisibleColor = adjustForEOL(palette().foreground().color());
     painter.setPen(invisibleColor);
 
+    const QString endOfLineStr = Config::singleton().endOfLineStr();
     QTextCursor cur = textCursor();
     cur.movePosition(QTextCursor::End);
     const int posEOF = cur.position();
@@ -639,8 +847,8 @@ void TextEdit::paintEvent(QPaintEvent* e) {
       QRect r = cursorRect(cur);
       if (r.top() >= bottom)
         break;
-      if (!Config::singleton().endOfLineStr().isEmpty()) {
-        painter.drawText(QPointF(r.left(), r.bottom()), Config::singleton().endOfLineStr());
+      if (!endOfLineStr.isEmpty()) {
+        painter.drawText(QPointF(r.left(), r.bottom()), endOfLineStr);
       }
       block = block.next();
     }
@@ -102,6 +102,18 @@ class TextEdit : public QPlainTextEdit, public core::ICloneable<TextEdit> {
   core::Document* document();
   QRect cursorRect() const;
   QRect cursorRect(const QTextCursor& cursor) const;
+  // Fold or unfold the range starting at line. line < 0 means the line of the cursor.
+  bool fold(int line = -1);
+  bool unfold(int line = -1);
+  void toggleFold(int line = -1);
+  void foldAll();
+  void unfoldAll();
+  // Moves the cursor to the other side of the bracket pair at the cursor, or to the closing
+  // bracket enclosing the cursor
+  bool jumpToMatchingBracket();
+  // Selects the inside of the brackets enclosing the selection. If it's selected already, the
+  // brackets are selected too.
+  bool selectInsideBrackets();
 
  signals:
   void pathUpdated(const QString& oldPath, const QString& newPath);
@@ -150,6 +162,7 @@ class TextEdit : public QPlainTextEdit, public core::ICloneable<TextEdit> {
   Q_PRIVATE_SLOT(d_func(), void updateLineNumberArea(const QRect&, int))
   Q_PRIVATE_SLOT(d_func(), void clearDirtyMarker())
   Q_PRIVATE_SLOT(d_func(), void setWordWrap(bool))
+  Q_PRIVATE_SLOT(d_func(), void revealCursor())
 };
 
 Q_DECLARE_METATYPE(TextEdit*)
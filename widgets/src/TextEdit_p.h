@@ -6,6 +6,10 @@
 #include "core/Region.h"
 
 namespace core {
+class BracketPairs;
+struct BracketPair;
+class FoldingRanges;
+struct FoldRange;
 class Regexp;
 class Theme;
 class Document;
@@ -30,6 +34,8 @@ class TextEditPrivate {
   void outdentCurrentLineIfNecessary();
   void updateLineNumberAreaWidth(int newBlockCount);
   void updateLineNumberArea(const QRect&, int);
+  // Tells the document which blocks the viewport shows
+  void updateVisibleBlocks();
   void setTheme(core::Theme* theme);
   void clearDirtyMarker();
   void emitLanguageChanged(const QString& scope);
@@ -44,4 +50,11 @@ class TextEditPrivate {
                           int end,
                                      core::Document::FindFlags flags);
   int tabWidth();
+  core::FoldingRanges* foldingRanges();
+  void moveCursorOutOf(const core::FoldRange& range);
+  // Unfolds the ranges hiding the cursor
+  void revealCursor();
+  const core::BracketPairs* bracketPairs();
+  // Returns the pair of the bracket after the cursor, or the one before it
+  boost::optional<core::BracketPair> bracketPairAtCursor();
 };
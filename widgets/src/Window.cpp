@@ -23,11 +23,15 @@
 #include "PlatformUtil.h"
 #include "App.h"
 #include "Console.h"
+#include "ProjectSearchView.h"
+#include "QuickOpenView.h"
+#include "DocumentManager.h"
 #include "core/Document.h"
 #include "core/Config.h"
 #include "core/Theme.h"
 #include "core/Util.h"
 #include "core/PackageManager.h"
+#include "core/ProjectFileSystem.h"
 #include "core/scoped_guard.h"
 
 using core::Config;
@@ -35,6 +39,7 @@ using core::Theme;
 using core::Util;
 using core::ColorSettings;
 using core::PackageManager;
+using core::ProjectFileSystem;
 using core::scoped_guard;
 
 namespace {
@@ -52,6 +57,9 @@ Window::Window(QWidget* parent, Qt::WindowFlags flags)
       m_projectView(nullptr),
       m_findReplaceView(new FindReplaceView(this)),
       m_console(new Console(this)),
+      m_projectSearchView(new ProjectSearchView(this)),
+      m_quickOpenView(new QuickOpenView(this)),
+      m_fileSystem(nullptr),
       m_firstPaintEventFired(false),
       m_horizontalSplitter(new QSplitter(Qt::Horizontal, this)) {
   ui->setupUi(this);
@@ -101,9 +109,11 @@ Window::Window(QWidget* parent, Qt::WindowFlags flags)
   ui->rootSplitter->setContentsMargins(0, 0, 0, 0);
   ui->rootSplitter->addWidget(m_horizontalSplitter);
   ui->rootSplitter->addWidget(m_console);
-  ui->rootSplitter->setSizes(QList<int>{500, 100});
+  ui->rootSplitter->addWidget(m_projectSearchView);
+  ui->rootSplitter->setSizes(QList<int>{500, 100, 200});
 
   m_console->hide();
+  m_projectSearchView->hide();
 
   setTheme(Config::singleton().theme());
   updateTitle();
@@ -440,22 +450,33 @@ TabView* Window::getActiveTabViewOrCreate() {
 }
 
 bool Window::openDir(const QString& dirPath) {
+  if (!QDir(dirPath).exists()) {
+    qWarning("%s doesn't exist", qPrintable(dirPath));
+    return false;
+  }
+
   if (!m_projectView) {
     m_projectView = new ProjectTreeView(this);
   }
 
   Q_ASSERT(m_projectView);
-  if (m_projectView->openDirOrExpand(dirPath)) {
-    // root splitter becomes the owner of a project view.
-    m_horizontalSplitter->insertWidget(0, m_projectView);
-    // Set the initial sizes for QSplitter widgets
-    QList<int> sizes;
-    sizes << 50 << 300;
-    m_horizontalSplitter->setSizes(sizes);
-    return true;
-  } else {
-    return false;
-  }
+  // The views and DocumentManager share one crawler and watcher of the directory
+  ProjectFileSystem* oldFileSystem = m_fileSystem;
+  m_fileSystem = new ProjectFileSystem(QDir(dirPath).absolutePath(), this);
+  m_projectView->setFileSystem(m_fileSystem);
+  m_projectSearchView->setFileSystem(m_fileSystem);
+  m_quickOpenView->setFileSystem(m_fileSystem);
+  DocumentManager::singleton().addFileSystem(m_fileSystem);
+  delete oldFileSystem;
+  m_fileSystem->start();
+
+  // root splitter becomes the owner of a project view.
+  m_horizontalSplitter->insertWidget(0, m_projectView);
+  // Set the initial sizes for QSplitter widgets
+  QList<int> sizes;
+  sizes << 50 << 300;
+  m_horizontalSplitter->setSizes(sizes);
+  return true;
 }
 
 void Window::paintEvent(QPaintEvent* event) {
@@ -18,9 +18,12 @@ class FindReplaceView;
 class TextEdit;
 class Toolbar;
 class Console;
+class ProjectSearchView;
+class QuickOpenView;
 
 namespace core {
 class Document;
+class ProjectFileSystem;
 }
 
 namespace Ui {
@@ -82,6 +85,8 @@ class Window : public QMainWindow {
   StatusBar* statusBar();
   Console* console() { return m_console; }
   FindReplaceView* findReplaceView() { return m_findReplaceView; }
+  ProjectSearchView* projectSearchView() { return m_projectSearchView; }
+  QuickOpenView* quickOpenView() { return m_quickOpenView; }
   TabView* activeTabView();
 
  signals:
@@ -104,6 +109,10 @@ class Window : public QMainWindow {
   ProjectTreeView* m_projectView;
   FindReplaceView* m_findReplaceView;
   Console* m_console;
+  ProjectSearchView* m_projectSearchView;
+  QuickOpenView* m_quickOpenView;
+  // files of the opened directory
+  core::ProjectFileSystem* m_fileSystem;
   bool m_firstPaintEventFired;
 
   // Splitter that splits ProjectView and editorWidget
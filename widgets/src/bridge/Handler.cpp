@@ -30,6 +30,8 @@
 #include "WebChannel.h"
 #include "Console.h"
 #include "FindReplaceView.h"
+#include "ProjectSearchView.h"
+#include "QuickOpenView.h"
 #include "util/YamlUtil.h"
 #include "core/Font.h"
 #include "core/JSHandler.h"
@@ -48,11 +50,16 @@
 #include "core/PackageManager.h"
 #include "core/TextOption.h"
 #include "core/Completer.h"
+#include "core/CompletionIndex.h"
+#include "core/SymbolIndex.h"
 #include "core/StringListModel.h"
 #include "core/Rect.h"
 #include "core/ItemSelectionModel.h"
 #include "core/QtEnums.h"
 #include "core/Validator.h"
+#include "core/GrammarProfiler.h"
+#include "core/Tracer.h"
+#include "core/Worker.h"
 #include "core/atom/node_includes.h"
 
 using core::Config;
@@ -69,11 +76,16 @@ using core::TextBlock;
 using core::PackageManager;
 using core::TextOption;
 using core::Completer;
+using core::CompletionIndex;
+using core::SymbolIndex;
 using core::StringListModel;
+using core::Worker;
 using core::Rect;
 using core::ItemSelectionModel;
 using core::QtEnums;
 using core::Validator;
+using core::GrammarProfiler;
+using core::Tracer;
 
 #ifdef Q_OS_WIN
 // MessageBox is defined in winuser.h
@@ -231,6 +243,8 @@ void bridge::Handler::lateInit(const v8::FunctionCallbackInfo<Value>& args) {
                   Util::stripNamespace(App::staticMetaObject.className()));
   setSingletonObj(exports, &CommandManager::singleton(),
                   Util::stripNamespace(CommandManager::staticMetaObject.className()));
+  setSingletonObj(exports, &CompletionIndex::singleton(),
+                  Util::stripNamespace(CompletionIndex::staticMetaObject.className()));
   setSingletonObj(exports, &DocumentManager::singleton(),
                   Util::stripNamespace(DocumentManager::staticMetaObject.className()));
   setSingletonObj(exports, &KeymapManager::singleton(),
@@ -239,6 +253,12 @@ void bridge::Handler::lateInit(const v8::FunctionCallbackInfo<Value>& args) {
                   Util::stripNamespace(ProjectManager::staticMetaObject.className()));
   setSingletonObj(exports, &PackageManager::singleton(),
                   Util::stripNamespace(PackageManager::staticMetaObject.className()));
+  setSingletonObj(exports, &SymbolIndex::singleton(),
+                  Util::stripNamespace(SymbolIndex::staticMetaObject.className()));
+  setSingletonObj(exports, &GrammarProfiler::singleton(),
+                  Util::stripNamespace(GrammarProfiler::staticMetaObject.className()));
+  setSingletonObj(exports, &Tracer::singleton(),
+                  Util::stripNamespace(Tracer::staticMetaObject.className()));
 
   // Config::get returns config whose type is decided based on ConfigDefinition, so we need to
   // handle it specially
@@ -256,6 +276,8 @@ void bridge::Handler::lateInit(const v8::FunctionCallbackInfo<Value>& args) {
   registerClass<Label>(exports);
   registerClass<LineEdit>(exports);
   registerClass<view::MessageBox>(exports);
+  registerClass<ProjectSearchView>(exports);
+  registerClass<QuickOpenView>(exports);
   registerClass<StringListModel>(exports);
   registerClass<TextEdit>(exports);
   registerClass<VBoxLayout>(exports);
@@ -264,6 +286,7 @@ void bridge::Handler::lateInit(const v8::FunctionCallbackInfo<Value>& args) {
   registerClass<WebView>(exports);
   registerClass<Window>(exports);
   registerClass<Validator>(exports);
+  registerClass<Worker>(exports);
 
   // Wrappers
   registerClass<Font>(exports);
@@ -350,9 +373,7 @@ void bridge::Handler::setSingletonObj(Local<Object>& exports,
 
   // create prototype object
   Local<Object> proto = Object::New(isolate);
-  Util::processWithPublicMethods(metaObj, [&](const QMetaMethod& method) {
-    NODE_SET_METHOD(proto, method.name().constData(), V8Util::invokeQObjectMethod);
-  });
+  ObjectTemplateStore::setMethods(proto, metaObj, isolate);
   JSHandler::inheritsQtEventEmitter(isolate, proto);
 
   // sets __proto__ (this doesn't create prototype property)